@@ -0,0 +1,447 @@
+/**
+ * @file AnyAngle.h
+ * @brief File containing the line-of-sight test, path smoothing and Theta*
+ * planner, for paths made of any-angle segments between corner waypoints.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#pragma once
+
+#include "Cell.h"
+#include "ConfigSpace.h"
+#include "MotionPlanning.h"
+#include "OpenList.h"
+#include "SearchStats.h"
+#include "SearchWorkspace.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Class providing the line-of-sight test between cells, and the
+ * smoothing of grid paths into the waypoints at their corners.
+ */
+class LineOfSight
+{
+  public:
+  /**
+   * @brief Check whether the straight segment between the centres of two cells
+   * only passes through accessible cells. The cells crossed are found by an
+   * integer supercover traversal, and tested a row span at a time against the
+   * free cells (or, at another robot radius, against the clearance).
+   * NOTE: as with the diagonal moves of the planners, the segment may pass
+   * through the shared corner of two blocked cells.
+   *
+   * @param cSpace The configuration space
+   * @param a The first cell
+   * @param b The second cell
+   * @param robotRadius The robot radius to check accessibility against, if
+   * other than the configuration space's own
+   * @return true If every cell crossed by the segment is accessible.
+   */
+  static bool isClear(const ConfigurationSpace& cSpace,
+                      const Cell& a,
+                      const Cell& b,
+                      const std::optional<size_t>& robotRadius = std::nullopt)
+  {
+    if (!cSpace.contains(a) || !cSpace.contains(b)) {
+      return false;
+    }
+    if (!robotRadius) {
+      const BitMap& free = cSpace.freeCells();
+      return allSpans(a, b, [&](const size_t y, size_t x0, size_t x1) {
+        return free.allSet(y, x0, x1);
+      });
+    }
+    return allSpans(a, b, [&](const size_t y, size_t x0, size_t x1) {
+      for (size_t x = x0; x <= x1; ++x) {
+        if (!cSpace.isAccessible(Cell(x, y), *robotRadius)) {
+          return false;
+        }
+      }
+      return true;
+    });
+  }
+
+  /**
+   * @brief Reduce a path found by one of the planners to the waypoints at its
+   * corners, such that the segments between consecutive waypoints are clear
+   * (see isClear()). The path is first reduced to the cells where its
+   * direction changes, then each waypoint is joined to the furthest of those
+   * it can see along the path.
+   *
+   * @param cSpace The configuration space the path was found in
+   * @param path The path from start to goal, as neighboring cells or as
+   * waypoints joined by clear segments
+   * @param robotRadius The robot radius the path was found for, if other than
+   * the configuration space's own
+   * @return std::vector<Cell> The waypoints, including the start and goal.
+   */
+  static std::vector<Cell> smoothPath(
+      const ConfigurationSpace& cSpace,
+      const std::vector<Cell>& path,
+      const std::optional<size_t>& robotRadius = std::nullopt)
+  {
+    if (path.size() <= 2U) {
+      return path;
+    }
+
+    // the straight runs of the path are always clear
+    std::vector<Cell> corners{path.front()};
+    for (size_t idx = 1; idx + 1 < path.size(); ++idx) {
+      const bool isStraight =
+          path[idx - 1].x() + path[idx + 1].x() == 2U * path[idx].x() &&
+          path[idx - 1].y() + path[idx + 1].y() == 2U * path[idx].y();
+      if (!isStraight) {
+        corners.push_back(path[idx]);
+      }
+    }
+    corners.push_back(path.back());
+
+    std::vector<Cell> waypoints{corners.front()};
+    for (size_t idx = 2; idx < corners.size(); ++idx) {
+      if (!isClear(cSpace, waypoints.back(), corners[idx], robotRadius)) {
+        waypoints.push_back(corners[idx - 1]);
+      }
+    }
+    waypoints.push_back(corners.back());
+    return waypoints;
+  }
+
+  /**
+   * @brief Calculate the Euclidean length of a path of waypoints.
+   */
+  static double pathLength(const std::vector<Cell>& waypoints)
+  {
+    double length = 0.0;
+    for (size_t idx = 1; idx < waypoints.size(); ++idx) {
+      length += waypoints[idx - 1].distance(waypoints[idx]);
+    }
+    return length;
+  }
+
+  private:
+  /**
+   * @brief Visit the cells crossed by the segment between the centres of two
+   * cells as horizontal spans, one per row, stopping early if a span fails the
+   * given test.
+   * NOTE: the next cell edge crossed is found by comparing the crossing
+   * parameters (ix + 1/2) / nx and (iy + 1/2) / ny without division. Where
+   * they are equal, the segment passes through a cell corner, and steps
+   * diagonally without touching the two cells either side.
+   *
+   * @param a The first cell
+   * @param b The second cell
+   * @param isFree The test of the inclusive span [x0, x1] of row y.
+   * @return true If all spans passed the test.
+   */
+  template <typename SpanTest>
+  static bool allSpans(const Cell& a, const Cell& b, SpanTest&& isFree)
+  {
+    const int64_t nx = static_cast<int64_t>(a.xDistance(b));
+    const int64_t ny = static_cast<int64_t>(a.yDistance(b));
+    const int64_t sx = b.x() >= a.x() ? 1 : -1;
+    const int64_t sy = b.y() >= a.y() ? 1 : -1;
+    int64_t x = static_cast<int64_t>(a.x());
+    int64_t y = static_cast<int64_t>(a.y());
+    int64_t spanStart = x;
+    const auto spanIsFree = [&]() {
+      return isFree(static_cast<size_t>(y),
+                    static_cast<size_t>(std::min(spanStart, x)),
+                    static_cast<size_t>(std::max(spanStart, x)));
+    };
+
+    for (int64_t ix = 0, iy = 0; ix < nx || iy < ny;) {
+      const int64_t decision = (1 + 2 * ix) * ny - (1 + 2 * iy) * nx;
+      if (decision < 0) {
+        // crosses a vertical edge first, staying in the same row
+        x += sx;
+        ++ix;
+        continue;
+      }
+      if (!spanIsFree()) {
+        return false;
+      }
+      if (decision == 0) {
+        x += sx;
+        ++ix;
+      }
+      y += sy;
+      ++iy;
+      spanStart = x;
+    }
+    return spanIsFree();
+  }
+};
+
+/**
+ * @brief Class used to perform the (Lazy) Theta* any-angle path-finding
+ * algorithm. This is A* over the 8-connected grid, except that a neighbor is
+ * reached straight from the parent of the expanded node whenever the parent
+ * can see it (see LineOfSight::isClear()), so parents need not be neighbors.
+ * The path is then the chain of parents, being only the waypoints at its
+ * corners, and is usually shorter than the smoothed grid path. The waypoints
+ * are then smoothed (see LineOfSight::smoothPath()), as Theta* leaves several
+ * slight bends where a path wraps around an obstacle.
+ * NOTE: the costs are Euclidean lengths, with the straight-line distance as
+ * the heuristic. Paths are not guaranteed to be the shortest any-angle paths,
+ * only close to them. The line of sight is only checked when a node is
+ * expanded, rather than for each of its neighbors, so each expansion costs a
+ * single line-of-sight test.
+ *
+ * @tparam OpenList The open list type, keyed on Euclidean lengths.
+ * @tparam Layout The layout of the per-node search state (see
+ * BasicSearchWorkspace).
+ */
+template <typename OpenList = IndexedHeap<double>,
+          typename Layout = RowMajorLayout>
+class BasicThetaStar
+{
+  public:
+  using cost_policy = EuclideanCost;
+  using cost_type = double;
+  using workspace_type = BasicSearchWorkspace<OpenList, Layout>;
+  using index_type = typename workspace_type::index_type;
+
+  /**
+   * @brief Construct a new Theta* object, sharing ownership of the
+   * configuration space.
+   *
+   * @param cSpace The configuration space to search.
+   */
+  explicit BasicThetaStar(SharedConfigSpace cSpace)
+      : m_cSpace(std::move(cSpace))
+  {
+    assert(m_cSpace);
+  }
+
+  /**
+   * @brief Construct a new Theta* object, borrowing the configuration space.
+   * NOTE: the configuration space is not copied, and must outlive this object.
+   *
+   * @param cSpace The configuration space to search.
+   */
+  explicit BasicThetaStar(const ConfigurationSpace& cSpace)
+      : m_cSpace(SharedConfigSpace(), &cSpace)
+  {
+    // do nothing
+  }
+
+  /**
+   * @brief Construct a new Theta* object for a robot of the given radius,
+   * sharing ownership of the configuration space (see BasicAStar).
+   * NOTE: throws if the configuration space's clearance was not computed.
+   *
+   * @param cSpace The configuration space to search.
+   * @param robotRadius The robot's radius, in cells.
+   */
+  BasicThetaStar(SharedConfigSpace cSpace, const size_t robotRadius)
+      : BasicThetaStar(std::move(cSpace))
+  {
+    SearchUtils::requireClearance(*m_cSpace);
+    m_robotRadius = robotRadius;
+  }
+
+  /**
+   * @brief Construct a new Theta* object for a robot of the given radius, as
+   * above, borrowing the configuration space.
+   *
+   * @param cSpace The configuration space to search.
+   * @param robotRadius The robot's radius, in cells.
+   */
+  BasicThetaStar(const ConfigurationSpace& cSpace, const size_t robotRadius)
+      : BasicThetaStar(cSpace)
+  {
+    SearchUtils::requireClearance(*m_cSpace);
+    m_robotRadius = robotRadius;
+  }
+
+  // prevent borrowing a temporary configuration space
+  explicit BasicThetaStar(ConfigurationSpace&& cSpace) = delete;
+  BasicThetaStar(ConfigurationSpace&& cSpace, size_t robotRadius) = delete;
+
+  const ConfigurationSpace& configSpace() const
+  {
+    return *m_cSpace;
+  }
+
+  size_t robotRadius() const
+  {
+    return m_robotRadius.value_or(m_cSpace->robotRadius());
+  }
+
+  /**
+   * @brief The robot radius searched using the clearance, if given, else none,
+   * as the padded cell states are searched.
+   */
+  std::optional<size_t> clearanceRadius() const
+  {
+    return m_robotRadius;
+  }
+
+  /**
+   * @brief Perform any-angle path-finding using the Theta* algorithm.
+   *
+   * @param start The start location
+   * @param goal The goal location
+   * @return std::vector<Cell> The waypoints of the path, ordered from start to
+   * goal, if found. Otherwise, an empty vector is returned.
+   */
+  std::vector<Cell> searchPath(const Cell& start, const Cell& goal) const
+  {
+    workspace_type workspace;
+    return searchPath(start, goal, workspace);
+  }
+
+  /**
+   * @brief Perform any-angle path-finding using the Theta* algorithm, as
+   * above, storing the search state in a caller-provided workspace.
+   *
+   * @param start The start location
+   * @param goal The goal location
+   * @param workspace The workspace used to store the search state
+   * @param stats If provided, the outcome, counters and timings of the search
+   * are written to it
+   * @return std::vector<Cell> The waypoints of the path, ordered from start to
+   * goal, if found. Otherwise, an empty vector is returned.
+   */
+  std::vector<Cell> searchPath(const Cell& start,
+                               const Cell& goal,
+                               workspace_type& workspace,
+                               SearchStats* stats = nullptr) const
+  {
+    SearchStats localStats;
+    SearchStats& st = stats ? *stats : localStats;
+    st = SearchStats();
+    const auto setupStart = SearchUtils::Clock::now();
+
+    st.status =
+        SearchUtils::checkStartGoal(*m_cSpace, start, goal, m_robotRadius);
+    if (st.status != search_status::FOUND) {
+      st.setupTime = SearchUtils::Clock::now() - setupStart;
+      return std::vector<Cell>();
+    }
+
+    workspace.reset(*m_cSpace);
+    OpenList& unexploredNodes = workspace.openList();
+    const index_type startIdx = workspace.idxFrom(start);
+    workspace.visit(startIdx, startIdx, 0.0);
+    unexploredNodes.push(startIdx, start.distance(goal));
+    ++st.heapPushes;
+    st.peakOpenListSize = 1U;
+
+    const auto searchStart = SearchUtils::Clock::now();
+    st.setupTime = searchStart - setupStart;
+    while (!unexploredNodes.empty()) {
+      const index_type qIdx = unexploredNodes.pop().item;
+      ++st.heapPops;
+      if (workspace.isExplored(qIdx)) {
+        // stale entry, for open lists without decrease-key
+        ++st.stalePops;
+        continue;
+      }
+      const Cell qPos = workspace.cellFrom(qIdx);
+      const uint8_t qMask =
+          SearchUtils::nbrMask(*m_cSpace, qPos, m_robotRadius);
+      ensureParentIsVisible(workspace, qIdx, qPos, qMask);
+      workspace.markExplored(qIdx);
+      ++st.nodesExpanded;
+
+      if (qPos == goal) {
+        const auto pathStart = SearchUtils::Clock::now();
+        st.searchTime = pathStart - searchStart;
+        std::vector<Cell> path = LineOfSight::smoothPath(
+            *m_cSpace,
+            SearchUtils::generatePath(workspace, goal),
+            m_robotRadius);
+        st.pathTime = SearchUtils::Clock::now() - pathStart;
+        st.workspaceBytes = workspace.bytes();
+        return path;
+      }
+
+      // the neighbors are assumed to be seen from the parent of the expanded
+      // node, which is only checked once they are expanded in turn
+      const index_type parentIdx = workspace.parent(qIdx);
+      const Cell parentPos = workspace.cellFrom(parentIdx);
+      const cost_type parentGCost = workspace.gCost(parentIdx);
+      const NeighborRange nbrs(qPos, qMask);
+      for (const Cell& nbrCell : nbrs) {
+        const index_type nbrIdx = workspace.idxFrom(nbrCell);
+        if (workspace.isExplored(nbrIdx)) {
+          continue;
+        }
+        const cost_type gCost = parentGCost + parentPos.distance(nbrCell);
+        const bool isOpen = workspace.isVisited(nbrIdx);
+        if (!isOpen || gCost < workspace.gCost(nbrIdx)) {
+          workspace.visit(nbrIdx, parentIdx, gCost);
+          const cost_type fCost = gCost + nbrCell.distance(goal);
+          if (isOpen) {
+            unexploredNodes.decreaseKey(nbrIdx, fCost);
+            ++st.heapDecreaseKeys;
+          } else {
+            unexploredNodes.push(nbrIdx, fCost);
+            ++st.heapPushes;
+          }
+          st.peakOpenListSize =
+              std::max(st.peakOpenListSize, unexploredNodes.size());
+        }
+      }
+    }
+    st.status = search_status::NOT_FOUND;
+    st.searchTime = SearchUtils::Clock::now() - searchStart;
+    st.workspaceBytes = workspace.bytes();
+    return std::vector<Cell>();
+  }
+
+  private:
+  SharedConfigSpace m_cSpace;
+  // the robot radius to search for, if other than the configuration space's
+  std::optional<size_t> m_robotRadius;
+
+  /**
+   * @brief Check the node being expanded can be seen from the parent it was
+   * assumed to be reached from. Otherwise, it is instead reached from the
+   * explored neighbor giving the lowest g-cost, which is always seen.
+   */
+  void ensureParentIsVisible(workspace_type& workspace,
+                             const index_type qIdx,
+                             const Cell& qPos,
+                             const uint8_t qMask) const
+  {
+    const index_type parentIdx = workspace.parent(qIdx);
+    if (parentIdx == qIdx ||
+        LineOfSight::isClear(*m_cSpace,
+                             workspace.cellFrom(parentIdx),
+                             qPos,
+                             m_robotRadius)) {
+      return;
+    }
+    index_type bestIdx = qIdx;
+    cost_type bestGCost = std::numeric_limits<cost_type>::max();
+    const NeighborRange nbrs(qPos, qMask);
+    for (auto nbrIt = nbrs.begin(); nbrIt != nbrs.end(); ++nbrIt) {
+      const index_type nbrIdx = workspace.idxFrom(*nbrIt);
+      if (!workspace.isExplored(nbrIdx)) {
+        continue;
+      }
+      const cost_type gCost = workspace.gCost(nbrIdx) +
+                              EuclideanCost::stepCost(nbrIt.direction());
+      if (gCost < bestGCost) {
+        bestIdx = nbrIdx;
+        bestGCost = gCost;
+      }
+    }
+    // the node was first reached from an explored neighbor
+    assert(bestIdx != qIdx);
+    workspace.visit(qIdx, bestIdx, bestGCost);
+  }
+};
+
+using ThetaStar = BasicThetaStar<>;
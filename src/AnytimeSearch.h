@@ -0,0 +1,436 @@
+/**
+ * @file AnytimeSearch.h
+ * @brief File containing the anytime (ARA*) path-finding algorithm, for
+ * queries with a bounded latency.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#pragma once
+
+#include "Cell.h"
+#include "ConfigSpace.h"
+#include "Heuristics.h"
+#include "MotionPlanning.h"
+#include "OpenList.h"
+#include "SearchStats.h"
+#include "SearchWorkspace.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <stop_token>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Structure containing the limits on the work of a single query. A
+ * query without limits runs to completion.
+ */
+struct SearchBudget {
+  // the wall time allowed, measured from the start of the query
+  std::optional<SearchStats::duration> timeLimit;
+  // the number of nodes allowed to be expanded
+  std::optional<size_t> maxExpansions;
+};
+
+/**
+ * @brief Class used to perform the Anytime Repairing A* (ARA*) path-finding
+ * algorithm. A first path is found quickly by weighted A*, with the heuristic
+ * inflated by the initial weight, then improved by repeating the search with
+ * smaller weights until the path is optimal or the budget is exhausted. Each
+ * repeat only re-expands the nodes whose costs improved, rather than starting
+ * over. The best path found so far is returned, with the bound on its cost
+ * relative to the optimal cost written to the search stats.
+ * NOTE: the budget is only checked every CHECK_INTERVAL expansions. If it is
+ * exhausted before the first path is found, no path is returned, so the
+ * initial weight should be large enough for the first search to fit within
+ * the budget.
+ * See: M. Likhachev, G. Gordon and S. Thrun, "ARA*: Anytime A* with Provable
+ * Bounds on Sub-Optimality", NIPS 2003.
+ *
+ * @tparam CostPolicy The move cost and heuristic policy.
+ * @tparam OpenList The open list type, keyed on the policy's cost type, which
+ * must support changing the key of any item (e.g., IndexedHeap).
+ * @tparam Layout The layout of the per-node search state (see
+ * BasicSearchWorkspace).
+ */
+template <typename CostPolicy = OctileCost,
+          typename OpenList = IndexedHeap<typename CostPolicy::cost_type>,
+          typename Layout = RowMajorLayout>
+class BasicAnytimeAStar
+{
+  // the inflated keys decrease along paths, whatever the cost policy
+  static_assert(!OpenList::NEEDS_MONOTONE_KEYS,
+                "ARA* cannot search with a bucket queue");
+
+  public:
+  using cost_policy = CostPolicy;
+  using cost_type = typename CostPolicy::cost_type;
+  using search_workspace_type = BasicSearchWorkspace<OpenList, Layout>;
+  using index_type = typename search_workspace_type::index_type;
+  using time_point = SearchUtils::Clock::time_point;
+
+  static constexpr double DEFAULT_WEIGHT = 3.0;
+  // the reduction of the weight after each search
+  static constexpr double WEIGHT_STEP = 0.5;
+  // the number of expansions between checks of the time limit
+  static constexpr size_t CHECK_INTERVAL = 64U;
+
+  /**
+   * @brief Structure holding the state of a query, which may be kept by the
+   * caller and reused between queries.
+   */
+  struct Workspace {
+    search_workspace_type search;
+    // the nodes explored by the current search
+    std::vector<index_type> exploredNodes;
+    // the explored nodes whose costs improved during the current search,
+    // which are reopened by the next search (with the nodes left open)
+    std::vector<index_type> inconsistentNodes;
+
+    size_t bytes() const
+    {
+      return search.bytes() +
+             (exploredNodes.capacity() + inconsistentNodes.capacity()) *
+                 sizeof(index_type);
+    }
+  };
+  using workspace_type = Workspace;
+
+  /**
+   * @brief Construct a new Anytime AStar object, sharing ownership of the
+   * configuration space.
+   * NOTE: throws if the initial weight is less than one.
+   *
+   * @param cSpace The configuration space to search.
+   * @param initialWeight The heuristic weight of the first search.
+   * @param budget The limits on the work of each query.
+   */
+  explicit BasicAnytimeAStar(SharedConfigSpace cSpace,
+                             const double initialWeight = DEFAULT_WEIGHT,
+                             const SearchBudget& budget = SearchBudget())
+      : m_cSpace(std::move(cSpace)),
+        m_initialWeight(initialWeight),
+        m_budget(budget)
+  {
+    assert(m_cSpace);
+    if (!(m_initialWeight >= 1.0)) {
+      throw std::runtime_error("Heuristic weight must be at least one");
+    }
+  }
+
+  /**
+   * @brief Construct a new Anytime AStar object, as above, borrowing the
+   * configuration space.
+   * NOTE: the configuration space is not copied, and must outlive this object.
+   */
+  explicit BasicAnytimeAStar(const ConfigurationSpace& cSpace,
+                             const double initialWeight = DEFAULT_WEIGHT,
+                             const SearchBudget& budget = SearchBudget())
+      : BasicAnytimeAStar(SharedConfigSpace(SharedConfigSpace(), &cSpace),
+                          initialWeight,
+                          budget)
+  {
+    // do nothing
+  }
+
+  // prevent borrowing a temporary configuration space
+  explicit BasicAnytimeAStar(ConfigurationSpace&& cSpace,
+                             double initialWeight = DEFAULT_WEIGHT,
+                             const SearchBudget& budget = SearchBudget()) =
+      delete;
+
+  const ConfigurationSpace& configSpace() const
+  {
+    return *m_cSpace;
+  }
+
+  size_t robotRadius() const
+  {
+    return m_cSpace->robotRadius();
+  }
+
+  /**
+   * @brief The robot radius searched using the clearance, being none, as the
+   * padded cell states are searched.
+   */
+  std::optional<size_t> clearanceRadius() const
+  {
+    return std::nullopt;
+  }
+
+  double initialWeight() const
+  {
+    return m_initialWeight;
+  }
+
+  const SearchBudget& budget() const
+  {
+    return m_budget;
+  }
+
+  /**
+   * @brief Find the best path possible within the budget.
+   *
+   * @param start The start location
+   * @param goal The goal location
+   * @return std::vector<Cell> The cell locations making up the path, ordered
+   * from start to goal, if found. Otherwise, an empty vector is returned.
+   */
+  std::vector<Cell> searchPath(const Cell& start, const Cell& goal) const
+  {
+    workspace_type workspace;
+    return searchPath(start, goal, workspace);
+  }
+
+  /**
+   * @brief Find the best path possible within the budget, as above, storing
+   * the search state in a caller-provided workspace.
+   *
+   * @param start The start location
+   * @param goal The goal location
+   * @param workspace The workspace used to store the search state
+   * @param stats If provided, the outcome, counters and timings of the search
+   * are written to it, including the suboptimality bound of the path
+   * @param cancel If a stop is requested, the search is abandoned, returning
+   * no path with the status CANCELLED (see SearchUtils::isCancelled())
+   * @return std::vector<Cell> The cell locations making up the path, ordered
+   * from start to goal, if found. Otherwise, an empty vector is returned.
+   */
+  std::vector<Cell> searchPath(const Cell& start,
+                               const Cell& goal,
+                               workspace_type& workspace,
+                               SearchStats* stats = nullptr,
+                               const std::stop_token& cancel = {}) const
+  {
+    return searchPath(start, goal, m_budget, workspace, stats, cancel);
+  }
+
+  /**
+   * @brief Find the best path possible within the given budget, rather than
+   * the planner's own, as above.
+   */
+  std::vector<Cell> searchPath(const Cell& start,
+                               const Cell& goal,
+                               const SearchBudget& budget,
+                               workspace_type& workspace,
+                               SearchStats* stats = nullptr,
+                               const std::stop_token& cancel = {}) const
+  {
+    SearchStats localStats;
+    SearchStats& st = stats ? *stats : localStats;
+    st = SearchStats();
+    const auto setupStart = SearchUtils::Clock::now();
+    const std::optional<time_point> deadline =
+        budget.timeLimit ? std::make_optional(setupStart + *budget.timeLimit)
+                         : std::nullopt;
+
+    st.status = SearchUtils::checkStartGoal(*m_cSpace, start, goal);
+    if (st.status != search_status::FOUND) {
+      st.setupTime = SearchUtils::Clock::now() - setupStart;
+      return std::vector<Cell>();
+    }
+
+    search_workspace_type& ws = workspace.search;
+    ws.reset(*m_cSpace);
+    workspace.exploredNodes.clear();
+    workspace.inconsistentNodes.clear();
+    const index_type startIdx = ws.idxFrom(start);
+    ws.visit(startIdx, startIdx, 0);
+    ws.openList().push(startIdx, key(start, goal, 0, m_initialWeight));
+    ++st.heapPushes;
+    st.peakOpenListSize = 1U;
+
+    const auto searchStart = SearchUtils::Clock::now();
+    st.setupTime = searchStart - setupStart;
+    std::optional<double> bound;
+    bool isCancelled = false;
+    for (double weight = m_initialWeight;;) {
+      if (!improvePath(
+              goal, weight, budget, deadline, cancel, workspace, st)) {
+        isCancelled = cancel.stop_requested();
+        break;
+      }
+      bound = std::min(weight, takeOpenNodes(goal, workspace, st));
+      if (*bound <= 1.0) {
+        break;
+      }
+      weight = std::max(1.0, std::min(weight - WEIGHT_STEP, *bound));
+      reopen(goal, weight, workspace, st);
+    }
+
+    const auto pathStart = SearchUtils::Clock::now();
+    st.searchTime = pathStart - searchStart;
+    st.workspaceBytes = workspace.bytes();
+    if (isCancelled) {
+      st.status = search_status::CANCELLED;
+      return std::vector<Cell>();
+    }
+    if (!bound) {
+      // the goal was never reached within the budget, or can't be reached
+      st.status = ws.openList().empty() ? search_status::NOT_FOUND
+                                        : search_status::BUDGET_EXHAUSTED;
+      return std::vector<Cell>();
+    }
+    // a search cut short by the budget may have improved on the last path
+    // found, but not tightened its bound
+    st.suboptimalityBound = std::max(1.0, *bound);
+    std::vector<Cell> path = SearchUtils::generatePath(ws, goal);
+    st.pathTime = SearchUtils::Clock::now() - pathStart;
+    return path;
+  }
+
+  private:
+  SharedConfigSpace m_cSpace;
+  double m_initialWeight;
+  SearchBudget m_budget;
+
+  static cost_type key(const Cell& c,
+                       const Cell& goal,
+                       const cost_type gCost,
+                       const double weight)
+  {
+    return static_cast<cost_type>(
+        gCost + weight * CostPolicy::heuristic(c, goal));
+  }
+
+  /**
+   * @brief Run weighted A* with the given weight until the path to the goal
+   * can't be improved by expanding any open node, or the budget is exhausted.
+   *
+   * @return true If the search completed within the budget (and wasn't
+   * cancelled), having reached the goal.
+   */
+  bool improvePath(const Cell& goal,
+                   const double weight,
+                   const SearchBudget& budget,
+                   const std::optional<time_point>& deadline,
+                   const std::stop_token& cancel,
+                   workspace_type& workspace,
+                   SearchStats& st) const
+  {
+    search_workspace_type& ws = workspace.search;
+    OpenList& unexploredNodes = ws.openList();
+    const index_type goalIdx = ws.idxFrom(goal);
+    while (!unexploredNodes.empty()) {
+      if (ws.isVisited(goalIdx) &&
+          ws.gCost(goalIdx) <= unexploredNodes.top().key) {
+        return true;
+      }
+      if (isExhausted(budget, deadline, st.nodesExpanded) ||
+          SearchUtils::isCancelled(cancel, st.nodesExpanded)) {
+        return false;
+      }
+
+      const index_type qIdx = unexploredNodes.pop().item;
+      ++st.heapPops;
+      ws.markExplored(qIdx);
+      workspace.exploredNodes.push_back(qIdx);
+      ++st.nodesExpanded;
+
+      const Cell qPos = ws.cellFrom(qIdx);
+      const cost_type parentGCost = ws.gCost(qIdx);
+      const NeighborRange nbrs(qPos,
+                               m_cSpace->nbrMask(qPos) & CostPolicy::MOVES);
+      for (auto nbrIt = nbrs.begin(); nbrIt != nbrs.end(); ++nbrIt) {
+        const Cell nbrCell = *nbrIt;
+        const index_type nbrIdx = ws.idxFrom(nbrCell);
+        const cost_type gCost =
+            parentGCost + CostPolicy::stepCost(nbrIt.direction());
+        if (ws.isVisited(nbrIdx) && gCost >= ws.gCost(nbrIdx)) {
+          continue;
+        }
+        if (ws.isExplored(nbrIdx)) {
+          // explored nodes aren't reopened until the next search
+          ws.visit(nbrIdx, qIdx, gCost);
+          ws.markExplored(nbrIdx);
+          workspace.inconsistentNodes.push_back(nbrIdx);
+          continue;
+        }
+        ws.visit(nbrIdx, qIdx, gCost);
+        const cost_type fCost = key(nbrCell, goal, gCost, weight);
+        if (unexploredNodes.contains(nbrIdx)) {
+          unexploredNodes.decreaseKey(nbrIdx, fCost);
+          ++st.heapDecreaseKeys;
+        } else {
+          unexploredNodes.push(nbrIdx, fCost);
+          ++st.heapPushes;
+        }
+        st.peakOpenListSize =
+            std::max(st.peakOpenListSize, unexploredNodes.size());
+      }
+    }
+    return ws.isVisited(goalIdx);
+  }
+
+  static bool isExhausted(const SearchBudget& budget,
+                          const std::optional<time_point>& deadline,
+                          const size_t nodesExpanded)
+  {
+    if (budget.maxExpansions && nodesExpanded >= *budget.maxExpansions) {
+      return true;
+    }
+    return deadline && nodesExpanded % CHECK_INTERVAL == 0U &&
+           SearchUtils::Clock::now() >= *deadline;
+  }
+
+  /**
+   * @brief Take the open and inconsistent nodes left by a search, ready to
+   * be reopened by the next search, and forget which nodes were explored.
+   *
+   * @return double The bound on the cost of the path to the goal relative to
+   * the optimal cost, being the ratio of its cost to the lowest (unweighted)
+   * f-cost of the nodes taken.
+   */
+  double takeOpenNodes(const Cell& goal,
+                       workspace_type& workspace,
+                       SearchStats& st) const
+  {
+    search_workspace_type& ws = workspace.search;
+    for (const index_type idx : workspace.exploredNodes) {
+      ws.markUnexplored(idx);
+    }
+    workspace.exploredNodes.clear();
+    std::vector<index_type>& openNodes = workspace.inconsistentNodes;
+    while (!ws.openList().empty()) {
+      openNodes.push_back(ws.openList().pop().item);
+      ++st.heapPops;
+    }
+    // a node may have become inconsistent more than once
+    std::sort(openNodes.begin(), openNodes.end());
+    openNodes.erase(std::unique(openNodes.begin(), openNodes.end()),
+                    openNodes.end());
+
+    double lowerBound = std::numeric_limits<double>::infinity();
+    for (const index_type idx : openNodes) {
+      const cost_type hCost = CostPolicy::heuristic(ws.cellFrom(idx), goal);
+      lowerBound = std::min(lowerBound,
+                            static_cast<double>(ws.gCost(idx)) +
+                                static_cast<double>(hCost));
+    }
+    const double pathCost = static_cast<double>(ws.gCost(ws.idxFrom(goal)));
+    return pathCost <= lowerBound ? 1.0 : pathCost / lowerBound;
+  }
+
+  /**
+   * @brief Reopen the nodes taken by takeOpenNodes(), keyed for the next
+   * search.
+   */
+  void reopen(const Cell& goal,
+              const double weight,
+              workspace_type& workspace,
+              SearchStats& st) const
+  {
+    search_workspace_type& ws = workspace.search;
+    for (const index_type idx : workspace.inconsistentNodes) {
+      ws.openList().push(idx,
+                         key(ws.cellFrom(idx), goal, ws.gCost(idx), weight));
+      ++st.heapPushes;
+    }
+    workspace.inconsistentNodes.clear();
+  }
+};
+using AnytimeAStar = BasicAnytimeAStar<>;
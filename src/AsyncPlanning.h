@@ -0,0 +1,184 @@
+/**
+ * @file AsyncPlanning.h
+ * @brief File containing a planner for answering path queries asynchronously
+ * on a thread pool, with cooperative cancellation.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#pragma once
+
+#include "Cell.h"
+#include "ConfigSpace.h"
+#include "MotionPlanning.h"
+#include "SearchStats.h"
+#include "ThreadPool.h"
+
+#include <future>
+#include <memory>
+#include <stop_token>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Structure containing the answer to an asynchronous path query.
+ */
+struct PathResult {
+  // the cell locations making up the path, ordered from start to goal, or
+  // empty if not found (see stats.status)
+  std::vector<Cell> path;
+  SearchStats stats;
+};
+
+/**
+ * @brief Class used to answer path queries asynchronously on a (possibly
+ * shared) thread pool, so callers aren't blocked while searching, using any
+ * planner providing a workspace_type and searchPath(start, goal, workspace,
+ * stats). Each query may be given a std::stop_token, which cancels it when a
+ * stop is requested from its std::stop_source: queries cancelled before they
+ * start are never searched, and planners taking the token in searchPath()
+ * (e.g., AStar) also abandon their search part way (with the status
+ * CANCELLED), freeing the worker for other queries.
+ * NOTE: the tasks share ownership of the planner and the per-worker
+ * workspaces, so queries still running when this object is destroyed finish
+ * normally.
+ *
+ * @tparam Planner The path-finding algorithm, e.g., AStar.
+ */
+template <typename Planner = AStar>
+class AsyncPlanner
+{
+  public:
+  using workspace_type = typename Planner::workspace_type;
+
+  /**
+   * @brief Construct a new Async Planner object, with its own thread pool.
+   *
+   * @param cSpace The configuration space to search.
+   * @param numWorkers The number of worker threads. If zero, the number of
+   * hardware threads is used.
+   */
+  explicit AsyncPlanner(SharedConfigSpace cSpace, const size_t numWorkers = 0U)
+      : AsyncPlanner(Planner(std::move(cSpace)),
+                     std::make_shared<ThreadPool>(numWorkers))
+  {
+    // do nothing
+  }
+
+  /**
+   * @brief Construct a new Async Planner object, running on a (possibly
+   * shared) thread pool.
+   *
+   * @param planner The planner used to answer each query.
+   * @param pool The thread pool to run the queries on.
+   */
+  AsyncPlanner(Planner planner, std::shared_ptr<ThreadPool> pool)
+      : m_state(std::make_shared<State>(std::move(planner), pool->size())),
+        m_pool(std::move(pool))
+  {
+    // do nothing
+  }
+
+  const Planner& planner() const
+  {
+    return m_state->planner;
+  }
+
+  const std::shared_ptr<ThreadPool>& pool() const
+  {
+    return m_pool;
+  }
+
+  /**
+   * @brief Submit a path query, to be answered by the next available worker.
+   * NOTE: waiting on the returned future from a task running on the same
+   * thread pool may deadlock if all workers are busy.
+   *
+   * @param start The start location
+   * @param goal The goal location
+   * @param cancel The token cancelling the query, if a stop is requested.
+   * @return std::future<PathResult> The future path and search stats.
+   */
+  std::future<PathResult> submit(const Cell& start,
+                                 const Cell& goal,
+                                 std::stop_token cancel = {}) const
+  {
+    return m_pool->submit(
+        [state = m_state, start, goal, cancel = std::move(cancel)](
+            const size_t workerIdx) {
+          return state->searchPath(start, goal, workerIdx, cancel);
+        });
+  }
+
+  /**
+   * @brief Submit a path query, as above, invoking the given callback with the
+   * result once answered, on the worker thread which answered it.
+   * NOTE: the callback should be quick (e.g., handing the result to another
+   * thread), as it holds up the worker. Exceptions thrown by the search or
+   * the callback are stored in the returned future.
+   *
+   * @param start The start location
+   * @param goal The goal location
+   * @param onComplete The callback, invoked as onComplete(PathResult&&).
+   * @param cancel The token cancelling the query, if a stop is requested.
+   * @return std::future<void> The future completion of the callback.
+   */
+  template <typename Callback>
+  std::future<void> submit(const Cell& start,
+                           const Cell& goal,
+                           Callback onComplete,
+                           std::stop_token cancel = {}) const
+  {
+    return m_pool->submit(
+        [state = m_state,
+         start,
+         goal,
+         onComplete = std::move(onComplete),
+         cancel = std::move(cancel)](const size_t workerIdx) mutable {
+          onComplete(state->searchPath(start, goal, workerIdx, cancel));
+        });
+  }
+
+  private:
+  /**
+   * @brief Structure holding the state shared with the submitted tasks.
+   */
+  struct State {
+    Planner planner;
+    // one workspace per pool worker, indexed by the worker running the query
+    std::vector<workspace_type> workspaces;
+
+    State(Planner p, const size_t numWorkers)
+        : planner(std::move(p)), workspaces(numWorkers)
+    {
+      // do nothing
+    }
+
+    PathResult searchPath(const Cell& start,
+                          const Cell& goal,
+                          const size_t workerIdx,
+                          const std::stop_token& cancel)
+    {
+      PathResult result;
+      if (cancel.stop_requested()) {
+        result.stats.status = search_status::CANCELLED;
+        return result;
+      }
+      workspace_type& workspace = workspaces[workerIdx];
+      if constexpr (requires {
+                      planner.searchPath(
+                          start, goal, workspace, &result.stats, cancel);
+                    }) {
+        result.path = planner.searchPath(
+            start, goal, workspace, &result.stats, cancel);
+      } else {
+        result.path =
+            planner.searchPath(start, goal, workspace, &result.stats);
+      }
+      return result;
+    }
+  };
+
+  std::shared_ptr<State> m_state;
+  std::shared_ptr<ThreadPool> m_pool;
+};
@@ -0,0 +1,137 @@
+/**
+ * @file BatchPlanning.h
+ * @brief File containing a planner for answering many path queries against the
+ * same configuration space in parallel.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#pragma once
+
+#include "Cell.h"
+#include "ConfigSpace.h"
+#include "MotionPlanning.h"
+#include "SearchStats.h"
+#include "SearchWorkspace.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+// stores {start, goal}
+using PathQuery = std::pair<Cell, Cell>;
+
+/**
+ * @brief Class used to answer batches of path queries in parallel, using any
+ * planner providing a workspace_type and searchPath(start, goal, workspace).
+ * NOTE: a single planner (and configuration space) is shared by all workers,
+ * with each worker using its own reusable search workspace.
+ *
+ * @tparam Planner The path-finding algorithm, e.g., AStar.
+ */
+template <typename Planner = AStar>
+class BatchPlanner
+{
+  public:
+  using workspace_type = typename Planner::workspace_type;
+
+  /**
+   * @brief Construct a new Batch Planner object, with its own thread pool.
+   *
+   * @param cSpace The configuration space to search.
+   * @param numWorkers The number of worker threads. If zero, the number of
+   * hardware threads is used.
+   */
+  explicit BatchPlanner(SharedConfigSpace cSpace, const size_t numWorkers = 0U)
+      : BatchPlanner(Planner(std::move(cSpace)),
+                     std::make_shared<ThreadPool>(numWorkers))
+  {
+    // do nothing
+  }
+
+  /**
+   * @brief Construct a new Batch Planner object, running on a (possibly
+   * shared) thread pool.
+   *
+   * @param planner The planner used to answer each query.
+   * @param pool The thread pool to run the queries on.
+   */
+  BatchPlanner(Planner planner, std::shared_ptr<ThreadPool> pool)
+      : m_planner(std::move(planner)),
+        m_pool(std::move(pool)),
+        m_workspaces(m_pool->size())
+  {
+    // do nothing
+  }
+
+  const Planner& planner() const
+  {
+    return m_planner;
+  }
+
+  const std::shared_ptr<ThreadPool>& pool() const
+  {
+    return m_pool;
+  }
+
+  /**
+   * @brief Search for paths for all of the given queries in parallel.
+   * NOTE: this blocks until all queries are answered, so must not be called
+   * from a task running on the same thread pool.
+   * NOTE: if any search throws, the remaining queries are still answered, and
+   * then the first worker's error is rethrown.
+   *
+   * @param queries The {start, goal} pairs to search paths for.
+   * @param stats If provided, resized to hold the search stats of each query,
+   * in the same order as the queries.
+   * @return std::vector<std::vector<Cell>> The path for each query, in the same
+   * order as the queries. Paths which are not found are empty.
+   */
+  std::vector<std::vector<Cell>> searchPaths(
+      std::span<const PathQuery> queries,
+      std::vector<SearchStats>* stats = nullptr)
+  {
+    std::vector<std::vector<Cell>> paths(queries.size());
+    if (stats) {
+      stats->assign(queries.size(), SearchStats());
+    }
+
+    // each worker takes the next unanswered query until none remain, which
+    // balances the load when query costs vary widely
+    std::atomic<size_t> nextQuery(0U);
+    auto work = [&](const size_t workerIdx) {
+      workspace_type& workspace = m_workspaces[workerIdx];
+      for (size_t idx = nextQuery++; idx < queries.size(); idx = nextQuery++) {
+        const auto& [start, goal] = queries[idx];
+        paths[idx] = m_planner.searchPath(
+            start, goal, workspace, stats ? &(*stats)[idx] : nullptr);
+      }
+    };
+
+    const size_t numTasks = std::min(m_pool->size(), queries.size());
+    std::vector<std::future<void>> tasks;
+    tasks.reserve(numTasks);
+    for (size_t taskIdx = 0; taskIdx < numTasks; ++taskIdx) {
+      tasks.emplace_back(m_pool->submit(work));
+    }
+    // the tasks use the locals above, so all must finish before any error
+    // from a query is rethrown
+    for (auto& task : tasks) {
+      task.wait();
+    }
+    for (auto& task : tasks) {
+      task.get();
+    }
+    return paths;
+  }
+
+  private:
+  Planner m_planner;
+  std::shared_ptr<ThreadPool> m_pool;
+  // one workspace per pool worker, indexed by the worker running the query
+  std::vector<workspace_type> m_workspaces;
+};
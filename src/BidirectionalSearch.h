@@ -0,0 +1,496 @@
+/**
+ * @file BidirectionalSearch.h
+ * @brief File containing the implementation of bidirectional A* path-finding,
+ * searching from both the start and the goal.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#pragma once
+
+#include "Cell.h"
+#include "ConfigSpace.h"
+#include "Heuristics.h"
+#include "MotionPlanning.h"
+#include "OpenList.h"
+#include "SearchStats.h"
+#include "SearchWorkspace.h"
+
+#include <algorithm>
+#include <array>
+#include <barrier>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Class used to perform bidirectional A* path-finding, with one search
+ * forward from the start and one backward from the goal which meet in the
+ * middle. In maps where a single search explores dead ends near one of the
+ * endpoints (e.g., the COMPLEX case on a 2500x1000 map), each search only has
+ * to reach about half way, often halving the nodes expanded.
+ * NOTE: this can expand more nodes than AStar, as each search is guided by
+ * only half of the heuristic. On winding mazes whose corridors cross the whole
+ * map (e.g., the MAZE case on a 2000x2000 map), both searches must flood most
+ * of the corridors anyway, and about a third more nodes are expanded than with
+ * AStar. Expanding the search with the smaller top key, rather than the smaller
+ * open list, was found to expand more again.
+ * NOTE: both searches use the average of the heuristics to the goal and from
+ * the start, which is consistent for either direction, so the search can stop
+ * as soon as the sum of the two lowest keys shows no path cheaper than the
+ * best found so far, and the paths are optimal. The same moves are allowed as
+ * with AStar.
+ * The below implementation follows the descriptions in:
+ *   T. Ikeda et al., "A fast algorithm for finding better routes by AI search
+ *   techniques", Vehicle Navigation and Information Systems Conference, 1994.
+ *   A. V. Goldberg and C. Harrelson, "Computing the shortest path: A* search
+ *   meets graph theory", SODA 2005.
+ *
+ * @tparam CostPolicy The move cost and heuristic policy.
+ * @tparam OpenList The open list type, keyed on the policy's cost type.
+ * @tparam Layout The layout of the per-node search state (see
+ * BasicSearchWorkspace).
+ */
+template <typename CostPolicy = OctileCost,
+          typename OpenList = IndexedHeap<typename CostPolicy::cost_type>,
+          typename Layout = RowMajorLayout>
+class BasicBidirectionalAStar
+{
+  static_assert(IS_COMPATIBLE_OPEN_LIST<CostPolicy, OpenList>,
+                "Bucket queues require a consistent cost policy");
+
+  public:
+  using cost_policy = CostPolicy;
+  using cost_type = typename CostPolicy::cost_type;
+  using search_workspace_type = BasicSearchWorkspace<OpenList, Layout>;
+  // the forward and backward search workspaces
+  using workspace_type = std::array<search_workspace_type, 2>;
+  using index_type = typename search_workspace_type::index_type;
+
+  // the nodes expanded by each search between checks for the two meeting,
+  // when run on two threads
+  static constexpr size_t PARALLEL_BATCH_SIZE = 256U;
+
+  /**
+   * @brief Construct a new BidirectionalAStar object, sharing ownership of the
+   * configuration space.
+   *
+   * @param cSpace The configuration space to search.
+   */
+  explicit BasicBidirectionalAStar(SharedConfigSpace cSpace)
+      : m_cSpace(std::move(cSpace))
+  {
+    assert(m_cSpace);
+  }
+
+  /**
+   * @brief Construct a new BidirectionalAStar object, borrowing the
+   * configuration space.
+   * NOTE: the configuration space is not copied, and must outlive this object.
+   *
+   * @param cSpace The configuration space to search.
+   */
+  explicit BasicBidirectionalAStar(const ConfigurationSpace& cSpace)
+      : m_cSpace(SharedConfigSpace(), &cSpace)
+  {
+    // do nothing
+  }
+
+  /**
+   * @brief Construct a new BidirectionalAStar object for a robot of the given
+   * radius, as for AStar.
+   * NOTE: throws if the configuration space's clearance was not computed.
+   *
+   * @param cSpace The configuration space to search.
+   * @param robotRadius The robot's radius, in cells.
+   */
+  BasicBidirectionalAStar(SharedConfigSpace cSpace, const size_t robotRadius)
+      : BasicBidirectionalAStar(std::move(cSpace))
+  {
+    SearchUtils::requireClearance(*m_cSpace);
+    m_robotRadius = robotRadius;
+  }
+
+  /**
+   * @brief Construct a new BidirectionalAStar object for a robot of the given
+   * radius, as above, borrowing the configuration space.
+   *
+   * @param cSpace The configuration space to search.
+   * @param robotRadius The robot's radius, in cells.
+   */
+  BasicBidirectionalAStar(const ConfigurationSpace& cSpace,
+                          const size_t robotRadius)
+      : BasicBidirectionalAStar(cSpace)
+  {
+    SearchUtils::requireClearance(*m_cSpace);
+    m_robotRadius = robotRadius;
+  }
+
+  // prevent borrowing a temporary configuration space
+  explicit BasicBidirectionalAStar(ConfigurationSpace&& cSpace) = delete;
+  BasicBidirectionalAStar(ConfigurationSpace&& cSpace,
+                          size_t robotRadius) = delete;
+
+  const ConfigurationSpace& configSpace() const
+  {
+    return *m_cSpace;
+  }
+
+  size_t robotRadius() const
+  {
+    return m_robotRadius.value_or(m_cSpace->robotRadius());
+  }
+
+  /**
+   * @brief The robot radius searched using the clearance, if given, else none,
+   * as the padded cell states are searched.
+   */
+  std::optional<size_t> clearanceRadius() const
+  {
+    return m_robotRadius;
+  }
+
+  /**
+   * @brief Perform bidirectional A* path-finding.
+   *
+   * @param start The start location
+   * @param goal The goal location
+   * @return std::vector<Cell> The cell locations making up the path, ordered
+   * from start to goal, if found. Otherwise, an empty vector is returned.
+   */
+  std::vector<Cell> searchPath(const Cell& start, const Cell& goal) const
+  {
+    workspace_type workspace;
+    return searchPath(start, goal, workspace);
+  }
+
+  /**
+   * @brief Perform bidirectional A* path-finding, as above, storing the state
+   * of both searches in a caller-provided workspace. The search with the
+   * smaller open list is expanded next.
+   *
+   * @param start The start location
+   * @param goal The goal location
+   * @param workspace The workspaces used to store the search state
+   * @param stats If provided, the outcome, counters and timings of the search
+   * are written to it, summed over both searches
+   * @return std::vector<Cell> The cell locations making up the path, ordered
+   * from start to goal, if found. Otherwise, an empty vector is returned.
+   */
+  std::vector<Cell> searchPath(const Cell& start,
+                               const Cell& goal,
+                               workspace_type& workspace,
+                               SearchStats* stats = nullptr) const
+  {
+    SearchStats localStats;
+    SearchStats& st = stats ? *stats : localStats;
+    st = SearchStats();
+    const auto setupStart = SearchUtils::Clock::now();
+    std::array<Frontier, 2> frontiers = makeFrontiers(start, goal, workspace);
+    if (!setUp(start, goal, frontiers, st)) {
+      st.setupTime = SearchUtils::Clock::now() - setupStart;
+      return std::vector<Cell>();
+    }
+
+    const auto searchStart = SearchUtils::Clock::now();
+    st.setupTime = searchStart - setupStart;
+    Meeting best;
+    while (!isFinished(
+        best, frontiers[0].topKey(), frontiers[1].topKey(), start, goal)) {
+      const size_t side = frontiers[0].workspace.openList().size() <=
+                                  frontiers[1].workspace.openList().size()
+                              ? 0U
+                              : 1U;
+      const Frontier& other = frontiers[1 - side];
+      expand(frontiers[side], [&](const index_type idx, const cost_type g) {
+        if (other.workspace.isVisited(idx)) {
+          best.merge({g + other.workspace.gCost(idx), idx});
+        }
+      });
+    }
+    return finish(best, frontiers, searchStart, st);
+  }
+
+  /**
+   * @brief Perform bidirectional A* path-finding, as above, running the
+   * backward search on a second thread. The searches run in batches, only
+   * checking where they meet in between, so neither reads the state of the
+   * other while it is being written.
+   *
+   * @param start The start location
+   * @param goal The goal location
+   * @param workspace The workspaces used to store the search state
+   * @param stats If provided, the outcome, counters and timings of the search
+   * are written to it, summed over both searches
+   * @return std::vector<Cell> The cell locations making up the path, ordered
+   * from start to goal, if found. Otherwise, an empty vector is returned.
+   */
+  std::vector<Cell> searchPathParallel(const Cell& start,
+                                       const Cell& goal,
+                                       workspace_type& workspace,
+                                       SearchStats* stats = nullptr) const
+  {
+    SearchStats localStats;
+    SearchStats& st = stats ? *stats : localStats;
+    st = SearchStats();
+    const auto setupStart = SearchUtils::Clock::now();
+    std::array<Frontier, 2> frontiers = makeFrontiers(start, goal, workspace);
+    if (!setUp(start, goal, frontiers, st)) {
+      st.setupTime = SearchUtils::Clock::now() - setupStart;
+      return std::vector<Cell>();
+    }
+
+    const auto searchStart = SearchUtils::Clock::now();
+    st.setupTime = searchStart - setupStart;
+    // written by each side only between the two barriers of a round, and read
+    // by both after the second
+    std::array<Meeting, 2> meetings;
+    std::array<cost_type, 2> topKeys{};
+    std::barrier sync(2);
+
+    const auto run = [&](const size_t side) {
+      Frontier& own = frontiers[side];
+      const Frontier& other = frontiers[1 - side];
+      std::vector<index_type> visited;
+      Meeting best;
+      do {
+        for (size_t count = 0; count < PARALLEL_BATCH_SIZE &&
+                               !own.workspace.openList().empty();
+             ++count) {
+          expand(own, [&](const index_type idx, const cost_type /* g */) {
+            visited.push_back(idx);
+          });
+        }
+        sync.arrive_and_wait();
+
+        // both searches are paused, so may read each other's state
+        for (const index_type idx : visited) {
+          if (other.workspace.isVisited(idx)) {
+            best.merge({own.workspace.gCost(idx) + other.workspace.gCost(idx),
+                        idx});
+          }
+        }
+        visited.clear();
+        meetings[side] = best;
+        topKeys[side] = own.topKey();
+        sync.arrive_and_wait();
+        best.merge(meetings[1 - side]);
+      } while (!isFinished(best, topKeys[0], topKeys[1], start, goal));
+    };
+    std::thread backward(run, 1U);
+    run(0U);
+    backward.join();
+
+    Meeting best = meetings[0];
+    best.merge(meetings[1]);
+    return finish(best, frontiers, searchStart, st);
+  }
+
+  private:
+  static constexpr cost_type INF = std::numeric_limits<cost_type>::max();
+
+  /**
+   * @brief Structure holding one direction of the search, from its source
+   * towards its target, with its own counters.
+   */
+  struct Frontier {
+    search_workspace_type& workspace;
+    Cell source;
+    Cell target;
+    SearchStats stats;
+
+    cost_type topKey()
+    {
+      return workspace.openList().empty() ? INF
+                                          : workspace.openList().top().key;
+    }
+  };
+
+  /**
+   * @brief Structure containing the cheapest path found through a node
+   * visited by both searches.
+   */
+  struct Meeting {
+    cost_type cost = INF;
+    index_type idx = 0U;
+
+    void merge(const Meeting& other)
+    {
+      if (other.cost < cost) {
+        *this = other;
+      }
+    }
+  };
+
+  SharedConfigSpace m_cSpace;
+  // the robot radius to search for, if other than the configuration space's
+  std::optional<size_t> m_robotRadius;
+
+  static std::array<Frontier, 2> makeFrontiers(const Cell& start,
+                                               const Cell& goal,
+                                               workspace_type& workspace)
+  {
+    return {Frontier{workspace[0], start, goal, SearchStats()},
+            Frontier{workspace[1], goal, start, SearchStats()}};
+  }
+
+  /**
+   * @brief Get the key of a node in the search from source to target, being
+   * twice its g-cost plus the difference of its heuristics to the target and
+   * from the source. The heuristic between the start and goal is added to
+   * keep the keys from being negative.
+   */
+  static cost_type key(const Frontier& frontier,
+                       const Cell& c,
+                       const cost_type g)
+  {
+    return 2 * g + CostPolicy::heuristic(c, frontier.target) +
+           CostPolicy::heuristic(frontier.source, frontier.target) -
+           CostPolicy::heuristic(c, frontier.source);
+  }
+
+  /**
+   * @brief Check the start and goal, and put each on the open list of its own
+   * search.
+   *
+   * @return bool Whether the query is valid.
+   */
+  bool setUp(const Cell& start,
+             const Cell& goal,
+             std::array<Frontier, 2>& frontiers,
+             SearchStats& st) const
+  {
+    st.status =
+        SearchUtils::checkStartGoal(*m_cSpace, start, goal, m_robotRadius);
+    if (st.status != search_status::FOUND) {
+      return false;
+    }
+    for (Frontier& frontier : frontiers) {
+      frontier.workspace.reset(*m_cSpace);
+      const index_type idx = frontier.workspace.idxFrom(frontier.source);
+      frontier.workspace.visit(idx, idx, 0);
+      frontier.workspace.openList().push(idx,
+                                         key(frontier, frontier.source, 0));
+      ++frontier.stats.heapPushes;
+      frontier.stats.peakOpenListSize = 1U;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Check whether the search can stop: once no path through the nodes
+   * still open in either search can be cheaper than the best found, or once
+   * either search has run out of nodes.
+   */
+  static bool isFinished(const Meeting& best,
+                         const cost_type forwardKey,
+                         const cost_type backwardKey,
+                         const Cell& start,
+                         const Cell& goal)
+  {
+    if (forwardKey == INF || backwardKey == INF) {
+      return true;
+    }
+    // the keys of a node on a path of cost C sum to 2 * (C + h(start, goal))
+    return best.cost != INF &&
+           forwardKey + backwardKey >=
+               2 * (best.cost + CostPolicy::heuristic(start, goal));
+  }
+
+  /**
+   * @brief Expand the next open node of a search, calling onVisit(idx, g) for
+   * each neighbor reached with a lower g-cost.
+   */
+  template <typename OnVisit>
+  void expand(Frontier& frontier, OnVisit&& onVisit) const
+  {
+    search_workspace_type& workspace = frontier.workspace;
+    SearchStats& st = frontier.stats;
+    OpenList& unexploredNodes = workspace.openList();
+    const index_type qIdx = unexploredNodes.pop().item;
+    ++st.heapPops;
+    if (workspace.isExplored(qIdx)) {
+      // stale entry, for open lists without decrease-key
+      ++st.stalePops;
+      return;
+    }
+    workspace.markExplored(qIdx);
+    ++st.nodesExpanded;
+    const Cell qPos = workspace.cellFrom(qIdx);
+    const cost_type parentGCost = workspace.gCost(qIdx);
+
+    // moves are symmetric, so the backward search follows the same moves
+    const NeighborRange nbrs(
+        qPos,
+        SearchUtils::nbrMask(*m_cSpace, qPos, m_robotRadius) &
+            CostPolicy::MOVES);
+    for (auto nbrIt = nbrs.begin(); nbrIt != nbrs.end(); ++nbrIt) {
+      const Cell nbrCell = *nbrIt;
+      const index_type nbrIdx = workspace.idxFrom(nbrCell);
+      if (workspace.isExplored(nbrIdx)) {
+        continue;
+      }
+      const cost_type gCost =
+          parentGCost + CostPolicy::stepCost(nbrIt.direction());
+      const bool isOpen = workspace.isVisited(nbrIdx);
+      if (!isOpen || gCost < workspace.gCost(nbrIdx)) {
+        workspace.visit(nbrIdx, qIdx, gCost);
+        const cost_type nbrKey = key(frontier, nbrCell, gCost);
+        if (isOpen) {
+          unexploredNodes.decreaseKey(nbrIdx, nbrKey);
+          ++st.heapDecreaseKeys;
+        } else {
+          unexploredNodes.push(nbrIdx, nbrKey);
+          ++st.heapPushes;
+        }
+        st.peakOpenListSize =
+            std::max(st.peakOpenListSize, unexploredNodes.size());
+        onVisit(nbrIdx, gCost);
+      }
+    }
+  }
+
+  /**
+   * @brief Sum the counters of both searches, and join their paths to the
+   * meeting node, if any.
+   */
+  std::vector<Cell> finish(const Meeting& best,
+                           const std::array<Frontier, 2>& frontiers,
+                           const SearchUtils::Clock::time_point& searchStart,
+                           SearchStats& st) const
+  {
+    for (const Frontier& frontier : frontiers) {
+      st.nodesExpanded += frontier.stats.nodesExpanded;
+      st.heapPushes += frontier.stats.heapPushes;
+      st.heapPops += frontier.stats.heapPops;
+      st.heapDecreaseKeys += frontier.stats.heapDecreaseKeys;
+      st.stalePops += frontier.stats.stalePops;
+      st.peakOpenListSize += frontier.stats.peakOpenListSize;
+      st.workspaceBytes += frontier.workspace.bytes();
+    }
+    const auto pathStart = SearchUtils::Clock::now();
+    st.searchTime = pathStart - searchStart;
+    if (best.cost == INF) {
+      st.status = search_status::NOT_FOUND;
+      return std::vector<Cell>();
+    }
+
+    // the forward path runs from the start, and the backward path from the
+    // meeting node back to the goal, its own parent
+    const search_workspace_type& backward = frontiers[1].workspace;
+    std::vector<Cell> path = SearchUtils::generatePath(
+        frontiers[0].workspace, frontiers[0].workspace.cellFrom(best.idx));
+    for (index_type idx = best.idx; backward.parent(idx) != idx;) {
+      idx = backward.parent(idx);
+      path.push_back(backward.cellFrom(idx));
+    }
+    st.pathTime = SearchUtils::Clock::now() - pathStart;
+    return path;
+  }
+};
+
+using BidirectionalAStar = BasicBidirectionalAStar<>;
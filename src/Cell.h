@@ -62,6 +62,22 @@ class Cell
     return sqrt(dx * dx + dy * dy);
   }
 
+  /**
+   * @brief Calculate the absolute difference in x-indices between two cells.
+   */
+  size_t xDistance(const Cell& other) const
+  {
+    return m_x > other.m_x ? m_x - other.m_x : other.m_x - m_x;
+  }
+
+  /**
+   * @brief Calculate the absolute difference in y-indices between two cells.
+   */
+  size_t yDistance(const Cell& other) const
+  {
+    return m_y > other.m_y ? m_y - other.m_y : other.m_y - m_y;
+  }
+
   bool operator==(const Cell& other) const
   {
     return m_x == other.m_x && m_y == other.m_y;
@@ -9,12 +9,29 @@
 #pragma once
 
 #include "Cell.h"
+#include "Connectivity.h"
+#include "DistanceTransform.h"
 #include "Grid.h"
+#include "RowKernels.h"
+#include "ThreadPool.h"
+#include "TiledGrid.h"
 
 #include <algorithm>
-#include <numeric>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
 #include <ostream>
+#include <stdexcept>
 #include <string>
+#include <tuple>
+#include <unordered_set>
 #include <vector>
 
 /**
@@ -22,10 +39,138 @@
  */
 enum class cell_state : uint8_t { FREE, OBJECT, PADDED };
 
+/**
+ * @brief Offset from a cell to one of its eight neighbors.
+ */
+struct NbrOffset {
+  int dx;
+  int dy;
+};
+
+/**
+ * @brief Offsets to the eight neighbors of a cell, ordered counter-clockwise
+ * starting from +x. The position in this array is the bit used for the
+ * neighbor in a free-neighbor mask, so odd bits are the diagonal moves and bit
+ * (i + 4) % 8 is the opposite direction of bit i.
+ */
+constexpr std::array<NbrOffset, 8> NBR_OFFSETS{{{1, 0},
+                                                {1, 1},
+                                                {0, 1},
+                                                {-1, 1},
+                                                {-1, 0},
+                                                {-1, -1},
+                                                {0, -1},
+                                                {1, -1}}};
+
+/**
+ * @brief Lightweight, non-allocating range over the neighbors of a cell which
+ * are set in a free-neighbor mask.
+ */
+class NeighborRange
+{
+  public:
+  class Iterator
+  {
+    public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Cell;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Cell*;
+    using reference = Cell;
+
+    Iterator() : m_center(), m_bits(0U)
+    {
+      // do nothing
+    }
+
+    Iterator(const Cell& center, const uint8_t bits)
+        : m_center(center), m_bits(bits)
+    {
+      // do nothing
+    }
+
+    Cell operator*() const
+    {
+      const NbrOffset& offset = NBR_OFFSETS[direction()];
+      return Cell(m_center.x() + offset.dx, m_center.y() + offset.dy);
+    }
+
+    /**
+     * @brief The bit / direction index of the current neighbor.
+     */
+    size_t direction() const
+    {
+      return static_cast<size_t>(std::countr_zero(m_bits));
+    }
+
+    Iterator& operator++()
+    {
+      // clear the lowest set bit
+      m_bits &= static_cast<uint8_t>(m_bits - 1U);
+      return *this;
+    }
+
+    Iterator operator++(int)
+    {
+      Iterator prev = *this;
+      ++(*this);
+      return prev;
+    }
+
+    bool operator==(const Iterator& other) const
+    {
+      return m_bits == other.m_bits;
+    }
+
+    bool operator!=(const Iterator& other) const
+    {
+      return !(*this == other);
+    }
+
+    private:
+    Cell m_center;
+    uint8_t m_bits;
+  };
+
+  NeighborRange(const Cell& center, const uint8_t mask)
+      : m_center(center), m_mask(mask)
+  {
+    // do nothing
+  }
+
+  Iterator begin() const
+  {
+    return Iterator(m_center, m_mask);
+  }
+
+  Iterator end() const
+  {
+    return Iterator(m_center, 0U);
+  }
+
+  size_t size() const
+  {
+    return static_cast<size_t>(std::popcount(m_mask));
+  }
+
+  bool empty() const
+  {
+    return m_mask == 0U;
+  }
+
+  private:
+  Cell m_center;
+  uint8_t m_mask;
+};
+
 /**
  * @brief Class used for defining the configuration space, including obstacles.
  * NOTE: the domain boundaries and obstacles are padded by the robot's radius to
  * limit its work space.
+ * NOTE: the cell states and free-neighbor masks may be stored in tiles (see
+ * grid_storage), only allocated where they differ from those of free space,
+ * for large maps which are mostly free. The bit-packed free cells, the
+ * connected components and the clearance are always dense.
  */
 class ConfigurationSpace : public GridIndexer
 {
@@ -38,21 +183,31 @@ class ConfigurationSpace : public GridIndexer
    * @param numX The number of cells in the x-dimension in the task space.
    * @param numY The number of cells in the y-dimension in the task space.
    * @param robotRadius The robot radius, in number of cells.
+   * @param storage The storage of the cell states and free-neighbor masks.
    */
   ConfigurationSpace(const size_t numX,
                      const size_t numY,
-                     const size_t robotRadius)
+                     const size_t robotRadius,
+                     const grid_storage storage = grid_storage::DENSE)
       : GridIndexer(numX, numY),
         m_robotRadius(robotRadius),
-        m_cellStates(std::make_pair(numX, numY), cell_state::FREE)
+        m_cellStates(std::make_pair(numX, numY), cell_state::FREE, storage),
+        m_freeCells(std::make_pair(numX, numY)),
+        // the masks of the cells surrounded by free cells
+        m_nbrMasks(std::make_pair(numX, numY), 0xFFU, storage),
+        m_obstacles(std::vector<Circle>()),
+        m_version(0U)
   {
     // set the cell state to 'padded' to account for robot radius
     assignBoundaryCellStates();
+    refreshLayers();
+    updateConnectivity();
   }
 
   /**
    * @brief Construct a new Configuration Space object, taking a pre-constructed
-   * map of cell states.
+   * map of cell states. The obstacles which produced the states are unknown
+   * (see hasObstacleGeometry()).
    *
    * @param cellStates The pre-constructed cell states.
    * @param robotRadius The robot's radius, in number of cells.
@@ -61,39 +216,274 @@ class ConfigurationSpace : public GridIndexer
                      const size_t robotRadius)
       : GridIndexer(cellStates),
         m_robotRadius(robotRadius),
-        m_cellStates(cellStates)
+        m_cellStates(DataMap<cell_state>(cellStates)),
+        m_freeCells(cellStates.shape()),
+        m_nbrMasks(DataMap<uint8_t>(cellStates.shape(), 0U)),
+        m_version(0U)
+  {
+    assignBoundaryCellStates();
+    refreshLayers();
+    updateConnectivity();
+  }
+
+  /**
+   * @brief Construct a new Configuration Space object, as above, taking
+   * ownership of the map of cell states. If the map is a view (e.g., of a
+   * memory-mapped file) the cell states are not copied.
+   *
+   * @param cellStates The pre-constructed cell states.
+   * @param robotRadius The robot's radius, in number of cells.
+   */
+  ConfigurationSpace(DataMap<cell_state>&& cellStates, const size_t robotRadius)
+      : GridIndexer(cellStates),
+        m_robotRadius(robotRadius),
+        m_cellStates(std::move(cellStates)),
+        m_freeCells(shape()),
+        m_nbrMasks(DataMap<uint8_t>(shape(), 0U)),
+        m_version(0U)
   {
     assignBoundaryCellStates();
+    refreshLayers();
+    updateConnectivity();
+  }
+
+  /**
+   * @brief Construct a new Configuration Space object, as above, along with
+   * the obstacles which produced the cell states (e.g., when loading a cached
+   * raster of an obstacle map).
+   * NOTE: the cell states are assumed to be those of adding the obstacles to
+   * an empty space of the same shape and robot radius.
+   *
+   * @param cellStates The pre-constructed cell states.
+   * @param robotRadius The robot's radius, in number of cells.
+   * @param obstacles The obstacles rasterized into the cell states.
+   */
+  ConfigurationSpace(DataMap<cell_state>&& cellStates,
+                     const size_t robotRadius,
+                     std::vector<Circle> obstacles)
+      : ConfigurationSpace(std::move(cellStates), robotRadius)
+  {
+    m_obstacles.emplace(std::move(obstacles));
   }
 
   /**
    * @brief Add circular obstacles to the configuration space.
    * NOTE: Padding is added around each object to account for the robot's
    * radius.
+   * NOTE: the cells are only rasterized within each obstacle's padded bounding
+   * box, and the clearance (if computed) is only updated near them (see
+   * computeClearance()), but the connectivity is relabeled over the whole
+   * space, in O(map size).
    * TODO: FUTURE WORK- create polymorphic obstacles to enable different shapes.
    *
    * @param obstacles The obstacles to add.
+   * @param changedCells If provided, the cells which were accessible before
+   * the obstacles were added, but are now blocked, are appended to it (e.g.,
+   * for repairing a search, see DStarLite).
    */
-  void addObstacles(const std::vector<Circle>& obstacles)
+  void addObstacles(const std::vector<Circle>& obstacles,
+                    std::vector<Cell>* changedCells = nullptr)
   {
-    // add padding around obstacles
+    CellBounds changed;
     for (const auto& obstacle : obstacles) {
-      // extend obstacles with robot radius
-      const Circle padded(obstacle.center(), obstacle.radius() + m_robotRadius);
-
-      // Add padding around circle obstacles to account for robot radius
-      // TODO: FUTURE WORK- this revisits the same cells as below. Add visitor
-      // method which only visits the padded region to reduce cost
-      GridCircle::visit(
-          padded, *this, [this](const size_t xIdx, const size_t yIdx) {
-            m_cellStates.at(xIdx, yIdx) = cell_state::PADDED;
-          });
+      const CellBounds bounds = paddedBounds(obstacle);
+      markObstacle(obstacle, bounds, changedCells);
 
-      // Mark the obstacles
-      GridCircle::visit(
-          obstacle, *this, [this](const size_t xIdx, const size_t yIdx) {
-            m_cellStates.at(xIdx, yIdx) = cell_state::OBJECT;
-          });
+      // Refresh the neighbor masks over the padded obstacle's bounding box
+      refreshNbrMasks(bounds.minX, bounds.minY, bounds.maxX, bounds.maxY);
+      changed.merge(bounds);
+    }
+    recordObstacles(obstacles);
+    finishChange(changed);
+  }
+
+  /**
+   * @brief Add circular obstacles to the configuration space, as above, using
+   * the threads of a pool. The rows are split into bands, and each obstacle is
+   * binned into the bands its padded bounding box overlaps. Each band is then
+   * rasterized by a single task, so no locking is needed, and as the resulting
+   * states do not depend on the order of the obstacles they are identical to
+   * adding the obstacles serially.
+   * NOTE: this waits on the pool, so must not be called from a task running on
+   * the same pool.
+   *
+   * @param obstacles The obstacles to add.
+   * @param pool The thread pool to rasterize the bands on.
+   * @param changedCells If provided, the newly blocked cells are appended to
+   * it, as above, ordered by row band.
+   */
+  void addObstacles(const std::vector<Circle>& obstacles,
+                    ThreadPool& pool,
+                    std::vector<Cell>* changedCells = nullptr)
+  {
+    if (obstacles.empty() || numY() == 0U) {
+      // as adding serially, there are no cells to rasterize
+      recordObstacles(obstacles);
+      finishChange(CellBounds());
+      return;
+    }
+    const size_t numBands = std::min(numY(), pool.size() * BANDS_PER_WORKER);
+    const size_t bandRows = (numY() + numBands - 1) / numBands;
+
+    std::vector<std::vector<size_t>> bandObstacles(numBands);
+    for (size_t idx = 0; idx < obstacles.size(); ++idx) {
+      const CellBounds bounds = paddedBounds(obstacles[idx]);
+      if (bounds.empty()) {
+        continue;
+      }
+      for (size_t band = bounds.minY / bandRows; band <= bounds.maxY / bandRows;
+           ++band) {
+        bandObstacles[band].emplace_back(idx);
+      }
+    }
+
+    // rasterize each band, tracking the bounds of the cells changed within it
+    std::vector<CellBounds> changed(numBands);
+    std::vector<std::vector<Cell>> bandChangedCells(
+        changedCells ? numBands : 0U);
+    runBands(pool, numBands, [&](const size_t band) {
+      const size_t rowBegin = band * bandRows;
+      const size_t rowEnd = std::min(rowBegin + bandRows, numY());
+      for (const size_t idx : bandObstacles[band]) {
+        CellBounds bounds = paddedBounds(obstacles[idx]);
+        bounds.minY = std::max(bounds.minY, rowBegin);
+        bounds.maxY = std::min(bounds.maxY, rowEnd - 1);
+        markObstacle(obstacles[idx],
+                     bounds,
+                     changedCells ? &bandChangedCells[band] : nullptr);
+        changed[band].merge(bounds);
+      }
+    });
+
+    // the neighbor masks read the free cells of the adjacent rows, which may
+    // be in the neighboring bands, so are only refreshed once all bands are
+    // rasterized
+    runBands(pool, numBands, [&](const size_t band) {
+      const size_t rowBegin = band * bandRows;
+      const size_t rowEnd = std::min(rowBegin + bandRows, numY());
+      CellBounds bounds = changed[band];
+      if (band > 0) {
+        bounds.merge(changed[band - 1]);
+      }
+      if (band + 1 < numBands) {
+        bounds.merge(changed[band + 1]);
+      }
+      if (bounds.empty()) {
+        return;
+      }
+      updateNbrMasks(bounds.minX > 0 ? bounds.minX - 1 : 0,
+                     std::max(bounds.minY > 0 ? bounds.minY - 1 : 0, rowBegin),
+                     std::min(bounds.maxX + 1, numX() - 1),
+                     std::min(bounds.maxY + 1, rowEnd - 1));
+    });
+    for (const auto& cells : bandChangedCells) {
+      changedCells->insert(changedCells->end(), cells.begin(), cells.end());
+    }
+    CellBounds allChanged;
+    for (const CellBounds& bounds : changed) {
+      allChanged.merge(bounds);
+    }
+    recordObstacles(obstacles);
+    finishChange(allChanged);
+  }
+
+  /**
+   * @brief Remove circular obstacles from the configuration space, freeing
+   * their cells and padding unless still covered by another obstacle (or the
+   * padding of the task space boundary). Only the padded bounding box of each
+   * removed obstacle is rasterized again, from the obstacles overlapping it,
+   * which are found from a spatial index of the obstacles (built on the first
+   * removal), so the cost of rasterizing is independent of the map size.
+   * Removing cells only merges the components next to the freed cells, so
+   * the connectivity is only updated over the rows of the bounding boxes (see
+   * ConnectivityIndex::addCells()), and the clearance (if computed) is only
+   * recomputed near them (see raiseClearance()).
+   * NOTE: throws if the obstacle geometry is unknown (see
+   * hasObstacleGeometry()), or if an obstacle was not added to the space, in
+   * which case the space is unchanged. Paths found before the removal remain
+   * valid, but may no longer be optimal.
+   *
+   * @param obstacles The obstacles to remove, each matching one added.
+   * @param freedCells If provided, the cells which were blocked before the
+   * obstacles were removed, but are now accessible, are appended to it.
+   */
+  void removeObstacles(const std::vector<Circle>& obstacles,
+                       std::vector<Cell>* freedCells = nullptr)
+  {
+    eraseObstacles(obstacles);
+    std::vector<CellBounds> freedBounds;
+    freedBounds.reserve(obstacles.size());
+    for (const auto& obstacle : obstacles) {
+      unmarkObstacle(obstacle, freedCells);
+      freedBounds.push_back(paddedBounds(obstacle));
+    }
+    mergeComponents(freedBounds);
+    ++m_version;
+
+    if (m_clearanceSq) {
+      for (const CellBounds& bounds : freedBounds) {
+        raiseClearance(bounds);
+      }
+    }
+  }
+
+  /**
+   * @brief Move an obstacle added to the configuration space, as if removing
+   * it (see removeObstacles()) and adding it at its new position, but
+   * changing the space only once. The cells and clearance are only updated
+   * near the old and new positions, as for removeObstacles() and
+   * addObstacles(), but as blocking cells may split a component, the
+   * connectivity is relabeled over the whole space, as for addObstacles(),
+   * unless the move blocks no cell which was accessible before it.
+   * NOTE: throws as for removeObstacles().
+   *
+   * @param from The obstacle to move, matching one added.
+   * @param to The obstacle at its new position (and size).
+   * @param freedCells If provided, the cells which were blocked before the
+   * move, but are now accessible, are appended to it.
+   * @param blockedCells If provided, the cells which were accessible before
+   * the move, but are now blocked, are appended to it.
+   */
+  void moveObstacle(const Circle& from,
+                    const Circle& to,
+                    std::vector<Cell>* freedCells = nullptr,
+                    std::vector<Cell>* blockedCells = nullptr)
+  {
+    eraseObstacles({from});
+    std::vector<Cell> freed;
+    unmarkObstacle(from, &freed);
+    std::vector<Cell> blocked;
+    const CellBounds bounds = paddedBounds(to);
+    markObstacle(to, bounds, &blocked);
+    refreshNbrMasks(bounds.minX, bounds.minY, bounds.maxX, bounds.maxY);
+    recordObstacles({to});
+
+    // cells freed by the removal may be blocked again at the new position
+    std::unordered_set<size_t> wasFreed;
+    for (const Cell& c : freed) {
+      wasFreed.insert(idxFrom(c));
+    }
+    std::erase_if(blocked,
+                  [&](const Cell& c) { return wasFreed.count(idxFrom(c)); });
+    if (blocked.empty()) {
+      mergeComponents({paddedBounds(from)});
+    } else {
+      updateConnectivity();
+    }
+    ++m_version;
+    if (m_clearanceSq) {
+      raiseClearance(paddedBounds(from));
+      updateClearance(bounds);
+    }
+
+    if (freedCells) {
+      std::copy_if(freed.begin(),
+                   freed.end(),
+                   std::back_inserter(*freedCells),
+                   [this](const Cell& c) { return isAccessible(c); });
+    }
+    if (blockedCells) {
+      blockedCells->insert(blockedCells->end(), blocked.begin(), blocked.end());
     }
   }
 
@@ -106,31 +496,168 @@ class ConfigurationSpace : public GridIndexer
    */
   bool isAccessible(const Cell& c) const
   {
-    return contains(c) && m_cellStates.at(c) == cell_state::FREE;
+    return contains(c) && m_freeCells.test(c);
+  }
+
+  /**
+   * @brief Get the bit-packed plane of accessible cells, where a set bit
+   * indicates a FREE cell.
+   */
+  const BitMap& freeCells() const
+  {
+    return m_freeCells;
+  }
+
+  /**
+   * @brief Get the free-neighbor mask of a cell, where bit i is set if the
+   * neighbor at NBR_OFFSETS[i] is within the task space and accessible.
+   *
+   * @param c The cell to check.
+   * @return uint8_t The free-neighbor mask.
+   */
+  uint8_t nbrMask(const Cell& c) const
+  {
+    return m_nbrMasks.at(c);
+  }
+
+  /**
+   * @brief Get a non-allocating range over the accessible neighbors of a given
+   * cell, where accessibility is defined by the above method. A given cell can
+   * have up to eight neighbors (the cell itself is not included).
+   *
+   * @param c The cell to check.
+   * @return NeighborRange The range of accessible neighbors.
+   */
+  NeighborRange accessibleNbrs(const Cell& c) const
+  {
+    return NeighborRange(c, nbrMask(c));
   }
 
   /**
-   * @brief Get all accessible neighbors of a given cell, where accessibility is
-   * defined by the above method. A given cell can have up to eight neighbors.
+   * @brief Get all accessible neighbors of a given cell as a vector.
+   * NOTE: this allocates, prefer accessibleNbrs() in performance-critical code.
    *
    * @param c The cell to check.
    * @return std::vector<Cell> The set of accessible neighbors.
    */
   std::vector<Cell> getAccessibleNbrs(const Cell& c) const
   {
-    std::vector<Cell> nbrs;
-    const size_t minX = c.x() > 0 ? c.x() - 1 : c.x();
-    const size_t minY = c.y() > 0 ? c.y() - 1 : c.y();
-    const size_t maxX = c.x() < numX() - 1 ? c.x() + 1 : c.x();
-    const size_t maxY = c.y() < numY() - 1 ? c.y() + 1 : c.y();
-    for (size_t yIdx = minY; yIdx <= maxY; ++yIdx) {
-      for (size_t xIdx = minX; xIdx <= maxX; ++xIdx) {
-        if (m_cellStates.at(xIdx, yIdx) == cell_state::FREE) {
-          nbrs.emplace_back(Cell(xIdx, yIdx));
-        }
+    const NeighborRange nbrs = accessibleNbrs(c);
+    return std::vector<Cell>(nbrs.begin(), nbrs.end());
+  }
+
+  /**
+   * @brief Get the connected components of the accessible cells, which are
+   * kept up to date as obstacles are added, removed or moved.
+   */
+  const ConnectivityIndex& components() const
+  {
+    return m_components;
+  }
+
+  /**
+   * @brief Check whether a path of accessible cells joins two cells, without
+   * searching for it (see ConnectivityIndex).
+   * NOTE: this is for the robot radius the space was padded for, not for the
+   * radii searched using the clearance.
+   *
+   * @param a The first cell.
+   * @param b The second cell.
+   * @return true If both cells are accessible and connected, else false.
+   */
+  bool isConnected(const Cell& a, const Cell& b) const
+  {
+    return m_components.connected(a, b);
+  }
+
+  /**
+   * @brief Compute the clearance of each cell, being the Euclidean distance to
+   * the nearest OBJECT cell or to the outside of the task space. Once computed,
+   * the accessibility for any robot radius is a threshold query on the
+   * clearance (see isAccessible(c, robotRadius)), so a single space may be
+   * searched by robots of different sizes. The clearance is kept up to date as
+   * obstacles are added, removed or moved, only recomputing it within the
+   * largest clearance of the changed obstacles' bounding boxes.
+   * NOTE: the padding of the cell states is derived from the obstacle circles,
+   * whereas the clearance is measured to the obstacle cells, so the two may
+   * differ slightly at the edge of the padding.
+   */
+  void computeClearance()
+  {
+    DataMap<uint32_t> clearanceSq = DistanceTransform::squared(
+        *this, [this](const size_t xIdx, const size_t yIdx) {
+          return m_cellStates.at(xIdx, yIdx) == cell_state::OBJECT;
+        });
+
+    // the cells outside of the task space are also obstacles
+    m_maxClearanceSq = 0U;
+    for (size_t yIdx = 0; yIdx < numY(); ++yIdx) {
+      for (size_t xIdx = 0; xIdx < numX(); ++xIdx) {
+        uint32_t& dSq = clearanceSq.at(xIdx, yIdx);
+        dSq = std::min(dSq, boundaryDistanceSq(xIdx, yIdx));
+        m_maxClearanceSq = std::max(m_maxClearanceSq, dSq);
       }
     }
-    return nbrs;
+    m_clearanceSq.emplace(std::move(clearanceSq));
+  }
+
+  bool hasClearance() const
+  {
+    return m_clearanceSq.has_value();
+  }
+
+  /**
+   * @brief Get the squared clearance of a cell (see computeClearance()).
+   */
+  uint32_t clearanceSq(const Cell& c) const
+  {
+    assert(hasClearance());
+    return m_clearanceSq->at(c);
+  }
+
+  double clearance(const Cell& c) const
+  {
+    return std::sqrt(static_cast<double>(clearanceSq(c)));
+  }
+
+  /**
+   * @brief Check whether a cell is accessible to a robot of the given radius,
+   * using the clearance rather than the padded cell states.
+   * NOTE: requires the clearance to have been computed.
+   *
+   * @param c The cell to check.
+   * @param robotRadius The robot's radius, in cells.
+   * @return true If accessible, else false.
+   */
+  bool isAccessible(const Cell& c, const size_t robotRadius) const
+  {
+    return contains(c) &&
+           clearanceSq(c) > static_cast<uint64_t>(robotRadius) * robotRadius;
+  }
+
+  /**
+   * @brief Get the free-neighbor mask of a cell for a robot of the given
+   * radius, as for nbrMask(c), using the clearance rather than the padded cell
+   * states.
+   * NOTE: requires the clearance to have been computed.
+   */
+  uint8_t nbrMask(const Cell& c, const size_t robotRadius) const
+  {
+    uint8_t mask = 0U;
+    for (size_t dir = 0; dir < NBR_OFFSETS.size(); ++dir) {
+      // NOTE: offsets below zero wrap around, and are rejected as outside of
+      // the task space
+      const Cell nbr(c.x() + NBR_OFFSETS[dir].dx, c.y() + NBR_OFFSETS[dir].dy);
+      if (isAccessible(nbr, robotRadius)) {
+        mask |= static_cast<uint8_t>(1U << dir);
+      }
+    }
+    return mask;
+  }
+
+  NeighborRange accessibleNbrs(const Cell& c, const size_t robotRadius) const
+  {
+    return NeighborRange(c, nbrMask(c, robotRadius));
   }
 
   size_t robotRadius() const
@@ -138,60 +665,853 @@ class ConfigurationSpace : public GridIndexer
     return m_robotRadius;
   }
 
+  /**
+   * @brief Get the version of the space's cells, which starts at zero and is
+   * incremented by each change to them (e.g., by addObstacles()), so results
+   * derived from the cells can be checked to still be current.
+   */
+  uint64_t version() const
+  {
+    return m_version;
+  }
+
+  /**
+   * @brief Check whether the obstacles added to the space are known, which is
+   * the case unless the space was constructed from a map of cell states alone.
+   */
+  bool hasObstacleGeometry() const
+  {
+    return m_obstacles.has_value();
+  }
+
+  /**
+   * @brief Get the obstacles added to the space, in the order added.
+   * NOTE: requires the obstacle geometry to be known.
+   */
+  const std::vector<Circle>& obstacles() const
+  {
+    assert(hasObstacleGeometry());
+    return *m_obstacles;
+  }
+
+  grid_storage storage() const
+  {
+    return m_cellStates.storage();
+  }
+
+  /**
+   * @brief Get the number of bytes allocated for the cell states and
+   * free-neighbor masks.
+   */
+  size_t layerBytes() const
+  {
+    return m_cellStates.bytes() + m_nbrMasks.bytes();
+  }
+
+  cell_state cellState(const Cell& c) const
+  {
+    return m_cellStates.at(c);
+  }
+
+  /**
+   * @brief Get the map of cell states.
+   * NOTE: requires dense storage, otherwise see forEachStateSpan().
+   */
+  const DataMap<cell_state>& cellStates() const
+  {
+    return m_cellStates.dense();
+  }
+
+  /**
+   * @brief Call f(xIdx, states, count) for the contiguous spans of the cell
+   * states of a row, in order, being the whole row if dense.
+   */
+  template <typename F>
+  void forEachStateSpan(const size_t yIdx, F&& f) const
+  {
+    if (numX() > 0) {
+      m_cellStates.forEachSpan(yIdx, 0, numX() - 1, f);
+    }
+  }
+
   friend std::ostream& operator<<(std::ostream& os,
                                   const ConfigurationSpace& space)
   {
-    return os << space.m_cellStates;
+    if (space.storage() == grid_storage::DENSE) {
+      return os << space.cellStates();
+    }
+    // as the dense cell states
+    for (size_t yIdx = 0; yIdx < space.numY(); ++yIdx) {
+      for (size_t xIdx = 0; xIdx < space.numX(); ++xIdx) {
+        os << static_cast<int>(space.cellState({xIdx, yIdx}))
+           << (xIdx < space.numX() - 1 ? " " : "");
+      }
+      os << '\n';
+    }
+    return os;
   };
 
   private:
+  // the number of row bands per worker when adding obstacles in parallel,
+  // which balances the load when the obstacles are unevenly spread
+  static constexpr size_t BANDS_PER_WORKER = 4;
+
+  /**
+   * @brief Structure containing the (inclusive) bounds of a rectangle of
+   * cells, being empty if the minimum exceeds the maximum in either direction.
+   */
+  struct CellBounds {
+    size_t minX = std::numeric_limits<size_t>::max();
+    size_t minY = std::numeric_limits<size_t>::max();
+    size_t maxX = 0U;
+    size_t maxY = 0U;
+
+    bool empty() const
+    {
+      return minX > maxX || minY > maxY;
+    }
+
+    void merge(const CellBounds& other)
+    {
+      if (other.empty()) {
+        return;
+      }
+      minX = std::min(minX, other.minX);
+      minY = std::min(minY, other.minY);
+      maxX = std::max(maxX, other.maxX);
+      maxY = std::max(maxY, other.maxY);
+    }
+  };
+
+  /**
+   * @brief Structure holding the obstacles binned by the square tiles their
+   * padded bounding boxes overlap, for finding the obstacles near a region.
+   */
+  struct ObstacleIndex {
+    static constexpr size_t TILE_DIM = 64U;
+
+    size_t numTilesX = 0U;
+    // the obstacles overlapping each tile, in row-major tile order
+    std::vector<std::vector<Circle>> tiles;
+  };
+
   size_t m_robotRadius;
-  DataMap<cell_state> m_cellStates;
+  GridLayer<cell_state> m_cellStates;
+  // derived layers, kept in sync with the cell states
+  BitMap m_freeCells;
+  GridLayer<uint8_t> m_nbrMasks;
+  ConnectivityIndex m_components;
+  // optional squared clearance of each cell, for searching at any radius
+  std::optional<DataMap<uint32_t>> m_clearanceSq;
+  // an upper bound on the squared clearance of every cell, only raised as
+  // obstacles are removed
+  uint32_t m_maxClearanceSq = 0U;
+  // the obstacles added, unless unknown (i.e., constructed from cell states)
+  std::optional<std::vector<Circle>> m_obstacles;
+  // the obstacles binned by tile, once an obstacle has been removed
+  std::optional<ObstacleIndex> m_obstacleIndex;
+  // incremented by each change to the cells (see version())
+  uint64_t m_version;
+
+  void recordObstacles(const std::vector<Circle>& obstacles)
+  {
+    if (m_obstacles) {
+      m_obstacles->insert(
+          m_obstacles->end(), obstacles.begin(), obstacles.end());
+    }
+    if (m_obstacleIndex) {
+      for (const auto& obstacle : obstacles) {
+        indexObstacle(obstacle, true);
+      }
+    }
+  }
 
   /**
-   * @brief Assign padding to the cells within the robot's radius around the
-   * outside of the task space.
+   * @brief Update the layers derived from the cells once obstacles have been
+   * added.
+   * NOTE: the connectivity is relabeled over the whole space, as blocking
+   * cells may split a component anywhere, but the clearance is only updated
+   * near the added obstacles (see updateClearance()).
+   *
+   * @param blockedBounds The bounds of the new OBJECT cells.
    */
-  void assignBoundaryCellStates()
+  void finishChange(const CellBounds& blockedBounds)
+  {
+    updateConnectivity();
+    ++m_version;
+
+    if (m_clearanceSq) {
+      updateClearance(blockedBounds);
+    }
+  }
+
+  /**
+   * @brief Merge the connected components joined by the cells freed within
+   * the given bounds, where no cell was blocked since the components were last
+   * updated, over the rows of the bounds rather than the whole space.
+   */
+  void mergeComponents(const std::vector<CellBounds>& freedBounds)
+  {
+    std::vector<std::pair<size_t, size_t>> rowRanges;
+    rowRanges.reserve(freedBounds.size());
+    for (const CellBounds& bounds : freedBounds) {
+      if (!bounds.empty()) {
+        rowRanges.emplace_back(bounds.minY, bounds.maxY);
+      }
+    }
+    // the overlapping ranges are only relabeled once
+    std::sort(rowRanges.begin(), rowRanges.end());
+    size_t numMerged = 0;
+    for (const auto& range : rowRanges) {
+      if (numMerged > 0 && range.first <= rowRanges[numMerged - 1].second) {
+        rowRanges[numMerged - 1].second =
+            std::max(rowRanges[numMerged - 1].second, range.second);
+      } else {
+        rowRanges[numMerged++] = range;
+      }
+    }
+    rowRanges.resize(numMerged);
+    m_components.addCells(m_freeCells, rowRanges);
+  }
+
+  /**
+   * @brief Grow bounds by a number of cells in each direction, clipped to the
+   * task space.
+   */
+  CellBounds grownBounds(const CellBounds& bounds, const size_t reach) const
+  {
+    return {bounds.minX > reach ? bounds.minX - reach : 0U,
+            bounds.minY > reach ? bounds.minY - reach : 0U,
+            std::min(saturatingAdd(bounds.maxX, reach), numX() - 1),
+            std::min(saturatingAdd(bounds.maxY, reach), numY() - 1)};
+  }
+
+  /**
+   * @brief Update the clearance once obstacles were added within the given
+   * bounds. The clearance only falls, and only for cells nearer to the new
+   * OBJECT cells than their clearance, so the distance transform is only run
+   * over the bounds grown by the largest clearance, in O(area of the grown
+   * bounds) rather than O(map size). Within this region, the nearest OBJECT
+   * cell of the region is either the nearest overall, or no nearer than the
+   * old clearance.
+   */
+  void updateClearance(const CellBounds& bounds)
+  {
+    if (bounds.empty()) {
+      return;
+    }
+    const CellBounds region = grownBounds(bounds, maxClearance());
+    const DataMap<uint32_t> regionSq = objectDistancesSq(region);
+    for (size_t yIdx = region.minY; yIdx <= region.maxY; ++yIdx) {
+      for (size_t xIdx = region.minX; xIdx <= region.maxX; ++xIdx) {
+        uint32_t& dSq = m_clearanceSq->at(xIdx, yIdx);
+        dSq = std::min(
+            dSq, regionSq.at(xIdx - region.minX, yIdx - region.minY));
+      }
+    }
+  }
+
+  /**
+   * @brief Update the clearance once an obstacle was removed within the given
+   * bounds. The clearance only rises, and only for cells whose nearest OBJECT
+   * cell was within the bounds, so within the largest clearance of them, but
+   * their new nearest OBJECT cell may be further away. The distance transform
+   * is run over these cells grown by a margin, doubling it until each cell's
+   * nearest OBJECT cell within the region is no further than the edge of the
+   * region (or the region is the whole space), in O(area of the grown bounds)
+   * unless the clearance rises well beyond its old maximum.
+   */
+  void raiseClearance(const CellBounds& bounds)
+  {
+    if (bounds.empty()) {
+      return;
+    }
+    const size_t reach = maxClearance();
+    const CellBounds changed = grownBounds(bounds, reach);
+    std::vector<uint32_t> changedSq;
+    for (size_t margin = std::max<size_t>(reach, 1U);
+         !regionClearanceSq(changed, grownBounds(changed, margin), changedSq);
+         margin = saturatingAdd(margin, margin)) {
+      // grow the region until it holds the nearest OBJECT cells
+    }
+
+    auto dSq = changedSq.begin();
+    for (size_t yIdx = changed.minY; yIdx <= changed.maxY; ++yIdx) {
+      for (size_t xIdx = changed.minX; xIdx <= changed.maxX; ++xIdx, ++dSq) {
+        m_clearanceSq->at(xIdx, yIdx) = *dSq;
+        m_maxClearanceSq = std::max(m_maxClearanceSq, *dSq);
+      }
+    }
+  }
+
+  /**
+   * @brief Compute the squared clearance of the cells within some bounds (see
+   * raiseClearance()) from the OBJECT cells within a region containing them,
+   * in row-major order.
+   *
+   * @return true If the clearance is exact, as no cell outside of the region
+   * may be nearer to a cell than its nearest OBJECT cell within the region,
+   * else false (and the clearance is incomplete).
+   */
+  bool regionClearanceSq(const CellBounds& bounds,
+                         const CellBounds& region,
+                         std::vector<uint32_t>& clearanceSq) const
+  {
+    const DataMap<uint32_t> regionSq = objectDistancesSq(region);
+    clearanceSq.clear();
+    for (size_t yIdx = bounds.minY; yIdx <= bounds.maxY; ++yIdx) {
+      for (size_t xIdx = bounds.minX; xIdx <= bounds.maxX; ++xIdx) {
+        const uint32_t dSq =
+            std::min(regionSq.at(xIdx - region.minX, yIdx - region.minY),
+                     boundaryDistanceSq(xIdx, yIdx));
+        // the distance to the nearest cell outside of the region, unless
+        // outside of the task space
+        uint64_t edge = std::numeric_limits<uint32_t>::max();
+        if (region.minX > 0) {
+          edge = std::min<uint64_t>(edge, xIdx - region.minX + 1);
+        }
+        if (region.minY > 0) {
+          edge = std::min<uint64_t>(edge, yIdx - region.minY + 1);
+        }
+        if (region.maxX + 1 < numX()) {
+          edge = std::min<uint64_t>(edge, region.maxX - xIdx + 1);
+        }
+        if (region.maxY + 1 < numY()) {
+          edge = std::min<uint64_t>(edge, region.maxY - yIdx + 1);
+        }
+        if (dSq > edge * edge) {
+          return false;
+        }
+        clearanceSq.push_back(dSq);
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Get an upper bound on the clearance of every cell, in cells.
+   */
+  size_t maxClearance() const
+  {
+    return static_cast<size_t>(
+        std::ceil(std::sqrt(static_cast<double>(m_maxClearanceSq))));
+  }
+
+  /**
+   * @brief Get the squared distance from each cell of a region to its nearest
+   * OBJECT cell within the region.
+   */
+  DataMap<uint32_t> objectDistancesSq(const CellBounds& region) const
+  {
+    return DistanceTransform::squared(
+        GridIndexer(region.maxX - region.minX + 1,
+                    region.maxY - region.minY + 1),
+        [&](const size_t xIdx, const size_t yIdx) {
+          return m_cellStates.at(region.minX + xIdx, region.minY + yIdx) ==
+                 cell_state::OBJECT;
+        });
+  }
+
+  /**
+   * @brief Get the squared distance from a cell to the nearest cell outside
+   * of the task space.
+   */
+  uint32_t boundaryDistanceSq(const size_t xIdx, const size_t yIdx) const
+  {
+    const uint64_t d = std::min(std::min(yIdx + 1, numY() - yIdx),
+                                std::min(xIdx + 1, numX() - xIdx));
+    return static_cast<uint32_t>(
+        std::min<uint64_t>(d * d, std::numeric_limits<uint32_t>::max()));
+  }
+
+  /**
+   * @brief Add an obstacle to (or remove it from) the tiles its padded
+   * bounding box overlaps.
+   */
+  void indexObstacle(const Circle& obstacle, const bool insert)
+  {
+    assert(m_obstacleIndex);
+    forEachTile(paddedBounds(obstacle), [&](std::vector<Circle>& tile) {
+      if (insert) {
+        tile.push_back(obstacle);
+      } else {
+        const auto it = std::find(tile.begin(), tile.end(), obstacle);
+        assert(it != tile.end());
+        *it = tile.back();
+        tile.pop_back();
+      }
+    });
+  }
+
+  template <typename TileFunc>
+  void forEachTile(const CellBounds& bounds, TileFunc&& f)
+  {
+    if (bounds.empty()) {
+      return;
+    }
+    ObstacleIndex& index = *m_obstacleIndex;
+    constexpr size_t DIM = ObstacleIndex::TILE_DIM;
+    for (size_t tileY = bounds.minY / DIM; tileY <= bounds.maxY / DIM;
+         ++tileY) {
+      for (size_t tileX = bounds.minX / DIM; tileX <= bounds.maxX / DIM;
+           ++tileX) {
+        f(index.tiles[tileY * index.numTilesX + tileX]);
+      }
+    }
+  }
+
+  /**
+   * @brief Remove obstacles from the recorded obstacles and their index,
+   * leaving both unchanged (and throwing) if any obstacle was not recorded.
+   * The obstacles are checked against the tile of the index holding every
+   * copy of them, then the most recent matches are erased in place, keeping
+   * the order of the rest, without copying the recorded obstacles.
+   */
+  void eraseObstacles(const std::vector<Circle>& obstacles)
+  {
+    if (!m_obstacles) {
+      throw std::runtime_error(
+          "Removing obstacles requires the obstacles added to the "
+          "configuration space to be known");
+    }
+    if (!m_obstacleIndex) {
+      ObstacleIndex& index = m_obstacleIndex.emplace();
+      index.numTilesX = (numX() + ObstacleIndex::TILE_DIM - 1) /
+                        ObstacleIndex::TILE_DIM;
+      index.tiles.resize(index.numTilesX *
+                         ((numY() + ObstacleIndex::TILE_DIM - 1) /
+                          ObstacleIndex::TILE_DIM));
+      for (const auto& obstacle : *m_obstacles) {
+        indexObstacle(obstacle, true);
+      }
+    }
+    if (obstacles.empty()) {
+      return;
+    }
+
+    // the number of copies of each obstacle to remove
+    const auto key = [](const Circle& o) {
+      return std::make_tuple(o.center().y(), o.center().x(), o.radius());
+    };
+    std::vector<Circle> sorted = obstacles;
+    std::sort(sorted.begin(), sorted.end(), [&](const auto& a, const auto& b) {
+      return key(a) < key(b);
+    });
+    std::vector<std::pair<Circle, size_t>> counts;
+    for (const auto& obstacle : sorted) {
+      if (!counts.empty() && counts.back().first == obstacle) {
+        ++counts.back().second;
+      } else {
+        counts.emplace_back(obstacle, 1U);
+      }
+    }
+
+    for (const auto& [obstacle, count] : counts) {
+      const CellBounds bounds = paddedBounds(obstacle);
+      // the obstacles outside of the task space are in no tile
+      const std::vector<Circle>& candidates =
+          bounds.empty() ? *m_obstacles : tileAt(bounds.minX, bounds.minY);
+      if (static_cast<size_t>(std::count(
+              candidates.begin(), candidates.end(), obstacle)) < count) {
+        throw std::runtime_error(
+            "Obstacle to remove was not added to the configuration space");
+      }
+    }
+
+    for (const auto& obstacle : obstacles) {
+      indexObstacle(obstacle, false);
+    }
+    // the positions of the most recently added matches, then the obstacles
+    // after the first of them are shifted down over them
+    std::vector<Circle>& recorded = *m_obstacles;
+    std::vector<size_t> erased;
+    erased.reserve(obstacles.size());
+    for (const auto& [obstacle, count] : counts) {
+      auto end = recorded.rbegin();
+      for (size_t idx = 0; idx < count; ++idx) {
+        end = std::find(end, recorded.rend(), obstacle);
+        erased.push_back(static_cast<size_t>(recorded.rend() - end) - 1);
+        ++end;
+      }
+    }
+    std::sort(erased.begin(), erased.end());
+    size_t numKept = erased.front();
+    for (size_t idx = erased.front(), next = 0; idx < recorded.size(); ++idx) {
+      if (next < erased.size() && erased[next] == idx) {
+        ++next;
+      } else {
+        recorded[numKept++] = recorded[idx];
+      }
+    }
+    recorded.erase(recorded.begin() + static_cast<std::ptrdiff_t>(numKept),
+                   recorded.end());
+  }
+
+  /**
+   * @brief Get the tile of the obstacle index holding a cell.
+   */
+  const std::vector<Circle>& tileAt(const size_t xIdx, const size_t yIdx) const
   {
-    std::vector<size_t> allCols(numX());
-    std::iota(allCols.begin(), allCols.end(), 0);
+    const ObstacleIndex& index = *m_obstacleIndex;
+    return index.tiles[(yIdx / ObstacleIndex::TILE_DIM) * index.numTilesX +
+                       xIdx / ObstacleIndex::TILE_DIM];
+  }
 
-    std::vector<size_t> allRows(numY());
-    std::iota(allRows.begin(), allRows.end(), 0);
+  /**
+   * @brief Rasterize the padded bounding box of a removed obstacle again, from
+   * the boundary padding and the obstacles which remain near it.
+   *
+   * @param obstacle The removed obstacle, no longer in the index.
+   * @param freedCells If provided, the cells which were blocked, but are now
+   * accessible, are appended to it.
+   */
+  void unmarkObstacle(const Circle& obstacle, std::vector<Cell>* freedCells)
+  {
+    const CellBounds bounds = paddedBounds(obstacle);
+    if (bounds.empty()) {
+      return;
+    }
+    const size_t width = bounds.maxX - bounds.minX + 1;
+    std::vector<cell_state> oldStates;
+    if (freedCells) {
+      oldStates.reserve(width * (bounds.maxY - bounds.minY + 1));
+    }
 
-    std::vector<size_t> bottomRows(m_robotRadius);
-    std::iota(bottomRows.begin(), bottomRows.end(), 0);
+    // free the box, then pad it within the robot radius of the boundary
+    const size_t edgeCols = std::min(m_robotRadius, numX());
+    for (size_t yIdx = bounds.minY; yIdx <= bounds.maxY; ++yIdx) {
+      if (freedCells) {
+        m_cellStates.forEachSpan(
+            yIdx,
+            bounds.minX,
+            bounds.maxX,
+            [&](size_t, const cell_state* states, const size_t count) {
+              oldStates.insert(oldStates.end(), states, states + count);
+            });
+      }
+      m_cellStates.fillSpan(yIdx, bounds.minX, bounds.maxX, cell_state::FREE);
+      m_freeCells.fillSpan(yIdx, bounds.minX, bounds.maxX, true);
+      const auto pad = [&](const size_t x0, const size_t x1) {
+        if (x0 <= x1) {
+          m_cellStates.fillSpan(yIdx, x0, x1, cell_state::PADDED);
+          m_freeCells.fillSpan(yIdx, x0, x1, false);
+        }
+      };
+      if (yIdx < m_robotRadius || yIdx + m_robotRadius >= numY()) {
+        pad(bounds.minX, bounds.maxX);
+      } else if (edgeCols > 0) {
+        pad(bounds.minX, std::min(bounds.maxX, edgeCols - 1));
+        pad(std::max(bounds.minX, numX() - edgeCols), bounds.maxX);
+      }
+    }
 
-    std::vector<size_t> topRows(m_robotRadius);
-    std::iota(topRows.begin(), topRows.end(), numY() - m_robotRadius);
+    // the obstacles overlapping several tiles are only marked once
+    std::vector<Circle> nearby;
+    forEachTile(bounds, [&](const std::vector<Circle>& tile) {
+      nearby.insert(nearby.end(), tile.begin(), tile.end());
+    });
+    const auto key = [](const Circle& o) {
+      return std::make_tuple(o.center().y(), o.center().x(), o.radius());
+    };
+    std::sort(nearby.begin(), nearby.end(), [&](const auto& a, const auto& b) {
+      return key(a) < key(b);
+    });
+    nearby.erase(std::unique(nearby.begin(), nearby.end()), nearby.end());
+    for (const auto& other : nearby) {
+      markObstacle(other, bounds, nullptr);
+    }
 
-    std::vector<size_t> leftCols(m_robotRadius);
-    std::iota(leftCols.begin(), leftCols.end(), 0);
+    if (freedCells) {
+      for (size_t yIdx = bounds.minY; yIdx <= bounds.maxY; ++yIdx) {
+        const cell_state* old = &oldStates[(yIdx - bounds.minY) * width];
+        for (size_t xIdx = bounds.minX; xIdx <= bounds.maxX; ++xIdx) {
+          if (old[xIdx - bounds.minX] != cell_state::FREE &&
+              m_cellStates.at(xIdx, yIdx) == cell_state::FREE) {
+            freedCells->emplace_back(xIdx, yIdx);
+          }
+        }
+      }
+    }
+    refreshNbrMasks(bounds.minX, bounds.minY, bounds.maxX, bounds.maxY);
+  }
 
-    std::vector<size_t> rightCols(m_robotRadius);
-    std::iota(rightCols.begin(), rightCols.end(), numX() - m_robotRadius);
+  /**
+   * @brief Relabel the connected components of the free cells.
+   * NOTE: this is a pass over the words of the free cells, and the runs within
+   * them, over the whole space, so for small obstacles on a large map it is
+   * the main cost of a change.
+   */
+  void updateConnectivity()
+  {
+    m_components = ConnectivityIndex(m_freeCells);
+  }
 
-    // bottom rows
-    padRowsAndCols(bottomRows, allCols);
+  /**
+   * @brief Get the bounding box of an obstacle's padded circle, clipped to the
+   * task space.
+   */
+  CellBounds paddedBounds(const Circle& obstacle) const
+  {
+    if (size() == 0U) {
+      return CellBounds();
+    }
+    const Cell c = obstacle.center();
+    const size_t r = paddedRadius(obstacle);
+    return {c.x() > r ? c.x() - r : 0,
+            c.y() > r ? c.y() - r : 0,
+            std::min(saturatingAdd(c.x(), r), numX() - 1),
+            std::min(saturatingAdd(c.y(), r), numY() - 1)};
+  }
 
-    // top rows
-    padRowsAndCols(topRows, allCols);
+  /**
+   * @brief Get the radius of an obstacle's padded circle, saturating rather
+   * than wrapping for (degenerate) radii near the maximum.
+   */
+  size_t paddedRadius(const Circle& obstacle) const
+  {
+    return saturatingAdd(obstacle.radius(), m_robotRadius);
+  }
 
-    // left cols
-    padRowsAndCols(allRows, leftCols);
+  static size_t saturatingAdd(const size_t a, const size_t b)
+  {
+    return a > std::numeric_limits<size_t>::max() - b
+               ? std::numeric_limits<size_t>::max()
+               : a + b;
+  }
 
-    // right cols
-    padRowsAndCols(allRows, rightCols);
+  /**
+   * @brief Mark an obstacle and the padding around it to account for the
+   * robot radius, within the given (inclusive) bounds, in a single pass over
+   * the padded circle's rows. Padding never overwrites the cells of other
+   * obstacles, so the resulting states do not depend on the order of the
+   * obstacles.
+   * NOTE: only the cell states and free cells are updated.
+   */
+  void markObstacle(const Circle& obstacle,
+                    const CellBounds& clip,
+                    std::vector<Cell>* changedCells)
+  {
+    if (clip.empty()) {
+      return;
+    }
+    const Circle padded(obstacle.center(), paddedRadius(obstacle));
+    const auto blockFree = [this, changedCells](const size_t yIdx,
+                                                const size_t x0,
+                                                const size_t x1) {
+      if (changedCells) {
+        m_freeCells.forEachSet(yIdx, x0, x1, [&](const size_t xIdx) {
+          changedCells->emplace_back(xIdx, yIdx);
+        });
+      }
+      m_freeCells.fillSpan(yIdx, x0, x1, false);
+    };
+    const auto markPadded = [&](const size_t yIdx, size_t x0, size_t x1) {
+      x0 = std::max(x0, clip.minX);
+      x1 = std::min(x1, clip.maxX);
+      if (x0 <= x1) {
+        m_cellStates.replaceSpan(
+            yIdx, x0, x1, cell_state::FREE, cell_state::PADDED);
+        blockFree(yIdx, x0, x1);
+      }
+    };
+    const auto markObject = [&](const size_t yIdx, size_t x0, size_t x1) {
+      x0 = std::max(x0, clip.minX);
+      x1 = std::min(x1, clip.maxX);
+      if (x0 <= x1) {
+        m_cellStates.fillSpan(yIdx, x0, x1, cell_state::OBJECT);
+        blockFree(yIdx, x0, x1);
+      }
+    };
+    GridCircle::visitRingSpans(padded,
+                               obstacle.radius(),
+                               *this,
+                               markPadded,
+                               markObject,
+                               clip.minY,
+                               clip.maxY + 1);
   }
 
-  void padRowsAndCols(const std::vector<size_t>& rows,
-                      const std::vector<size_t>& cols)
+  /**
+   * @brief Run f(band) for each band in [0, numBands) on a thread pool, and
+   * wait for all of them to finish.
+   */
+  template <typename BandFunc>
+  static void runBands(ThreadPool& pool, const size_t numBands, BandFunc&& f)
+  {
+    std::vector<std::future<void>> results;
+    results.reserve(numBands);
+    for (size_t band = 0; band < numBands; ++band) {
+      results.emplace_back(
+          pool.submit([&f, band](const size_t /* workerIdx */) { f(band); }));
+    }
+    for (auto& result : results) {
+      result.get();
+    }
+  }
+
+  /**
+   * @brief Recompute the layers derived from the cell states for all cells.
+   */
+  void refreshLayers()
+  {
+    if (size() == 0U) {
+      return;
+    }
+    updateFreeCells(0, numY() - 1);
+    updateNbrMasks(0, 0, numX() - 1, numY() - 1);
+  }
+
+  /**
+   * @brief Refresh the neighbor masks after the free cells within the given
+   * (inclusive) bounds have changed, if any (e.g., not for obstacles outside
+   * of the task space).
+   */
+  void refreshNbrMasks(const size_t minX,
+                       const size_t minY,
+                       const size_t maxX,
+                       const size_t maxY)
+  {
+    if (minX > maxX || minY > maxY) {
+      return;
+    }
+    // the neighbor masks of the cells bordering the region are also affected
+    updateNbrMasks(minX > 0 ? minX - 1 : 0,
+                   minY > 0 ? minY - 1 : 0,
+                   std::min(maxX + 1, numX() - 1),
+                   std::min(maxY + 1, numY() - 1));
+  }
+
+  /**
+   * @brief Get cell states as bytes for the row kernels.
+   */
+  static const uint8_t* asBytes(const cell_state* states)
+  {
+    return reinterpret_cast<const uint8_t*>(states);
+  }
+
+  static uint8_t* asBytes(cell_state* states)
+  {
+    return reinterpret_cast<uint8_t*>(states);
+  }
+
+  /**
+   * @brief Recompute the bit-packed free cells for all cells of the rows
+   * within the given (inclusive) bounds, packing a whole row at a time, or a
+   * tile's span of it if tiled.
+   */
+  void updateFreeCells(const size_t minY, const size_t maxY)
+  {
+    // the tiles' spans start on a word of the free cells
+    static_assert(TileIndexer::TILE_DIM % 64 == 0);
+    const RowKernels& kernels = RowKernels::best();
+    for (size_t yIdx = minY; yIdx <= maxY; ++yIdx) {
+      uint64_t* words = m_freeCells.row(yIdx);
+      forEachStateSpan(yIdx,
+                       [&](const size_t xIdx,
+                           const cell_state* states,
+                           const size_t count) {
+                         kernels.packMatches(
+                             asBytes(states),
+                             count,
+                             static_cast<uint8_t>(cell_state::FREE),
+                             words + xIdx / 64);
+                       });
+    }
+  }
+
+  /**
+   * @brief Recompute the free-neighbor masks for all cells within the given
+   * (inclusive) bounds, a span of a row at a time.
+   * NOTE: the free cells are read from the cell states, which the free cells
+   * are always kept in sync with.
+   */
+  void updateNbrMasks(const size_t minX,
+                      const size_t minY,
+                      const size_t maxX,
+                      const size_t maxY)
   {
-    for (const size_t yIdx : rows) {
-      for (const size_t xIdx : cols) {
-        m_cellStates.at(xIdx, yIdx) = cell_state::PADDED;
+    const RowKernels& kernels = RowKernels::best();
+
+    // the free bytes (see RowKernels::NbrMasksFunc) of the rows below, at and
+    // above the current row, for the span and the cell either side of it,
+    // which remain zero outside of the task space
+    const size_t width = maxX - minX + 1;
+    const size_t x0 = minX > 0 ? minX - 1 : 0;
+    const size_t x1 = std::min(maxX + 1, numX() - 1);
+    std::vector<uint8_t> freeBytes(3 * (width + 2), 0U);
+    std::array<uint8_t*, 3> rows{freeBytes.data(),
+                                 freeBytes.data() + width + 2,
+                                 freeBytes.data() + 2 * (width + 2)};
+    const auto loadRow = [&](const size_t yIdx, uint8_t* row) {
+      if (yIdx >= numY()) {
+        std::fill(row, row + width + 2, 0U);
+        return;
       }
+      m_cellStates.forEachSpan(
+          yIdx,
+          x0,
+          x1,
+          [&](const size_t xIdx, const cell_state* states, const size_t n) {
+            kernels.matchBytes(asBytes(states),
+                               n,
+                               static_cast<uint8_t>(cell_state::FREE),
+                               row + (xIdx + 1 - minX));
+          });
+    };
+
+    // NOTE: rows below zero wrap around, and are outside of the task space
+    std::vector<uint8_t> masks(width);
+    loadRow(minY - 1, rows[0]);
+    loadRow(minY, rows[1]);
+    for (size_t yIdx = minY; yIdx <= maxY; ++yIdx) {
+      loadRow(yIdx + 1, rows[2]);
+      kernels.nbrMasks(
+          rows[0] + 1, rows[1] + 1, rows[2] + 1, width, masks.data());
+      m_nbrMasks.assignSpan(yIdx, minX, masks.data(), width);
+      std::rotate(rows.begin(), rows.begin() + 1, rows.end());
     }
   }
-};
\ No newline at end of file
+
+  /**
+   * @brief Assign padding to the cells within the robot's radius around the
+   * outside of the task space, a span of a row at a time.
+   * NOTE: only free cells are written, leaving obstacles which extend to the
+   * boundary in place, and avoiding writes to already padded cells (which
+   * would copy the pages of memory-mapped cell states).
+   */
+  void assignBoundaryCellStates()
+  {
+    const RowKernels& kernels = RowKernels::best();
+    const auto pad = [&](const size_t yIdx, const size_t x0, const size_t x1) {
+      m_cellStates.forEachMutableSpan(
+          yIdx,
+          x0,
+          x1,
+          [&](size_t, cell_state* states, const size_t count) {
+            kernels.replaceBytes(asBytes(states),
+                                 count,
+                                 static_cast<uint8_t>(cell_state::FREE),
+                                 static_cast<uint8_t>(cell_state::PADDED));
+          });
+    };
+
+    const size_t edgeCols = std::min(m_robotRadius, numX());
+    for (size_t yIdx = 0; yIdx < numY() && numX() > 0; ++yIdx) {
+      if (yIdx < m_robotRadius || yIdx + m_robotRadius >= numY()) {
+        // bottom and top rows
+        pad(yIdx, 0, numX() - 1);
+      } else if (edgeCols > 0) {
+        // left and right cols
+        pad(yIdx, 0, edgeCols - 1);
+        pad(yIdx, numX() - edgeCols, numX() - 1);
+      }
+    }
+  }
+};
+
+/**
+ * @brief Shared, read-only handle to a configuration space. This allows
+ * multiple planners (e.g., one per thread) to read a single obstacle grid
+ * without copying it.
+ */
+using SharedConfigSpace = std::shared_ptr<const ConfigurationSpace>;
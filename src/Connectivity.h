@@ -0,0 +1,361 @@
+/**
+ * @file Connectivity.h
+ * @brief File containing the connected components of the cells of a bit-packed
+ * grid, for answering reachability queries without a search.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#pragma once
+
+#include "Cell.h"
+#include "Grid.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Class labelling the 8-connected components of the set cells of a
+ * BitMap (e.g., the free cells of a configuration space). Two set cells are in
+ * the same component if they are joined by moves to any of the eight
+ * neighbors, as for the free-neighbor masks, so cells in different components
+ * can never be reached from one another (although cells in the same component
+ * may not be by planners restricted to fewer moves, e.g., ManhattanCost).
+ * NOTE: the set cells are held as the maximal runs of each row, which are
+ * labelled with a union-find over the runs, so the memory and the time to
+ * build the index scale with the number of runs rather than of cells. Looking
+ * up a cell is a binary search over the runs of its row.
+ * NOTE: as cells are set (see addCells()), the components they join are
+ * merged with a union-find over the labels, so a run's label is resolved to
+ * the label of its component on lookup.
+ */
+class ConnectivityIndex
+{
+  public:
+  using label_type = uint32_t;
+
+  // the label of the cells which are not set (or are outside of the grid)
+  static constexpr label_type NO_COMPONENT =
+      std::numeric_limits<label_type>::max();
+
+  ConnectivityIndex() : m_numRuns(0U), m_numComponents(0U)
+  {
+    // do nothing
+  }
+
+  /**
+   * @brief Construct the index over the set cells of a bit map.
+   *
+   * @param cells The cells to label.
+   */
+  explicit ConnectivityIndex(const BitMap& cells)
+      : m_rows(cells.numY()), m_numRuns(0U), m_numComponents(0U)
+  {
+    assert(cells.numX() <= std::numeric_limits<uint32_t>::max());
+    for (size_t yIdx = 0; yIdx < cells.numY(); ++yIdx) {
+      appendRuns(cells, yIdx, m_rows[yIdx]);
+      m_numRuns += m_rows[yIdx].size();
+    }
+    labelRuns();
+  }
+
+  /**
+   * @brief Update the index once cells of the bit map have been set, merging
+   * the components they join, in O(runs of the given rows) rather than
+   * relabelling the whole map.
+   * NOTE: requires that no cell has been cleared since the index was last
+   * updated, and that all of the cells set are within the given (inclusive)
+   * ranges of rows.
+   *
+   * @param cells The bit map the index was built from.
+   * @param rowRanges The (inclusive) ranges of rows containing the set cells.
+   */
+  void addCells(const BitMap& cells,
+                const std::vector<std::pair<size_t, size_t>>& rowRanges)
+  {
+    assert(cells.numY() == m_rows.size());
+    // relabel the runs of the rows, each new run containing any old runs
+    // of its row, as no cell was cleared
+    std::vector<Run> oldRuns;
+    for (const auto& [minY, maxY] : rowRanges) {
+      for (size_t yIdx = minY; yIdx <= maxY && yIdx < m_rows.size(); ++yIdx) {
+        oldRuns.swap(m_rows[yIdx]);
+        m_rows[yIdx].clear();
+        appendRuns(cells, yIdx, m_rows[yIdx]);
+        m_numRuns += m_rows[yIdx].size();
+        m_numRuns -= oldRuns.size();
+
+        auto old = oldRuns.begin();
+        for (Run& run : m_rows[yIdx]) {
+          for (; old != oldRuns.end() && old->x1 <= run.x1; ++old) {
+            assert(run.x0 <= old->x0);
+            run.label = run.label == NO_COMPONENT
+                            ? findLabel(old->label)
+                            : uniteLabels(run.label, old->label);
+          }
+          if (run.label == NO_COMPONENT) {
+            run.label = static_cast<label_type>(m_labelParents.size());
+            m_labelParents.push_back(run.label);
+            m_labelRanks.push_back(0U);
+            ++m_numComponents;
+          }
+        }
+      }
+    }
+
+    // then join the runs touching those of the rows either side
+    for (const auto& [minY, maxY] : rowRanges) {
+      const size_t last = std::min(maxY + 1, m_rows.size() - 1);
+      for (size_t yIdx = std::max<size_t>(minY, 1U); yIdx <= last; ++yIdx) {
+        forEachTouching(
+            m_rows[yIdx - 1], m_rows[yIdx], [this](const Run& a, const Run& b) {
+              uniteLabels(a.label, b.label);
+            });
+      }
+    }
+  }
+
+  /**
+   * @brief Get the label of the component containing a cell, or NO_COMPONENT
+   * if the cell is not set. The labels are numbered from zero when the index
+   * is constructed, but may not be contiguous once cells have been added.
+   */
+  label_type component(const Cell& c) const
+  {
+    if (c.y() >= m_rows.size()) {
+      return NO_COMPONENT;
+    }
+    const std::vector<Run>& runs = m_rows[c.y()];
+
+    // the first run of the row ending at or after the cell
+    const auto run = std::lower_bound(
+        runs.begin(), runs.end(), c.x(), [](const Run& r, const size_t xIdx) {
+          return r.x1 < xIdx;
+        });
+    if (run == runs.end() || run->x0 > c.x()) {
+      return NO_COMPONENT;
+    }
+    label_type label = run->label;
+    while (m_labelParents[label] != label) {
+      label = m_labelParents[label];
+    }
+    return label;
+  }
+
+  /**
+   * @brief Check whether two cells are set and in the same component.
+   */
+  bool connected(const Cell& a, const Cell& b) const
+  {
+    const label_type label = component(a);
+    return label != NO_COMPONENT && label == component(b);
+  }
+
+  size_t numComponents() const
+  {
+    return m_numComponents;
+  }
+
+  size_t numRuns() const
+  {
+    return m_numRuns;
+  }
+
+  size_t bytes() const
+  {
+    size_t bytes = m_rows.capacity() * sizeof(std::vector<Run>) +
+                   m_labelParents.capacity() * sizeof(label_type) +
+                   m_labelRanks.capacity();
+    for (const auto& runs : m_rows) {
+      bytes += runs.capacity() * sizeof(Run);
+    }
+    return bytes;
+  }
+
+  private:
+  using word_type = BitMap::word_type;
+  static constexpr size_t WORD_BITS = BitMap::WORD_BITS;
+
+  /**
+   * @brief Structure containing the (inclusive) span [x0, x1] of a run of set
+   * cells within a row, and the label of its component.
+   */
+  struct Run {
+    uint32_t x0;
+    uint32_t x1;
+    label_type label;
+  };
+
+  // the runs of each row, in order
+  std::vector<std::vector<Run>> m_rows;
+  // the union-find over the labels, with the rank of each root
+  std::vector<label_type> m_labelParents;
+  std::vector<uint8_t> m_labelRanks;
+  size_t m_numRuns;
+  size_t m_numComponents;
+
+  /**
+   * @brief Append the runs of set cells of a row, scanning a word at a time.
+   */
+  static void appendRuns(const BitMap& cells,
+                         const size_t yIdx,
+                         std::vector<Run>& runs)
+  {
+    const word_type* words = cells.row(yIdx);
+    const size_t numWords = cells.wordsPerRow();
+    size_t xIdx = findBit(words, numWords, 0U, true);
+    while (xIdx < cells.numX()) {
+      // NOTE: the padding bits at the end of a row are never set
+      const size_t end = findBit(words, numWords, xIdx, false);
+      runs.push_back({static_cast<uint32_t>(xIdx),
+                      static_cast<uint32_t>(end - 1),
+                      NO_COMPONENT});
+      xIdx = findBit(words, numWords, end, true);
+    }
+  }
+
+  /**
+   * @brief Find the first bit at or after a position which has the given
+   * value, or the number of bits if there is none.
+   */
+  static size_t findBit(const word_type* words,
+                        const size_t numWords,
+                        const size_t from,
+                        const bool value)
+  {
+    size_t wIdx = from / WORD_BITS;
+    if (wIdx >= numWords) {
+      return numWords * WORD_BITS;
+    }
+    const word_type flip = value ? word_type{0} : ~word_type{0};
+    word_type word =
+        (words[wIdx] ^ flip) & (~word_type{0} << (from % WORD_BITS));
+    while (word == 0U) {
+      if (++wIdx == numWords) {
+        return numWords * WORD_BITS;
+      }
+      word = words[wIdx] ^ flip;
+    }
+    return wIdx * WORD_BITS + static_cast<size_t>(std::countr_zero(word));
+  }
+
+  /**
+   * @brief Call f(a, b) for each pair of runs of adjacent rows which touch,
+   * including diagonally.
+   */
+  template <typename F>
+  static void forEachTouching(const std::vector<Run>& below,
+                              const std::vector<Run>& runs,
+                              F&& f)
+  {
+    size_t first = 0;
+    for (const Run& run : runs) {
+      // runs below ending left of this run can't touch any later run either
+      while (first < below.size() && below[first].x1 + 1U < run.x0) {
+        ++first;
+      }
+      for (size_t other = first;
+           other < below.size() && below[other].x0 <= run.x1 + 1U;
+           ++other) {
+        f(below[other], run);
+      }
+    }
+  }
+
+  /**
+   * @brief Join the runs of adjacent rows which touch, including diagonally,
+   * and number the resulting components in the order first seen.
+   */
+  void labelRuns()
+  {
+    assert(m_numRuns < NO_COMPONENT);
+    // the runs are numbered in row-major order for the union-find, using
+    // the label of each run to hold its number
+    std::vector<uint32_t> parents(m_numRuns);
+    std::iota(parents.begin(), parents.end(), 0U);
+    label_type runIdx = 0U;
+    for (auto& runs : m_rows) {
+      for (Run& run : runs) {
+        run.label = runIdx++;
+      }
+    }
+    for (size_t yIdx = 1; yIdx < m_rows.size(); ++yIdx) {
+      forEachTouching(
+          m_rows[yIdx - 1], m_rows[yIdx], [&](const Run& a, const Run& b) {
+            unite(parents, a.label, b.label);
+          });
+    }
+
+    std::vector<label_type> rootLabels(m_numRuns, NO_COMPONENT);
+    for (auto& runs : m_rows) {
+      for (Run& run : runs) {
+        label_type& rootLabel = rootLabels[findRoot(parents, run.label)];
+        if (rootLabel == NO_COMPONENT) {
+          rootLabel = static_cast<label_type>(m_numComponents++);
+        }
+        run.label = rootLabel;
+      }
+    }
+    m_labelParents.resize(m_numComponents);
+    std::iota(m_labelParents.begin(), m_labelParents.end(), 0U);
+    m_labelRanks.assign(m_numComponents, 0U);
+  }
+
+  /**
+   * @brief Find the label of the component of a (run's) label.
+   */
+  label_type findLabel(label_type label)
+  {
+    return findRoot(m_labelParents, label);
+  }
+
+  /**
+   * @brief Merge the components of two labels, by rank so the depth of the
+   * labels followed on lookup stays logarithmic, and get the label of the
+   * merged component.
+   */
+  label_type uniteLabels(const label_type a, const label_type b)
+  {
+    label_type rootA = findLabel(a);
+    label_type rootB = findLabel(b);
+    if (rootA == rootB) {
+      return rootA;
+    }
+    if (m_labelRanks[rootA] < m_labelRanks[rootB]) {
+      std::swap(rootA, rootB);
+    }
+    m_labelParents[rootB] = rootA;
+    if (m_labelRanks[rootA] == m_labelRanks[rootB]) {
+      ++m_labelRanks[rootA];
+    }
+    --m_numComponents;
+    return rootA;
+  }
+
+  static uint32_t findRoot(std::vector<uint32_t>& parents, size_t idx)
+  {
+    // path halving
+    while (parents[idx] != idx) {
+      parents[idx] = parents[parents[idx]];
+      idx = parents[idx];
+    }
+    return static_cast<uint32_t>(idx);
+  }
+
+  static void unite(std::vector<uint32_t>& parents,
+                    const size_t a,
+                    const size_t b)
+  {
+    const uint32_t rootA = findRoot(parents, a);
+    const uint32_t rootB = findRoot(parents, b);
+    if (rootA != rootB) {
+      parents[std::max(rootA, rootB)] = std::min(rootA, rootB);
+    }
+  }
+};
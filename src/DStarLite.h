@@ -0,0 +1,439 @@
+/**
+ * @file DStarLite.h
+ * @brief File containing the implementation of the D* Lite incremental
+ * path-finding algorithm.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#pragma once
+
+#include "Cell.h"
+#include "ConfigSpace.h"
+#include "Heuristics.h"
+#include "MotionPlanning.h"
+#include "OpenList.h"
+#include "SearchStats.h"
+#include "SearchWorkspace.h"
+#include "TiledGrid.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Class used to perform the D* Lite incremental path-finding algorithm,
+ * for a robot which discovers obstacles while following its path. The search
+ * runs backwards from the goal, so its state remains valid as the robot moves
+ * (see moveStart()), and when cells of the configuration space change (see
+ * updateCells()) only the part of the search tree affected by the change is
+ * repaired by the next searchPath(), rather than searching from scratch.
+ * NOTE: the same moves are allowed as with AStar, for the robot radius the
+ * configuration space was padded for. The search state is stored in lazily
+ * allocated tiles (see TiledLayout), so its memory depends on the area
+ * explored rather than the map size.
+ * The below implementation follows the optimized version described in:
+ *   S. Koenig and M. Likhachev, "D* Lite", AAAI 2002.
+ *
+ * @tparam CostPolicy The move cost and heuristic policy.
+ */
+template <typename CostPolicy = OctileCost>
+class BasicDStarLite
+{
+  public:
+  using cost_policy = CostPolicy;
+  using cost_type = typename CostPolicy::cost_type;
+  using index_type = uint32_t;
+
+  /**
+   * @brief Construct a new DStarLite object for a query, sharing ownership of
+   * the configuration space.
+   * NOTE: the configuration space may be changed (e.g., by the robot's owner
+   * adding obstacles to it), as long as the changed cells are then passed to
+   * updateCells(), otherwise searches are rejected (see searchPath()).
+   *
+   * @param cSpace The configuration space to search.
+   * @param start The start location
+   * @param goal The goal location
+   */
+  BasicDStarLite(SharedConfigSpace cSpace, const Cell& start, const Cell& goal)
+      : m_cSpace(std::move(cSpace)),
+        m_grid(m_cSpace->shape()),
+        m_start(start),
+        m_goal(goal),
+        m_keyOffset(0),
+        m_version(m_cSpace->version())
+  {
+    assert(m_grid.storageSize() <=
+           size_t{std::numeric_limits<index_type>::max()} + 1U);
+    m_gCosts.assign(m_grid.storageSize(), INF);
+    m_rhsCosts.assign(m_grid.storageSize(), INF);
+    m_openList.reset(m_grid.storageSize());
+    if (m_grid.contains(m_goal)) {
+      const index_type goalIdx = idxFrom(m_goal);
+      setCost(m_rhsCosts, goalIdx, 0);
+      m_openList.push(goalIdx, key(goalIdx, m_goal));
+    }
+  }
+
+  /**
+   * @brief Construct a new DStarLite object, as above, borrowing the
+   * configuration space.
+   * NOTE: the configuration space is not copied, and must outlive this object.
+   */
+  BasicDStarLite(const ConfigurationSpace& cSpace,
+                 const Cell& start,
+                 const Cell& goal)
+      : BasicDStarLite(SharedConfigSpace(SharedConfigSpace(), &cSpace),
+                       start,
+                       goal)
+  {
+    // do nothing
+  }
+
+  // prevent borrowing a temporary configuration space
+  BasicDStarLite(ConfigurationSpace&& cSpace,
+                 const Cell& start,
+                 const Cell& goal) = delete;
+
+  const ConfigurationSpace& configSpace() const
+  {
+    return *m_cSpace;
+  }
+
+  Cell start() const
+  {
+    return m_start;
+  }
+
+  Cell goal() const
+  {
+    return m_goal;
+  }
+
+  /**
+   * @brief Move the start of the query (e.g., as the robot follows its path),
+   * keeping the search state.
+   */
+  void moveStart(const Cell& start)
+  {
+    // the keys queued for the previous start remain lower bounds once offset
+    // by the heuristic distance moved
+    m_keyOffset += CostPolicy::heuristic(m_start, start);
+    m_start = start;
+  }
+
+  /**
+   * @brief Repair the search state after the accessibility of the given cells
+   * has changed (e.g., as reported by ConfigurationSpace::addObstacles()). The
+   * moves into and out of each cell are re-evaluated, and the path is repaired
+   * by the next searchPath().
+   * NOTE: the cells are those changed since the previous call, and the search
+   * is then current with the configuration space's version.
+   *
+   * @param changedCells The changed cells, in any order.
+   */
+  void updateCells(const std::vector<Cell>& changedCells)
+  {
+    m_version = m_cSpace->version();
+    SearchStats st;
+    for (const Cell& c : changedCells) {
+      if (!m_grid.contains(c)) {
+        continue;
+      }
+      // NOTE: cells below zero wrap around, and are outside of the task space
+      refreshVertex(c, st);
+      for (const NbrOffset& offset : NBR_OFFSETS) {
+        const Cell nbr(c.x() + offset.dx, c.y() + offset.dy);
+        if (m_grid.contains(nbr)) {
+          refreshVertex(nbr, st);
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Find the path from the start to the goal, repairing the search
+   * state after any moves of the start and changes of the cells since the
+   * previous call. The first call performs a full search, backwards from the
+   * goal.
+   * NOTE: if the configuration space changed since the search was constructed
+   * or updateCells() was last called, the search state no longer matches it,
+   * so no path is returned, with the status MAP_CHANGED.
+   *
+   * @param stats If provided, the outcome, counters and timings of the search
+   * are written to it
+   * @return std::vector<Cell> The cell locations making up the path, ordered
+   * from start to goal, if found. Otherwise, an empty vector is returned.
+   */
+  std::vector<Cell> searchPath(SearchStats* stats = nullptr)
+  {
+    SearchStats localStats;
+    SearchStats& st = stats ? *stats : localStats;
+    st = SearchStats();
+    const auto setupStart = SearchUtils::Clock::now();
+
+    st.status = m_version != m_cSpace->version()
+                    ? search_status::MAP_CHANGED
+                    : SearchUtils::checkStartGoal(*m_cSpace, m_start, m_goal);
+    const auto searchStart = SearchUtils::Clock::now();
+    st.setupTime = searchStart - setupStart;
+    if (st.status != search_status::FOUND) {
+      return std::vector<Cell>();
+    }
+
+    computeShortestPath(st);
+    const auto pathStart = SearchUtils::Clock::now();
+    st.searchTime = pathStart - searchStart;
+    st.workspaceBytes = bytes();
+
+    std::vector<Cell> path = generatePath();
+    if (path.empty()) {
+      st.status = search_status::NOT_FOUND;
+    }
+    st.pathTime = SearchUtils::Clock::now() - pathStart;
+    return path;
+  }
+
+  /**
+   * @brief The number of bytes currently held by the search state.
+   */
+  size_t bytes() const
+  {
+    return m_gCosts.bytes() + m_rhsCosts.bytes() + m_openList.bytes();
+  }
+
+  private:
+  static constexpr cost_type INF = std::numeric_limits<cost_type>::max();
+
+  /**
+   * @brief Structure containing the priority of a queued cell, ordered
+   * lexicographically.
+   */
+  struct Key {
+    cost_type primary;
+    cost_type secondary;
+
+    bool operator<(const Key& other) const
+    {
+      return primary < other.primary ||
+             (primary == other.primary && secondary < other.secondary);
+    }
+  };
+
+  using Costs = TiledLayout::array_type<cost_type>;
+
+  SharedConfigSpace m_cSpace;
+  TileIndexer m_grid;
+  Cell m_start;
+  Cell m_goal;
+  // the sum of the heuristic distances the start has moved, added to keys so
+  // that queued keys need not be recomputed for each move
+  cost_type m_keyOffset;
+  // the version of the configuration space the search state matches
+  uint64_t m_version;
+  // the cost-to-goal of each cell, and its one-step lookahead
+  Costs m_gCosts;
+  Costs m_rhsCosts;
+  IndexedHeap<Key, 4, TiledLayout::array_type<uint32_t>> m_openList;
+
+  index_type idxFrom(const Cell& c) const
+  {
+    return static_cast<index_type>(m_grid.idxFrom(c));
+  }
+
+  cost_type gCost(const index_type idx) const
+  {
+    return std::as_const(m_gCosts)[idx];
+  }
+
+  cost_type rhsCost(const index_type idx) const
+  {
+    return std::as_const(m_rhsCosts)[idx];
+  }
+
+  /**
+   * @brief Assign a cost, only allocating its tile for finite costs.
+   */
+  static void setCost(Costs& costs, const index_type idx, const cost_type cost)
+  {
+    if (cost != INF || costs.isAllocated(idx / TileIndexer::TILE_CELLS)) {
+      costs[idx] = cost;
+    }
+  }
+
+  static cost_type addStep(const cost_type cost, const size_t dir)
+  {
+    return cost == INF ? INF : cost + CostPolicy::stepCost(dir);
+  }
+
+  Key key(const index_type idx, const Cell& c) const
+  {
+    const cost_type cost = std::min(gCost(idx), rhsCost(idx));
+    if (cost == INF) {
+      return {INF, INF};
+    }
+    return {cost + CostPolicy::heuristic(c, m_start) + m_keyOffset, cost};
+  }
+
+  /**
+   * @brief Get the neighbors of a cell which may be moved to (or from, as all
+   * moves are reversible), being none for an inaccessible cell.
+   */
+  NeighborRange moves(const Cell& c) const
+  {
+    return NeighborRange(c,
+                         m_cSpace->isAccessible(c)
+                             ? m_cSpace->nbrMask(c) & CostPolicy::MOVES
+                             : 0U);
+  }
+
+  /**
+   * @brief Get the lowest cost-to-goal of a cell through any of its moves.
+   */
+  cost_type lookahead(const Cell& c) const
+  {
+    cost_type best = INF;
+    const NeighborRange nbrs = moves(c);
+    for (auto nbrIt = nbrs.begin(); nbrIt != nbrs.end(); ++nbrIt) {
+      best = std::min(best,
+                      addStep(gCost(idxFrom(*nbrIt)), nbrIt.direction()));
+    }
+    return best;
+  }
+
+  /**
+   * @brief Queue a cell if its cost is inconsistent with its lookahead, or
+   * remove it from the queue if not.
+   */
+  void updateVertex(const index_type idx, const Cell& c, SearchStats& st)
+  {
+    const bool inconsistent = gCost(idx) != rhsCost(idx);
+    if (m_openList.contains(idx)) {
+      if (inconsistent) {
+        m_openList.updateKey(idx, key(idx, c));
+        ++st.heapDecreaseKeys;
+      } else {
+        m_openList.erase(idx);
+      }
+    } else if (inconsistent) {
+      m_openList.push(idx, key(idx, c));
+      ++st.heapPushes;
+      st.peakOpenListSize = std::max(st.peakOpenListSize, m_openList.size());
+    }
+  }
+
+  /**
+   * @brief Recompute the lookahead of a cell from its moves, and requeue it.
+   */
+  void refreshVertex(const Cell& c, SearchStats& st)
+  {
+    if (c == m_goal) {
+      return;
+    }
+    const index_type idx = idxFrom(c);
+    setCost(m_rhsCosts, idx, lookahead(c));
+    updateVertex(idx, c, st);
+  }
+
+  /**
+   * @brief Expand queued cells until the start's cost is consistent and no
+   * queued cell could lower it.
+   */
+  void computeShortestPath(SearchStats& st)
+  {
+    const index_type startIdx = idxFrom(m_start);
+    while (!m_openList.empty() &&
+           (m_openList.top().key < key(startIdx, m_start) ||
+            rhsCost(startIdx) > gCost(startIdx))) {
+      const auto [oldKey, idx] = m_openList.top();
+      const Cell c = m_grid.cellFrom(idx);
+      const Key newKey = key(idx, c);
+      if (oldKey < newKey) {
+        // queued before the start moved, so requeue with the current key
+        m_openList.updateKey(idx, newKey);
+        ++st.heapDecreaseKeys;
+        continue;
+      }
+      ++st.heapPops;
+      ++st.nodesExpanded;
+
+      const cost_type g = gCost(idx);
+      const cost_type rhs = rhsCost(idx);
+      const NeighborRange nbrs = moves(c);
+      if (g > rhs) {
+        // overconsistent, so the cell's cost is lowered to its lookahead,
+        // which may lower the lookahead of its neighbors
+        setCost(m_gCosts, idx, rhs);
+        m_openList.erase(idx);
+        for (auto nbrIt = nbrs.begin(); nbrIt != nbrs.end(); ++nbrIt) {
+          const Cell nbr = *nbrIt;
+          if (nbr == m_goal) {
+            continue;
+          }
+          const index_type nbrIdx = idxFrom(nbr);
+          const cost_type cost = addStep(rhs, nbrIt.direction());
+          if (cost < rhsCost(nbrIdx)) {
+            setCost(m_rhsCosts, nbrIdx, cost);
+            updateVertex(nbrIdx, nbr, st);
+          }
+        }
+      } else {
+        // underconsistent, so the cell's cost is raised, and the neighbors
+        // whose lookahead was through it are recomputed
+        setCost(m_gCosts, idx, INF);
+        for (auto nbrIt = nbrs.begin(); nbrIt != nbrs.end(); ++nbrIt) {
+          const Cell nbr = *nbrIt;
+          if (nbr != m_goal &&
+              rhsCost(idxFrom(nbr)) == addStep(g, nbrIt.direction())) {
+            refreshVertex(nbr, st);
+          }
+        }
+        refreshVertex(c, st);
+      }
+    }
+  }
+
+  /**
+   * @brief Generate the path from the start to the goal by following the
+   * lowest cost-to-goal moves, being empty if the start can't reach the goal.
+   * The costs strictly decrease along a path through the search state, so if
+   * they don't (e.g., if the state is inconsistent with the cells) the path is
+   * also empty, rather than looping.
+   */
+  std::vector<Cell> generatePath() const
+  {
+    // NOTE: the start's lookahead is its cost-to-goal, although its own cost
+    // may not have been updated
+    cost_type remaining = rhsCost(idxFrom(m_start));
+    if (remaining == INF) {
+      return std::vector<Cell>();
+    }
+    std::vector<Cell> path{m_start};
+    while (path.back() != m_goal) {
+      const Cell c = path.back();
+      const NeighborRange nbrs = moves(c);
+      Cell next = c;
+      cost_type best = INF;
+      for (auto nbrIt = nbrs.begin(); nbrIt != nbrs.end(); ++nbrIt) {
+        const cost_type cost =
+            addStep(gCost(idxFrom(*nbrIt)), nbrIt.direction());
+        if (cost < best) {
+          best = cost;
+          next = *nbrIt;
+        }
+      }
+      if (best == INF || gCost(idxFrom(next)) >= remaining) {
+        return std::vector<Cell>();
+      }
+      remaining = gCost(idxFrom(next));
+      path.emplace_back(next);
+    }
+    return path;
+  }
+};
+
+using DStarLite = BasicDStarLite<>;
@@ -0,0 +1,150 @@
+/**
+ * @file DistanceTransform.h
+ * @brief File containing the exact Euclidean distance transform of a grid.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#pragma once
+
+#include "Grid.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/**
+ * @brief Class for computing the exact squared Euclidean distance from each
+ * cell of a grid to its nearest 'site' cell, in time linear in the number of
+ * cells. The transform is separable, first finding the nearest site within
+ * each column, then the lower envelope of the resulting parabolas along each
+ * row. The below implementation follows the description provided at:
+ *   https://cs.brown.edu/people/pfelzens/papers/dt-final.pdf
+ */
+class DistanceTransform
+{
+  public:
+  // distance of cells with no site in the grid
+  static constexpr uint32_t INF_SQ = std::numeric_limits<uint32_t>::max();
+
+  /**
+   * @brief Compute the squared distance from each cell to its nearest site.
+   *
+   * @param grid The grid object.
+   * @param isSite Called as isSite(xIdx, yIdx), returning whether the cell is a
+   * site.
+   * @return DataMap<uint32_t> The squared distances, saturating at INF_SQ.
+   */
+  template <typename IsSite>
+  static DataMap<uint32_t> squared(const GridIndexer& grid, IsSite&& isSite)
+  {
+    const size_t nx = grid.numX();
+    const size_t ny = grid.numY();
+    if (nx == 0U || ny == 0U) {
+      // no cells, and the row sweeps below assume at least one of each
+      return DataMap<uint32_t>(grid.shape(), INF_SQ);
+    }
+
+    // vertical distance to the nearest site in the same column, swept up then
+    // down the rows so that each pass reads the grid in memory order
+    std::vector<int64_t> colDist(nx * ny, INF_DIST);
+    for (size_t yIdx = 0; yIdx < ny; ++yIdx) {
+      for (size_t xIdx = 0; xIdx < nx; ++xIdx) {
+        int64_t& d = colDist[xIdx + yIdx * nx];
+        if (isSite(xIdx, yIdx)) {
+          d = 0;
+        } else if (yIdx > 0 && colDist[xIdx + (yIdx - 1) * nx] < INF_DIST) {
+          d = colDist[xIdx + (yIdx - 1) * nx] + 1;
+        }
+      }
+    }
+    for (size_t yIdx = ny - 1; yIdx-- > 0;) {
+      for (size_t xIdx = 0; xIdx < nx; ++xIdx) {
+        const int64_t above = colDist[xIdx + (yIdx + 1) * nx];
+        int64_t& d = colDist[xIdx + yIdx * nx];
+        if (above < INF_DIST) {
+          d = std::min(d, above + 1);
+        }
+      }
+    }
+
+    // combine the columns along each row
+    DataMap<uint32_t> result(grid.shape(), INF_SQ);
+    std::vector<int64_t> rowCost(nx);
+    std::vector<int64_t> rowDist(nx);
+    std::vector<size_t> sites(nx);
+    std::vector<double> bounds(nx + 1);
+    for (size_t yIdx = 0; yIdx < ny; ++yIdx) {
+      for (size_t xIdx = 0; xIdx < nx; ++xIdx) {
+        const int64_t d = colDist[xIdx + yIdx * nx];
+        rowCost[xIdx] = d < INF_DIST ? d * d : INF_DIST;
+      }
+      transformRow(rowCost, rowDist, sites, bounds);
+      for (size_t xIdx = 0; xIdx < nx; ++xIdx) {
+        result.at(xIdx, yIdx) =
+            static_cast<uint32_t>(std::min<int64_t>(rowDist[xIdx], INF_SQ));
+      }
+    }
+    return result;
+  }
+
+  private:
+  static constexpr int64_t INF_DIST = std::numeric_limits<int64_t>::max() / 4;
+
+  /**
+   * @brief Compute d(q) = min over p of (q - p)^2 + f(p) for each cell of a row,
+   * being the lower envelope of the parabolas rooted at each finite cost.
+   *
+   * @param f The row costs, where INF_DIST has no site
+   * @param d The transformed row costs (output)
+   * @param sites Scratch space for the envelope's parabolas
+   * @param bounds Scratch space for the envelope's parabola boundaries
+   */
+  static void transformRow(const std::vector<int64_t>& f,
+                           std::vector<int64_t>& d,
+                           std::vector<size_t>& sites,
+                           std::vector<double>& bounds)
+  {
+    const size_t n = f.size();
+    const auto intersect = [&](const size_t p, const size_t q) {
+      const double fp = static_cast<double>(f[p]) + static_cast<double>(p * p);
+      const double fq = static_cast<double>(f[q]) + static_cast<double>(q * q);
+      return (fq - fp) / (2.0 * static_cast<double>(q - p));
+    };
+
+    // build the lower envelope from the cells with finite costs
+    size_t numSites = 0;
+    for (size_t q = 0; q < n; ++q) {
+      if (f[q] >= INF_DIST) {
+        continue;
+      }
+      double bound = -std::numeric_limits<double>::max();
+      while (numSites > 0) {
+        bound = intersect(sites[numSites - 1], q);
+        if (bound > bounds[numSites - 1]) {
+          break;
+        }
+        --numSites;
+        bound = -std::numeric_limits<double>::max();
+      }
+      bounds[numSites] = bound;
+      sites[numSites++] = q;
+    }
+    if (numSites == 0) {
+      std::fill(d.begin(), d.end(), INF_DIST);
+      return;
+    }
+    bounds[numSites] = std::numeric_limits<double>::max();
+
+    size_t k = 0;
+    for (size_t q = 0; q < n; ++q) {
+      while (bounds[k + 1] < static_cast<double>(q)) {
+        ++k;
+      }
+      const int64_t dq =
+          static_cast<int64_t>(q) - static_cast<int64_t>(sites[k]);
+      d[q] = dq * dq + f[sites[k]];
+    }
+  }
+};
@@ -9,15 +9,61 @@
 
 #include "Cell.h"
 #include "ConfigSpace.h"
+#include "MappedFile.h"
+#include "RowKernels.h"
+#include "RunLength.h"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 constexpr char DELIM = ' ';
 
+/**
+ * @brief Enumeration of the encodings of the binary configuration space file
+ * payload.
+ */
+enum class payload_encoding : uint32_t {
+  // one byte per cell state in row-major order, which may be memory-mapped
+  RAW_STATES = 0,
+  // the row-major cell states, run-length encoded (see RunLengthWriter)
+  RUN_LENGTH
+};
+
+/**
+ * @brief Structure containing the header of the binary configuration space
+ * file format, which is followed by the payload of cell states.
+ * NOTE: fields are stored in the native byte order, so a file written on a
+ * machine of the other byte order is rejected by its magic number.
+ */
+struct ConfigSpaceFileHeader {
+  static constexpr std::array<char, 4> MAGIC = {'B', 'B', '8', 'C'};
+  static constexpr uint32_t VERSION = 1U;
+
+  std::array<char, 4> magic;
+  uint32_t version;
+  uint64_t robotRadius;
+  uint64_t nx;
+  uint64_t ny;
+  // FNV-1a hash of the payload, as stored
+  uint64_t checksum;
+  payload_encoding encoding;
+  uint32_t reserved;
+};
+static_assert(std::is_trivially_copyable_v<ConfigSpaceFileHeader>);
+static_assert(sizeof(cell_state) == 1, "Cell states are stored as bytes");
+
 /**
  * @brief Class for I/O operations involving ConfigurationSpace objects.
  */
@@ -54,9 +100,138 @@ class ConfigSpaceIO
     outStream << configSpace;
   }
 
+  /**
+   * @brief Write the ConfigurationSpace data to a specified path, in the
+   * binary format (see ConfigSpaceFileHeader). Raw payloads may be
+   * memory-mapped by readBinary(), while run-length encoded payloads are much
+   * smaller for sparse maps, and are encoded and decoded in a streaming
+   * fashion.
+   *
+   * @param configSpace The configuration space object.
+   * @param filePath The file to be written.
+   * @param encoding The encoding of the payload.
+   * NOTE: If the file exists, it will be overwritten.
+   * NOTE: The directory structure will be created as needed.
+   */
+  static void writeBinary(
+      const ConfigurationSpace& configSpace,
+      const std::filesystem::path& filePath,
+      const payload_encoding encoding = payload_encoding::RAW_STATES)
+  {
+    std::filesystem::create_directories(filePath.parent_path());
+    std::ofstream outStream(filePath.string(),
+                            std::ios::out | std::ios::binary);
+    if (!outStream) {
+      throw std::runtime_error("Failed to open file for writing: " +
+                               filePath.string());
+    }
+
+    ConfigSpaceFileHeader header{};
+    header.magic = ConfigSpaceFileHeader::MAGIC;
+    header.version = ConfigSpaceFileHeader::VERSION;
+    header.robotRadius = configSpace.robotRadius();
+    header.nx = configSpace.numX();
+    header.ny = configSpace.numY();
+    header.encoding = encoding;
+
+    if (encoding == payload_encoding::RAW_STATES) {
+      Fnv1a hash;
+      forEachStateSpan(configSpace,
+                       [&](const std::byte* bytes, const size_t count) {
+                         hash.update(bytes, count);
+                       });
+      header.checksum = hash.value();
+      writeHeader(outStream, header);
+      forEachStateSpan(configSpace,
+                       [&](const std::byte* bytes, const size_t count) {
+                         outStream.write(reinterpret_cast<const char*>(bytes),
+                                         static_cast<std::streamsize>(count));
+                       });
+    } else {
+      // the checksum of the encoded payload is only known once written
+      writeHeader(outStream, header);
+      header.checksum = encodeStates(outStream, configSpace);
+      outStream.seekp(0);
+      writeHeader(outStream, header);
+    }
+    if (!outStream) {
+      throw std::runtime_error("Failed to write file: " + filePath.string());
+    }
+  }
+
+  /**
+   * @brief Check whether a file is in the binary format.
+   */
+  static bool isBinary(const std::filesystem::path& filePath)
+  {
+    std::ifstream inStream(filePath, std::ios::in | std::ios::binary);
+    std::array<char, 4> magic{};
+    inStream.read(magic.data(), magic.size());
+    return inStream && magic == ConfigSpaceFileHeader::MAGIC;
+  }
+
+  /**
+   * @brief Read ConfigurationSpace data from a file in the binary format. Raw
+   * payloads are memory-mapped, and the cell states are a view of the mapped
+   * pages rather than a copy, so only the layers derived from the cell states
+   * are allocated. Changes to the cell states (e.g., adding obstacles) are
+   * copy-on-write, and never reach the file. Run-length encoded payloads are
+   * decoded in blocks directly into the cell states.
+   *
+   * @param filePath The file path.
+   * @param verifyChecksum Whether to verify the payload against the header's
+   * checksum, and that each byte is a valid cell state, which reads the whole
+   * file. Otherwise a raw payload is trusted as written by writeBinary().
+   * @return ConfigurationSpace The constructed ConfigurationSpace object.
+   */
+  static ConfigurationSpace readBinary(const std::filesystem::path& filePath,
+                                       const bool verifyChecksum = true)
+  {
+    if (!std::filesystem::exists(filePath)) {
+      throw std::runtime_error("File not found for reading: " +
+                               filePath.string());
+    }
+    std::ifstream inStream(filePath, std::ios::in | std::ios::binary);
+    if (!inStream) {
+      throw std::runtime_error("Failed to open file for reading: " +
+                               filePath.string());
+    }
+    ConfigSpaceFileHeader header;
+    inStream.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!inStream) {
+      throw std::runtime_error("Truncated configuration space file: " +
+                               filePath.string());
+    }
+    if (header.magic != ConfigSpaceFileHeader::MAGIC) {
+      throw std::runtime_error("Not a binary configuration space file: " +
+                               filePath.string());
+    }
+    if (header.version != ConfigSpaceFileHeader::VERSION ||
+        (header.encoding != payload_encoding::RAW_STATES &&
+         header.encoding != payload_encoding::RUN_LENGTH)) {
+      throw std::runtime_error(
+          "Unsupported configuration space file version " +
+          std::to_string(header.version) + ": " + filePath.string());
+    }
+
+    if (header.encoding == payload_encoding::RUN_LENGTH) {
+      DataMap<cell_state> dataMap =
+          decodeStates(inStream,
+                       shapeOf(header.nx, header.ny, filePath),
+                       verifyChecksum ? std::optional(header.checksum)
+                                      : std::nullopt,
+                       filePath);
+      return ConfigurationSpace(std::move(dataMap),
+                                static_cast<size_t>(header.robotRadius));
+    }
+    inStream.close();
+    return mapStates(header, filePath, verifyChecksum);
+  }
+
   /**
    * @brief Read ConfigurationSpace data from a specified file and return a
-   * constructed ConfigurationSpace object.
+   * constructed ConfigurationSpace object. Files in the binary format are
+   * read with readBinary(), otherwise the text format is parsed.
    *
    * @param filePath The file path.
    * @return ConfigurationSpace The constructed ConfigurationSpace object.
@@ -68,6 +243,9 @@ class ConfigSpaceIO
       throw std::runtime_error("File not found for reading: " +
                                filePath.string());
     }
+    if (isBinary(filePath)) {
+      return readBinary(filePath);
+    }
 
     std::ifstream inStream(filePath, std::ios::in);
     if (!inStream) {
@@ -83,33 +261,496 @@ class ConfigSpaceIO
 
       // determine nx and ny from file while reading cell values
       getline(inStream, line);
-      const size_t nx = static_cast<size_t>(std::stoi(line));
+      const int numX = std::stoi(line);
       getline(inStream, line);
-      const size_t ny = static_cast<size_t>(std::stoi(line));
+      const int numY = std::stoi(line);
+      if (numX < 0 || numY < 0) {
+        throw std::runtime_error("Invalid configuration space dimensions");
+      }
+      const size_t nx = static_cast<size_t>(numX);
+      const size_t ny = static_cast<size_t>(numY);
 
-      std::string entry;
+      // parse the single digit cell states of each row directly, without
+      // allocating per row or per entry
       std::vector<cell_state> cellData;
+      cellData.reserve(nx * ny);
       while (getline(inStream, line)) {
-        std::vector<cell_state> row;
-        std::stringstream s(line);
-        while (getline(s, entry, DELIM)) {
-          row.emplace_back(static_cast<cell_state>(std::stoi(entry)));
+        for (const char ch : line) {
+          if (ch >= '0' && ch <= '0' + static_cast<char>(MAX_STATE)) {
+            cellData.emplace_back(static_cast<cell_state>(ch - '0'));
+          } else if (ch != DELIM && ch != '\r') {
+            throw std::runtime_error(std::string("Invalid cell state: ") + ch);
+          }
         }
-        // append the row to the end of the cellData
-        std::move(row.begin(), row.end(), std::back_inserter(cellData));
-        row.clear();
       }
 
       // ensure the data is properly sized
-      assert(nx * ny == cellData.size());
+      if (nx * ny != cellData.size()) {
+        throw std::runtime_error("Expected " + std::to_string(nx * ny) +
+                                 " cell states, found " +
+                                 std::to_string(cellData.size()));
+      }
 
       // construct and return the ConfigurationSpace
-      DataMap<cell_state> dataMap(std::make_pair(nx, ny), cellData);
-      return ConfigurationSpace(dataMap, robotRadius);
+      DataMap<cell_state> dataMap(std::make_pair(nx, ny), std::move(cellData));
+      return ConfigurationSpace(std::move(dataMap), robotRadius);
     } catch (const std::exception& e) {
       std::cerr << "Error reading configuration space data: " << e.what()
                 << std::endl;
-      throw(e);
+      throw;
+    }
+  }
+
+  private:
+  friend class ObstacleMapIO;
+
+  // the largest valid cell state
+  static constexpr uint8_t MAX_STATE = static_cast<uint8_t>(cell_state::PADDED);
+  // the payload bytes hashed and validated at a time, while in cache
+  static constexpr size_t VERIFY_BLOCK_BYTES = 64U * 1024U;
+
+  /**
+   * @brief Get the shape of the cell states of a file's header, checking the
+   * number of cells is representable.
+   */
+  static std::pair<size_t, size_t> shapeOf(
+      const uint64_t nx,
+      const uint64_t ny,
+      const std::filesystem::path& filePath)
+  {
+    if (ny != 0U && nx > std::numeric_limits<size_t>::max() / ny) {
+      throw std::runtime_error(
+          "Configuration space file dimensions overflow: " +
+          filePath.string());
+    }
+    return std::make_pair(static_cast<size_t>(nx), static_cast<size_t>(ny));
+  }
+
+  /**
+   * @brief Check each of the bytes of a payload is a valid cell state.
+   */
+  static void requireValidStates(const std::byte* states,
+                                 const size_t n,
+                                 const std::filesystem::path& filePath)
+  {
+    if (RowKernels::best().maxByte(reinterpret_cast<const uint8_t*>(states),
+                                   n) > MAX_STATE) {
+      throw std::runtime_error(
+          "Invalid cell state in configuration space file: " +
+          filePath.string());
+    }
+  }
+
+  static void writeHeader(std::ostream& outStream,
+                          const ConfigSpaceFileHeader& header)
+  {
+    outStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  }
+
+  /**
+   * @brief Construct the ConfigurationSpace from a view of the memory-mapped
+   * raw payload of a file with the given header.
+   */
+  static ConfigurationSpace mapStates(const ConfigSpaceFileHeader& header,
+                                      const std::filesystem::path& filePath,
+                                      const bool verifyChecksum)
+  {
+    auto file = std::make_shared<MappedFile>(filePath);
+    const auto shape = shapeOf(header.nx, header.ny, filePath);
+    const size_t numCells = shape.first * shape.second;
+    if (file->size() < sizeof(header) ||
+        file->size() - sizeof(header) != numCells) {
+      throw std::runtime_error("Configuration space file size does not match "
+                               "its header: " +
+                               filePath.string());
+    }
+    std::byte* payload = file->data() + sizeof(header);
+    if (verifyChecksum) {
+      // validate the states in the same pass, while each block is in cache
+      Fnv1a hash;
+      for (size_t first = 0; first < numCells; first += VERIFY_BLOCK_BYTES) {
+        const size_t count = std::min(VERIFY_BLOCK_BYTES, numCells - first);
+        hash.update(payload + first, count);
+        requireValidStates(payload + first, count, filePath);
+      }
+      if (hash.value() != header.checksum) {
+        throw std::runtime_error(
+            "Configuration space file checksum mismatch: " +
+            filePath.string());
+      }
+    }
+
+    DataMap<cell_state> dataMap(
+        shape, reinterpret_cast<cell_state*>(payload), std::move(file));
+    return ConfigurationSpace(std::move(dataMap),
+                              static_cast<size_t>(header.robotRadius));
+  }
+
+  /**
+   * @brief Run-length encode the cell states to a stream, returning the
+   * checksum of the encoded bytes.
+   */
+  static uint64_t encodeStates(std::ostream& outStream,
+                               const ConfigurationSpace& configSpace)
+  {
+    RunLengthWriter writer(outStream);
+    forEachStateSpan(configSpace,
+                     [&](const std::byte* bytes, const size_t count) {
+                       writer.write(bytes, count);
+                     });
+    writer.finish();
+    return writer.checksum();
+  }
+
+  /**
+   * @brief Call f(bytes, count) for the cell states of a configuration space
+   * in row-major order, a contiguous span at a time (i.e., per row, or per
+   * tile of a row if tiled).
+   */
+  template <typename F>
+  static void forEachStateSpan(const ConfigurationSpace& configSpace, F&& f)
+  {
+    for (size_t yIdx = 0; yIdx < configSpace.numY(); ++yIdx) {
+      configSpace.forEachStateSpan(
+          yIdx, [&](size_t, const cell_state* states, const size_t count) {
+            f(reinterpret_cast<const std::byte*>(states), count);
+          });
+    }
+  }
+
+  /**
+   * @brief Decode run-length encoded cell states which continue to the end of
+   * a stream.
+   *
+   * @param inStream The stream, positioned at the start of the encoded states.
+   * @param shape The shape of the cell states.
+   * @param checksum The expected checksum of the encoded bytes, if verifying.
+   * @param filePath The file being read, for error messages.
+   * @return DataMap<cell_state> The decoded cell states.
+   */
+  static DataMap<cell_state> decodeStates(
+      std::istream& inStream,
+      const std::pair<size_t, size_t>& shape,
+      const std::optional<uint64_t>& checksum,
+      const std::filesystem::path& filePath)
+  {
+    DataMap<cell_state> dataMap(shape, cell_state::FREE);
+    RunLengthReader reader(inStream);
+    try {
+      reader.read(reinterpret_cast<std::byte*>(dataMap.data()),
+                  dataMap.size());
+      reader.finish();
+    } catch (const std::runtime_error& e) {
+      throw std::runtime_error(std::string(e.what()) + ": " +
+                               filePath.string());
+    }
+    if (checksum && reader.checksum() != *checksum) {
+      throw std::runtime_error("Configuration space file checksum mismatch: " +
+                               filePath.string());
+    }
+    requireValidStates(reinterpret_cast<const std::byte*>(dataMap.data()),
+                       dataMap.size(),
+                       filePath);
+    return dataMap;
+  }
+};
+
+/**
+ * @brief Structure containing the header of the obstacle map file format,
+ * which is followed by the obstacle records and then, optionally, a cached
+ * raster of the cell states, run-length encoded as for ConfigSpaceFileHeader.
+ * NOTE: fields are stored in the native byte order, as above.
+ */
+struct ObstacleMapFileHeader {
+  static constexpr std::array<char, 4> MAGIC = {'B', 'B', '8', 'O'};
+  static constexpr uint32_t VERSION = 1U;
+
+  std::array<char, 4> magic;
+  uint32_t version;
+  uint64_t robotRadius;
+  uint64_t nx;
+  uint64_t ny;
+  uint64_t numObstacles;
+  // FNV-1a hashes of the obstacle records and the encoded raster
+  uint64_t obstaclesChecksum;
+  uint64_t rasterChecksum;
+  uint32_t hasRaster;
+  uint32_t reserved;
+};
+static_assert(std::is_trivially_copyable_v<ObstacleMapFileHeader>);
+
+/**
+ * @brief Structure containing a stored circular obstacle.
+ */
+struct ObstacleRecord {
+  uint32_t x;
+  uint32_t y;
+  uint32_t radius;
+};
+static_assert(sizeof(ObstacleRecord) == 12, "Obstacle records are packed");
+
+/**
+ * @brief Class for I/O operations involving obstacle maps, which store the
+ * obstacles added to a ConfigurationSpace rather than its cells, so are a
+ * small fraction of the size, and keep the obstacle geometry.
+ */
+class ObstacleMapIO
+{
+  public:
+  /**
+   * @brief Write the dimensions, robot radius and obstacles of a
+   * ConfigurationSpace to a specified path, with an optional cached raster of
+   * its cell states.
+   *
+   * @param configSpace The configuration space object, which must know its
+   * obstacle geometry (see ConfigurationSpace::hasObstacleGeometry()).
+   * @param filePath The file to be written.
+   * @param cacheRaster Whether to also store the rasterized cell states.
+   * NOTE: If the file exists, it will be overwritten.
+   * NOTE: The directory structure will be created as needed.
+   */
+  static void write(const ConfigurationSpace& configSpace,
+                    const std::filesystem::path& filePath,
+                    const bool cacheRaster = false)
+  {
+    if (!configSpace.hasObstacleGeometry()) {
+      throw std::runtime_error(
+          "Obstacle geometry is unknown for configuration spaces constructed "
+          "from cell states");
+    }
+    std::vector<ObstacleRecord> records;
+    records.reserve(configSpace.obstacles().size());
+    for (const Circle& obstacle : configSpace.obstacles()) {
+      records.push_back({toRecordValue(obstacle.center().x()),
+                         toRecordValue(obstacle.center().y()),
+                         toRecordValue(obstacle.radius())});
+    }
+
+    std::filesystem::create_directories(filePath.parent_path());
+    std::ofstream outStream(filePath.string(),
+                            std::ios::out | std::ios::binary);
+    if (!outStream) {
+      throw std::runtime_error("Failed to open file for writing: " +
+                               filePath.string());
+    }
+
+    const auto* recordBytes =
+        reinterpret_cast<const std::byte*>(records.data());
+    const size_t recordsSize = records.size() * sizeof(ObstacleRecord);
+    Fnv1a hash;
+    hash.update(recordBytes, recordsSize);
+    ObstacleMapFileHeader header{};
+    header.magic = ObstacleMapFileHeader::MAGIC;
+    header.version = ObstacleMapFileHeader::VERSION;
+    header.robotRadius = configSpace.robotRadius();
+    header.nx = configSpace.numX();
+    header.ny = configSpace.numY();
+    header.numObstacles = records.size();
+    header.obstaclesChecksum = hash.value();
+    header.hasRaster = cacheRaster ? 1U : 0U;
+
+    writeHeader(outStream, header);
+    outStream.write(reinterpret_cast<const char*>(recordBytes),
+                    static_cast<std::streamsize>(recordsSize));
+    if (cacheRaster) {
+      // the checksum of the encoded raster is only known once written
+      header.rasterChecksum =
+          ConfigSpaceIO::encodeStates(outStream, configSpace);
+      outStream.seekp(0);
+      writeHeader(outStream, header);
+    }
+    if (!outStream) {
+      throw std::runtime_error("Failed to write file: " + filePath.string());
+    }
+  }
+
+  /**
+   * @brief Check whether a file is in the obstacle map format.
+   */
+  static bool isObstacleMap(const std::filesystem::path& filePath)
+  {
+    std::ifstream inStream(filePath, std::ios::in | std::ios::binary);
+    std::array<char, 4> magic{};
+    inStream.read(magic.data(), magic.size());
+    return inStream && magic == ObstacleMapFileHeader::MAGIC;
+  }
+
+  /**
+   * @brief Read an obstacle map from a specified file and return the
+   * constructed ConfigurationSpace, which knows its obstacle geometry. The
+   * cell states are decoded from the cached raster if present and requested,
+   * otherwise the obstacles are rasterized.
+   *
+   * @param filePath The file path.
+   * @param useCachedRaster Whether to use the cached raster, if present.
+   * @return ConfigurationSpace The constructed ConfigurationSpace object.
+   */
+  static ConfigurationSpace read(const std::filesystem::path& filePath,
+                                 const bool useCachedRaster = true)
+  {
+    if (!std::filesystem::exists(filePath)) {
+      throw std::runtime_error("File not found for reading: " +
+                               filePath.string());
+    }
+    std::ifstream inStream(filePath, std::ios::in | std::ios::binary);
+    if (!inStream) {
+      throw std::runtime_error("Failed to open file for reading: " +
+                               filePath.string());
+    }
+    ObstacleMapFileHeader header;
+    inStream.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!inStream) {
+      throw std::runtime_error("Truncated obstacle map file: " +
+                               filePath.string());
+    }
+    if (header.magic != ObstacleMapFileHeader::MAGIC) {
+      throw std::runtime_error("Not an obstacle map file: " +
+                               filePath.string());
+    }
+    if (header.version != ObstacleMapFileHeader::VERSION) {
+      throw std::runtime_error("Unsupported obstacle map file version " +
+                               std::to_string(header.version) + ": " +
+                               filePath.string());
+    }
+    // check the count against the file size before allocating for it
+    const uint64_t maxObstacles =
+        (std::filesystem::file_size(filePath) - sizeof(header)) /
+        sizeof(ObstacleRecord);
+    if (header.numObstacles > maxObstacles) {
+      throw std::runtime_error("Truncated obstacle map file: " +
+                               filePath.string());
+    }
+
+    std::vector<ObstacleRecord> records(
+        static_cast<size_t>(header.numObstacles));
+    const size_t recordsSize = records.size() * sizeof(ObstacleRecord);
+    inStream.read(reinterpret_cast<char*>(records.data()),
+                  static_cast<std::streamsize>(recordsSize));
+    Fnv1a hash;
+    hash.update(reinterpret_cast<const std::byte*>(records.data()),
+                recordsSize);
+    if (hash.value() != header.obstaclesChecksum) {
+      throw std::runtime_error("Obstacle map file checksum mismatch: " +
+                               filePath.string());
+    }
+    std::vector<Circle> obstacles;
+    obstacles.reserve(records.size());
+    for (const ObstacleRecord& record : records) {
+      obstacles.emplace_back(Cell(record.x, record.y), record.radius);
+    }
+
+    const auto shape =
+        ConfigSpaceIO::shapeOf(header.nx, header.ny, filePath);
+    const auto robotRadius = static_cast<size_t>(header.robotRadius);
+    if (header.hasRaster != 0U && useCachedRaster) {
+      DataMap<cell_state> dataMap = ConfigSpaceIO::decodeStates(
+          inStream, shape, header.rasterChecksum, filePath);
+      return ConfigurationSpace(
+          std::move(dataMap), robotRadius, std::move(obstacles));
+    }
+    ConfigurationSpace configSpace(shape.first, shape.second, robotRadius);
+    configSpace.addObstacles(obstacles);
+    return configSpace;
+  }
+
+  private:
+  static void writeHeader(std::ostream& outStream,
+                          const ObstacleMapFileHeader& header)
+  {
+    outStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  }
+
+  static uint32_t toRecordValue(const size_t value)
+  {
+    if (value > std::numeric_limits<uint32_t>::max()) {
+      throw std::runtime_error("Obstacle exceeds the range of the obstacle "
+                               "map format: " +
+                               std::to_string(value));
+    }
+    return static_cast<uint32_t>(value);
+  }
+};
+
+/**
+ * @brief Class for writing a configuration space as a greyscale image, for
+ * visualization without writing (and parsing) the full text format.
+ */
+class ConfigSpaceImageIO
+{
+  public:
+  // the shades of the cell states, and of the path drawn over them
+  static constexpr uint8_t FREE_SHADE = 255U;
+  static constexpr uint8_t PADDED_SHADE = 160U;
+  static constexpr uint8_t OBJECT_SHADE = 0U;
+  static constexpr uint8_t PATH_SHADE = 96U;
+
+  /**
+   * @brief Get the number of pixels along a side of numCells cells, rounding
+   * up, without overflowing for any scale.
+   */
+  static size_t numPixels(const size_t numCells, const size_t scale)
+  {
+    return numCells / scale + (numCells % scale != 0U ? 1U : 0U);
+  }
+
+  /**
+   * @brief Write the configuration space as a binary PGM image, downsampled
+   * so each pixel covers a square block of cells and takes the darkest shade
+   * in the block, so thin obstacles and paths are never lost. Rows are
+   * written from y = 0, as in the text format.
+   *
+   * @param configSpace The configuration space object.
+   * @param filePath The file to be written.
+   * @param scale The number of cells along each side of a pixel's block.
+   * @param path If provided, a path drawn over the cell states.
+   * NOTE: If the file exists, it will be overwritten.
+   * NOTE: The directory structure will be created as needed.
+   */
+  static void writePgm(const ConfigurationSpace& configSpace,
+                       const std::filesystem::path& filePath,
+                       const size_t scale = 1U,
+                       const std::vector<Cell>& path = {})
+  {
+    if (scale == 0U) {
+      throw std::runtime_error("Image scale must be at least one");
+    }
+    const size_t width = numPixels(configSpace.numX(), scale);
+    const size_t height = numPixels(configSpace.numY(), scale);
+    std::vector<uint8_t> pixels(width * height, FREE_SHADE);
+    const auto darken = [&](const Cell& c, const uint8_t shade) {
+      uint8_t& pixel = pixels[(c.y() / scale) * width + c.x() / scale];
+      pixel = std::min(pixel, shade);
+    };
+    for (size_t yIdx = 0; yIdx < configSpace.numY(); ++yIdx) {
+      configSpace.forEachStateSpan(
+          yIdx, [&](const size_t x0, const cell_state* states, size_t count) {
+            for (size_t idx = 0; idx < count; ++idx) {
+              if (states[idx] != cell_state::FREE) {
+                darken({x0 + idx, yIdx},
+                       states[idx] == cell_state::OBJECT ? OBJECT_SHADE
+                                                         : PADDED_SHADE);
+              }
+            }
+          });
+    }
+    for (const Cell& c : path) {
+      if (configSpace.contains(c)) {
+        darken(c, PATH_SHADE);
+      }
+    }
+
+    std::filesystem::create_directories(filePath.parent_path());
+    std::ofstream outStream(filePath.string(),
+                            std::ios::out | std::ios::binary);
+    if (!outStream) {
+      throw std::runtime_error("Failed to open file for writing: " +
+                               filePath.string());
+    }
+    outStream << "P5\n" << width << DELIM << height << "\n255\n";
+    outStream.write(reinterpret_cast<const char*>(pixels.data()),
+                    static_cast<std::streamsize>(pixels.size()));
+    if (!outStream) {
+      throw std::runtime_error("Failed to write file: " + filePath.string());
     }
   }
 };
@@ -0,0 +1,266 @@
+/**
+ * @file FlowField.h
+ * @brief File containing the cost-to-goal (flow) field of a single goal, for
+ * planning the paths of many robots heading to the same destination.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#pragma once
+
+#include "Cell.h"
+#include "ConfigSpace.h"
+#include "Grid.h"
+#include "Heuristics.h"
+#include "MotionPlanning.h"
+#include "OpenList.h"
+#include "SearchStats.h"
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Class holding the next step towards a goal from every cell which can
+ * reach it, found by a single Dijkstra search backwards from the goal. The path
+ * of any robot to the goal is then extracted by following the steps, in
+ * O(path length) with no search, so a fleet sharing a destination (e.g., a
+ * charging dock) only pays for one search per goal and map version.
+ * NOTE: only the direction of the step is stored, in a byte per cell. The
+ * costs to the goal would need 32 bits per cell on large maps, so are instead
+ * summed along the steps by costToGoal(). The field is never modified once
+ * built, so may be shared between threads without locking, but describes the
+ * configuration space as it was when built (see isCurrent()).
+ *
+ * @tparam CostPolicy The move cost policy.
+ */
+template <typename CostPolicy = OctileCost>
+class BasicFlowField
+{
+  public:
+  using cost_policy = CostPolicy;
+  using cost_type = typename CostPolicy::cost_type;
+
+  // the step of the goal itself, and of the cells which can't reach it
+  static constexpr uint8_t GOAL_STEP = 8U;
+  static constexpr uint8_t NO_STEP = 0xFFU;
+
+  /**
+   * @brief Construct the flow field of a goal, sharing ownership of the
+   * configuration space.
+   *
+   * @param cSpace The configuration space to search.
+   * @param goal The goal location
+   */
+  BasicFlowField(SharedConfigSpace cSpace, const Cell& goal)
+      : m_cSpace(std::move(cSpace)),
+        m_goal(goal),
+        m_version(m_cSpace->version()),
+        m_steps(m_cSpace->shape(), NO_STEP),
+        m_numReachable(0U)
+  {
+    if (m_cSpace->isAccessible(m_goal)) {
+      build();
+    }
+  }
+
+  /**
+   * @brief Construct the flow field of a goal, as above, borrowing the
+   * configuration space.
+   * NOTE: the configuration space is not copied, and must outlive this object.
+   */
+  BasicFlowField(const ConfigurationSpace& cSpace, const Cell& goal)
+      : BasicFlowField(SharedConfigSpace(SharedConfigSpace(), &cSpace), goal)
+  {
+    // do nothing
+  }
+
+  // prevent borrowing a temporary configuration space
+  BasicFlowField(ConfigurationSpace&& cSpace, const Cell& goal) = delete;
+
+  const ConfigurationSpace& configSpace() const
+  {
+    return *m_cSpace;
+  }
+
+  Cell goal() const
+  {
+    return m_goal;
+  }
+
+  /**
+   * @brief The version of the configuration space the field was built for.
+   */
+  uint64_t version() const
+  {
+    return m_version;
+  }
+
+  /**
+   * @brief Check whether the configuration space is unchanged since the field
+   * was built. Otherwise, the field should be rebuilt, as its paths may pass
+   * through newly blocked cells.
+   */
+  bool isCurrent() const
+  {
+    return m_version == m_cSpace->version();
+  }
+
+  /**
+   * @brief The number of cells which can reach the goal, including the goal.
+   */
+  size_t numReachable() const
+  {
+    return m_numReachable;
+  }
+
+  size_t bytes() const
+  {
+    return m_steps.size() * sizeof(uint8_t);
+  }
+
+  /**
+   * @brief Check whether a cell can reach the goal.
+   */
+  bool isReachable(const Cell& c) const
+  {
+    return m_cSpace->contains(c) && m_steps.at(c) != NO_STEP;
+  }
+
+  /**
+   * @brief Get the direction (indexing NBR_OFFSETS) of the first step from a
+   * cell towards the goal, GOAL_STEP at the goal, or NO_STEP if the goal can't
+   * be reached.
+   */
+  uint8_t step(const Cell& c) const
+  {
+    return m_cSpace->contains(c) ? m_steps.at(c) : NO_STEP;
+  }
+
+  /**
+   * @brief Get the cost of the optimal path from a cell to the goal, or the
+   * maximum cost if the goal can't be reached, in O(path length).
+   */
+  cost_type costToGoal(const Cell& c) const
+  {
+    if (!isReachable(c)) {
+      return std::numeric_limits<cost_type>::max();
+    }
+    cost_type cost = 0;
+    for (Cell next = c; m_steps.at(next) != GOAL_STEP;) {
+      const uint8_t dir = m_steps.at(next);
+      cost += CostPolicy::stepCost(dir);
+      next = stepFrom(next, dir);
+    }
+    return cost;
+  }
+
+  /**
+   * @brief Extract the optimal path from a start cell to the goal, by following
+   * the steps of the field.
+   *
+   * @param start The start location
+   * @param stats If provided, the outcome and timings of the extraction are
+   * written to it. No nodes are expanded.
+   * @return std::vector<Cell> The cell locations making up the path, ordered
+   * from start to goal, if found. Otherwise, an empty vector is returned.
+   */
+  std::vector<Cell> searchPath(const Cell& start,
+                               SearchStats* stats = nullptr) const
+  {
+    SearchStats localStats;
+    SearchStats& st = stats ? *stats : localStats;
+    st = SearchStats();
+    const auto pathStart = SearchUtils::Clock::now();
+
+    st.status = SearchUtils::checkStartGoal(*m_cSpace, start, m_goal);
+    if (st.status == search_status::FOUND && !isReachable(start)) {
+      // connected, but not by the moves of the cost policy
+      st.status = search_status::NOT_FOUND;
+    }
+    if (st.status != search_status::FOUND) {
+      st.setupTime = SearchUtils::Clock::now() - pathStart;
+      return std::vector<Cell>();
+    }
+
+    std::vector<Cell> path{start};
+    while (m_steps.at(path.back()) != GOAL_STEP) {
+      path.push_back(stepFrom(path.back(), m_steps.at(path.back())));
+    }
+    st.pathTime = SearchUtils::Clock::now() - pathStart;
+    return path;
+  }
+
+  private:
+  // integer costs use a bucket queue, as the keys are popped in order
+  using open_list_type = std::conditional_t<std::is_integral_v<cost_type>,
+                                            BucketQueue<cost_type>,
+                                            IndexedHeap<cost_type>>;
+
+  SharedConfigSpace m_cSpace;
+  Cell m_goal;
+  uint64_t m_version;
+  DataMap<uint8_t> m_steps;
+  size_t m_numReachable;
+
+  static Cell stepFrom(const Cell& c, const uint8_t dir)
+  {
+    assert(dir < NBR_OFFSETS.size());
+    return Cell(c.x() + NBR_OFFSETS[dir].dx, c.y() + NBR_OFFSETS[dir].dy);
+  }
+
+  /**
+   * @brief Run Dijkstra's algorithm backwards from the goal over the accessible
+   * cells, recording the step from each cell reached back towards the cell it
+   * was reached from.
+   * NOTE: the costs are only held while building. The moves are symmetric, so
+   * the steps follow the same moves as the forward searches.
+   */
+  void build()
+  {
+    constexpr cost_type INF = std::numeric_limits<cost_type>::max();
+    assert(m_cSpace->size() <= std::numeric_limits<uint32_t>::max());
+    std::vector<cost_type> costs(m_cSpace->size(), INF);
+    open_list_type unexploredNodes;
+    unexploredNodes.reset(m_cSpace->size());
+
+    const uint32_t goalIdx = static_cast<uint32_t>(m_cSpace->idxFrom(m_goal));
+    costs[goalIdx] = 0;
+    m_steps.at(m_goal) = GOAL_STEP;
+    unexploredNodes.push(goalIdx, 0);
+    while (!unexploredNodes.empty()) {
+      const auto [cost, qIdx] = unexploredNodes.pop();
+      if (costs[qIdx] < cost) {
+        // stale entry, for open lists without decrease-key
+        continue;
+      }
+      ++m_numReachable;
+      const Cell qPos(qIdx % m_cSpace->numX(), qIdx / m_cSpace->numX());
+      const NeighborRange nbrs(qPos,
+                               m_cSpace->nbrMask(qPos) & CostPolicy::MOVES);
+      for (auto nbrIt = nbrs.begin(); nbrIt != nbrs.end(); ++nbrIt) {
+        const uint32_t nbrIdx =
+            static_cast<uint32_t>(m_cSpace->idxFrom(*nbrIt));
+        const cost_type nbrCost =
+            cost + CostPolicy::stepCost(nbrIt.direction());
+        if (nbrCost < costs[nbrIdx]) {
+          const bool isOpen = costs[nbrIdx] != INF;
+          costs[nbrIdx] = nbrCost;
+          // the neighbor steps back the opposite way
+          m_steps.at(*nbrIt) =
+              static_cast<uint8_t>((nbrIt.direction() + 4U) % 8U);
+          if (isOpen) {
+            unexploredNodes.decreaseKey(nbrIdx, nbrCost);
+          } else {
+            unexploredNodes.push(nbrIdx, nbrCost);
+          }
+        }
+      }
+    }
+  }
+};
+
+using FlowField = BasicFlowField<>;
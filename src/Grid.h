@@ -10,9 +10,16 @@
 
 #include "Cell.h"
 
+#include <algorithm>
+#include <bit>
 #include <cassert>
-#include <functional>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 /**
  * @brief Class used to provide information and convenient indexing of a 2D
@@ -38,6 +45,8 @@ class GridIndexer
     // do nothing
   }
 
+  GridIndexer& operator=(const GridIndexer& other) = default;
+
   /**
    * @brief Get the collapsed 1D index, given the 2D cartesian indices.
    *
@@ -100,49 +109,154 @@ class GridIndexer
  * @brief Class used for storing data on a 2D grid, with convenience methods for
  * natural data access, while storing data in a 1D vector for improved cache
  * performance.
+ * The data may instead be a view of external memory (e.g., a memory-mapped
+ * file), which is kept alive by a shared owner. Copying a view copies its data
+ * into a new, owned map, while moving a view keeps viewing the same memory.
  *
  * @tparam T The data type.
  */
 template <typename T>
 class DataMap : public GridIndexer
 {
+  static_assert(!std::is_same_v<T, bool>,
+                "DataMap data must be addressable, use BitMap for bits");
+
   public:
   DataMap(const std::pair<size_t, size_t>& shape)
-      : GridIndexer(shape), m_data(size())
+      : GridIndexer(shape), m_data(size()), m_ptr(m_data.data())
   {
     // do nothing
   }
 
   DataMap(const std::pair<size_t, size_t>& shape, const std::vector<T>& data)
-      : GridIndexer(shape), m_data(data)
+      : GridIndexer(shape), m_data(data), m_ptr(m_data.data())
+  {
+    // do nothing
+  }
+
+  DataMap(const std::pair<size_t, size_t>& shape, std::vector<T>&& data)
+      : GridIndexer(shape), m_data(std::move(data)), m_ptr(m_data.data())
   {
     // do nothing
   }
 
   DataMap(const std::pair<size_t, size_t>& shape, const T& initVal)
-      : GridIndexer(shape), m_data(size(), initVal)
+      : GridIndexer(shape), m_data(size(), initVal), m_ptr(m_data.data())
+  {
+    // do nothing
+  }
+
+  /**
+   * @brief Construct a DataMap viewing external memory, without copying it.
+   *
+   * @param shape The grid shape.
+   * @param data The external data, of nx * ny values in row-major order.
+   * @param owner The owner of the external memory, which is kept alive for as
+   * long as the view.
+   */
+  DataMap(const std::pair<size_t, size_t>& shape,
+          T* data,
+          std::shared_ptr<void> owner)
+      : GridIndexer(shape), m_ptr(data), m_owner(std::move(owner))
+  {
+    assert(m_ptr || size() == 0);
+  }
+
+  DataMap(const DataMap& other)
+      : GridIndexer(other),
+        m_data(other.m_ptr, other.m_ptr + other.size()),
+        m_ptr(m_data.data())
   {
     // do nothing
   }
 
+  DataMap(DataMap&& other) noexcept
+      : GridIndexer(other),
+        m_data(std::move(other.m_data)),
+        m_ptr(other.m_ptr),
+        m_owner(std::move(other.m_owner))
+  {
+    // NOTE: moving a vector keeps its buffer, so m_ptr remains valid
+    other.m_ptr = other.m_data.data();
+  }
+
+  DataMap& operator=(DataMap other) noexcept
+  {
+    GridIndexer::operator=(other);
+    std::swap(m_data, other.m_data);
+    std::swap(m_ptr, other.m_ptr);
+    std::swap(m_owner, other.m_owner);
+    return *this;
+  }
+
   T at(const size_t xIdx, const size_t yIdx) const
   {
-    return m_data[GridIndexer::idxFrom(xIdx, yIdx)];
+    return m_ptr[GridIndexer::idxFrom(xIdx, yIdx)];
   }
 
   T at(const Cell& c) const
   {
-    return m_data[GridIndexer::idxFrom(c)];
+    return m_ptr[GridIndexer::idxFrom(c)];
+  }
+
+  T& at(const size_t xIdx, const size_t yIdx)
+  {
+    return m_ptr[GridIndexer::idxFrom(xIdx, yIdx)];
   }
 
-  typename std::vector<T>::reference at(const size_t xIdx, const size_t yIdx)
+  T& at(const Cell& c)
+  {
+    return m_ptr[GridIndexer::idxFrom(c)];
+  }
+
+  /**
+   * @brief Get the underlying data, of nx * ny values in row-major order.
+   */
+  const T* data() const
   {
-    return m_data[GridIndexer::idxFrom(xIdx, yIdx)];
+    return m_ptr;
   }
 
-  typename std::vector<T>::reference at(const Cell& c)
+  T* data()
   {
-    return m_data[GridIndexer::idxFrom(c)];
+    return m_ptr;
+  }
+
+  /**
+   * @brief Check whether the data is a view of external memory.
+   */
+  bool isView() const
+  {
+    return m_owner != nullptr;
+  }
+
+  /**
+   * @brief Assign a value to all cells in the (inclusive) span [x0, x1] of a
+   * row, which are contiguous in memory.
+   */
+  void fillSpan(const size_t yIdx,
+                const size_t x0,
+                const size_t x1,
+                const T& val)
+  {
+    assert(x0 <= x1);
+    T* first = m_ptr + GridIndexer::idxFrom(x0, yIdx);
+    std::fill(first, first + (x1 - x0 + 1), val);
+  }
+
+  /**
+   * @brief Replace all cells equal to oldVal with newVal, in the (inclusive)
+   * span [x0, x1] of a row.
+   */
+  void replaceSpan(const size_t yIdx,
+                   const size_t x0,
+                   const size_t x1,
+                   const T& oldVal,
+                   const T& newVal)
+  {
+    assert(x0 <= x1);
+    T* first = m_ptr + GridIndexer::idxFrom(x0, yIdx);
+    std::replace(first, first + (x1 - x0 + 1), oldVal, newVal);
   }
 
   friend std::ostream& operator<<(std::ostream& os, const DataMap& dataMap)
@@ -152,13 +266,176 @@ class DataMap : public GridIndexer
         os << static_cast<int>(dataMap.at(xIdx, yIdx))
            << (xIdx < dataMap.numX() - 1 ? " " : "");
       }
-      os << std::endl;
+      // NOTE: avoid flushing the stream for each row
+      os << '\n';
     }
     return os;
   };
 
   private:
   std::vector<T> m_data;
+  T* m_ptr;
+  // the owner of the external memory, if a view
+  std::shared_ptr<void> m_owner;
+};
+
+/**
+ * @brief Class used for storing a single bit per cell on a 2D grid. Each row is
+ * padded to a whole number of 64-bit words, so that rows (or spans of a row)
+ * may be tested and updated with word-wide operations.
+ */
+class BitMap : public GridIndexer
+{
+  public:
+  using word_type = uint64_t;
+  static constexpr size_t WORD_BITS = std::numeric_limits<word_type>::digits;
+
+  BitMap(const std::pair<size_t, size_t>& shape, const bool initVal = false)
+      : GridIndexer(shape),
+        m_wordsPerRow((shape.first + WORD_BITS - 1) / WORD_BITS),
+        m_words(m_wordsPerRow * shape.second, 0U)
+  {
+    if (initVal) {
+      for (size_t yIdx = 0; yIdx < numY(); ++yIdx) {
+        fillSpan(yIdx, 0, numX() - 1, true);
+      }
+    }
+  }
+
+  bool test(const size_t xIdx, const size_t yIdx) const
+  {
+    assert(xIdx < numX());
+    assert(yIdx < numY());
+    return (row(yIdx)[xIdx / WORD_BITS] >> (xIdx % WORD_BITS)) & 1U;
+  }
+
+  bool test(const Cell& c) const
+  {
+    return test(c.x(), c.y());
+  }
+
+  void set(const size_t xIdx, const size_t yIdx, const bool val)
+  {
+    assert(xIdx < numX());
+    assert(yIdx < numY());
+    const word_type bit = word_type{1} << (xIdx % WORD_BITS);
+    word_type& word = row(yIdx)[xIdx / WORD_BITS];
+    word = val ? (word | bit) : (word & ~bit);
+  }
+
+  /**
+   * @brief Set or clear all bits in the (inclusive) span [x0, x1] of a row.
+   */
+  void fillSpan(const size_t yIdx,
+                const size_t x0,
+                const size_t x1,
+                const bool val)
+  {
+    assert(x0 <= x1);
+    assert(x1 < numX());
+    word_type* words = row(yIdx);
+    forEachWord(x0, x1, [&](const size_t wIdx, const word_type mask) {
+      words[wIdx] = val ? (words[wIdx] | mask) : (words[wIdx] & ~mask);
+    });
+  }
+
+  /**
+   * @brief Check whether all bits in the (inclusive) span [x0, x1] of a row
+   * are set.
+   */
+  bool allSet(const size_t yIdx, const size_t x0, const size_t x1) const
+  {
+    assert(x0 <= x1);
+    assert(x1 < numX());
+    const word_type* words = row(yIdx);
+    bool result = true;
+    forEachWord(x0, x1, [&](const size_t wIdx, const word_type mask) {
+      result = result && (words[wIdx] & mask) == mask;
+    });
+    return result;
+  }
+
+  /**
+   * @brief Count the set bits in the (inclusive) span [x0, x1] of a row.
+   */
+  size_t count(const size_t yIdx, const size_t x0, const size_t x1) const
+  {
+    assert(x0 <= x1);
+    assert(x1 < numX());
+    const word_type* words = row(yIdx);
+    size_t result = 0;
+    forEachWord(x0, x1, [&](const size_t wIdx, const word_type mask) {
+      result += static_cast<size_t>(std::popcount(words[wIdx] & mask));
+    });
+    return result;
+  }
+
+  /**
+   * @brief Call f(xIdx) for each set bit in the (inclusive) span [x0, x1] of a
+   * row, in order.
+   */
+  template <typename F>
+  void forEachSet(const size_t yIdx,
+                  const size_t x0,
+                  const size_t x1,
+                  F&& f) const
+  {
+    assert(x0 <= x1);
+    assert(x1 < numX());
+    const word_type* words = row(yIdx);
+    forEachWord(x0, x1, [&](const size_t wIdx, const word_type mask) {
+      for (word_type bits = words[wIdx] & mask; bits != 0U; bits &= bits - 1U) {
+        f(wIdx * WORD_BITS + static_cast<size_t>(std::countr_zero(bits)));
+      }
+    });
+  }
+
+  const word_type* row(const size_t yIdx) const
+  {
+    assert(yIdx < numY());
+    return m_words.data() + yIdx * m_wordsPerRow;
+  }
+
+  word_type* row(const size_t yIdx)
+  {
+    assert(yIdx < numY());
+    return m_words.data() + yIdx * m_wordsPerRow;
+  }
+
+  size_t wordsPerRow() const
+  {
+    return m_wordsPerRow;
+  }
+
+  size_t bytes() const
+  {
+    return m_words.size() * sizeof(word_type);
+  }
+
+  private:
+  size_t m_wordsPerRow;
+  std::vector<word_type> m_words;
+
+  /**
+   * @brief Call f(wordIdx, mask) for each word overlapping the (inclusive)
+   * span [x0, x1], with the mask selecting the bits within the span.
+   */
+  template <typename F>
+  static void forEachWord(const size_t x0, const size_t x1, F&& f)
+  {
+    const size_t firstWord = x0 / WORD_BITS;
+    const size_t lastWord = x1 / WORD_BITS;
+    for (size_t wIdx = firstWord; wIdx <= lastWord; ++wIdx) {
+      word_type mask = ~word_type{0};
+      if (wIdx == firstWord) {
+        mask &= ~word_type{0} << (x0 % WORD_BITS);
+      }
+      if (wIdx == lastWord) {
+        mask &= ~word_type{0} >> (WORD_BITS - 1 - x1 % WORD_BITS);
+      }
+      f(wIdx, mask);
+    }
+  }
 };
 
 /**
@@ -188,67 +465,194 @@ class Circle
     return m_radius;
   }
 
+  bool operator==(const Circle& other) const
+  {
+    return m_center == other.m_center && m_radius == other.m_radius;
+  }
+
   private:
   Cell m_center;
   size_t m_radius;
 };
 
-using Callback = std::function<void(const size_t xIdx, const size_t yIdx)>;
 /**
- * @brief Class for representing a circle on a 2D grid object.
+ * @brief Class for representing a circle on a 2D grid object. The circle covers
+ * the cells strictly within its radius of the center, and is rasterized as one
+ * contiguous span for each row, clipped to the grid.
  */
 class GridCircle
 {
   public:
+  /**
+   * @brief Visit the row spans of the cells within the provided circle.
+   *
+   * @param circle The circle.
+   * @param grid The grid object.
+   * @param visitor Called as visitor(yIdx, x0, x1) for the (inclusive) span
+   * [x0, x1] of each row, which is already clipped to the grid.
+   */
+  template <typename SpanVisitor>
+  static void visitSpans(const Circle& circle,
+                         const GridIndexer& grid,
+                         SpanVisitor&& visitor)
+  {
+    const int64_t r = rasterRadius(circle, grid);
+    const int64_t cx = static_cast<int64_t>(circle.center().x());
+    forEachRow(circle, grid, [&](const size_t yIdx, const int64_t dy) {
+      const int64_t w = halfWidth(r, dy);
+      visitClipped(grid, yIdx, cx - w, cx + w, visitor);
+    });
+  }
+
+  /**
+   * @brief Visit the row spans of a circle split into its core (the cells
+   * within innerRadius of the center) and the surrounding ring, in a single
+   * pass over the rows. Each cell is in exactly one of the visited spans.
+   *
+   * @param circle The circle, including the ring.
+   * @param innerRadius The radius of the core, no larger than the circle's.
+   * @param grid The grid object.
+   * @param ringVisitor Called as ringVisitor(yIdx, x0, x1) for each span of
+   * the ring.
+   * @param coreVisitor Called as coreVisitor(yIdx, x0, x1) for each span of
+   * the core.
+   * @param rowBegin The first row to visit (e.g., of a tile of the grid).
+   * @param rowEnd One past the last row to visit.
+   */
+  template <typename RingVisitor, typename CoreVisitor>
+  static void visitRingSpans(
+      const Circle& circle,
+      const size_t innerRadius,
+      const GridIndexer& grid,
+      RingVisitor&& ringVisitor,
+      CoreVisitor&& coreVisitor,
+      const size_t rowBegin = 0U,
+      const size_t rowEnd = std::numeric_limits<size_t>::max())
+  {
+    assert(innerRadius <= circle.radius());
+    const int64_t r = rasterRadius(circle, grid);
+    const int64_t ri = std::min(static_cast<int64_t>(std::min<size_t>(
+                                    innerRadius, MAX_RASTER_RADIUS)),
+                                r);
+    const int64_t cx = static_cast<int64_t>(circle.center().x());
+    const auto visitRow = [&](const size_t yIdx, const int64_t dy) {
+      const int64_t w = halfWidth(r, dy);
+      if (dy >= ri || dy <= -ri) {
+        visitClipped(grid, yIdx, cx - w, cx + w, ringVisitor);
+        return;
+      }
+      const int64_t wi = halfWidth(ri, dy);
+      visitClipped(grid, yIdx, cx - w, cx - wi - 1, ringVisitor);
+      visitClipped(grid, yIdx, cx - wi, cx + wi, coreVisitor);
+      visitClipped(grid, yIdx, cx + wi + 1, cx + w, ringVisitor);
+    };
+    forEachRow(circle, grid, visitRow, rowBegin, rowEnd);
+  }
+
   /**
    * @brief Visit all cells within the provided circle, performing a callback
-   * function at each cell.
+   * function at each cell. Each cell is visited exactly once.
    *
    * @param circle The circle.
    * @param grid The grid object.
-   * @param callback The callback to be performed.
+   * @param callback Called as callback(xIdx, yIdx) for each cell.
    */
+  template <typename CellVisitor>
   static void visit(const Circle& circle,
                     const GridIndexer& grid,
-                    Callback callback)
-  {
-    const size_t r = circle.radius();
-    const Cell c = circle.center();
-
-    const size_t xLimit = grid.numX() - 1;
-    const size_t yLimit = grid.numY() - 1;
-
-    auto insideLeft{[&](const size_t xIdx) { return c.x() >= xIdx; }};
-    auto insideRight{[&](const size_t xIdx) { return xIdx + c.x() <= xLimit; }};
-    auto insideBottom{[&](const size_t yIdx) { return c.y() >= yIdx; }};
-    auto insideTop{[&](const size_t yIdx) { return yIdx + c.y() <= yLimit; }};
-
-    // TODO: FUTURE WORK- consider replacing this with a simple brute force loop over
-    // bounding box, checking each point is within the circle. This will avoid
-    // all of the excessive checking for each point to be within the domain
-    for (size_t yIdx = 0; yIdx <= r; ++yIdx) {
-      const size_t xMaxSq = r * r - yIdx * yIdx;
-      size_t xIdx = 0;
-      while (xIdx * xIdx < xMaxSq) {
-        // TODO: only visit if within domain
-        // Quadrant I
-        if (insideRight(xIdx) && insideTop(yIdx)) {
-          callback(c.x() + xIdx, c.y() + yIdx);
-        }
-        // Quadrant II
-        if (insideLeft(xIdx) && insideTop(yIdx)) {
-          callback(c.x() - xIdx, c.y() + yIdx);
-        }
-        // Quadrant III
-        if (insideLeft(xIdx) && insideBottom(yIdx)) {
-          callback(c.x() - xIdx, c.y() - yIdx);
-        }
-        // Quadrant IV
-        if (insideRight(xIdx) && insideBottom(yIdx)) {
-          callback(c.x() + xIdx, c.y() - yIdx);
-        }
-        ++xIdx;
-      }
+                    CellVisitor&& callback)
+  {
+    visitSpans(circle,
+               grid,
+               [&](const size_t yIdx, const size_t x0, const size_t x1) {
+                 for (size_t xIdx = x0; xIdx <= x1; ++xIdx) {
+                   callback(xIdx, yIdx);
+                 }
+               });
+  }
+
+  private:
+  // the largest radius rasterized, so its square fits in 64 bits
+  static constexpr size_t MAX_RASTER_RADIUS =
+      std::numeric_limits<uint32_t>::max();
+
+  /**
+   * @brief Get the radius to rasterize a circle with, clamped to the distance
+   * beyond which every cell of the grid is covered, so the squared distances
+   * can't overflow. Clamping never changes the cells covered, while the center
+   * is within 2^31 cells of the grid.
+   */
+  static int64_t rasterRadius(const Circle& circle, const GridIndexer& grid)
+  {
+    // no cell is further than dx + dy from the center, where dx and dy are
+    // its largest offsets over the grid
+    const size_t dx = std::max(circle.center().x(), grid.numX());
+    const size_t dy = std::max(circle.center().y(), grid.numY());
+    const size_t cover =
+        dx >= MAX_RASTER_RADIUS || dy >= MAX_RASTER_RADIUS - dx
+            ? MAX_RASTER_RADIUS
+            : dx + dy + 1U;
+    return static_cast<int64_t>(std::min(circle.radius(), cover));
+  }
+
+  /**
+   * @brief Get the largest x-offset within a circle of radius r for the row at
+   * y-offset dy, where |dy| < r (i.e., the largest dx with dx^2 + dy^2 < r^2).
+   * NOTE: r is at most MAX_RASTER_RADIUS, so the squares are computed without
+   * overflow as unsigned 64-bit values.
+   */
+  static int64_t halfWidth(const int64_t r, const int64_t dy)
+  {
+    const uint64_t ur = static_cast<uint64_t>(r);
+    const uint64_t udy = static_cast<uint64_t>(dy < 0 ? -dy : dy);
+    const uint64_t maxSq = ur * ur - udy * udy - 1U;
+    uint64_t w = static_cast<uint64_t>(std::sqrt(static_cast<double>(maxSq)));
+    // correct any rounding of the floating point square root
+    while (w * w > maxSq) {
+      --w;
+    }
+    while ((w + 1U) * (w + 1U) <= maxSq) {
+      ++w;
     }
+    return static_cast<int64_t>(w);
   }
-};
\ No newline at end of file
+
+  /**
+   * @brief Call f(yIdx, dy) for each row of the circle within the grid (and
+   * within [rowBegin, rowEnd)), where dy is the row's offset from the center.
+   */
+  template <typename RowFunc>
+  static void forEachRow(
+      const Circle& circle,
+      const GridIndexer& grid,
+      RowFunc&& f,
+      const size_t rowBegin = 0U,
+      const size_t rowEnd = std::numeric_limits<size_t>::max())
+  {
+    const int64_t r = rasterRadius(circle, grid);
+    const int64_t cy = static_cast<int64_t>(circle.center().y());
+    const size_t lastRow = std::min(rowEnd, grid.numY()) - 1;
+    const int64_t yMin =
+        std::max<int64_t>(cy - r + 1, static_cast<int64_t>(rowBegin));
+    const int64_t yMax =
+        std::min<int64_t>(cy + r - 1, static_cast<int64_t>(lastRow));
+    for (int64_t yIdx = yMin; yIdx <= yMax; ++yIdx) {
+      f(static_cast<size_t>(yIdx), yIdx - cy);
+    }
+  }
+
+  template <typename SpanVisitor>
+  static void visitClipped(const GridIndexer& grid,
+                           const size_t yIdx,
+                           const int64_t x0,
+                           const int64_t x1,
+                           SpanVisitor& visitor)
+  {
+    const int64_t lo = std::max<int64_t>(x0, 0);
+    const int64_t hi =
+        std::min<int64_t>(x1, static_cast<int64_t>(grid.numX()) - 1);
+    if (lo <= hi) {
+      visitor(yIdx, static_cast<size_t>(lo), static_cast<size_t>(hi));
+    }
+  }
+};
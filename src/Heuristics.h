@@ -0,0 +1,137 @@
+/**
+ * @file Heuristics.h
+ * @brief File containing the move cost and heuristic policies used to
+ * configure the path-finding algorithms at compile time.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#pragma once
+
+#include "Cell.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Each policy provides:
+//  - cost_type: the (integer or floating point) type of path costs
+//  - MOVES: the mask of allowed move directions (bits index NBR_OFFSETS)
+//  - stepCost(dir): the cost of a single move in the given direction
+//  - heuristic(c, goal): the estimated cost to reach the goal from c, which
+//    must not overestimate the true cost for paths to be optimal
+//  - IS_CONSISTENT: whether the heuristic drops by no more than the cost of
+//    any move, so the keys of A* never decrease (as bucket queues require)
+
+/**
+ * @brief 8-connected moves with integer-scaled octile costs, being 10 for
+ * straight moves and 14 for diagonal moves (approximating 10 * sqrt(2)). This
+ * avoids any floating point math in the search.
+ */
+struct OctileCost {
+  using cost_type = uint32_t;
+  static constexpr uint8_t MOVES = 0xFF;
+  static constexpr bool IS_CONSISTENT = true;
+  static constexpr cost_type STRAIGHT = 10U;
+  static constexpr cost_type DIAGONAL = 14U;
+
+  static cost_type stepCost(const size_t dir)
+  {
+    // odd directions are the diagonal moves
+    return (dir & 1U) ? DIAGONAL : STRAIGHT;
+  }
+
+  static cost_type heuristic(const Cell& c, const Cell& goal)
+  {
+    const size_t dx = c.xDistance(goal);
+    const size_t dy = c.yDistance(goal);
+    const size_t dMin = std::min(dx, dy);
+    return static_cast<cost_type>(STRAIGHT * (std::max(dx, dy) - dMin) +
+                                  DIAGONAL * dMin);
+  }
+};
+
+/**
+ * @brief 8-connected moves with unit costs for both straight and diagonal
+ * moves, with the Chebyshev distance as the heuristic.
+ */
+struct ChebyshevCost {
+  using cost_type = uint32_t;
+  static constexpr uint8_t MOVES = 0xFF;
+  static constexpr bool IS_CONSISTENT = true;
+
+  static cost_type stepCost(const size_t /* dir */)
+  {
+    return 1U;
+  }
+
+  static cost_type heuristic(const Cell& c, const Cell& goal)
+  {
+    return static_cast<cost_type>(
+        std::max(c.xDistance(goal), c.yDistance(goal)));
+  }
+};
+
+/**
+ * @brief 4-connected (straight only) moves with unit costs, with the Manhattan
+ * distance as the heuristic.
+ */
+struct ManhattanCost {
+  using cost_type = uint32_t;
+  // even directions are the straight moves
+  static constexpr uint8_t MOVES = 0x55;
+  static constexpr bool IS_CONSISTENT = true;
+
+  static cost_type stepCost(const size_t /* dir */)
+  {
+    return 1U;
+  }
+
+  static cost_type heuristic(const Cell& c, const Cell& goal)
+  {
+    return static_cast<cost_type>(c.xDistance(goal) + c.yDistance(goal));
+  }
+};
+
+/**
+ * @brief 8-connected moves with exact Euclidean costs (1 for straight moves,
+ * sqrt(2) for diagonal moves), with the Euclidean distance as the heuristic.
+ */
+struct EuclideanCost {
+  using cost_type = double;
+  static constexpr uint8_t MOVES = 0xFF;
+  static constexpr bool IS_CONSISTENT = true;
+
+  static cost_type stepCost(const size_t dir)
+  {
+    return (dir & 1U) ? std::sqrt(2.0) : 1.0;
+  }
+
+  static cost_type heuristic(const Cell& c, const Cell& goal)
+  {
+    return c.distance(goal);
+  }
+};
+
+/**
+ * @brief Weighted variant of a cost policy, inflating its heuristic by a
+ * factor of Num / Den. This expands fewer nodes, at the expense of the path
+ * cost being up to Num / Den times the optimal cost.
+ * NOTE: the weighted heuristic is not consistent (unless Num == Den), so
+ * cannot be searched with a bucket queue.
+ *
+ * @tparam Policy The cost policy to weight.
+ * @tparam Num The numerator of the weight.
+ * @tparam Den The denominator of the weight.
+ */
+template <typename Policy, unsigned Num, unsigned Den = 1U>
+struct WeightedCost : public Policy {
+  static_assert(Den > 0U && Num >= Den, "Heuristic weight must be >= 1");
+  using typename Policy::cost_type;
+  static constexpr bool IS_CONSISTENT = Policy::IS_CONSISTENT && Num == Den;
+
+  static cost_type heuristic(const Cell& c, const Cell& goal)
+  {
+    return static_cast<cost_type>(Policy::heuristic(c, goal) * Num / Den);
+  }
+};
@@ -0,0 +1,960 @@
+/**
+ * @file HierarchicalPlanning.h
+ * @brief File containing the implementation of hierarchical path-finding
+ * (HPA*), for long-range queries on large maps.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#pragma once
+
+#include "Cell.h"
+#include "ConfigSpace.h"
+#include "Grid.h"
+#include "Heuristics.h"
+#include "MotionPlanning.h"
+#include "OpenList.h"
+#include "SearchStats.h"
+#include "SearchWorkspace.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Class used to perform hierarchical path-finding (HPA*). The
+ * configuration space is split into square clusters, and the cells either side
+ * of each entrance between neighboring clusters (a run of cells which can be
+ * crossed straight into the next cluster, or a diagonal move between clusters
+ * which can't be made as two straight moves) become the nodes of an abstract
+ * graph. Nodes of the same cluster are joined by the cost of the shortest path
+ * between them within the cluster, which is precomputed, so a query is a
+ * search of the (much smaller) abstract graph, and only the clusters along the
+ * resulting path are then searched to refine it into cells.
+ * NOTE: the paths found are near-optimal rather than optimal, as they must
+ * pass through the entrance nodes. The same moves are allowed as with AStar,
+ * for the robot radius the configuration space was padded for.
+ * The below implementation follows the description in:
+ *   A. Botea, M. Mueller and J. Schaeffer, "Near Optimal Hierarchical
+ *   Path-Finding", Journal of Game Development, 2004.
+ *
+ * @tparam CostPolicy The move cost and heuristic policy.
+ */
+template <typename CostPolicy = OctileCost>
+class BasicHierarchicalPlanner
+{
+  static_assert(CostPolicy::MOVES == 0xFF || CostPolicy::MOVES == 0x55,
+                "Policy must allow either all moves or all straight moves");
+
+  public:
+  using cost_policy = CostPolicy;
+  using cost_type = typename CostPolicy::cost_type;
+  using index_type = uint32_t;
+
+  // the default cluster width, matching the tiles of a TiledLayout
+  static constexpr size_t DEFAULT_CLUSTER_SIZE = TileIndexer::TILE_DIM;
+
+  /**
+   * @brief Structure holding the search state of a query, which may be kept
+   * by the caller and reused between queries (see BatchPlanner).
+   */
+  struct Workspace {
+    using search_workspace_type =
+        BasicSearchWorkspace<IndexedHeap<cost_type>, RowMajorLayout>;
+
+    // the nodes of the abstract graph
+    search_workspace_type graph;
+    // the cells of one cluster, in cluster-local coordinates
+    search_workspace_type cluster;
+    // the costs between the start / goal and the nodes of their clusters
+    std::vector<cost_type> startCosts;
+    std::vector<cost_type> goalCosts;
+
+    size_t bytes() const
+    {
+      return graph.bytes() + cluster.bytes() +
+             (startCosts.capacity() + goalCosts.capacity()) *
+                 sizeof(cost_type);
+    }
+  };
+  using workspace_type = Workspace;
+
+  /**
+   * @brief Construct a new HierarchicalPlanner object, sharing ownership of
+   * the configuration space, and build its abstract graph.
+   * NOTE: the configuration space may be changed (e.g., by adding obstacles to
+   * it), as long as the changed cells are then passed to updateCells(),
+   * otherwise queries are rejected (see searchPath()).
+   *
+   * @param cSpace The configuration space to search.
+   * @param clusterSize The width of the clusters, in cells.
+   */
+  explicit BasicHierarchicalPlanner(
+      SharedConfigSpace cSpace,
+      const size_t clusterSize = DEFAULT_CLUSTER_SIZE)
+      : m_cSpace(std::move(cSpace)),
+        m_clusterSize(clusterSize),
+        m_numClustersX((m_cSpace->numX() + clusterSize - 1) / clusterSize),
+        m_numClustersY((m_cSpace->numY() + clusterSize - 1) / clusterSize),
+        m_clusters(m_numClustersX * m_numClustersY),
+        m_graphGrid(0U, 0U),
+        m_version(m_cSpace->version())
+  {
+    typename Workspace::search_workspace_type workspace;
+    for (size_t clusterIdx = 0; clusterIdx < m_clusters.size(); ++clusterIdx) {
+      buildCluster(clusterIdx, workspace);
+    }
+    buildGraph();
+  }
+
+  /**
+   * @brief Construct a new HierarchicalPlanner object, as above, building the
+   * clusters on a thread pool.
+   */
+  BasicHierarchicalPlanner(SharedConfigSpace cSpace,
+                           ThreadPool& pool,
+                           const size_t clusterSize = DEFAULT_CLUSTER_SIZE)
+      : m_cSpace(std::move(cSpace)),
+        m_clusterSize(clusterSize),
+        m_numClustersX((m_cSpace->numX() + clusterSize - 1) / clusterSize),
+        m_numClustersY((m_cSpace->numY() + clusterSize - 1) / clusterSize),
+        m_clusters(m_numClustersX * m_numClustersY),
+        m_graphGrid(0U, 0U),
+        m_version(m_cSpace->version())
+  {
+    std::vector<size_t> clusterIdxs(m_clusters.size());
+    for (size_t clusterIdx = 0; clusterIdx < m_clusters.size(); ++clusterIdx) {
+      clusterIdxs[clusterIdx] = clusterIdx;
+    }
+    buildClusters(clusterIdxs, pool);
+    buildGraph();
+  }
+
+  /**
+   * @brief Construct a new HierarchicalPlanner object, as above, borrowing the
+   * configuration space.
+   * NOTE: the configuration space is not copied, and must outlive this object.
+   */
+  explicit BasicHierarchicalPlanner(
+      const ConfigurationSpace& cSpace,
+      const size_t clusterSize = DEFAULT_CLUSTER_SIZE)
+      : BasicHierarchicalPlanner(
+            SharedConfigSpace(SharedConfigSpace(), &cSpace), clusterSize)
+  {
+    // do nothing
+  }
+
+  /**
+   * @brief Construct a new HierarchicalPlanner object, as above, borrowing the
+   * configuration space and building the clusters on a thread pool.
+   */
+  BasicHierarchicalPlanner(const ConfigurationSpace& cSpace,
+                           ThreadPool& pool,
+                           const size_t clusterSize = DEFAULT_CLUSTER_SIZE)
+      : BasicHierarchicalPlanner(
+            SharedConfigSpace(SharedConfigSpace(), &cSpace), pool, clusterSize)
+  {
+    // do nothing
+  }
+
+  // prevent borrowing a temporary configuration space
+  explicit BasicHierarchicalPlanner(ConfigurationSpace&& cSpace,
+                                    size_t clusterSize = 0U) = delete;
+  BasicHierarchicalPlanner(ConfigurationSpace&& cSpace,
+                           ThreadPool& pool,
+                           size_t clusterSize = 0U) = delete;
+
+  const ConfigurationSpace& configSpace() const
+  {
+    return *m_cSpace;
+  }
+
+  size_t clusterSize() const
+  {
+    return m_clusterSize;
+  }
+
+  size_t numClusters() const
+  {
+    return m_clusters.size();
+  }
+
+  /**
+   * @brief The version of the configuration space the abstract graph was
+   * built or last updated for.
+   */
+  uint64_t version() const
+  {
+    return m_version;
+  }
+
+  /**
+   * @brief Check whether the configuration space is unchanged since the
+   * abstract graph was built or last updated. Otherwise, the changed cells
+   * should be passed to updateCells() before searching.
+   */
+  bool isCurrent() const
+  {
+    return m_version == m_cSpace->version();
+  }
+
+  /**
+   * @brief The number of nodes of the abstract graph.
+   */
+  size_t numNodes() const
+  {
+    return m_nodeCells.size();
+  }
+
+  /**
+   * @brief The number of (directed) edges of the abstract graph.
+   */
+  size_t numEdges() const
+  {
+    return m_edges.size();
+  }
+
+  /**
+   * @brief The number of bytes held by the abstract graph and clusters.
+   */
+  size_t bytes() const
+  {
+    size_t result = m_clusters.capacity() * sizeof(Cluster) +
+                    m_nodeOffsets.capacity() * sizeof(index_type) +
+                    m_nodeCells.capacity() * sizeof(Cell) +
+                    m_edgeOffsets.capacity() * sizeof(index_type) +
+                    m_edges.capacity() * sizeof(Edge);
+    for (const Cluster& cluster : m_clusters) {
+      result += cluster.nodes.capacity() * sizeof(Cell) +
+                cluster.costs.capacity() * sizeof(cost_type);
+    }
+    return result;
+  }
+
+  /**
+   * @brief Update the abstract graph after the accessibility of the given cells
+   * has changed (e.g., as reported by ConfigurationSpace::addObstacles()). Only
+   * the clusters containing changed cells are rebuilt, along with the
+   * neighboring clusters sharing an entrance with a changed cell.
+   * NOTE: the cells are those changed since the graph was built or last
+   * updated, and the graph is then current with the configuration space's
+   * version.
+   *
+   * @param changedCells The changed cells, in any order.
+   */
+  void updateCells(const std::vector<Cell>& changedCells)
+  {
+    typename Workspace::search_workspace_type workspace;
+    for (const size_t clusterIdx : changedClusters(changedCells)) {
+      buildCluster(clusterIdx, workspace);
+    }
+    buildGraph();
+    m_version = m_cSpace->version();
+  }
+
+  /**
+   * @brief Update the abstract graph, as above, rebuilding the changed
+   * clusters on a thread pool.
+   */
+  void updateCells(const std::vector<Cell>& changedCells, ThreadPool& pool)
+  {
+    buildClusters(changedClusters(changedCells), pool);
+    buildGraph();
+    m_version = m_cSpace->version();
+  }
+
+  /**
+   * @brief Perform hierarchical path-finding between two cells.
+   *
+   * @param start The start location
+   * @param goal The goal location
+   * @return std::vector<Cell> The cell locations making up the path, ordered
+   * from start to goal, if found. Otherwise, an empty vector is returned.
+   */
+  std::vector<Cell> searchPath(const Cell& start, const Cell& goal) const
+  {
+    workspace_type workspace;
+    return searchPath(start, goal, workspace);
+  }
+
+  /**
+   * @brief Perform hierarchical path-finding, as above, storing the search
+   * state in a caller-provided workspace.
+   * NOTE: if the configuration space changed since the abstract graph was
+   * built or last updated (see isCurrent()), the graph no longer matches it,
+   * so no path is returned, with the status MAP_CHANGED.
+   *
+   * @param start The start location
+   * @param goal The goal location
+   * @param workspace The workspace used to store the search state
+   * @param stats If provided, the outcome, counters and timings of the search
+   * are written to it. The nodes expanded include those of the abstract graph
+   * and of the cluster searches.
+   * @return std::vector<Cell> The cell locations making up the path, ordered
+   * from start to goal, if found. Otherwise, an empty vector is returned.
+   */
+  std::vector<Cell> searchPath(const Cell& start,
+                               const Cell& goal,
+                               workspace_type& workspace,
+                               SearchStats* stats = nullptr) const
+  {
+    SearchStats localStats;
+    SearchStats& st = stats ? *stats : localStats;
+    st = SearchStats();
+    const auto setupStart = SearchUtils::Clock::now();
+
+    st.status = isCurrent()
+                    ? SearchUtils::checkStartGoal(*m_cSpace, start, goal)
+                    : search_status::MAP_CHANGED;
+    if (st.status != search_status::FOUND) {
+      st.setupTime = SearchUtils::Clock::now() - setupStart;
+      return std::vector<Cell>();
+    }
+
+    // connect the start and goal to the nodes of their clusters
+    const size_t startCluster = clusterOf(start);
+    const size_t goalCluster = clusterOf(goal);
+    const cost_type directCost = nodeCosts(
+        startCluster, start, goal, workspace.cluster, workspace.startCosts, st);
+    nodeCosts(
+        goalCluster, goal, start, workspace.cluster, workspace.goalCosts, st);
+
+    const auto searchStart = SearchUtils::Clock::now();
+    st.setupTime = searchStart - setupStart;
+    if (!searchGraph(start, goal, directCost, workspace, st)) {
+      st.status = search_status::NOT_FOUND;
+      st.searchTime = SearchUtils::Clock::now() - searchStart;
+      st.workspaceBytes = workspace.bytes();
+      return std::vector<Cell>();
+    }
+
+    // refine the abstract path, searching within each cluster it crosses
+    const auto pathStart = SearchUtils::Clock::now();
+    st.searchTime = pathStart - searchStart;
+    const GraphView graphView{*this, workspace.graph, start, goal};
+    const std::vector<Cell> nodePath =
+        SearchUtils::generatePath(graphView, goal);
+    std::vector<Cell> path{start};
+    for (size_t idx = 1; idx < nodePath.size(); ++idx) {
+      const Cell& from = nodePath[idx - 1];
+      const Cell& to = nodePath[idx];
+      const size_t clusterIdx = clusterOf(from);
+      if (clusterIdx != clusterOf(to)) {
+        // an entrance, crossed with a single step
+        path.push_back(to);
+        continue;
+      }
+      if (!searchCluster(clusterIdx, from, &to, workspace.cluster, st)) {
+        // only if the graph doesn't match the cells it was updated for
+        st.status = search_status::NOT_FOUND;
+        st.pathTime = SearchUtils::Clock::now() - pathStart;
+        st.workspaceBytes = workspace.bytes();
+        return std::vector<Cell>();
+      }
+      const Bounds bounds = clusterBounds(clusterIdx);
+      const std::vector<Cell> segment = SearchUtils::generatePath(
+          workspace.cluster, bounds.toLocal(to));
+      for (size_t segIdx = 1; segIdx < segment.size(); ++segIdx) {
+        path.push_back(bounds.toGlobal(segment[segIdx]));
+      }
+    }
+    st.pathTime = SearchUtils::Clock::now() - pathStart;
+    st.workspaceBytes = workspace.bytes();
+    return path;
+  }
+
+  private:
+  static constexpr cost_type INF = std::numeric_limits<cost_type>::max();
+  // entrances of at least this many cells get a node at each end rather than
+  // one in the middle, so paths along the border needn't detour to the middle
+  static constexpr size_t LONG_ENTRANCE = 6U;
+
+  /**
+   * @brief Structure containing the entrance nodes of a cluster, ordered by
+   * row then column, and the costs between them within the cluster.
+   */
+  struct Cluster {
+    std::vector<Cell> nodes;
+    // the cost from node i to node j is at [i * nodes.size() + j], or INF if
+    // there is no path within the cluster
+    std::vector<cost_type> costs;
+    // whether every cell of the cluster is accessible
+    bool open = false;
+  };
+
+  /**
+   * @brief Structure containing an edge of the abstract graph.
+   */
+  struct Edge {
+    index_type target;
+    cost_type cost;
+  };
+
+  /**
+   * @brief Structure containing the (inclusive) cells spanned by a cluster.
+   */
+  struct Bounds {
+    size_t minX;
+    size_t minY;
+    size_t maxX;
+    size_t maxY;
+
+    bool contains(const Cell& c) const
+    {
+      return c.x() >= minX && c.x() <= maxX && c.y() >= minY && c.y() <= maxY;
+    }
+
+    Cell toLocal(const Cell& c) const
+    {
+      return Cell(c.x() - minX, c.y() - minY);
+    }
+
+    Cell toGlobal(const Cell& c) const
+    {
+      return Cell(c.x() + minX, c.y() + minY);
+    }
+  };
+
+  /**
+   * @brief Structure presenting the search state of the abstract graph as
+   * cells, for generating the abstract path. The start and goal follow the
+   * nodes in the abstract graph's indices.
+   */
+  struct GraphView {
+    const BasicHierarchicalPlanner& planner;
+    const typename Workspace::search_workspace_type& graph;
+    const Cell& start;
+    const Cell& goal;
+
+    index_type idxFrom([[maybe_unused]] const Cell& c) const
+    {
+      // only used for the goal
+      assert(c == goal);
+      return static_cast<index_type>(planner.numNodes() + 1);
+    }
+
+    index_type parent(const index_type idx) const
+    {
+      return graph.parent(idx);
+    }
+
+    Cell cellFrom(const size_t idx) const
+    {
+      return planner.nodeCell(idx, start, goal);
+    }
+  };
+
+  SharedConfigSpace m_cSpace;
+  size_t m_clusterSize;
+  size_t m_numClustersX;
+  size_t m_numClustersY;
+  std::vector<Cluster> m_clusters;
+  // the abstract graph, numbering the nodes cluster by cluster: the nodes of
+  // cluster c are [m_nodeOffsets[c], m_nodeOffsets[c + 1]), and the edges of
+  // node n are [m_edgeOffsets[n], m_edgeOffsets[n + 1])
+  std::vector<index_type> m_nodeOffsets;
+  std::vector<Cell> m_nodeCells;
+  std::vector<index_type> m_edgeOffsets;
+  std::vector<Edge> m_edges;
+  // the abstract nodes as a single row, followed by the start and goal
+  GridIndexer m_graphGrid;
+  // the version of the configuration space the graph matches
+  uint64_t m_version;
+
+  size_t clusterOf(const Cell& c) const
+  {
+    return c.y() / m_clusterSize * m_numClustersX + c.x() / m_clusterSize;
+  }
+
+  Bounds clusterBounds(const size_t clusterIdx) const
+  {
+    const size_t minX = clusterIdx % m_numClustersX * m_clusterSize;
+    const size_t minY = clusterIdx / m_numClustersX * m_clusterSize;
+    return {minX,
+            minY,
+            std::min(minX + m_clusterSize, m_cSpace->numX()) - 1,
+            std::min(minY + m_clusterSize, m_cSpace->numY()) - 1};
+  }
+
+  /**
+   * @brief Get the cell of an abstract node, or of the start / goal.
+   */
+  Cell nodeCell(const size_t idx, const Cell& start, const Cell& goal) const
+  {
+    if (idx < m_nodeCells.size()) {
+      return m_nodeCells[idx];
+    }
+    return idx == m_nodeCells.size() ? start : goal;
+  }
+
+  /**
+   * @brief Order cells by row then column.
+   */
+  static bool rowMajorLess(const Cell& a, const Cell& b)
+  {
+    return a.y() < b.y() || (a.y() == b.y() && a.x() < b.x());
+  }
+
+  /**
+   * @brief Get the cost of the shortest path between two cells of a cluster
+   * with every cell accessible, which is direct.
+   */
+  static cost_type openCost(const Cell& a, const Cell& b)
+  {
+    const size_t dx = a.xDistance(b);
+    const size_t dy = a.yDistance(b);
+    if constexpr (CostPolicy::MOVES == 0xFF) {
+      const size_t dMin = std::min(dx, dy);
+      return static_cast<cost_type>(std::max(dx, dy) - dMin) *
+                 CostPolicy::stepCost(0) +
+             static_cast<cost_type>(dMin) * CostPolicy::stepCost(1);
+    } else {
+      return static_cast<cost_type>(dx + dy) * CostPolicy::stepCost(0);
+    }
+  }
+
+  /**
+   * @brief Get the positions of the transitions along a border, between the
+   * positions [from, to]. A vertical border lies between columns line - 1 and
+   * line (so positions are rows), and a horizontal border between rows
+   * line - 1 and line (so positions are columns).
+   */
+  std::vector<size_t> borderTransitions(const bool vertical,
+                                        const size_t line,
+                                        const size_t from,
+                                        const size_t to) const
+  {
+    const auto crossable = [&](const size_t pos) {
+      return vertical ? m_cSpace->isAccessible(Cell(line - 1, pos)) &&
+                            m_cSpace->isAccessible(Cell(line, pos))
+                      : m_cSpace->isAccessible(Cell(pos, line - 1)) &&
+                            m_cSpace->isAccessible(Cell(pos, line));
+    };
+    std::vector<size_t> transitions;
+    for (size_t pos = from; pos <= to; ++pos) {
+      if (!crossable(pos)) {
+        continue;
+      }
+      const size_t begin = pos;
+      while (pos < to && crossable(pos + 1)) {
+        ++pos;
+      }
+      if (pos - begin + 1 >= LONG_ENTRANCE) {
+        transitions.push_back(begin);
+        transitions.push_back(pos);
+      } else {
+        transitions.push_back(begin + (pos - begin) / 2);
+      }
+    }
+    return transitions;
+  }
+
+  /**
+   * @brief Append the cells of a cluster's border which can move diagonally
+   * into another cluster, where neither of the cells either side of the move
+   * is accessible. Otherwise, the move can be made as two straight moves, one
+   * of which crosses an entrance of a border, so needs no node.
+   */
+  void appendDiagonalNodes(const Bounds& bounds, std::vector<Cell>& nodes) const
+  {
+    const auto visit = [&](const Cell& c) {
+      if (!m_cSpace->isAccessible(c)) {
+        return;
+      }
+      for (size_t dir = 1; dir < NBR_OFFSETS.size(); dir += 2) {
+        // NOTE: offsets below zero wrap around, and are rejected as outside of
+        // the task space
+        const NbrOffset& offset = NBR_OFFSETS[dir];
+        const Cell nbr(c.x() + offset.dx, c.y() + offset.dy);
+        if (!bounds.contains(nbr) && m_cSpace->isAccessible(nbr) &&
+            !m_cSpace->isAccessible(Cell(nbr.x(), c.y())) &&
+            !m_cSpace->isAccessible(Cell(c.x(), nbr.y()))) {
+          nodes.push_back(c);
+          return;
+        }
+      }
+    };
+    for (size_t xIdx = bounds.minX; xIdx <= bounds.maxX; ++xIdx) {
+      visit(Cell(xIdx, bounds.minY));
+      if (bounds.maxY > bounds.minY) {
+        visit(Cell(xIdx, bounds.maxY));
+      }
+    }
+    for (size_t yIdx = bounds.minY + 1; yIdx < bounds.maxY; ++yIdx) {
+      visit(Cell(bounds.minX, yIdx));
+      if (bounds.maxX > bounds.minX) {
+        visit(Cell(bounds.maxX, yIdx));
+      }
+    }
+  }
+
+  /**
+   * @brief Find the entrance nodes of a cluster on each of its borders, and
+   * the costs between them within the cluster.
+   */
+  void buildCluster(const size_t clusterIdx,
+                    typename Workspace::search_workspace_type& workspace)
+  {
+    Cluster& cluster = m_clusters[clusterIdx];
+    const Bounds bounds = clusterBounds(clusterIdx);
+    std::vector<Cell>& nodes = cluster.nodes;
+    nodes.clear();
+    if (bounds.minX > 0) {
+      for (const size_t yIdx : borderTransitions(
+               true, bounds.minX, bounds.minY, bounds.maxY)) {
+        nodes.emplace_back(bounds.minX, yIdx);
+      }
+    }
+    if (bounds.maxX + 1 < m_cSpace->numX()) {
+      for (const size_t yIdx : borderTransitions(
+               true, bounds.maxX + 1, bounds.minY, bounds.maxY)) {
+        nodes.emplace_back(bounds.maxX, yIdx);
+      }
+    }
+    if (bounds.minY > 0) {
+      for (const size_t xIdx : borderTransitions(
+               false, bounds.minY, bounds.minX, bounds.maxX)) {
+        nodes.emplace_back(xIdx, bounds.minY);
+      }
+    }
+    if (bounds.maxY + 1 < m_cSpace->numY()) {
+      for (const size_t xIdx : borderTransitions(
+               false, bounds.maxY + 1, bounds.minX, bounds.maxX)) {
+        nodes.emplace_back(xIdx, bounds.maxY);
+      }
+    }
+    if constexpr (CostPolicy::MOVES == 0xFF) {
+      appendDiagonalNodes(bounds, nodes);
+    }
+    // corner cells may be on the entrances of two borders
+    std::sort(nodes.begin(), nodes.end(), rowMajorLess);
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+
+    cluster.open = true;
+    for (size_t yIdx = bounds.minY; yIdx <= bounds.maxY && cluster.open;
+         ++yIdx) {
+      cluster.open =
+          m_cSpace->freeCells().allSet(yIdx, bounds.minX, bounds.maxX);
+    }
+
+    const size_t numNodes = nodes.size();
+    cluster.costs.assign(numNodes * numNodes, INF);
+    SearchStats st;
+    for (size_t i = 0; i < numNodes; ++i) {
+      cluster.costs[i * numNodes + i] = 0;
+      if (!cluster.open && i + 1 < numNodes) {
+        searchCluster(clusterIdx, nodes[i], nullptr, workspace, st);
+      }
+      // the costs are symmetric, so only search from the first of each pair
+      for (size_t j = i + 1; j < numNodes; ++j) {
+        const cost_type cost =
+            cluster.open ? openCost(nodes[i], nodes[j])
+                         : exploredCost(workspace, bounds.toLocal(nodes[j]));
+        cluster.costs[i * numNodes + j] = cost;
+        cluster.costs[j * numNodes + i] = cost;
+      }
+    }
+  }
+
+  /**
+   * @brief Build the given clusters on a thread pool, each worker using its
+   * own search workspace.
+   */
+  void buildClusters(const std::vector<size_t>& clusterIdxs, ThreadPool& pool)
+  {
+    std::vector<typename Workspace::search_workspace_type> workspaces(
+        pool.size());
+    const size_t numTasks = std::min(clusterIdxs.size(), 4 * pool.size());
+    std::vector<std::future<void>> results;
+    results.reserve(numTasks);
+    for (size_t task = 0; task < numTasks; ++task) {
+      results.emplace_back(pool.submit([&, task](const size_t workerIdx) {
+        for (size_t idx = task; idx < clusterIdxs.size(); idx += numTasks) {
+          buildCluster(clusterIdxs[idx], workspaces[workerIdx]);
+        }
+      }));
+    }
+    for (auto& result : results) {
+      result.get();
+    }
+  }
+
+  /**
+   * @brief Get the clusters to rebuild after the given cells have changed.
+   */
+  std::vector<size_t> changedClusters(
+      const std::vector<Cell>& changedCells) const
+  {
+    std::vector<bool> changed(m_clusters.size(), false);
+    for (const Cell& c : changedCells) {
+      if (!m_cSpace->contains(c)) {
+        continue;
+      }
+      changed[clusterOf(c)] = true;
+
+      // the entrances of a border (or corner) depend on the cells either
+      // side of it, so on the clusters of the cell's neighbors
+      for (const NbrOffset& offset : NBR_OFFSETS) {
+        const Cell nbr(c.x() + offset.dx, c.y() + offset.dy);
+        if (m_cSpace->contains(nbr)) {
+          changed[clusterOf(nbr)] = true;
+        }
+      }
+    }
+    std::vector<size_t> clusterIdxs;
+    for (size_t clusterIdx = 0; clusterIdx < changed.size(); ++clusterIdx) {
+      if (changed[clusterIdx]) {
+        clusterIdxs.push_back(clusterIdx);
+      }
+    }
+    return clusterIdxs;
+  }
+
+  /**
+   * @brief Number the nodes of every cluster, and join them by the edges within
+   * each cluster and across each entrance.
+   */
+  void buildGraph()
+  {
+    m_nodeOffsets.assign(1U, 0U);
+    m_nodeCells.clear();
+    for (const Cluster& cluster : m_clusters) {
+      m_nodeCells.insert(
+          m_nodeCells.end(), cluster.nodes.begin(), cluster.nodes.end());
+      m_nodeOffsets.push_back(static_cast<index_type>(m_nodeCells.size()));
+    }
+    // the start and goal are numbered after the nodes
+    assert(m_nodeCells.size() + 2U <= std::numeric_limits<index_type>::max());
+    m_graphGrid = GridIndexer(m_nodeCells.size() + 2U, 1U);
+
+    m_edgeOffsets.assign(1U, 0U);
+    m_edges.clear();
+    for (size_t clusterIdx = 0; clusterIdx < m_clusters.size(); ++clusterIdx) {
+      const Cluster& cluster = m_clusters[clusterIdx];
+      const size_t numNodes = cluster.nodes.size();
+      for (size_t i = 0; i < numNodes; ++i) {
+        for (size_t j = 0; j < numNodes; ++j) {
+          const cost_type cost = cluster.costs[i * numNodes + j];
+          if (j != i && cost != INF) {
+            m_edges.push_back(
+                {static_cast<index_type>(m_nodeOffsets[clusterIdx] + j), cost});
+          }
+        }
+
+        // the entrance nodes across a border (or corner) into another cluster
+        const NeighborRange nbrs(
+            cluster.nodes[i],
+            m_cSpace->nbrMask(cluster.nodes[i]) & CostPolicy::MOVES);
+        for (auto nbrIt = nbrs.begin(); nbrIt != nbrs.end(); ++nbrIt) {
+          const size_t nbrCluster = clusterOf(*nbrIt);
+          if (nbrCluster == clusterIdx) {
+            continue;
+          }
+          const std::vector<Cell>& nbrNodes = m_clusters[nbrCluster].nodes;
+          const auto node = std::lower_bound(
+              nbrNodes.begin(), nbrNodes.end(), *nbrIt, rowMajorLess);
+          if (node != nbrNodes.end() && *node == *nbrIt) {
+            m_edges.push_back(
+                {static_cast<index_type>(m_nodeOffsets[nbrCluster] +
+                                         (node - nbrNodes.begin())),
+                 CostPolicy::stepCost(nbrIt.direction())});
+          }
+        }
+        m_edgeOffsets.push_back(static_cast<index_type>(m_edges.size()));
+      }
+    }
+  }
+
+  /**
+   * @brief Get the cost to a (cluster-local) cell explored by the last cluster
+   * search, or INF if it wasn't reached.
+   */
+  static cost_type exploredCost(
+      const typename Workspace::search_workspace_type& workspace,
+      const Cell& local)
+  {
+    const index_type idx = workspace.idxFrom(local);
+    return workspace.isExplored(idx) ? workspace.gCost(idx) : INF;
+  }
+
+  /**
+   * @brief Get the costs from a cell to the nodes of its cluster, and to
+   * another cell if in the same cluster (else INF).
+   */
+  cost_type nodeCosts(const size_t clusterIdx,
+                      const Cell& source,
+                      const Cell& other,
+                      typename Workspace::search_workspace_type& workspace,
+                      std::vector<cost_type>& costs,
+                      SearchStats& st) const
+  {
+    const Cluster& cluster = m_clusters[clusterIdx];
+    const Bounds bounds = clusterBounds(clusterIdx);
+    costs.clear();
+    if (cluster.open) {
+      for (const Cell& node : cluster.nodes) {
+        costs.push_back(openCost(source, node));
+      }
+      return bounds.contains(other) ? openCost(source, other) : INF;
+    }
+    searchCluster(clusterIdx, source, nullptr, workspace, st);
+    for (const Cell& node : cluster.nodes) {
+      costs.push_back(exploredCost(workspace, bounds.toLocal(node)));
+    }
+    return bounds.contains(other)
+               ? exploredCost(workspace, bounds.toLocal(other))
+               : INF;
+  }
+
+  /**
+   * @brief Search the cells of a cluster from a source cell, storing the search
+   * state in cluster-local coordinates. With a target, this is an A* search
+   * ending once the target is explored. Otherwise, every cell of the cluster
+   * reachable within it is explored, with Dijkstra's algorithm.
+   *
+   * @return bool Whether the target (if any) was found.
+   */
+  bool searchCluster(const size_t clusterIdx,
+                     const Cell& source,
+                     const Cell* target,
+                     typename Workspace::search_workspace_type& workspace,
+                     SearchStats& st) const
+  {
+    const Bounds bounds = clusterBounds(clusterIdx);
+    const auto heuristic = [target](const Cell& c) {
+      return target ? CostPolicy::heuristic(c, *target) : cost_type(0);
+    };
+    workspace.reset(GridIndexer(m_clusterSize, m_clusterSize));
+    IndexedHeap<cost_type>& unexploredNodes = workspace.openList();
+    const index_type sourceIdx = workspace.idxFrom(bounds.toLocal(source));
+    workspace.visit(sourceIdx, sourceIdx, 0);
+    unexploredNodes.push(sourceIdx, heuristic(source));
+    ++st.heapPushes;
+
+    while (!unexploredNodes.empty()) {
+      const index_type qIdx = unexploredNodes.pop().item;
+      ++st.heapPops;
+      workspace.markExplored(qIdx);
+      ++st.nodesExpanded;
+      const Cell qPos = bounds.toGlobal(workspace.cellFrom(qIdx));
+      if (target && qPos == *target) {
+        return true;
+      }
+      const cost_type parentGCost = workspace.gCost(qIdx);
+
+      const NeighborRange nbrs(qPos,
+                               m_cSpace->nbrMask(qPos) & CostPolicy::MOVES);
+      for (auto nbrIt = nbrs.begin(); nbrIt != nbrs.end(); ++nbrIt) {
+        const Cell nbrCell = *nbrIt;
+        if (!bounds.contains(nbrCell)) {
+          continue;
+        }
+        const index_type nbrIdx = workspace.idxFrom(bounds.toLocal(nbrCell));
+        if (workspace.isExplored(nbrIdx)) {
+          continue;
+        }
+        const cost_type gCost =
+            parentGCost + CostPolicy::stepCost(nbrIt.direction());
+        const bool isOpen = workspace.isVisited(nbrIdx);
+        if (!isOpen || gCost < workspace.gCost(nbrIdx)) {
+          workspace.visit(nbrIdx, qIdx, gCost);
+          const cost_type fCost = gCost + heuristic(nbrCell);
+          if (isOpen) {
+            unexploredNodes.decreaseKey(nbrIdx, fCost);
+            ++st.heapDecreaseKeys;
+          } else {
+            unexploredNodes.push(nbrIdx, fCost);
+            ++st.heapPushes;
+          }
+        }
+      }
+    }
+    return target == nullptr;
+  }
+
+  /**
+   * @brief Search the abstract graph from the start to the goal with A*, the
+   * start and goal being joined to the nodes of their clusters by the costs
+   * in the workspace, and to each other by the direct cost (if in the same
+   * cluster).
+   *
+   * @return bool Whether the goal was found.
+   */
+  bool searchGraph(const Cell& start,
+                   const Cell& goal,
+                   const cost_type directCost,
+                   workspace_type& workspace,
+                   SearchStats& st) const
+  {
+    auto& graph = workspace.graph;
+    const index_type startIdx = static_cast<index_type>(m_nodeCells.size());
+    const index_type goalIdx = startIdx + 1;
+    const size_t startCluster = clusterOf(start);
+    const size_t goalCluster = clusterOf(goal);
+
+    graph.reset(m_graphGrid);
+    IndexedHeap<cost_type>& unexploredNodes = graph.openList();
+    graph.visit(startIdx, startIdx, 0);
+    unexploredNodes.push(startIdx, CostPolicy::heuristic(start, goal));
+    ++st.heapPushes;
+    st.peakOpenListSize = std::max(st.peakOpenListSize, size_t{1});
+
+    while (!unexploredNodes.empty()) {
+      const index_type qIdx = unexploredNodes.pop().item;
+      ++st.heapPops;
+      graph.markExplored(qIdx);
+      ++st.nodesExpanded;
+      if (qIdx == goalIdx) {
+        return true;
+      }
+      const cost_type parentGCost = graph.gCost(qIdx);
+
+      const auto relax = [&](const index_type nbrIdx, const cost_type cost) {
+        if (cost == INF || graph.isExplored(nbrIdx)) {
+          return;
+        }
+        const cost_type gCost = parentGCost + cost;
+        const bool isOpen = graph.isVisited(nbrIdx);
+        if (!isOpen || gCost < graph.gCost(nbrIdx)) {
+          graph.visit(nbrIdx, qIdx, gCost);
+          const Cell nbrCell = nodeCell(nbrIdx, start, goal);
+          const cost_type fCost = gCost + CostPolicy::heuristic(nbrCell, goal);
+          if (isOpen) {
+            unexploredNodes.decreaseKey(nbrIdx, fCost);
+            ++st.heapDecreaseKeys;
+          } else {
+            unexploredNodes.push(nbrIdx, fCost);
+            ++st.heapPushes;
+          }
+          st.peakOpenListSize =
+              std::max(st.peakOpenListSize, unexploredNodes.size());
+        }
+      };
+
+      if (qIdx == startIdx) {
+        const index_type offset = m_nodeOffsets[startCluster];
+        for (size_t j = 0; j < workspace.startCosts.size(); ++j) {
+          relax(static_cast<index_type>(offset + j), workspace.startCosts[j]);
+        }
+        relax(goalIdx, directCost);
+        continue;
+      }
+      for (index_type e = m_edgeOffsets[qIdx]; e < m_edgeOffsets[qIdx + 1];
+           ++e) {
+        relax(m_edges[e].target, m_edges[e].cost);
+      }
+      if (qIdx >= m_nodeOffsets[goalCluster] &&
+          qIdx < m_nodeOffsets[goalCluster + 1]) {
+        relax(goalIdx, workspace.goalCosts[qIdx - m_nodeOffsets[goalCluster]]);
+      }
+    }
+    return false;
+  }
+};
+
+using HierarchicalPlanner = BasicHierarchicalPlanner<>;
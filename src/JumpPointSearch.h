@@ -0,0 +1,432 @@
+/**
+ * @file JumpPointSearch.h
+ * @brief File containing the implementation of the Jump Point Search
+ * path-finding algorithm.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#pragma once
+
+#include "Cell.h"
+#include "ConfigSpace.h"
+#include "Heuristics.h"
+#include "MotionPlanning.h"
+#include "OpenList.h"
+#include "SearchStats.h"
+#include "SearchWorkspace.h"
+
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <vector>
+
+/**
+ * @brief Class used to perform the Jump Point Search (JPS) path-finding
+ * algorithm. JPS is an optimization of A* for uniform-cost grids, which prunes
+ * symmetric paths by 'jumping' along straight and diagonal lines, only adding
+ * cells with forced neighbors (jump points) to the open list.
+ * NOTE: the same moves are allowed as with AStar (i.e., any accessible
+ * neighbor, including diagonal moves past blocked corners). The path returned
+ * contains every cell from start to goal, as with AStar.
+ * The below implementation follows the description provided at:
+ *   https://harablog.wordpress.com/2011/09/07/jump-point-search/
+ *
+ * @tparam CostPolicy The move cost and heuristic policy, which must allow all
+ * eight move directions with uniform straight and diagonal costs.
+ * @tparam Layout The layout of the per-node search state (see
+ * BasicSearchWorkspace).
+ */
+template <typename CostPolicy = OctileCost, typename Layout = RowMajorLayout>
+class BasicJumpPointSearch
+{
+  static_assert(CostPolicy::MOVES == 0xFF,
+                "Jump point search requires 8-connected moves");
+
+  public:
+  using cost_policy = CostPolicy;
+  using cost_type = typename CostPolicy::cost_type;
+  using workspace_type = BasicSearchWorkspace<
+      IndexedHeap<cost_type, 4, typename Layout::template array_type<uint32_t>>,
+      Layout>;
+  using index_type = typename workspace_type::index_type;
+
+  /**
+   * @brief Construct a new JumpPointSearch object, sharing ownership of the
+   * configuration space.
+   *
+   * @param cSpace The configuration space to search.
+   */
+  explicit BasicJumpPointSearch(SharedConfigSpace cSpace)
+      : m_cSpace(std::move(cSpace))
+  {
+    assert(m_cSpace);
+  }
+
+  /**
+   * @brief Construct a new JumpPointSearch object, borrowing the configuration
+   * space.
+   * NOTE: the configuration space is not copied, and must outlive this object.
+   *
+   * @param cSpace The configuration space to search.
+   */
+  explicit BasicJumpPointSearch(const ConfigurationSpace& cSpace)
+      : m_cSpace(SharedConfigSpace(), &cSpace)
+  {
+    // do nothing
+  }
+
+  /**
+   * @brief Construct a new JumpPointSearch object for a robot of the given
+   * radius, sharing ownership of the configuration space. Accessibility is then
+   * checked against the configuration space's clearance, rather than its
+   * padded cell states.
+   * NOTE: throws if the configuration space's clearance was not computed.
+   *
+   * @param cSpace The configuration space to search.
+   * @param robotRadius The robot's radius, in cells.
+   */
+  BasicJumpPointSearch(SharedConfigSpace cSpace, const size_t robotRadius)
+      : BasicJumpPointSearch(std::move(cSpace))
+  {
+    SearchUtils::requireClearance(*m_cSpace);
+    m_robotRadius = robotRadius;
+  }
+
+  /**
+   * @brief Construct a new JumpPointSearch object for a robot of the given
+   * radius, as above, borrowing the configuration space.
+   *
+   * @param cSpace The configuration space to search.
+   * @param robotRadius The robot's radius, in cells.
+   */
+  BasicJumpPointSearch(const ConfigurationSpace& cSpace,
+                       const size_t robotRadius)
+      : BasicJumpPointSearch(cSpace)
+  {
+    SearchUtils::requireClearance(*m_cSpace);
+    m_robotRadius = robotRadius;
+  }
+
+  // prevent borrowing a temporary configuration space
+  explicit BasicJumpPointSearch(ConfigurationSpace&& cSpace) = delete;
+  BasicJumpPointSearch(ConfigurationSpace&& cSpace,
+                       size_t robotRadius) = delete;
+
+  const ConfigurationSpace& configSpace() const
+  {
+    return *m_cSpace;
+  }
+
+  size_t robotRadius() const
+  {
+    return m_robotRadius.value_or(m_cSpace->robotRadius());
+  }
+
+  /**
+   * @brief The robot radius searched using the clearance, if given, else none,
+   * as the padded cell states are searched.
+   */
+  std::optional<size_t> clearanceRadius() const
+  {
+    return m_robotRadius;
+  }
+
+  /**
+   * @brief Perform path-finding using Jump Point Search.
+   *
+   * @param start The start location
+   * @param goal The goal location
+   * @return std::vector<Cell> The cell locations making up the path, ordered
+   * from start to goal, if found. Otherwise, an empty vector is returned.
+   */
+  std::vector<Cell> searchPath(const Cell& start, const Cell& goal) const
+  {
+    workspace_type workspace;
+    return searchPath(start, goal, workspace);
+  }
+
+  /**
+   * @brief Perform path-finding using Jump Point Search, as above, storing the
+   * search state in a caller-provided workspace.
+   *
+   * @param start The start location
+   * @param goal The goal location
+   * @param workspace The workspace used to store the search state
+   * @param stats If provided, the outcome, counters and timings of the search
+   * are written to it
+   * @return std::vector<Cell> The cell locations making up the path, ordered
+   * from start to goal, if found. Otherwise, an empty vector is returned.
+   */
+  std::vector<Cell> searchPath(const Cell& start,
+                               const Cell& goal,
+                               workspace_type& workspace,
+                               SearchStats* stats = nullptr) const
+  {
+    SearchStats localStats;
+    SearchStats& st = stats ? *stats : localStats;
+    st = SearchStats();
+    const auto setupStart = SearchUtils::Clock::now();
+
+    st.status =
+        SearchUtils::checkStartGoal(*m_cSpace, start, goal, m_robotRadius);
+    if (st.status != search_status::FOUND) {
+      st.setupTime = SearchUtils::Clock::now() - setupStart;
+      return std::vector<Cell>();
+    }
+
+    workspace.reset(*m_cSpace);
+    auto& openList = workspace.openList();
+
+    const index_type startIdx = workspace.idxFrom(start);
+    workspace.visit(startIdx, startIdx, 0);
+    openList.push(startIdx, CostPolicy::heuristic(start, goal));
+    ++st.heapPushes;
+    st.peakOpenListSize = 1U;
+
+    const auto searchStart = SearchUtils::Clock::now();
+    st.setupTime = searchStart - setupStart;
+    std::array<Direction, NBR_OFFSETS.size()> directions;
+    while (!openList.empty()) {
+      const index_type qIdx = openList.pop().item;
+      ++st.heapPops;
+      workspace.markExplored(qIdx);
+      ++st.nodesExpanded;
+
+      const Cell qPos = workspace.cellFrom(qIdx);
+      if (qPos == goal) {
+        const auto pathStart = SearchUtils::Clock::now();
+        st.searchTime = pathStart - searchStart;
+        std::vector<Cell> path =
+            expandPath(SearchUtils::generatePath(workspace, goal));
+        st.pathTime = SearchUtils::Clock::now() - pathStart;
+        st.workspaceBytes = workspace.bytes();
+        return path;
+      }
+
+      const cost_type qGCost = workspace.gCost(qIdx);
+      const index_type parentIdx = workspace.parent(qIdx);
+      const size_t numDirs = prunedDirections(
+          qPos,
+          parentIdx == qIdx ? std::nullopt
+                            : std::optional(workspace.cellFrom(parentIdx)),
+          directions);
+      for (size_t dirIdx = 0; dirIdx < numDirs; ++dirIdx) {
+        const std::optional<Cell> jumpPt =
+            jump(qPos, directions[dirIdx], goal);
+        if (!jumpPt) {
+          continue;
+        }
+        const index_type jumpIdx = workspace.idxFrom(*jumpPt);
+        if (workspace.isExplored(jumpIdx)) {
+          continue;
+        }
+
+        const cost_type gCost =
+            qGCost + segmentCost(qPos, *jumpPt, directions[dirIdx]);
+        const bool isOpen = workspace.isVisited(jumpIdx);
+        if (!isOpen || gCost < workspace.gCost(jumpIdx)) {
+          workspace.visit(jumpIdx, qIdx, gCost);
+          const cost_type fCost = gCost + CostPolicy::heuristic(*jumpPt, goal);
+          if (isOpen) {
+            openList.decreaseKey(jumpIdx, fCost);
+            ++st.heapDecreaseKeys;
+          } else {
+            openList.push(jumpIdx, fCost);
+            ++st.heapPushes;
+          }
+          st.peakOpenListSize = std::max(st.peakOpenListSize, openList.size());
+        }
+      }
+    }
+    st.status = search_status::NOT_FOUND;
+    st.searchTime = SearchUtils::Clock::now() - searchStart;
+    st.workspaceBytes = workspace.bytes();
+    return std::vector<Cell>();
+  }
+
+  private:
+  struct Direction {
+    int dx;
+    int dy;
+  };
+
+  SharedConfigSpace m_cSpace;
+  // the robot radius to search for, if other than the configuration space's
+  std::optional<size_t> m_robotRadius;
+
+  /**
+   * @brief Calculate the cost of moving in a straight line, in the given
+   * direction, between two cells.
+   */
+  static cost_type segmentCost(const Cell& from,
+                               const Cell& to,
+                               const Direction& dir)
+  {
+    size_t dirIdx = 0;
+    while (NBR_OFFSETS[dirIdx].dx != dir.dx ||
+           NBR_OFFSETS[dirIdx].dy != dir.dy) {
+      ++dirIdx;
+    }
+    const size_t numSteps = std::max(from.xDistance(to), from.yDistance(to));
+    return static_cast<cost_type>(numSteps * CostPolicy::stepCost(dirIdx));
+  }
+
+  static int sign(const size_t from, const size_t to)
+  {
+    return to > from ? 1 : (to < from ? -1 : 0);
+  }
+
+  /**
+   * @brief Check whether the cell offset from c by (dx, dy) is accessible.
+   */
+  bool walkable(const Cell& c, const int dx, const int dy) const
+  {
+    // NOTE: offsets below zero wrap around, and are rejected as outside of the
+    // task space
+    return SearchUtils::isAccessible(
+        *m_cSpace, Cell(c.x() + dx, c.y() + dy), m_robotRadius);
+  }
+
+  /**
+   * @brief Get the directions to search from a node, pruning the neighbors
+   * which are reached optimally through the node's parent.
+   *
+   * @param c The cell of the node being expanded
+   * @param parent The cell of the node's parent, unless the start node
+   * @param directions The directions to search (output)
+   * @return size_t The number of directions
+   */
+  size_t prunedDirections(
+      const Cell& c,
+      const std::optional<Cell>& parent,
+      std::array<Direction, NBR_OFFSETS.size()>& directions) const
+  {
+    size_t count = 0;
+
+    // the start node has no parent, so search all accessible neighbors
+    if (!parent) {
+      const NeighborRange nbrs(
+          c, SearchUtils::nbrMask(*m_cSpace, c, m_robotRadius));
+      for (const Cell nbr : nbrs) {
+        directions[count++] = {sign(c.x(), nbr.x()), sign(c.y(), nbr.y())};
+      }
+      return count;
+    }
+
+    const int dx = sign(parent->x(), c.x());
+    const int dy = sign(parent->y(), c.y());
+    auto add = [&](const int ddx, const int ddy) {
+      if (walkable(c, ddx, ddy)) {
+        directions[count++] = {ddx, ddy};
+      }
+    };
+
+    if (dx != 0 && dy != 0) {
+      // natural neighbors
+      add(dx, 0);
+      add(0, dy);
+      add(dx, dy);
+      // forced neighbors
+      if (!walkable(c, -dx, 0)) {
+        add(-dx, dy);
+      }
+      if (!walkable(c, 0, -dy)) {
+        add(dx, -dy);
+      }
+    } else if (dx != 0) {
+      add(dx, 0);
+      if (!walkable(c, 0, 1)) {
+        add(dx, 1);
+      }
+      if (!walkable(c, 0, -1)) {
+        add(dx, -1);
+      }
+    } else {
+      add(0, dy);
+      if (!walkable(c, 1, 0)) {
+        add(1, dy);
+      }
+      if (!walkable(c, -1, 0)) {
+        add(-1, dy);
+      }
+    }
+    return count;
+  }
+
+  /**
+   * @brief Step from a cell in the given direction until reaching a jump point
+   * (the goal, or a cell with a forced neighbor), or a blocked cell.
+   *
+   * @param from The cell to jump from
+   * @param dir The direction of travel
+   * @param goal The goal location
+   * @return std::optional<Cell> The jump point, if found.
+   */
+  std::optional<Cell> jump(const Cell& from,
+                           const Direction& dir,
+                           const Cell& goal) const
+  {
+    const int dx = dir.dx;
+    const int dy = dir.dy;
+    Cell c = from;
+    while (true) {
+      if (!walkable(c, dx, dy)) {
+        return std::nullopt;
+      }
+      c = Cell(c.x() + dx, c.y() + dy);
+      if (c == goal) {
+        return c;
+      }
+
+      if (dx != 0 && dy != 0) {
+        if ((walkable(c, -dx, dy) && !walkable(c, -dx, 0)) ||
+            (walkable(c, dx, -dy) && !walkable(c, 0, -dy))) {
+          return c;
+        }
+        // a diagonal step is a jump point if either straight jump from it is
+        if (jump(c, {dx, 0}, goal) || jump(c, {0, dy}, goal)) {
+          return c;
+        }
+      } else if (dx != 0) {
+        if ((walkable(c, dx, 1) && !walkable(c, 0, 1)) ||
+            (walkable(c, dx, -1) && !walkable(c, 0, -1))) {
+          return c;
+        }
+      } else {
+        if ((walkable(c, 1, dy) && !walkable(c, 1, 0)) ||
+            (walkable(c, -1, dy) && !walkable(c, -1, 0))) {
+          return c;
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Expand a path of jump points into the full path of cells, filling
+   * in the straight or diagonal segment between each pair of jump points.
+   */
+  static std::vector<Cell> expandPath(const std::vector<Cell>& jumpPoints)
+  {
+    std::vector<Cell> path;
+    if (jumpPoints.empty()) {
+      return path;
+    }
+    path.emplace_back(jumpPoints.front());
+    for (size_t idx = 1; idx < jumpPoints.size(); ++idx) {
+      const Cell& target = jumpPoints[idx];
+      const int dx = sign(path.back().x(), target.x());
+      const int dy = sign(path.back().y(), target.y());
+      while (path.back() != target) {
+        const Cell& prev = path.back();
+        path.emplace_back(prev.x() + dx, prev.y() + dy);
+      }
+    }
+    return path;
+  }
+};
+
+using JumpPointSearch = BasicJumpPointSearch<>;
+
+// JPS storing its node state in lazily allocated tiles, for very large maps
+using TiledJumpPointSearch = BasicJumpPointSearch<OctileCost, TiledLayout>;
@@ -9,13 +9,19 @@
 #include "ConfigSpace.h"
 #include "FileIO.h"
 #include "MotionPlanning.h"
+#include "PlanningService.h"
+#include "Scenarios.h"
+#include "SearchStats.h"
 
 #include <exception>
 #include <filesystem>
 #include <iostream>
+#include <string>
+#include <utility>
 #include <vector>
 
 constexpr int EXPECTED_ARGS = 5;
+const std::string SERVE_OPTION = "--serve";
 
 int main(int argc, char** argv)
 {
@@ -28,10 +34,13 @@ int main(int argc, char** argv)
   // 2- N (num cols => nx)
   // 3- robot radius (in cells)
   // 4- Pre-configured case
+  // 5- (optional) --serve, to keep the map resident and answer commands from
+  //    stdin (see PlanningService.h) rather than writing the output files
   // Usage:
-  // ./<this-executable> <M> <N> <robot-radius> <pre-configured-case>
+  // ./<this-executable> <M> <N> <robot-radius> <pre-configured-case> [--serve]
   // ./save-bb8 100 250 6 3
-  if (argc != EXPECTED_ARGS) {
+  const bool isServing = argc == EXPECTED_ARGS + 1 && argv[5] == SERVE_OPTION;
+  if (argc != EXPECTED_ARGS && !isServing) {
     throw std::runtime_error(
         "Invalid number of args provided: " + std::to_string(argc) +
         ", expected " + std::to_string(EXPECTED_ARGS));
@@ -40,121 +49,48 @@ int main(int argc, char** argv)
   const size_t nx = static_cast<size_t>(std::stoi(argv[2]));
   const size_t robotRadius = static_cast<size_t>(std::stoi(argv[3]));
 
-  // Pre-configured obstacle cases:
-  // 1- no obstacles
-  // 2- impossible path- single circle in center of domain = max(M, N)
-  // 3- simple path, following diagonal- circles at opposite corners from start
-  // and goal 4- more complex path 5- Maze- staggered barriers
-  enum class obstacle_config { NONE = 1, IMPOSSIBLE, SIMPLE, COMPLEX, MAZE };
-  const obstacle_config obstacleCase =
-      static_cast<obstacle_config>(std::stoi(argv[4]));
+  // Pre-configured obstacle case (see Scenarios.h)
+  const obstacle_config obstacleCase = Scenarios::fromInt(std::stoi(argv[4]));
 
   ConfigurationSpace cSpace(nx, ny, robotRadius);
 
   // TODO: FUTURE WORK- make interactive assignment of obstacles
-  std::vector<Circle> obstacles;
-  switch (obstacleCase) {
-    case obstacle_config::NONE: {
-      // nothing to do here
-      break;
-    }
-    case obstacle_config::IMPOSSIBLE: {
-      // single circle in center of domain with radius spanning the narrow
-      // dimension
-      const size_t minRadius = std::min(nx, ny) / 2;
-      const Cell midPt = Cell(nx / 2, ny / 2);
-      obstacles.emplace_back(Circle(midPt, minRadius));
-      break;
-    }
-    case obstacle_config::SIMPLE: {
-      // two circles at opposite corners
-      const size_t radius = static_cast<int>(std::min(nx, ny) / 2) -
-                            static_cast<int>(robotRadius);
-      obstacles.emplace_back(Circle({0, ny - 1}, radius));
-      obstacles.emplace_back(Circle({nx - 1, 0}, radius));
-      break;
-    }
-    case obstacle_config::COMPLEX: {
-      // two circles at opposite corners
-      const size_t radius = static_cast<int>(std::min(nx, ny) / 8) -
-                            static_cast<int>(robotRadius);
-      obstacles.emplace_back(Circle({0, ny / 4}, radius));
-      obstacles.emplace_back(Circle({0, ny / 2}, radius));
-      obstacles.emplace_back(Circle({0, 3 * ny / 4}, radius));
-
-      obstacles.emplace_back(Circle({nx / 4, 0}, radius));
-      obstacles.emplace_back(Circle({nx / 4, ny / 3}, radius));
-      obstacles.emplace_back(Circle({nx / 4, 2 * ny / 3}, radius));
-      obstacles.emplace_back(Circle({nx / 4, ny - 1}, radius));
-
-      obstacles.emplace_back(Circle({nx / 2, ny / 4}, radius));
-      obstacles.emplace_back(Circle({nx / 2, ny / 2}, radius));
-      obstacles.emplace_back(Circle({nx / 2, 3 * ny / 4}, radius));
-
-      obstacles.emplace_back(Circle({3 * nx / 4, 0}, radius));
-      obstacles.emplace_back(Circle({3 * nx / 4, ny / 3}, radius));
-      obstacles.emplace_back(Circle({3 * nx / 4, 2 * ny / 3}, radius));
-      obstacles.emplace_back(Circle({3 * nx / 4, ny - 1}, radius));
-
-      obstacles.emplace_back(Circle({nx - 1, ny / 4}, radius));
-      obstacles.emplace_back(Circle({nx - 1, ny / 2}, radius));
-      obstacles.emplace_back(Circle({nx - 1, 3 * ny / 4}, radius));
-
-      break;
-    }
-    case obstacle_config::MAZE: {
-      const size_t radius = static_cast<int>(std::min(nx, ny) / 10) -
-                            static_cast<int>(robotRadius);
-      obstacles.emplace_back(Circle({nx / 5, 0}, radius));
-      obstacles.emplace_back(Circle({nx / 5, ny / 6}, radius));
-      obstacles.emplace_back(Circle({nx / 5, ny / 3}, radius));
-      obstacles.emplace_back(Circle({nx / 5, ny / 2}, radius));
-      obstacles.emplace_back(Circle({nx / 5, 2 * ny / 3}, radius));
-      obstacles.emplace_back(Circle({nx / 5, 5 * ny / 6}, radius));
-
-      obstacles.emplace_back(Circle({2 * nx / 5, ny / 6}, radius));
-      obstacles.emplace_back(Circle({2 * nx / 5, ny / 3}, radius));
-      obstacles.emplace_back(Circle({2 * nx / 5, ny / 2}, radius));
-      obstacles.emplace_back(Circle({2 * nx / 5, 2 * ny / 3}, radius));
-      obstacles.emplace_back(Circle({2 * nx / 5, 5 * ny / 6}, radius));
-      obstacles.emplace_back(Circle({2 * nx / 5, ny - 1}, radius));
-
-      obstacles.emplace_back(Circle({3 * nx / 5, 0}, radius));
-      obstacles.emplace_back(Circle({3 * nx / 5, ny / 6}, radius));
-      obstacles.emplace_back(Circle({3 * nx / 5, ny / 3}, radius));
-      obstacles.emplace_back(Circle({3 * nx / 5, ny / 2}, radius));
-      obstacles.emplace_back(Circle({3 * nx / 5, 2 * ny / 3}, radius));
-      obstacles.emplace_back(Circle({3 * nx / 5, 5 * ny / 6}, radius));
-
-      obstacles.emplace_back(Circle({4 * nx / 5, ny / 6}, radius));
-      obstacles.emplace_back(Circle({4 * nx / 5, ny / 3}, radius));
-      obstacles.emplace_back(Circle({4 * nx / 5, ny / 2}, radius));
-      obstacles.emplace_back(Circle({4 * nx / 5, 2 * ny / 3}, radius));
-      obstacles.emplace_back(Circle({4 * nx / 5, 5 * ny / 6}, radius));
-      obstacles.emplace_back(Circle({4 * nx / 5, ny - 1}, radius));
-      break;
-    }
-    default:
-      throw std::runtime_error("Invalid obstacleCase argument: " +
-                               std::to_string(static_cast<int>(obstacleCase)));
-  }
+  const std::vector<Circle> obstacles =
+      Scenarios::obstacles(obstacleCase, nx, ny, robotRadius);
 
   // Add the obstacles to the configuration space
   cSpace.addObstacles(obstacles);
 
-  // Write the configuration space to a file
+  // Keep the map resident, answering commands until quit, instead of writing it
+  // out and planning the single pre-configured query
+  if (isServing) {
+    PlanningService service(std::move(cSpace));
+    service.serve(std::cin, std::cout);
+    return 0;
+  }
+
+  // Write the configuration space to a file, both as text (for visualization)
+  // and in the binary format
   const std::filesystem::path cSpaceFile("./output/config-space.txt");
   ConfigSpaceIO::write(cSpace, cSpaceFile);
+  const std::filesystem::path cSpaceBinFile("./output/config-space.bin");
+  ConfigSpaceIO::writeBinary(cSpace, cSpaceBinFile);
 
-  // Read the configuration space back in and assign to a new object
-  ConfigurationSpace cSpace2 = ConfigSpaceIO::read(cSpaceFile);
+  // Read the configuration space back in (memory-mapping the binary file) and
+  // assign to a new object
+  ConfigurationSpace cSpace2 = ConfigSpaceIO::readBinary(cSpaceBinFile);
 
   // Search for a solution, with the starting position at the bottom corner, and
   // goal at opposite corner
   AStar search(cSpace2);
-  const std::vector<Cell> path = search.searchPath(
-      {robotRadius + 1, robotRadius + 1},
-      {cSpace.numX() - robotRadius - 1, cSpace.numY() - robotRadius - 1});
+  AStar::workspace_type workspace;
+  SearchStats stats;
+  const std::vector<Cell> path =
+      search.searchPath(Scenarios::start(nx, ny, robotRadius),
+                        Scenarios::goal(nx, ny, robotRadius),
+                        workspace,
+                        &stats);
+  std::cout << stats << std::endl;
 
   // Write the solved path to a file
   const std::filesystem::path pathFile("./output/solution-path.txt");
@@ -0,0 +1,121 @@
+/**
+ * @file MappedFile.h
+ * @brief File containing a read-only, copy-on-write memory mapping of a file.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SAVE_BB8_HAS_MMAP 1
+#else
+#include <fstream>
+#include <vector>
+#endif
+
+/**
+ * @brief Class providing the contents of a file as memory. Where supported,
+ * the file is memory-mapped privately, so pages are only read from disk once
+ * accessed, and writes to the memory are copy-on-write (never reaching the
+ * file). Otherwise the file is read into memory.
+ */
+class MappedFile
+{
+  public:
+  /**
+   * @brief Map the given file into memory.
+   *
+   * @param filePath The file to map.
+   */
+  explicit MappedFile(const std::filesystem::path& filePath)
+      : m_data(nullptr), m_size(0U)
+  {
+    if (!std::filesystem::exists(filePath)) {
+      throw std::runtime_error("File not found for reading: " +
+                               filePath.string());
+    }
+#ifdef SAVE_BB8_HAS_MMAP
+    const int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("Failed to open file for reading: " +
+                               filePath.string());
+    }
+    struct stat fileStat;
+    if (::fstat(fd, &fileStat) != 0) {
+      ::close(fd);
+      throw std::runtime_error("Failed to stat file: " + filePath.string());
+    }
+    m_size = static_cast<size_t>(fileStat.st_size);
+    if (m_size > 0U) {
+      void* mapped = ::mmap(nullptr,
+                            m_size,
+                            PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE,
+                            fd,
+                            0);
+      if (mapped == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("Failed to map file: " + filePath.string());
+      }
+      m_data = static_cast<std::byte*>(mapped);
+    }
+    // the mapping remains valid once the file is closed
+    ::close(fd);
+#else
+    std::ifstream inStream(filePath, std::ios::in | std::ios::binary);
+    if (!inStream) {
+      throw std::runtime_error("Failed to open file for reading: " +
+                               filePath.string());
+    }
+    m_buffer.resize(static_cast<size_t>(std::filesystem::file_size(filePath)));
+    inStream.read(reinterpret_cast<char*>(m_buffer.data()),
+                  static_cast<std::streamsize>(m_buffer.size()));
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+#endif
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ~MappedFile()
+  {
+#ifdef SAVE_BB8_HAS_MMAP
+    if (m_data) {
+      ::munmap(m_data, m_size);
+    }
+#endif
+  }
+
+  std::byte* data()
+  {
+    return m_data;
+  }
+
+  const std::byte* data() const
+  {
+    return m_data;
+  }
+
+  size_t size() const
+  {
+    return m_size;
+  }
+
+  private:
+  std::byte* m_data;
+  size_t m_size;
+#ifndef SAVE_BB8_HAS_MMAP
+  std::vector<std::byte> m_buffer;
+#endif
+};
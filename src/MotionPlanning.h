@@ -9,69 +9,258 @@
 
 #include "Cell.h"
 #include "ConfigSpace.h"
+#include "Heuristics.h"
+#include "OpenList.h"
+#include "SearchStats.h"
+#include "SearchWorkspace.h"
 
-#include <iostream>
-#include <limits>
-#include <queue>
-
-constexpr double UNSET_VAL = std::numeric_limits<double>::max();
-constexpr size_t _UNSET_IDX = std::numeric_limits<size_t>::max();
-const Cell UNSET_CELL(_UNSET_IDX, _UNSET_IDX);
-
-// stores {fCost, Cell}
-using CostCell = std::pair<double, Cell>;
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <stop_token>
+#include <vector>
 
 /**
- * @brief Structure containing Node data for use with path finding algorithms.
+ * @brief Class providing operations shared by the path-finding algorithms.
  */
-struct Node {
+class SearchUtils
+{
   public:
-  Node()
-      : pos(UNSET_CELL),
-        parentPos(UNSET_CELL),
-        gCost(UNSET_VAL),
-        fCost(UNSET_VAL)
+  using Clock = std::chrono::steady_clock;
+
+  // the number of expansions between checks for cancellation
+  static constexpr size_t CANCEL_CHECK_INTERVAL = 256U;
+
+  /**
+   * @brief Check the start and goal positions to ensure they are valid. Invalid
+   * cases include:
+   *  - Start is outside of the domain
+   *  - Goal is outside of the domain
+   *  - Start is not accessible
+   *  - Goal is not accessible
+   *  - Start is already at the goal
+   *  - Goal is not connected to the start (see isConnected())
+   * NOTE: we chose not to throw an exception for these cases, to allow the
+   * program to continue with new user-provided inputs.
+   *
+   * @param cSpace The configuration space
+   * @param start The start position
+   * @param goal The goal position
+   * @param robotRadius The robot radius to check accessibility against, if
+   * other than the configuration space's own (see isAccessible())
+   * @return search_status The reason the query is invalid, or FOUND if valid
+   */
+  static search_status checkStartGoal(
+      const ConfigurationSpace& cSpace,
+      const Cell& start,
+      const Cell& goal,
+      const std::optional<size_t>& robotRadius = std::nullopt)
   {
-    // do nothing
+    if (!cSpace.contains(start)) {
+      return search_status::START_OUTSIDE;
+    }
+    if (!cSpace.contains(goal)) {
+      return search_status::GOAL_OUTSIDE;
+    }
+    if (!isAccessible(cSpace, start, robotRadius)) {
+      return search_status::START_BLOCKED;
+    }
+    if (!isAccessible(cSpace, goal, robotRadius)) {
+      return search_status::GOAL_BLOCKED;
+    }
+    if (start == goal) {
+      return search_status::START_AT_GOAL;
+    }
+    // reject goals walled off from the start without searching, although
+    // the components are only known for the space's own robot radius
+    if (!robotRadius && !cSpace.isConnected(start, goal)) {
+      return search_status::UNREACHABLE;
+    }
+    return search_status::FOUND;
   }
 
-  Node(const Cell& p, const Cell& parentPos) : pos(p), parentPos(parentPos)
+  /**
+   * @brief Check whether a cell is accessible, either to the robot radius the
+   * configuration space was padded for, or to the given robot radius (using the
+   * configuration space's clearance).
+   */
+  static bool isAccessible(const ConfigurationSpace& cSpace,
+                           const Cell& c,
+                           const std::optional<size_t>& robotRadius)
   {
-    // do nothing
+    return robotRadius ? cSpace.isAccessible(c, *robotRadius)
+                       : cSpace.isAccessible(c);
   }
 
-  void updateCosts(const Cell& goal, const double parentGCost)
+  /**
+   * @brief Get the free-neighbor mask of a cell, as for isAccessible() above.
+   */
+  static uint8_t nbrMask(const ConfigurationSpace& cSpace,
+                         const Cell& c,
+                         const std::optional<size_t>& robotRadius)
+  {
+    return robotRadius ? cSpace.nbrMask(c, *robotRadius) : cSpace.nbrMask(c);
+  }
+
+  /**
+   * @brief Check a configuration space can be searched at the given robot
+   * radius, which requires its clearance.
+   */
+  static void requireClearance(const ConfigurationSpace& cSpace)
+  {
+    if (!cSpace.hasClearance()) {
+      throw std::runtime_error(
+          "Searching at a robot radius other than the configuration space's "
+          "requires its clearance to be computed");
+    }
+  }
+
+  /**
+   * @brief Check whether a search has been asked to stop, which is only
+   * checked every CANCEL_CHECK_INTERVAL expansions to keep it off the search
+   * loop's critical path.
+   *
+   * @param cancel The token of the search, which may have no stop state.
+   * @param nodesExpanded The number of nodes expanded so far.
+   */
+  static bool isCancelled(const std::stop_token& cancel,
+                          const size_t nodesExpanded)
   {
-    // TODO: FUTURE WORK- make configurable function to determine which
-    // heuristic to use
-    const double hCost = pos.distance(goal);
-    gCost = parentGCost + 1.0;
-    fCost = gCost + hCost;
+    return nodesExpanded % CANCEL_CHECK_INTERVAL == 0U &&
+           cancel.stop_requested();
   }
 
-  Cell pos;
-  Cell parentPos;
+  /**
+   * @brief Generate the path followed from start to goal
+   *
+   * @param workspace The workspace containing node data at each grid point
+   * @param goal The goal location
+   * @return std::vector<Cell> All points followed from start to goal
+   */
+  template <typename Workspace>
+  static std::vector<Cell> generatePath(const Workspace& workspace,
+                                        const Cell& goal)
+  {
+    std::vector<Cell> path;
 
-  // gCost, fCost
-  double gCost;
-  double fCost;
+    // Generate the path, working backwards from the goal node, and
+    // terminating once we reach the start location (its own parent)
+    auto next = workspace.idxFrom(goal);
+    path.emplace_back(goal);
+    while (workspace.parent(next) != next) {
+      next = workspace.parent(next);
+      path.emplace_back(workspace.cellFrom(next));
+    }
 
-  private:
+    // Reverse the order to go from start to goal
+    std::reverse(path.begin(), path.end());
+    return path;
+  }
 };
 
 /**
  * @brief Class used to perform the A* path-finding algorithm.
+ * NOTE: the move costs and heuristic are selected at compile time through a
+ * cost policy (see Heuristics.h), so they are inlined in the search loop.
+ *
+ * @tparam CostPolicy The move cost and heuristic policy.
+ * @tparam OpenList The open list type, keyed on the policy's cost type.
+ * @tparam Layout The layout of the per-node search state (see
+ * BasicSearchWorkspace).
  */
-class AStar
+template <typename CostPolicy = OctileCost,
+          typename OpenList = IndexedHeap<typename CostPolicy::cost_type>,
+          typename Layout = RowMajorLayout>
+class BasicAStar
 {
+  static_assert(IS_COMPATIBLE_OPEN_LIST<CostPolicy, OpenList>,
+                "Bucket queues require a consistent cost policy");
+
   public:
-  // TODO: FUTURE WORK- provide a heuristic function to enable experimenting
-  // with different heuristics.
-  explicit AStar(const ConfigurationSpace& cSpace) : m_cSpace(cSpace)
+  using cost_policy = CostPolicy;
+  using cost_type = typename CostPolicy::cost_type;
+  using workspace_type = BasicSearchWorkspace<OpenList, Layout>;
+  using index_type = typename workspace_type::index_type;
+
+  /**
+   * @brief Construct a new AStar object, sharing ownership of the
+   * configuration space.
+   *
+   * @param cSpace The configuration space to search.
+   */
+  explicit BasicAStar(SharedConfigSpace cSpace) : m_cSpace(std::move(cSpace))
+  {
+    assert(m_cSpace);
+  }
+
+  /**
+   * @brief Construct a new AStar object, borrowing the configuration space.
+   * NOTE: the configuration space is not copied, and must outlive this object.
+   *
+   * @param cSpace The configuration space to search.
+   */
+  explicit BasicAStar(const ConfigurationSpace& cSpace)
+      : m_cSpace(SharedConfigSpace(), &cSpace)
   {
     // do nothing
   }
 
+  /**
+   * @brief Construct a new AStar object for a robot of the given radius,
+   * sharing ownership of the configuration space. Accessibility is then
+   * checked against the configuration space's clearance, rather than its
+   * padded cell states.
+   * NOTE: throws if the configuration space's clearance was not computed.
+   *
+   * @param cSpace The configuration space to search.
+   * @param robotRadius The robot's radius, in cells.
+   */
+  BasicAStar(SharedConfigSpace cSpace, const size_t robotRadius)
+      : BasicAStar(std::move(cSpace))
+  {
+    SearchUtils::requireClearance(*m_cSpace);
+    m_robotRadius = robotRadius;
+  }
+
+  /**
+   * @brief Construct a new AStar object for a robot of the given radius, as
+   * above, borrowing the configuration space.
+   *
+   * @param cSpace The configuration space to search.
+   * @param robotRadius The robot's radius, in cells.
+   */
+  BasicAStar(const ConfigurationSpace& cSpace, const size_t robotRadius)
+      : BasicAStar(cSpace)
+  {
+    SearchUtils::requireClearance(*m_cSpace);
+    m_robotRadius = robotRadius;
+  }
+
+  // prevent borrowing a temporary configuration space
+  explicit BasicAStar(ConfigurationSpace&& cSpace) = delete;
+  BasicAStar(ConfigurationSpace&& cSpace, size_t robotRadius) = delete;
+
+  const ConfigurationSpace& configSpace() const
+  {
+    return *m_cSpace;
+  }
+
+  size_t robotRadius() const
+  {
+    return m_robotRadius.value_or(m_cSpace->robotRadius());
+  }
+
+  /**
+   * @brief The robot radius searched using the clearance, if given, else none,
+   * as the padded cell states are searched.
+   */
+  std::optional<size_t> clearanceRadius() const
+  {
+    return m_robotRadius;
+  }
+
   /**
    * @brief Perform path-finding using the A* algorithm. The below
    * implementation follows the descriptions provided at the following links:
@@ -86,153 +275,147 @@ class AStar
    */
   std::vector<Cell> searchPath(const Cell& start, const Cell& goal) const
   {
+    workspace_type workspace;
+    return searchPath(start, goal, workspace);
+  }
+
+  /**
+   * @brief Perform path-finding using the A* algorithm, as above, storing the
+   * search state in a caller-provided workspace. Reusing the workspace between
+   * queries avoids reallocating and clearing the full-map node data, so the
+   * cost of a query depends on the area explored rather than the map size.
+   *
+   * @param start The start location
+   * @param goal The goal location
+   * @param workspace The workspace used to store the search state
+   * @param stats If provided, the outcome, counters and timings of the search
+   * are written to it
+   * @param cancel If a stop is requested, the search is abandoned, returning
+   * no path with the status CANCELLED (see SearchUtils::isCancelled())
+   * @return std::vector<Cell> The cell locations making up the path, ordered
+   * from start to goal, if found. Otherwise, an empty vector is returned.
+   */
+  std::vector<Cell> searchPath(const Cell& start,
+                               const Cell& goal,
+                               workspace_type& workspace,
+                               SearchStats* stats = nullptr,
+                               const std::stop_token& cancel = {}) const
+  {
+    SearchStats localStats;
+    SearchStats& st = stats ? *stats : localStats;
+    st = SearchStats();
+    const auto setupStart = SearchUtils::Clock::now();
+
     // Check for blocked / unreachable start and goal positions, or start is at
-    // the goal. Chose not to throw an exception to allow program to continue
-    // with new user-provided inputs
-    if (!isValidStartGoal(start, goal)) {
+    // the goal
+    st.status =
+        SearchUtils::checkStartGoal(*m_cSpace, start, goal, m_robotRadius);
+    if (st.status != search_status::FOUND) {
+      st.setupTime = SearchUtils::Clock::now() - setupStart;
       return std::vector<Cell>();
     }
 
-    // Use a priority queue as a min-heap with smallest f-cost at the top for
-    // storing the unexplored (open) nodes
-    auto comp = [&](const CostCell& c1, const CostCell& c2) {
-      return c1.first > c2.first;
-    };
-    std::priority_queue<CostCell, std::vector<CostCell>, decltype(comp)>
-        unexploredNodes(comp);
+    // Reset the state of each node in the map, which also tracks which nodes
+    // have been explored in the search (closed)
+    workspace.reset(*m_cSpace);
 
-    // Container storing the current state of each node in the map
-    const std::pair<size_t, size_t> mapShape = m_cSpace.shape();
-    DataMap<Node> nodeMap(mapShape);
+    // Use the workspace's open list as a min-heap with smallest f-cost at the
+    // top for storing the unexplored (open) nodes
+    OpenList& unexploredNodes = workspace.openList();
 
-    // Map tracking which nodes have been explored in the search (closed)
-    // TODO: FUTORE WORK- consider replacing this with unordered_set to reduce memory usage
-    DataMap<bool> exploredNodes(mapShape, false);
-
-    // Put starting node on the open list (with fCost = 0 and gCost = 0)
-    Node startNode(start, start);
-    startNode.fCost = 0.0;
-    startNode.gCost = 0.0;
-    nodeMap.at(start) = startNode;
-
-    CostCell startCP{startNode.fCost, start};
-    unexploredNodes.emplace(startCP);
+    // Put starting node on the open list (with gCost = 0)
+    const index_type startIdx = workspace.idxFrom(start);
+    workspace.visit(startIdx, startIdx, 0);
+    unexploredNodes.push(startIdx, CostPolicy::heuristic(start, goal));
+    ++st.heapPushes;
+    st.peakOpenListSize = 1U;
 
+    const auto searchStart = SearchUtils::Clock::now();
+    st.setupTime = searchStart - setupStart;
     while (!unexploredNodes.empty()) {
-      // Next search node 'q' is the node with lowest fCost from the heap
-      CostCell q = unexploredNodes.top();
-      const Cell qPos = q.second;
+      if (SearchUtils::isCancelled(cancel, st.nodesExpanded)) {
+        st.status = search_status::CANCELLED;
+        break;
+      }
+
+      // Next search node 'q' is the node with lowest fCost from the heap.
       // Remove q from the top of the heap and add it to the explored nodes
-      unexploredNodes.pop();
-      exploredNodes.at(qPos) = true;
+      const index_type qIdx = unexploredNodes.pop().item;
+      ++st.heapPops;
+      if (workspace.isExplored(qIdx)) {
+        // stale entry, for open lists without decrease-key
+        ++st.stalePops;
+        continue;
+      }
+      workspace.markExplored(qIdx);
+      ++st.nodesExpanded;
 
-      // Get all of the current node's accessible neighbors.
+      // The goal is only reached optimally once it is taken from the heap
+      const Cell qPos = workspace.cellFrom(qIdx);
+      if (qPos == goal) {
+        const auto pathStart = SearchUtils::Clock::now();
+        st.searchTime = pathStart - searchStart;
+        std::vector<Cell> path = SearchUtils::generatePath(workspace, goal);
+        st.pathTime = SearchUtils::Clock::now() - pathStart;
+        st.workspaceBytes = workspace.bytes();
+        return path;
+      }
+      const cost_type parentGCost = workspace.gCost(qIdx);
+
+      // Visit all of the current node's accessible neighbors.
       // There are 8 max possible neighbors, but may be less if near
-      // the border or within an obstacle
-      const std::vector<Cell> nbrCells = m_cSpace.getAccessibleNbrs(qPos);
-      for (const auto& nbrCell : nbrCells) {
-        // Check if this neighbor is the goal, updates its state, and
-        // return a path
-        if (nbrCell == goal) {
-          std::cout << "Goal found!!!" << std::endl;
-          Node nbr(nbrCell, qPos);
-          nodeMap.at(nbr.pos) = nbr;
-          return generatePath(nodeMap, goal);
-        }
+      // the border or within an obstacle, or if the policy restricts the moves
+      const NeighborRange nbrs(
+          qPos,
+          SearchUtils::nbrMask(*m_cSpace, qPos, m_robotRadius) &
+              CostPolicy::MOVES);
+      for (auto nbrIt = nbrs.begin(); nbrIt != nbrs.end(); ++nbrIt) {
+        const Cell nbrCell = *nbrIt;
+        const index_type nbrIdx = workspace.idxFrom(nbrCell);
 
         // Explore this neighbor if we haven't already
-        if (!exploredNodes.at(nbrCell)) {
-          Node nbr(nbrCell, qPos);
-          const double parentGCost = nodeMap.at(qPos).gCost;
-          nbr.updateCosts(goal, parentGCost);
-
-          // Add this neighbor to the unexplored nodes
-          // if not on the open list, add to open list, and set current cell as
-          // the parent
-          //         OR
-          // if on the open list, check if has a smaller f
-          if (nodeMap.at(nbr.pos).fCost == UNSET_VAL ||
-              nodeMap.at(nbr.pos).fCost > nbr.fCost) {
-            unexploredNodes.emplace(std::make_pair(nbr.fCost, nbr.pos));
-            nodeMap.at(nbr.pos) = nbr;
+        if (workspace.isExplored(nbrIdx)) {
+          continue;
+        }
+        const cost_type gCost =
+            parentGCost + CostPolicy::stepCost(nbrIt.direction());
+
+        // if not on the open list, add to open list, and set current cell as
+        // the parent
+        //         OR
+        // if on the open list, check if has a smaller g
+        const bool isOpen = workspace.isVisited(nbrIdx);
+        if (!isOpen || gCost < workspace.gCost(nbrIdx)) {
+          workspace.visit(nbrIdx, qIdx, gCost);
+          const cost_type fCost = gCost + CostPolicy::heuristic(nbrCell, goal);
+          if (isOpen) {
+            unexploredNodes.decreaseKey(nbrIdx, fCost);
+            ++st.heapDecreaseKeys;
+          } else {
+            unexploredNodes.push(nbrIdx, fCost);
+            ++st.heapPushes;
           }
+          st.peakOpenListSize =
+              std::max(st.peakOpenListSize, unexploredNodes.size());
         }
       }
     }
-    std::cout << "Goal not found... :(" << std::endl;
+    if (st.status != search_status::CANCELLED) {
+      st.status = search_status::NOT_FOUND;
+    }
+    st.searchTime = SearchUtils::Clock::now() - searchStart;
+    st.workspaceBytes = workspace.bytes();
     return std::vector<Cell>();
   }
 
   private:
-  ConfigurationSpace m_cSpace;
-
-  /**
-   * @brief Check the start and goal positions to ensure they are valid. Incalid
-   * cases include:
-   *  - Start is outside of the domain
-   *  - Goal is outside of the domain
-   *  - Start is not accessible
-   *  - Goal is not accessible
-   *  - Start is already at the goal
-   *
-   * @param start The start position
-   * @param goal The goal position
-   * @return false if one of the above conditions, else true
-   */
-  bool isValidStartGoal(const Cell& start, const Cell& goal) const
-  {
-    if (!m_cSpace.contains(start)) {
-      std::cout << "Start point " << start << " is not in the grid"
-                << std::endl;
-      return false;
-    }
-
-    if (!m_cSpace.contains(goal)) {
-      std::cout << "Goal point " << start << " is not in the grid" << std::endl;
-      return false;
-    }
-
-    if (!m_cSpace.isAccessible(start)) {
-      std::cout << "Start point " << start << " is not accessible" << std::endl;
-      return false;
-    }
-
-    if (!m_cSpace.isAccessible(goal)) {
-      std::cout << "Goal point " << goal << " is not accessible" << std::endl;
-      return false;
-    }
-
-    if (start == goal) {
-      std::cout << "Start position " << start << " is already at goal"
-                << std::endl;
-      return false;
-    }
-    return true;
-  }
-
-  /**
-   * @brief Generate the path followed from start to goal
-   *
-   * @param nodeMap The node map containing node data at each grid point
-   * @param goal The goal location
-   * @return std::vector<Cell> All points followed from start to goal
-   */
-  static std::vector<Cell> generatePath(const DataMap<Node>& nodeMap,
-                                        const Cell& goal)
-  {
-    std::vector<Cell> path;
+  SharedConfigSpace m_cSpace;
+  // the robot radius to search for, if other than the configuration space's
+  std::optional<size_t> m_robotRadius;
+};
 
-    // Generate the path, working backwards from the goal
-    // node, and terminating when we reach the start location
-    path.emplace_back(goal);
-    Cell next = nodeMap.at(goal).parentPos;
-    do {
-      path.emplace_back(next);
-      next = nodeMap.at(next).parentPos;
-    } while (next != nodeMap.at(next).parentPos);
+using AStar = BasicAStar<>;
 
-    // Reverse the order to go from start to goal
-    std::reverse(path.begin(), path.end());
-    return path;
-  }
-};
+// A* storing its node state in lazily allocated tiles, for very large maps
+using TiledAStar =
+    BasicAStar<OctileCost, TiledIndexedHeap<OctileCost::cost_type>, TiledLayout>;
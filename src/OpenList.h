@@ -0,0 +1,379 @@
+/**
+ * @file OpenList.h
+ * @brief File containing priority queues used for storing the open (unexplored)
+ * nodes of the path-finding algorithms.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Class providing an indexed d-ary min-heap of items (e.g., linear cell
+ * indices) keyed on their cost. The position of each item within the heap is
+ * tracked, supporting decrease-key, so each item is only ever stored once.
+ * NOTE: the item positions are not cleared between queries. An item is only in
+ * the heap if its recorded position refers back to it, so stale positions
+ * from previous queries are never mistaken for heap entries.
+ *
+ * @tparam Key The cost type.
+ * @tparam Arity The number of children of each heap node.
+ * @tparam Positions The array type of the item positions, indexed by item
+ * (e.g., a PagedArray, so positions are only stored for the items pushed).
+ */
+template <typename Key,
+          size_t Arity = 4,
+          typename Positions = std::vector<uint32_t>>
+class IndexedHeap
+{
+  static_assert(Arity >= 2, "Heap must have at least two children per node");
+
+  public:
+  using key_type = Key;
+  using item_type = uint32_t;
+  // keys may be pushed in any order
+  static constexpr bool NEEDS_MONOTONE_KEYS = false;
+  static_assert(std::is_same_v<typename Positions::value_type, item_type>,
+                "Positions must store item_type values");
+
+  struct Entry {
+    Key key;
+    item_type item;
+  };
+
+  /**
+   * @brief Remove all entries, preparing the heap for items in [0, numItems).
+   * Memory is only (re)allocated if the number of items has changed.
+   */
+  void reset(const size_t numItems)
+  {
+    assert(numItems <= std::numeric_limits<item_type>::max());
+    if (m_positions.size() != numItems) {
+      m_positions.assign(numItems, 0U);
+    }
+    m_entries.clear();
+  }
+
+  bool empty() const
+  {
+    return m_entries.empty();
+  }
+
+  size_t size() const
+  {
+    return m_entries.size();
+  }
+
+  bool contains(const item_type item) const
+  {
+    assert(item < m_positions.size());
+    const size_t pos = m_positions[item];
+    return pos < m_entries.size() && m_entries[pos].item == item;
+  }
+
+  /**
+   * @brief Add an item which is not already in the heap.
+   */
+  void push(const item_type item, const Key key)
+  {
+    assert(!contains(item));
+    m_entries.push_back({key, item});
+    siftUp(m_entries.size() - 1);
+  }
+
+  /**
+   * @brief Lower the key of an item already in the heap.
+   */
+  void decreaseKey(const item_type item, const Key key)
+  {
+    assert(contains(item));
+    const size_t pos = m_positions[item];
+    assert(!(m_entries[pos].key < key));
+    m_entries[pos].key = key;
+    siftUp(pos);
+  }
+
+  const Entry& top() const
+  {
+    assert(!empty());
+    return m_entries.front();
+  }
+
+  /**
+   * @brief Remove and return the entry with the lowest key.
+   */
+  Entry pop()
+  {
+    assert(!empty());
+    const Entry result = m_entries.front();
+    const Entry last = m_entries.back();
+    m_entries.pop_back();
+    if (!m_entries.empty()) {
+      m_entries.front() = last;
+      siftDown(0);
+    }
+    return result;
+  }
+
+  /**
+   * @brief Change the key of an item already in the heap, either raising or
+   * lowering it (e.g., for incremental searches, see DStarLite).
+   */
+  void updateKey(const item_type item, const Key key)
+  {
+    assert(contains(item));
+    const size_t pos = m_positions[item];
+    const bool lowered = key < m_entries[pos].key;
+    m_entries[pos].key = key;
+    if (lowered) {
+      siftUp(pos);
+    } else {
+      siftDown(pos);
+    }
+  }
+
+  /**
+   * @brief Remove an item from the heap.
+   */
+  void erase(const item_type item)
+  {
+    assert(contains(item));
+    const size_t pos = m_positions[item];
+    const Entry last = m_entries.back();
+    m_entries.pop_back();
+    if (pos < m_entries.size()) {
+      // move the last entry into the gap, then restore the heap order in
+      // whichever direction it is violated
+      const bool lowered = last.key < m_entries[pos].key;
+      place(pos, last);
+      if (lowered) {
+        siftUp(pos);
+      } else {
+        siftDown(pos);
+      }
+    }
+  }
+
+  size_t bytes() const
+  {
+    return m_entries.capacity() * sizeof(Entry) +
+           m_positions.capacity() * sizeof(item_type);
+  }
+
+  private:
+  std::vector<Entry> m_entries;
+  Positions m_positions;
+
+  void place(const size_t pos, const Entry& entry)
+  {
+    m_entries[pos] = entry;
+    m_positions[entry.item] = static_cast<item_type>(pos);
+  }
+
+  void siftUp(size_t pos)
+  {
+    const Entry entry = m_entries[pos];
+    while (pos > 0) {
+      const size_t parent = (pos - 1) / Arity;
+      if (!(entry.key < m_entries[parent].key)) {
+        break;
+      }
+      place(pos, m_entries[parent]);
+      pos = parent;
+    }
+    place(pos, entry);
+  }
+
+  void siftDown(size_t pos)
+  {
+    const Entry entry = m_entries[pos];
+    const size_t count = m_entries.size();
+    while (true) {
+      const size_t firstChild = pos * Arity + 1;
+      if (firstChild >= count) {
+        break;
+      }
+      const size_t lastChild = std::min(firstChild + Arity, count);
+      size_t best = firstChild;
+      for (size_t child = firstChild + 1; child < lastChild; ++child) {
+        if (m_entries[child].key < m_entries[best].key) {
+          best = child;
+        }
+      }
+      if (!(m_entries[best].key < entry.key)) {
+        break;
+      }
+      place(pos, m_entries[best]);
+      pos = best;
+    }
+    place(pos, entry);
+  }
+};
+
+/**
+ * @brief Class providing a bucket (Dial) queue of items keyed on integer costs,
+ * with one bucket per cost value. Pushing and popping are O(1), provided keys
+ * are never pushed below the last popped key (i.e., with a consistent
+ * heuristic). Pushing a lower key throws, and the planners reject inconsistent
+ * cost policies at compile time (see IS_COMPATIBLE_OPEN_LIST).
+ * NOTE: decrease-key pushes a second entry for the item, leaving the old one in
+ * place. Callers must skip these stale entries when popped (e.g., by checking
+ * whether the item has already been explored).
+ *
+ * @tparam Key The (integer) cost type.
+ */
+template <typename Key = uint32_t>
+class BucketQueue
+{
+  static_assert(std::is_integral_v<Key>, "Bucket queues need integer keys");
+
+  public:
+  using key_type = Key;
+  using item_type = uint32_t;
+  // keys must never be pushed below the last popped key
+  static constexpr bool NEEDS_MONOTONE_KEYS = true;
+
+  struct Entry {
+    Key key;
+    item_type item;
+  };
+
+  BucketQueue()
+      : m_baseKey(0),
+        m_cursor(0U),
+        m_usedBuckets(0U),
+        m_size(0U),
+        m_hasPopped(false)
+  {
+    // do nothing
+  }
+
+  /**
+   * @brief Remove all entries, keeping the bucket storage for reuse.
+   */
+  void reset(const size_t /* numItems */)
+  {
+    for (size_t idx = m_cursor; idx < m_usedBuckets; ++idx) {
+      m_buckets[idx].clear();
+    }
+    m_cursor = 0U;
+    m_usedBuckets = 0U;
+    m_size = 0U;
+    m_hasPopped = false;
+  }
+
+  bool empty() const
+  {
+    return m_size == 0U;
+  }
+
+  size_t size() const
+  {
+    return m_size;
+  }
+
+  void push(const item_type item, const Key key)
+  {
+    if (m_usedBuckets == 0U) {
+      m_baseKey = key;
+    } else if (key < m_baseKey) {
+      if (m_hasPopped) {
+        throwBelowCursor(key);
+      }
+      // before the first pop, so shift the buckets up to make room for the
+      // lower key
+      const size_t shift = static_cast<size_t>(m_baseKey - key);
+      m_buckets.insert(m_buckets.begin(), shift, std::vector<item_type>());
+      m_usedBuckets += shift;
+      m_baseKey = key;
+    }
+    const size_t bucketIdx = static_cast<size_t>(key - m_baseKey);
+    if (bucketIdx < m_cursor) {
+      throwBelowCursor(key);
+    }
+    if (bucketIdx >= m_buckets.size()) {
+      m_buckets.resize(bucketIdx + 1);
+    }
+    m_usedBuckets = std::max(m_usedBuckets, bucketIdx + 1);
+    m_buckets[bucketIdx].push_back(item);
+    ++m_size;
+  }
+
+  void decreaseKey(const item_type item, const Key key)
+  {
+    push(item, key);
+  }
+
+  Entry top()
+  {
+    assert(!empty());
+    advance();
+    return {static_cast<Key>(m_baseKey + m_cursor), m_buckets[m_cursor].back()};
+  }
+
+  /**
+   * @brief Remove and return an entry with the lowest key.
+   */
+  Entry pop()
+  {
+    const Entry result = top();
+    m_buckets[m_cursor].pop_back();
+    --m_size;
+    m_hasPopped = true;
+    return result;
+  }
+
+  size_t bytes() const
+  {
+    size_t result = m_buckets.capacity() * sizeof(std::vector<item_type>);
+    for (const auto& bucket : m_buckets) {
+      result += bucket.capacity() * sizeof(item_type);
+    }
+    return result;
+  }
+
+  private:
+  std::vector<std::vector<item_type>> m_buckets;
+  Key m_baseKey;
+  size_t m_cursor;
+  size_t m_usedBuckets;
+  size_t m_size;
+  // whether an entry was popped since the last reset, after which no lower key
+  // may be pushed
+  bool m_hasPopped;
+
+  [[noreturn]] void throwBelowCursor(const Key key) const
+  {
+    throw std::runtime_error(
+        "Bucket queue key " + std::to_string(key) +
+        " is below the last popped key " + std::to_string(m_baseKey + m_cursor) +
+        " (is the heuristic consistent?)");
+  }
+
+  // move the cursor to the lowest non-empty bucket
+  void advance()
+  {
+    while (m_buckets[m_cursor].empty()) {
+      ++m_cursor;
+    }
+  }
+};
+
+/**
+ * @brief Whether an open list may be searched with a cost policy. Bucket queues
+ * would lose the entries pushed below the last popped key, so need a consistent
+ * cost policy.
+ */
+template <typename CostPolicy, typename OpenList>
+inline constexpr bool IS_COMPATIBLE_OPEN_LIST =
+    !OpenList::NEEDS_MONOTONE_KEYS || CostPolicy::IS_CONSISTENT;
@@ -0,0 +1,380 @@
+/**
+ * @file PathCache.h
+ * @brief File containing a bounded cache of the paths found by the planners,
+ * for answering repeated queries without searching.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#pragma once
+
+#include "Cell.h"
+#include "ConfigSpace.h"
+#include "MotionPlanning.h"
+#include "SearchStats.h"
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Class providing a bounded, least-recently-used cache of paths, keyed
+ * on their start, goal and robot radius. The radius is that searched using the
+ * clearance, if given, or none for the padded cell states, as the two differ
+ * at the edge of the padding (see ConfigurationSpace::computeClearance()), so
+ * their paths are never shared. Each path is stored with the version
+ * of the configuration space it was found in, and is only returned while that
+ * version is current, so changes to the space are never missed. After
+ * obstacles are added, invalidate() drops only the paths through the changed
+ * cells, keeping the rest current: adding obstacles never makes a path
+ * cheaper, so paths which avoid them remain optimal.
+ * NOTE: all operations lock the cache, so it may be shared by the threads of a
+ * BatchPlanner (see CachedPlanner).
+ */
+class PathCache
+{
+  public:
+  /**
+   * @brief Construct a new Path Cache object, sharing ownership of the
+   * configuration space.
+   *
+   * @param cSpace The configuration space the cached paths were found in.
+   * @param capacity The maximum number of paths held.
+   */
+  PathCache(SharedConfigSpace cSpace, const size_t capacity)
+      : m_cSpace(std::move(cSpace)),
+        m_capacity(capacity),
+        m_hits(0U),
+        m_misses(0U)
+  {
+    assert(m_cSpace);
+  }
+
+  /**
+   * @brief Construct a new Path Cache object, as above, borrowing the
+   * configuration space.
+   * NOTE: the configuration space is not copied, and must outlive this object.
+   */
+  PathCache(const ConfigurationSpace& cSpace, const size_t capacity)
+      : PathCache(SharedConfigSpace(SharedConfigSpace(), &cSpace), capacity)
+  {
+    // do nothing
+  }
+
+  // prevent borrowing a temporary configuration space
+  PathCache(ConfigurationSpace&& cSpace, size_t capacity) = delete;
+
+  const ConfigurationSpace& configSpace() const
+  {
+    return *m_cSpace;
+  }
+
+  size_t capacity() const
+  {
+    return m_capacity;
+  }
+
+  size_t size() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+  }
+
+  /**
+   * @brief The number of lookups answered from the cache.
+   */
+  size_t hits() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hits;
+  }
+
+  /**
+   * @brief The number of lookups not answered from the cache, including those
+   * of paths found in an older version of the configuration space.
+   */
+  size_t misses() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_misses;
+  }
+
+  /**
+   * @brief Look up the path of a query, marking it as the most recently used.
+   *
+   * @param start The start location
+   * @param goal The goal location
+   * @param robotRadius The robot radius searched using the clearance, if
+   * given, else none for the padded cell states (see
+   * AStar::clearanceRadius()).
+   * @return std::optional<std::vector<Cell>> The path, if cached and current.
+   */
+  std::optional<std::vector<Cell>> find(
+      const Cell& start,
+      const Cell& goal,
+      const std::optional<size_t>& robotRadius)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_index.find(Key{start, goal, robotRadius});
+    if (it == m_index.end()) {
+      ++m_misses;
+      return std::nullopt;
+    }
+    if (it->second->version != m_cSpace->version()) {
+      // found before the space changed, without being invalidated since
+      m_entries.erase(it->second);
+      m_index.erase(it);
+      ++m_misses;
+      return std::nullopt;
+    }
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    ++m_hits;
+    return it->second->path;
+  }
+
+  /**
+   * @brief Add the path of a query found in the current version of the
+   * configuration space, evicting the least recently used path if full. The
+   * robot radius is as for find().
+   */
+  void insert(const Cell& start,
+              const Cell& goal,
+              const std::optional<size_t>& robotRadius,
+              std::vector<Cell> path)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_capacity == 0U) {
+      return;
+    }
+    const Key key{start, goal, robotRadius};
+    const auto it = m_index.find(key);
+    if (it != m_index.end()) {
+      m_entries.erase(it->second);
+      m_index.erase(it);
+    } else if (m_entries.size() == m_capacity) {
+      m_index.erase(m_entries.back().key);
+      m_entries.pop_back();
+    }
+    m_entries.push_front({key, m_cSpace->version(), std::move(path)});
+    m_index.emplace(key, m_entries.begin());
+  }
+
+  /**
+   * @brief Drop the paths which are no longer valid after obstacles were added
+   * to the configuration space, and mark the rest as current.
+   * NOTE: for paths searched using the clearance (at any radius, including
+   * the space's own), the cells of each path are checked against the clearance
+   * instead, as the changed cells are only those blocked in the padded cell
+   * states. Only call this after adding
+   * obstacles: after removing or moving them (see
+   * ConfigurationSpace::removeObstacles()), shorter paths may open up, so let
+   * the paths expire with the version instead, or clear() the cache.
+   * NOTE: the changed cells are those of the last change only, so only the
+   * paths found in the version before it are kept. Paths found in older
+   * versions may pass through cells blocked by earlier changes, and are
+   * dropped. Paths found in the current version are kept as they are.
+   *
+   * @param changedCells The newly blocked cells, as reported by
+   * ConfigurationSpace::addObstacles().
+   */
+  void invalidate(const std::vector<Cell>& changedCells)
+  {
+    std::unordered_set<size_t> changed;
+    changed.reserve(changedCells.size());
+    for (const Cell& c : changedCells) {
+      changed.insert(m_cSpace->idxFrom(c));
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const uint64_t version = m_cSpace->version();
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+      if (it->version == version) {
+        ++it;
+      } else if (it->version + 1 != version || isBlocked(*it, changed)) {
+        m_index.erase(it->key);
+        it = m_entries.erase(it);
+      } else {
+        it->version = version;
+        ++it;
+      }
+    }
+  }
+
+  /**
+   * @brief Drop all of the paths, keeping the counters.
+   */
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_index.clear();
+  }
+
+  private:
+  struct Key {
+    Cell start;
+    Cell goal;
+    std::optional<size_t> robotRadius;
+
+    bool operator==(const Key& other) const
+    {
+      return start == other.start && goal == other.goal &&
+             robotRadius == other.robotRadius;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const
+    {
+      const std::hash<size_t> hash;
+      size_t seed = hash(key.start.x());
+      // searches of the padded cell states hash as the largest radius
+      for (const size_t value :
+           {key.start.y(),
+            key.goal.x(),
+            key.goal.y(),
+            key.robotRadius.value_or(std::numeric_limits<size_t>::max())}) {
+        // as boost::hash_combine
+        seed ^= hash(value) + 0x9e3779b9U + (seed << 6) + (seed >> 2);
+      }
+      return seed;
+    }
+  };
+
+  struct Entry {
+    Key key;
+    uint64_t version;
+    std::vector<Cell> path;
+  };
+
+  SharedConfigSpace m_cSpace;
+  size_t m_capacity;
+  // the entries, most recently used first, and their positions by key
+  std::list<Entry> m_entries;
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_index;
+  size_t m_hits;
+  size_t m_misses;
+  mutable std::mutex m_mutex;
+
+  bool isBlocked(const Entry& entry,
+                 const std::unordered_set<size_t>& changed) const
+  {
+    const std::optional<size_t>& robotRadius = entry.key.robotRadius;
+    for (const Cell& c : entry.path) {
+      if (robotRadius ? !m_cSpace->isAccessible(c, *robotRadius)
+                      : changed.count(m_cSpace->idxFrom(c)) > 0U) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+/**
+ * @brief Class answering queries from a (possibly shared) path cache in front
+ * of a planner, which is only searched on a miss. Provides the same interface
+ * as the planner, so may be used by a BatchPlanner.
+ *
+ * @tparam Planner The path-finding algorithm, e.g., AStar.
+ */
+template <typename Planner = AStar>
+class CachedPlanner
+{
+  public:
+  using cost_policy = typename Planner::cost_policy;
+  using workspace_type = typename Planner::workspace_type;
+
+  /**
+   * @brief Construct a new Cached Planner object.
+   *
+   * @param planner The planner used to answer cache misses.
+   * @param cache The cache, over the planner's configuration space.
+   */
+  CachedPlanner(Planner planner, std::shared_ptr<PathCache> cache)
+      : m_planner(std::move(planner)), m_cache(std::move(cache))
+  {
+    assert(m_cache);
+    assert(&m_cache->configSpace() == &m_planner.configSpace());
+  }
+
+  const Planner& planner() const
+  {
+    return m_planner;
+  }
+
+  const std::shared_ptr<PathCache>& cache() const
+  {
+    return m_cache;
+  }
+
+  const ConfigurationSpace& configSpace() const
+  {
+    return m_planner.configSpace();
+  }
+
+  size_t robotRadius() const
+  {
+    return m_planner.robotRadius();
+  }
+
+  /**
+   * @brief Get the path of a query from the cache, or else search for it.
+   */
+  std::vector<Cell> searchPath(const Cell& start, const Cell& goal) const
+  {
+    workspace_type workspace;
+    return searchPath(start, goal, workspace);
+  }
+
+  /**
+   * @brief Get the path of a query, as above, searching with a caller-provided
+   * workspace on a miss.
+   *
+   * @param start The start location
+   * @param goal The goal location
+   * @param workspace The workspace used to store the search state
+   * @param stats If provided, the outcome, counters and timings of the search
+   * are written to it, with no nodes expanded if the path was cached
+   * @return std::vector<Cell> The cell locations making up the path, ordered
+   * from start to goal, if found. Otherwise, an empty vector is returned.
+   */
+  std::vector<Cell> searchPath(const Cell& start,
+                               const Cell& goal,
+                               workspace_type& workspace,
+                               SearchStats* stats = nullptr) const
+  {
+    const auto lookupStart = SearchUtils::Clock::now();
+    std::optional<std::vector<Cell>> path =
+        m_cache->find(start, goal, m_planner.clearanceRadius());
+    if (path) {
+      if (stats) {
+        *stats = SearchStats();
+        stats->status = search_status::FOUND;
+        stats->cacheHit = true;
+        stats->pathTime = SearchUtils::Clock::now() - lookupStart;
+      }
+      return std::move(*path);
+    }
+
+    // only found paths are cached, as invalid queries are rejected cheaply
+    std::vector<Cell> result =
+        m_planner.searchPath(start, goal, workspace, stats);
+    if (!result.empty()) {
+      m_cache->insert(start, goal, m_planner.clearanceRadius(), result);
+    }
+    return result;
+  }
+
+  private:
+  Planner m_planner;
+  std::shared_ptr<PathCache> m_cache;
+};
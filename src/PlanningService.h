@@ -0,0 +1,271 @@
+/**
+ * @file PlanningService.h
+ * @brief File containing a line protocol for planning over a resident
+ * configuration space, updated and queried as a long-running process.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#pragma once
+
+#include "Cell.h"
+#include "ConfigSpace.h"
+#include "FileIO.h"
+#include "Grid.h"
+#include "MotionPlanning.h"
+#include "SearchStats.h"
+
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Class answering commands over a configuration space held in memory,
+ * so tools making many queries pay neither the process startup nor the file
+ * round trips of a run per query. Commands are read a line at a time, with
+ * whitespace-separated arguments, and each is answered with a single line
+ * starting "ok" (followed by the results), "fail" (a valid query with no
+ * path, followed by the search status) or "error" (a malformed or rejected
+ * command, followed by the reason). Blank lines and lines starting "#" are
+ * ignored. The commands are:
+ *   add <x> <y> <r>            ->  ok <version> <num blocked cells>
+ *   remove <x> <y> <r>         ->  ok <version> <num freed cells>
+ *   move <x> <y> <r> <x> <y> <r>
+ *                              ->  ok <version> <num freed> <num blocked>
+ *   path <sx> <sy> <gx> <gy>   ->  ok <num cells> <x0> <y0> <x1> <y1> ...
+ *   image <file> [scale]       ->  ok <width> <height>
+ *   info                       ->  ok <nx> <ny> <robot radius> <version>
+ *                                     <num obstacles>
+ *   quit                       ->  ok
+ * where obstacles are circles of radius r centered on cell (x, y), and image
+ * writes a PGM of the cell states, downsampled by scale and with the last
+ * path found drawn over them (see ConfigSpaceImageIO). Obstacles must be
+ * centered within the space, with radii no larger than the sum of its
+ * dimensions (which covers the whole space from any cell), so malformed
+ * commands are rejected rather than rasterizing circles far beyond it. For
+ * the same reason, image scales larger than the space's largest dimension
+ * (which already gives a single pixel) are rejected.
+ */
+class PlanningService
+{
+  public:
+  /**
+   * @brief Construct a new Planning Service object, taking ownership of the
+   * configuration space.
+   *
+   * @param cSpace The configuration space, which must know its obstacle
+   * geometry for obstacles to be removed or moved.
+   */
+  explicit PlanningService(ConfigurationSpace cSpace)
+      : m_cSpace(std::move(cSpace)), m_search(m_cSpace)
+  {
+    // do nothing
+  }
+
+  // the planner borrows the configuration space held by this object
+  PlanningService(const PlanningService&) = delete;
+  PlanningService& operator=(const PlanningService&) = delete;
+
+  const ConfigurationSpace& configSpace() const
+  {
+    return m_cSpace;
+  }
+
+  /**
+   * @brief Answer commands from a stream until quit or the end of the stream,
+   * flushing after each reply so results are streamed to the caller.
+   */
+  void serve(std::istream& inStream, std::ostream& outStream)
+  {
+    std::string line;
+    while (std::getline(inStream, line)) {
+      const bool isRunning = handle(line, outStream);
+      outStream.flush();
+      if (!isRunning) {
+        break;
+      }
+    }
+  }
+
+  /**
+   * @brief Answer a single command, writing its reply line (if any).
+   *
+   * @param line The command line.
+   * @param outStream The stream the reply is written to.
+   * @return bool Whether to keep answering commands, false after quit.
+   */
+  bool handle(const std::string& line, std::ostream& outStream)
+  {
+    std::istringstream args(line);
+    std::string command;
+    if (!(args >> command) || command.front() == '#') {
+      return true;
+    }
+    try {
+      if (command == "quit") {
+        expectEnd(args);
+        outStream << "ok\n";
+        return false;
+      }
+      if (command == "add") {
+        addObstacle(args, outStream);
+      } else if (command == "remove") {
+        removeObstacle(args, outStream);
+      } else if (command == "move") {
+        moveObstacle(args, outStream);
+      } else if (command == "path") {
+        searchPath(args, outStream);
+      } else if (command == "image") {
+        writeImage(args, outStream);
+      } else if (command == "info") {
+        expectEnd(args);
+        outStream << "ok " << m_cSpace.numX() << ' ' << m_cSpace.numY() << ' '
+                  << m_cSpace.robotRadius() << ' ' << m_cSpace.version() << ' '
+                  << m_cSpace.obstacles().size() << '\n';
+      } else {
+        throw std::runtime_error("Unknown command: " + command);
+      }
+    } catch (const std::exception& e) {
+      outStream << "error " << e.what() << '\n';
+    }
+    return true;
+  }
+
+  private:
+  ConfigurationSpace m_cSpace;
+  AStar m_search;
+  AStar::workspace_type m_workspace;
+  std::vector<Cell> m_lastPath;
+
+  void addObstacle(std::istream& args, std::ostream& outStream)
+  {
+    const Circle obstacle = readCircle(args);
+    expectEnd(args);
+    std::vector<Cell> blockedCells;
+    m_cSpace.addObstacles({obstacle}, &blockedCells);
+    outStream << "ok " << m_cSpace.version() << ' ' << blockedCells.size()
+              << '\n';
+  }
+
+  void removeObstacle(std::istream& args, std::ostream& outStream)
+  {
+    const Circle obstacle = readCircle(args);
+    expectEnd(args);
+    std::vector<Cell> freedCells;
+    m_cSpace.removeObstacles({obstacle}, &freedCells);
+    outStream << "ok " << m_cSpace.version() << ' ' << freedCells.size()
+              << '\n';
+  }
+
+  void moveObstacle(std::istream& args, std::ostream& outStream)
+  {
+    const Circle from = readCircle(args);
+    const Circle to = readCircle(args);
+    expectEnd(args);
+    std::vector<Cell> freedCells;
+    std::vector<Cell> blockedCells;
+    m_cSpace.moveObstacle(from, to, &freedCells, &blockedCells);
+    outStream << "ok " << m_cSpace.version() << ' ' << freedCells.size() << ' '
+              << blockedCells.size() << '\n';
+  }
+
+  void searchPath(std::istream& args, std::ostream& outStream)
+  {
+    const Cell start = readCell(args);
+    const Cell goal = readCell(args);
+    expectEnd(args);
+    SearchStats stats;
+    m_lastPath = m_search.searchPath(start, goal, m_workspace, &stats);
+    if (m_lastPath.empty()) {
+      outStream << "fail " << stats.status << '\n';
+      return;
+    }
+    outStream << "ok " << m_lastPath.size();
+    for (const Cell& c : m_lastPath) {
+      outStream << ' ' << c.x() << ' ' << c.y();
+    }
+    outStream << '\n';
+  }
+
+  void writeImage(std::istream& args, std::ostream& outStream)
+  {
+    std::string file;
+    if (!(args >> file)) {
+      throw std::runtime_error("Missing image file");
+    }
+    size_t scale = 1U;
+    if (std::string token; args >> token) {
+      scale = toSize(token);
+    }
+    expectEnd(args);
+    // a single pixel already covers the whole space
+    if (scale > std::max<size_t>({m_cSpace.numX(), m_cSpace.numY(), 1U})) {
+      throw std::runtime_error("Image scale larger than the space: " +
+                               std::to_string(scale));
+    }
+    ConfigSpaceImageIO::writePgm(
+        m_cSpace, std::filesystem::path(file), scale, m_lastPath);
+    outStream << "ok " << ConfigSpaceImageIO::numPixels(m_cSpace.numX(), scale)
+              << ' ' << ConfigSpaceImageIO::numPixels(m_cSpace.numY(), scale)
+              << '\n';
+  }
+
+  static size_t toSize(const std::string& token)
+  {
+    if (token.empty() ||
+        token.find_first_not_of("0123456789") != std::string::npos) {
+      throw std::runtime_error("Expected a non-negative integer: " + token);
+    }
+    try {
+      return static_cast<size_t>(std::stoull(token));
+    } catch (const std::out_of_range&) {
+      throw std::runtime_error("Integer out of range: " + token);
+    }
+  }
+
+  static size_t readSize(std::istream& args)
+  {
+    std::string token;
+    if (!(args >> token)) {
+      throw std::runtime_error("Missing argument");
+    }
+    return toSize(token);
+  }
+
+  static Cell readCell(std::istream& args)
+  {
+    const size_t x = readSize(args);
+    const size_t y = readSize(args);
+    return Cell(x, y);
+  }
+
+  Circle readCircle(std::istream& args) const
+  {
+    const Cell center = readCell(args);
+    const size_t radius = readSize(args);
+    if (!m_cSpace.contains(center)) {
+      throw std::runtime_error("Obstacle center outside of the space: " +
+                               std::to_string(center.x()) + ' ' +
+                               std::to_string(center.y()));
+    }
+    if (radius > m_cSpace.numX() + m_cSpace.numY()) {
+      throw std::runtime_error("Obstacle radius larger than the space: " +
+                               std::to_string(radius));
+    }
+    return Circle(center, radius);
+  }
+
+  static void expectEnd(std::istream& args)
+  {
+    std::string token;
+    if (args >> token) {
+      throw std::runtime_error("Unexpected argument: " + token);
+    }
+  }
+};
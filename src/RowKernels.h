@@ -0,0 +1,581 @@
+/**
+ * @file RowKernels.h
+ * @brief File containing vectorized kernels over rows of byte-sized cells,
+ * used to derive the layers of the configuration space from its cell states.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define BB8_ROW_KERNELS_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__)
+// AVX2 kernels are compiled for the target alone, and only used if the CPU
+// supports them (see RowKernels::best())
+#define BB8_ROW_KERNELS_AVX2
+#define BB8_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define BB8_ROW_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+/**
+ * @brief Table of kernels over rows of bytes, for one instruction set. The
+ * scalar kernels are always available, and the best kernels for the CPU are
+ * selected once at runtime (see best()), so a single x86 binary uses AVX2
+ * where supported and SSE2 otherwise. NEON is part of the AArch64 baseline, so
+ * is used on all ARM targets.
+ * NOTE: all kernels give identical results whichever table is used.
+ */
+struct RowKernels {
+  /**
+   * @brief Set dst[i] to 0xFF where src[i] == value, and 0x00 elsewhere, for
+   * i in [0, n).
+   */
+  using MatchBytesFunc = void (*)(const uint8_t* src,
+                                  size_t n,
+                                  uint8_t value,
+                                  uint8_t* dst);
+
+  /**
+   * @brief Pack the bits src[i] == value for i in [0, n) into the words of a
+   * bit-packed row (bit i % 64 of word i / 64). All (n + 63) / 64 words are
+   * written, with the bits past n cleared.
+   */
+  using PackMatchesFunc = void (*)(const uint8_t* src,
+                                   size_t n,
+                                   uint8_t value,
+                                   uint64_t* words);
+
+  /**
+   * @brief Replace the bytes equal to oldVal with newVal, for i in [0, n).
+   * NOTE: blocks of bytes without any match are not written, so unchanged
+   * pages of memory (e.g., of a memory-mapped file) are not copied.
+   */
+  using ReplaceBytesFunc = void (*)(uint8_t* data,
+                                    size_t n,
+                                    uint8_t oldVal,
+                                    uint8_t newVal);
+
+  /**
+   * @brief Compute the free-neighbor masks of a row of n cells (see
+   * NBR_OFFSETS), from the rows below, at and above it, where each byte is
+   * 0xFF if the cell is free or else 0x00. Each row must be readable at
+   * indices [-1, n], with the cells outside of the grid not free.
+   */
+  using NbrMasksFunc = void (*)(const uint8_t* below,
+                                const uint8_t* center,
+                                const uint8_t* above,
+                                size_t n,
+                                uint8_t* dst);
+
+  /**
+   * @brief Get the largest of the bytes src[i] for i in [0, n), or zero if n
+   * is zero (e.g., for validating a payload of cell states).
+   */
+  using MaxByteFunc = uint8_t (*)(const uint8_t* src, size_t n);
+
+  const char* name;
+  MatchBytesFunc matchBytes;
+  PackMatchesFunc packMatches;
+  ReplaceBytesFunc replaceBytes;
+  NbrMasksFunc nbrMasks;
+  MaxByteFunc maxByte;
+
+  /**
+   * @brief Get the fastest kernels supported by the CPU.
+   */
+  static const RowKernels& best()
+  {
+    static const RowKernels kernels = supported().back();
+    return kernels;
+  }
+
+  /**
+   * @brief Get all kernels supported by the CPU, from the scalar kernels to
+   * the fastest (e.g., for testing each against the scalar kernels).
+   */
+  static std::vector<RowKernels> supported()
+  {
+    std::vector<RowKernels> kernels{scalar()};
+#if defined(BB8_ROW_KERNELS_SSE2)
+    kernels.push_back(sse2());
+#endif
+#if defined(BB8_ROW_KERNELS_AVX2)
+    if (__builtin_cpu_supports("avx2")) {
+      kernels.push_back(avx2());
+    }
+#endif
+#if defined(BB8_ROW_KERNELS_NEON)
+    kernels.push_back(neon());
+#endif
+    return kernels;
+  }
+
+  static RowKernels scalar()
+  {
+    return {"scalar",
+            &Scalar::matchBytes,
+            &Scalar::packMatches,
+            &Scalar::replaceBytes,
+            &Scalar::nbrMasks,
+            &Scalar::maxByte};
+  }
+
+  private:
+  // the neighbor bits of the cells to the right, centered and to the left of
+  // a cell, in the rows below, at and above it (see NBR_OFFSETS)
+  static constexpr uint8_t BELOW_RIGHT = 0x80U;
+  static constexpr uint8_t BELOW = 0x40U;
+  static constexpr uint8_t BELOW_LEFT = 0x20U;
+  static constexpr uint8_t LEFT = 0x10U;
+  static constexpr uint8_t ABOVE_LEFT = 0x08U;
+  static constexpr uint8_t ABOVE = 0x04U;
+  static constexpr uint8_t ABOVE_RIGHT = 0x02U;
+  static constexpr uint8_t RIGHT = 0x01U;
+
+  static constexpr size_t WORD_BITS = 64U;
+
+  struct Scalar {
+    static void matchBytes(const uint8_t* src,
+                           const size_t n,
+                           const uint8_t value,
+                           uint8_t* dst)
+    {
+      for (size_t idx = 0; idx < n; ++idx) {
+        dst[idx] = src[idx] == value ? 0xFFU : 0x00U;
+      }
+    }
+
+    static void packMatches(const uint8_t* src,
+                            const size_t n,
+                            const uint8_t value,
+                            uint64_t* words)
+    {
+      for (size_t first = 0; first < n; first += WORD_BITS) {
+        const size_t count = n - first < WORD_BITS ? n - first : WORD_BITS;
+        uint64_t word = 0U;
+        for (size_t bit = 0; bit < count; ++bit) {
+          word |= static_cast<uint64_t>(src[first + bit] == value) << bit;
+        }
+        words[first / WORD_BITS] = word;
+      }
+    }
+
+    static void replaceBytes(uint8_t* data,
+                             const size_t n,
+                             const uint8_t oldVal,
+                             const uint8_t newVal)
+    {
+      for (size_t idx = 0; idx < n; ++idx) {
+        if (data[idx] == oldVal) {
+          data[idx] = newVal;
+        }
+      }
+    }
+
+    static void nbrMasks(const uint8_t* below,
+                         const uint8_t* center,
+                         const uint8_t* above,
+                         const size_t n,
+                         uint8_t* dst)
+    {
+      const uint8_t* belowLeft = below - 1;
+      const uint8_t* left = center - 1;
+      const uint8_t* aboveLeft = above - 1;
+      for (size_t idx = 0; idx < n; ++idx) {
+        dst[idx] = static_cast<uint8_t>(
+            (center[idx + 1] & RIGHT) | (above[idx + 1] & ABOVE_RIGHT) |
+            (above[idx] & ABOVE) | (aboveLeft[idx] & ABOVE_LEFT) |
+            (left[idx] & LEFT) | (belowLeft[idx] & BELOW_LEFT) |
+            (below[idx] & BELOW) | (below[idx + 1] & BELOW_RIGHT));
+      }
+    }
+
+    static uint8_t maxByte(const uint8_t* src, const size_t n)
+    {
+      uint8_t result = 0U;
+      for (size_t idx = 0; idx < n; ++idx) {
+        result = src[idx] > result ? src[idx] : result;
+      }
+      return result;
+    }
+  };
+
+#if defined(BB8_ROW_KERNELS_SSE2)
+  static RowKernels sse2()
+  {
+    return {"sse2",
+            &Sse2::matchBytes,
+            &Sse2::packMatches,
+            &Sse2::replaceBytes,
+            &Sse2::nbrMasks,
+            &Sse2::maxByte};
+  }
+
+  struct Sse2 {
+    static constexpr size_t LANES = 16U;
+
+    static __m128i load(const uint8_t* src)
+    {
+      return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    }
+
+    static void store(uint8_t* dst, const __m128i v)
+    {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), v);
+    }
+
+    static uint64_t matchBits(const uint8_t* src, const __m128i value)
+    {
+      return static_cast<uint16_t>(
+          _mm_movemask_epi8(_mm_cmpeq_epi8(load(src), value)));
+    }
+
+    static void matchBytes(const uint8_t* src,
+                           const size_t n,
+                           const uint8_t value,
+                           uint8_t* dst)
+    {
+      const __m128i v = _mm_set1_epi8(static_cast<char>(value));
+      size_t idx = 0;
+      for (; idx + LANES <= n; idx += LANES) {
+        store(dst + idx, _mm_cmpeq_epi8(load(src + idx), v));
+      }
+      Scalar::matchBytes(src + idx, n - idx, value, dst + idx);
+    }
+
+    static void packMatches(const uint8_t* src,
+                            const size_t n,
+                            const uint8_t value,
+                            uint64_t* words)
+    {
+      const __m128i v = _mm_set1_epi8(static_cast<char>(value));
+      size_t idx = 0;
+      for (; idx + WORD_BITS <= n; idx += WORD_BITS) {
+        words[idx / WORD_BITS] = matchBits(src + idx, v) |
+                                 matchBits(src + idx + 16U, v) << 16U |
+                                 matchBits(src + idx + 32U, v) << 32U |
+                                 matchBits(src + idx + 48U, v) << 48U;
+      }
+      Scalar::packMatches(src + idx, n - idx, value, words + idx / WORD_BITS);
+    }
+
+    static void replaceBytes(uint8_t* data,
+                             const size_t n,
+                             const uint8_t oldVal,
+                             const uint8_t newVal)
+    {
+      const __m128i oldV = _mm_set1_epi8(static_cast<char>(oldVal));
+      const __m128i newV = _mm_set1_epi8(static_cast<char>(newVal));
+      size_t idx = 0;
+      for (; idx + LANES <= n; idx += LANES) {
+        const __m128i cur = load(data + idx);
+        const __m128i eq = _mm_cmpeq_epi8(cur, oldV);
+        if (_mm_movemask_epi8(eq) != 0) {
+          store(data + idx,
+                _mm_or_si128(_mm_and_si128(eq, newV),
+                             _mm_andnot_si128(eq, cur)));
+        }
+      }
+      Scalar::replaceBytes(data + idx, n - idx, oldVal, newVal);
+    }
+
+    static __m128i nbrBits(const uint8_t* row, const uint8_t bits)
+    {
+      return _mm_and_si128(load(row), _mm_set1_epi8(static_cast<char>(bits)));
+    }
+
+    static void nbrMasks(const uint8_t* below,
+                         const uint8_t* center,
+                         const uint8_t* above,
+                         const size_t n,
+                         uint8_t* dst)
+    {
+      size_t idx = 0;
+      for (; idx + LANES <= n; idx += LANES) {
+        const __m128i mask = _mm_or_si128(
+            _mm_or_si128(_mm_or_si128(nbrBits(center + idx + 1, RIGHT),
+                                      nbrBits(above + idx + 1, ABOVE_RIGHT)),
+                         _mm_or_si128(nbrBits(above + idx, ABOVE),
+                                      nbrBits(above + idx - 1, ABOVE_LEFT))),
+            _mm_or_si128(_mm_or_si128(nbrBits(center + idx - 1, LEFT),
+                                      nbrBits(below + idx - 1, BELOW_LEFT)),
+                         _mm_or_si128(nbrBits(below + idx, BELOW),
+                                      nbrBits(below + idx + 1, BELOW_RIGHT))));
+        store(dst + idx, mask);
+      }
+      Scalar::nbrMasks(
+          below + idx, center + idx, above + idx, n - idx, dst + idx);
+    }
+
+    static uint8_t maxByte(const uint8_t* src, const size_t n)
+    {
+      __m128i acc = _mm_setzero_si128();
+      size_t idx = 0;
+      for (; idx + LANES <= n; idx += LANES) {
+        acc = _mm_max_epu8(acc, load(src + idx));
+      }
+      // fold the lanes in halves
+      acc = _mm_max_epu8(acc, _mm_srli_si128(acc, 8));
+      acc = _mm_max_epu8(acc, _mm_srli_si128(acc, 4));
+      acc = _mm_max_epu8(acc, _mm_srli_si128(acc, 2));
+      acc = _mm_max_epu8(acc, _mm_srli_si128(acc, 1));
+      const uint8_t result = static_cast<uint8_t>(_mm_cvtsi128_si32(acc));
+      const uint8_t tail = Scalar::maxByte(src + idx, n - idx);
+      return result > tail ? result : tail;
+    }
+  };
+#endif
+
+#if defined(BB8_ROW_KERNELS_AVX2)
+  static RowKernels avx2()
+  {
+    return {"avx2",
+            &Avx2::matchBytes,
+            &Avx2::packMatches,
+            &Avx2::replaceBytes,
+            &Avx2::nbrMasks,
+            &Avx2::maxByte};
+  }
+
+  struct Avx2 {
+    static constexpr size_t LANES = 32U;
+
+    BB8_TARGET_AVX2 static __m256i load(const uint8_t* src)
+    {
+      return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    }
+
+    BB8_TARGET_AVX2 static void store(uint8_t* dst, const __m256i v)
+    {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), v);
+    }
+
+    BB8_TARGET_AVX2 static uint64_t matchBits(const uint8_t* src,
+                                              const __m256i value)
+    {
+      return static_cast<uint32_t>(
+          _mm256_movemask_epi8(_mm256_cmpeq_epi8(load(src), value)));
+    }
+
+    BB8_TARGET_AVX2 static void matchBytes(const uint8_t* src,
+                                           const size_t n,
+                                           const uint8_t value,
+                                           uint8_t* dst)
+    {
+      const __m256i v = _mm256_set1_epi8(static_cast<char>(value));
+      size_t idx = 0;
+      for (; idx + LANES <= n; idx += LANES) {
+        store(dst + idx, _mm256_cmpeq_epi8(load(src + idx), v));
+      }
+      Scalar::matchBytes(src + idx, n - idx, value, dst + idx);
+    }
+
+    BB8_TARGET_AVX2 static void packMatches(const uint8_t* src,
+                                            const size_t n,
+                                            const uint8_t value,
+                                            uint64_t* words)
+    {
+      const __m256i v = _mm256_set1_epi8(static_cast<char>(value));
+      size_t idx = 0;
+      for (; idx + WORD_BITS <= n; idx += WORD_BITS) {
+        words[idx / WORD_BITS] =
+            matchBits(src + idx, v) | matchBits(src + idx + LANES, v) << 32U;
+      }
+      Scalar::packMatches(src + idx, n - idx, value, words + idx / WORD_BITS);
+    }
+
+    BB8_TARGET_AVX2 static void replaceBytes(uint8_t* data,
+                                             const size_t n,
+                                             const uint8_t oldVal,
+                                             const uint8_t newVal)
+    {
+      const __m256i oldV = _mm256_set1_epi8(static_cast<char>(oldVal));
+      const __m256i newV = _mm256_set1_epi8(static_cast<char>(newVal));
+      size_t idx = 0;
+      for (; idx + LANES <= n; idx += LANES) {
+        const __m256i cur = load(data + idx);
+        const __m256i eq = _mm256_cmpeq_epi8(cur, oldV);
+        if (_mm256_movemask_epi8(eq) != 0) {
+          store(data + idx, _mm256_blendv_epi8(cur, newV, eq));
+        }
+      }
+      Scalar::replaceBytes(data + idx, n - idx, oldVal, newVal);
+    }
+
+    BB8_TARGET_AVX2 static __m256i nbrBits(const uint8_t* row,
+                                           const uint8_t bits)
+    {
+      return _mm256_and_si256(load(row),
+                              _mm256_set1_epi8(static_cast<char>(bits)));
+    }
+
+    BB8_TARGET_AVX2 static void nbrMasks(const uint8_t* below,
+                                         const uint8_t* center,
+                                         const uint8_t* above,
+                                         const size_t n,
+                                         uint8_t* dst)
+    {
+      size_t idx = 0;
+      for (; idx + LANES <= n; idx += LANES) {
+        const __m256i mask = _mm256_or_si256(
+            _mm256_or_si256(
+                _mm256_or_si256(nbrBits(center + idx + 1, RIGHT),
+                                nbrBits(above + idx + 1, ABOVE_RIGHT)),
+                _mm256_or_si256(nbrBits(above + idx, ABOVE),
+                                nbrBits(above + idx - 1, ABOVE_LEFT))),
+            _mm256_or_si256(
+                _mm256_or_si256(nbrBits(center + idx - 1, LEFT),
+                                nbrBits(below + idx - 1, BELOW_LEFT)),
+                _mm256_or_si256(nbrBits(below + idx, BELOW),
+                                nbrBits(below + idx + 1, BELOW_RIGHT))));
+        store(dst + idx, mask);
+      }
+      Scalar::nbrMasks(
+          below + idx, center + idx, above + idx, n - idx, dst + idx);
+    }
+
+    BB8_TARGET_AVX2 static uint8_t maxByte(const uint8_t* src, const size_t n)
+    {
+      __m256i acc = _mm256_setzero_si256();
+      size_t idx = 0;
+      for (; idx + LANES <= n; idx += LANES) {
+        acc = _mm256_max_epu8(acc, load(src + idx));
+      }
+      // fold the lanes in halves
+      __m128i half = _mm_max_epu8(_mm256_castsi256_si128(acc),
+                                  _mm256_extracti128_si256(acc, 1));
+      half = _mm_max_epu8(half, _mm_srli_si128(half, 8));
+      half = _mm_max_epu8(half, _mm_srli_si128(half, 4));
+      half = _mm_max_epu8(half, _mm_srli_si128(half, 2));
+      half = _mm_max_epu8(half, _mm_srli_si128(half, 1));
+      const uint8_t result = static_cast<uint8_t>(_mm_cvtsi128_si32(half));
+      const uint8_t tail = Scalar::maxByte(src + idx, n - idx);
+      return result > tail ? result : tail;
+    }
+  };
+#endif
+
+#if defined(BB8_ROW_KERNELS_NEON)
+  static RowKernels neon()
+  {
+    return {"neon",
+            &Neon::matchBytes,
+            &Neon::packMatches,
+            &Neon::replaceBytes,
+            &Neon::nbrMasks,
+            &Neon::maxByte};
+  }
+
+  struct Neon {
+    static constexpr size_t LANES = 16U;
+
+    static uint64_t matchBits(const uint8_t* src, const uint8x16_t value)
+    {
+      // weight each matching lane by its bit, and sum each half into a byte
+      static constexpr uint8_t LANE_BITS[16] = {
+          1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+      const uint8x16_t bits =
+          vandq_u8(vceqq_u8(vld1q_u8(src), value), vld1q_u8(LANE_BITS));
+      return static_cast<uint64_t>(vaddv_u8(vget_low_u8(bits))) |
+             static_cast<uint64_t>(vaddv_u8(vget_high_u8(bits))) << 8U;
+    }
+
+    static void matchBytes(const uint8_t* src,
+                           const size_t n,
+                           const uint8_t value,
+                           uint8_t* dst)
+    {
+      const uint8x16_t v = vdupq_n_u8(value);
+      size_t idx = 0;
+      for (; idx + LANES <= n; idx += LANES) {
+        vst1q_u8(dst + idx, vceqq_u8(vld1q_u8(src + idx), v));
+      }
+      Scalar::matchBytes(src + idx, n - idx, value, dst + idx);
+    }
+
+    static void packMatches(const uint8_t* src,
+                            const size_t n,
+                            const uint8_t value,
+                            uint64_t* words)
+    {
+      const uint8x16_t v = vdupq_n_u8(value);
+      size_t idx = 0;
+      for (; idx + WORD_BITS <= n; idx += WORD_BITS) {
+        words[idx / WORD_BITS] = matchBits(src + idx, v) |
+                                 matchBits(src + idx + 16U, v) << 16U |
+                                 matchBits(src + idx + 32U, v) << 32U |
+                                 matchBits(src + idx + 48U, v) << 48U;
+      }
+      Scalar::packMatches(src + idx, n - idx, value, words + idx / WORD_BITS);
+    }
+
+    static void replaceBytes(uint8_t* data,
+                             const size_t n,
+                             const uint8_t oldVal,
+                             const uint8_t newVal)
+    {
+      const uint8x16_t oldV = vdupq_n_u8(oldVal);
+      const uint8x16_t newV = vdupq_n_u8(newVal);
+      size_t idx = 0;
+      for (; idx + LANES <= n; idx += LANES) {
+        const uint8x16_t cur = vld1q_u8(data + idx);
+        const uint8x16_t eq = vceqq_u8(cur, oldV);
+        if (vmaxvq_u8(eq) != 0U) {
+          vst1q_u8(data + idx, vbslq_u8(eq, newV, cur));
+        }
+      }
+      Scalar::replaceBytes(data + idx, n - idx, oldVal, newVal);
+    }
+
+    static uint8x16_t nbrBits(const uint8_t* row, const uint8_t bits)
+    {
+      return vandq_u8(vld1q_u8(row), vdupq_n_u8(bits));
+    }
+
+    static void nbrMasks(const uint8_t* below,
+                         const uint8_t* center,
+                         const uint8_t* above,
+                         const size_t n,
+                         uint8_t* dst)
+    {
+      size_t idx = 0;
+      for (; idx + LANES <= n; idx += LANES) {
+        const uint8x16_t mask = vorrq_u8(
+            vorrq_u8(vorrq_u8(nbrBits(center + idx + 1, RIGHT),
+                              nbrBits(above + idx + 1, ABOVE_RIGHT)),
+                     vorrq_u8(nbrBits(above + idx, ABOVE),
+                              nbrBits(above + idx - 1, ABOVE_LEFT))),
+            vorrq_u8(vorrq_u8(nbrBits(center + idx - 1, LEFT),
+                              nbrBits(below + idx - 1, BELOW_LEFT)),
+                     vorrq_u8(nbrBits(below + idx, BELOW),
+                              nbrBits(below + idx + 1, BELOW_RIGHT))));
+        vst1q_u8(dst + idx, mask);
+      }
+      Scalar::nbrMasks(
+          below + idx, center + idx, above + idx, n - idx, dst + idx);
+    }
+
+    static uint8_t maxByte(const uint8_t* src, const size_t n)
+    {
+      uint8x16_t acc = vdupq_n_u8(0U);
+      size_t idx = 0;
+      for (; idx + LANES <= n; idx += LANES) {
+        acc = vmaxq_u8(acc, vld1q_u8(src + idx));
+      }
+      const uint8_t result = vmaxvq_u8(acc);
+      const uint8_t tail = Scalar::maxByte(src + idx, n - idx);
+      return result > tail ? result : tail;
+    }
+  };
+#endif
+};
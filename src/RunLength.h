@@ -0,0 +1,273 @@
+/**
+ * @file RunLength.h
+ * @brief File containing streaming run-length encoding of byte sequences.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief Class for incrementally calculating the 64-bit FNV-1a hash of a
+ * sequence of bytes.
+ */
+class Fnv1a
+{
+  public:
+  Fnv1a() : m_hash(OFFSET_BASIS)
+  {
+    // do nothing
+  }
+
+  void update(const std::byte* data, const size_t size)
+  {
+    for (size_t idx = 0; idx < size; ++idx) {
+      m_hash ^= static_cast<uint64_t>(data[idx]);
+      m_hash *= PRIME;
+    }
+  }
+
+  uint64_t value() const
+  {
+    return m_hash;
+  }
+
+  private:
+  static constexpr uint64_t OFFSET_BASIS = 14695981039346656037ULL;
+  static constexpr uint64_t PRIME = 1099511628211ULL;
+
+  uint64_t m_hash;
+};
+
+/**
+ * @brief Class for run-length encoding bytes to a stream. Each run is stored
+ * as its byte value followed by its length less one, as a LEB128 variable
+ * length integer. Runs continue across calls to write(), so the input may be
+ * supplied in pieces (e.g., row by row), and the encoded output is buffered in
+ * fixed-size blocks, so neither the whole input nor output need be held.
+ */
+class RunLengthWriter
+{
+  public:
+  explicit RunLengthWriter(std::ostream& outStream)
+      : m_outStream(outStream),
+        m_buffer(BUFFER_SIZE),
+        m_bufferSize(0U),
+        m_runValue(),
+        m_runLength(0U),
+        m_bytesWritten(0U)
+  {
+    // do nothing
+  }
+
+  RunLengthWriter(const RunLengthWriter&) = delete;
+  RunLengthWriter& operator=(const RunLengthWriter&) = delete;
+
+  /**
+   * @brief Encode the next bytes of the input.
+   */
+  void write(const std::byte* data, const size_t size)
+  {
+    size_t idx = 0;
+    while (idx < size) {
+      if (m_runLength > 0U && data[idx] != m_runValue) {
+        emitRun();
+      }
+      if (m_runLength == 0U) {
+        m_runValue = data[idx];
+      }
+      const std::byte* runEnd =
+          std::find_if(data + idx, data + size, [this](const std::byte b) {
+            return b != m_runValue;
+          });
+      const size_t runEndIdx = static_cast<size_t>(runEnd - data);
+      m_runLength += runEndIdx - idx;
+      idx = runEndIdx;
+    }
+  }
+
+  /**
+   * @brief Encode the final run and flush the output to the stream. Must be
+   * called once all input has been written.
+   */
+  void finish()
+  {
+    if (m_runLength > 0U) {
+      emitRun();
+    }
+    flush();
+  }
+
+  /**
+   * @brief Get the hash of the encoded bytes written to the stream.
+   */
+  uint64_t checksum() const
+  {
+    return m_checksum.value();
+  }
+
+  /**
+   * @brief Get the number of encoded bytes written to the stream.
+   */
+  size_t bytesWritten() const
+  {
+    return m_bytesWritten;
+  }
+
+  private:
+  static constexpr size_t BUFFER_SIZE = 1U << 16U;
+  // a byte value plus a 64-bit LEB128 integer
+  static constexpr size_t MAX_RUN_BYTES = 11U;
+
+  void emitRun()
+  {
+    if (m_bufferSize + MAX_RUN_BYTES > m_buffer.size()) {
+      flush();
+    }
+    m_buffer[m_bufferSize++] = m_runValue;
+    uint64_t remaining = m_runLength - 1U;
+    do {
+      auto byte = static_cast<uint8_t>(remaining & 0x7FU);
+      remaining >>= 7U;
+      if (remaining > 0U) {
+        byte |= 0x80U;
+      }
+      m_buffer[m_bufferSize++] = static_cast<std::byte>(byte);
+    } while (remaining > 0U);
+    m_runLength = 0U;
+  }
+
+  void flush()
+  {
+    m_checksum.update(m_buffer.data(), m_bufferSize);
+    m_outStream.write(reinterpret_cast<const char*>(m_buffer.data()),
+                      static_cast<std::streamsize>(m_bufferSize));
+    m_bytesWritten += m_bufferSize;
+    m_bufferSize = 0U;
+  }
+
+  std::ostream& m_outStream;
+  std::vector<std::byte> m_buffer;
+  size_t m_bufferSize;
+  std::byte m_runValue;
+  size_t m_runLength;
+  size_t m_bytesWritten;
+  Fnv1a m_checksum;
+};
+
+/**
+ * @brief Class for decoding bytes from a stream, as encoded by
+ * RunLengthWriter. The encoded input is read in fixed-size blocks and runs
+ * may be split across calls to read(), so the output may be decoded in pieces
+ * directly into its destination.
+ */
+class RunLengthReader
+{
+  public:
+  explicit RunLengthReader(std::istream& inStream)
+      : m_inStream(inStream),
+        m_buffer(BUFFER_SIZE),
+        m_bufferPos(0U),
+        m_bufferSize(0U),
+        m_runValue(),
+        m_runRemaining(0U)
+  {
+    // do nothing
+  }
+
+  RunLengthReader(const RunLengthReader&) = delete;
+  RunLengthReader& operator=(const RunLengthReader&) = delete;
+
+  /**
+   * @brief Decode exactly the given number of bytes.
+   * NOTE: Throws if the encoded input ends first.
+   */
+  void read(std::byte* data, const size_t size)
+  {
+    size_t idx = 0;
+    while (idx < size) {
+      if (m_runRemaining == 0U) {
+        readRun();
+      }
+      const size_t count =
+          static_cast<size_t>(std::min<uint64_t>(m_runRemaining, size - idx));
+      std::memset(data + idx, static_cast<int>(m_runValue), count);
+      m_runRemaining -= count;
+      idx += count;
+    }
+  }
+
+  /**
+   * @brief Check that the encoded input has been entirely consumed.
+   * NOTE: Throws if runs or bytes remain.
+   */
+  void finish()
+  {
+    if (m_runRemaining > 0U || m_bufferPos < m_bufferSize ||
+        m_inStream.peek() != std::istream::traits_type::eof()) {
+      throw std::runtime_error(
+          "Run-length encoded input is longer than expected");
+    }
+  }
+
+  /**
+   * @brief Get the hash of the encoded bytes consumed from the stream.
+   */
+  uint64_t checksum() const
+  {
+    return m_checksum.value();
+  }
+
+  private:
+  static constexpr size_t BUFFER_SIZE = 1U << 16U;
+  static constexpr size_t MAX_LENGTH_BYTES = 10U;
+
+  void readRun()
+  {
+    m_runValue = nextByte();
+    uint64_t length = 0U;
+    for (size_t shift = 0;; shift += 7U) {
+      if (shift >= 7U * MAX_LENGTH_BYTES) {
+        throw std::runtime_error("Invalid run length in encoded input");
+      }
+      const auto byte = static_cast<uint8_t>(nextByte());
+      length |= static_cast<uint64_t>(byte & 0x7FU) << shift;
+      if ((byte & 0x80U) == 0U) {
+        break;
+      }
+    }
+    m_runRemaining = length + 1U;
+  }
+
+  std::byte nextByte()
+  {
+    if (m_bufferPos == m_bufferSize) {
+      m_inStream.read(reinterpret_cast<char*>(m_buffer.data()),
+                      static_cast<std::streamsize>(m_buffer.size()));
+      m_bufferSize = static_cast<size_t>(m_inStream.gcount());
+      m_bufferPos = 0U;
+      if (m_bufferSize == 0U) {
+        throw std::runtime_error("Run-length encoded input is truncated");
+      }
+      m_checksum.update(m_buffer.data(), m_bufferSize);
+    }
+    return m_buffer[m_bufferPos++];
+  }
+
+  std::istream& m_inStream;
+  std::vector<std::byte> m_buffer;
+  size_t m_bufferPos;
+  size_t m_bufferSize;
+  std::byte m_runValue;
+  uint64_t m_runRemaining;
+  Fnv1a m_checksum;
+};
@@ -0,0 +1,208 @@
+/**
+ * @file Scenarios.h
+ * @brief File containing the pre-configured obstacle cases, scaled to the size
+ * of the task space.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#pragma once
+
+#include "Cell.h"
+#include "Grid.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Enumerator for the pre-configured obstacle cases:
+ * 1- no obstacles
+ * 2- impossible path- single circle in center of domain = max(M, N)
+ * 3- simple path, following diagonal- circles at opposite corners from start
+ *    and goal
+ * 4- more complex path
+ * 5- Maze- staggered barriers
+ */
+enum class obstacle_config { NONE = 1, IMPOSSIBLE, SIMPLE, COMPLEX, MAZE };
+
+constexpr std::array<obstacle_config, 5> ALL_OBSTACLE_CONFIGS = {
+    obstacle_config::NONE,
+    obstacle_config::IMPOSSIBLE,
+    obstacle_config::SIMPLE,
+    obstacle_config::COMPLEX,
+    obstacle_config::MAZE};
+
+/**
+ * @brief Class for generating the obstacles of the pre-configured cases.
+ */
+class Scenarios
+{
+  public:
+  /**
+   * @brief Convert a case number (as given on the command line) to its
+   * obstacle configuration.
+   */
+  static obstacle_config fromInt(const int caseNum)
+  {
+    if (caseNum < static_cast<int>(obstacle_config::NONE) ||
+        caseNum > static_cast<int>(obstacle_config::MAZE)) {
+      throw std::runtime_error("Invalid obstacleCase argument: " +
+                               std::to_string(caseNum));
+    }
+    return static_cast<obstacle_config>(caseNum);
+  }
+
+  static const char* name(const obstacle_config config)
+  {
+    switch (config) {
+      case obstacle_config::NONE:
+        return "NONE";
+      case obstacle_config::IMPOSSIBLE:
+        return "IMPOSSIBLE";
+      case obstacle_config::SIMPLE:
+        return "SIMPLE";
+      case obstacle_config::COMPLEX:
+        return "COMPLEX";
+      case obstacle_config::MAZE:
+        return "MAZE";
+    }
+    return "UNKNOWN";
+  }
+
+  /**
+   * @brief Generate the obstacles of a pre-configured case, scaled to the task
+   * space.
+   *
+   * @param config The obstacle case
+   * @param nx The number of cells in the x direction
+   * @param ny The number of cells in the y direction
+   * @param robotRadius The robot's radius, in cells
+   * @return std::vector<Circle> The obstacles
+   */
+  static std::vector<Circle> obstacles(const obstacle_config config,
+                                       const size_t nx,
+                                       const size_t ny,
+                                       const size_t robotRadius)
+  {
+    std::vector<Circle> obstacles;
+    switch (config) {
+      case obstacle_config::NONE: {
+        // nothing to do here
+        break;
+      }
+      case obstacle_config::IMPOSSIBLE: {
+        // single circle in center of domain with radius spanning the narrow
+        // dimension
+        const size_t minRadius = std::min(nx, ny) / 2;
+        const Cell midPt = Cell(nx / 2, ny / 2);
+        obstacles.emplace_back(Circle(midPt, minRadius));
+        break;
+      }
+      case obstacle_config::SIMPLE: {
+        // two circles at opposite corners
+        const size_t radius = scaledRadius(nx, ny, 2, robotRadius);
+        obstacles.emplace_back(Circle({0, ny - 1}, radius));
+        obstacles.emplace_back(Circle({nx - 1, 0}, radius));
+        break;
+      }
+      case obstacle_config::COMPLEX: {
+        const size_t radius = scaledRadius(nx, ny, 8, robotRadius);
+        obstacles.emplace_back(Circle({0, ny / 4}, radius));
+        obstacles.emplace_back(Circle({0, ny / 2}, radius));
+        obstacles.emplace_back(Circle({0, 3 * ny / 4}, radius));
+
+        obstacles.emplace_back(Circle({nx / 4, 0}, radius));
+        obstacles.emplace_back(Circle({nx / 4, ny / 3}, radius));
+        obstacles.emplace_back(Circle({nx / 4, 2 * ny / 3}, radius));
+        obstacles.emplace_back(Circle({nx / 4, ny - 1}, radius));
+
+        obstacles.emplace_back(Circle({nx / 2, ny / 4}, radius));
+        obstacles.emplace_back(Circle({nx / 2, ny / 2}, radius));
+        obstacles.emplace_back(Circle({nx / 2, 3 * ny / 4}, radius));
+
+        obstacles.emplace_back(Circle({3 * nx / 4, 0}, radius));
+        obstacles.emplace_back(Circle({3 * nx / 4, ny / 3}, radius));
+        obstacles.emplace_back(Circle({3 * nx / 4, 2 * ny / 3}, radius));
+        obstacles.emplace_back(Circle({3 * nx / 4, ny - 1}, radius));
+
+        obstacles.emplace_back(Circle({nx - 1, ny / 4}, radius));
+        obstacles.emplace_back(Circle({nx - 1, ny / 2}, radius));
+        obstacles.emplace_back(Circle({nx - 1, 3 * ny / 4}, radius));
+        break;
+      }
+      case obstacle_config::MAZE: {
+        const size_t radius = scaledRadius(nx, ny, 10, robotRadius);
+        obstacles.emplace_back(Circle({nx / 5, 0}, radius));
+        obstacles.emplace_back(Circle({nx / 5, ny / 6}, radius));
+        obstacles.emplace_back(Circle({nx / 5, ny / 3}, radius));
+        obstacles.emplace_back(Circle({nx / 5, ny / 2}, radius));
+        obstacles.emplace_back(Circle({nx / 5, 2 * ny / 3}, radius));
+        obstacles.emplace_back(Circle({nx / 5, 5 * ny / 6}, radius));
+
+        obstacles.emplace_back(Circle({2 * nx / 5, ny / 6}, radius));
+        obstacles.emplace_back(Circle({2 * nx / 5, ny / 3}, radius));
+        obstacles.emplace_back(Circle({2 * nx / 5, ny / 2}, radius));
+        obstacles.emplace_back(Circle({2 * nx / 5, 2 * ny / 3}, radius));
+        obstacles.emplace_back(Circle({2 * nx / 5, 5 * ny / 6}, radius));
+        obstacles.emplace_back(Circle({2 * nx / 5, ny - 1}, radius));
+
+        obstacles.emplace_back(Circle({3 * nx / 5, 0}, radius));
+        obstacles.emplace_back(Circle({3 * nx / 5, ny / 6}, radius));
+        obstacles.emplace_back(Circle({3 * nx / 5, ny / 3}, radius));
+        obstacles.emplace_back(Circle({3 * nx / 5, ny / 2}, radius));
+        obstacles.emplace_back(Circle({3 * nx / 5, 2 * ny / 3}, radius));
+        obstacles.emplace_back(Circle({3 * nx / 5, 5 * ny / 6}, radius));
+
+        obstacles.emplace_back(Circle({4 * nx / 5, ny / 6}, radius));
+        obstacles.emplace_back(Circle({4 * nx / 5, ny / 3}, radius));
+        obstacles.emplace_back(Circle({4 * nx / 5, ny / 2}, radius));
+        obstacles.emplace_back(Circle({4 * nx / 5, 2 * ny / 3}, radius));
+        obstacles.emplace_back(Circle({4 * nx / 5, 5 * ny / 6}, radius));
+        obstacles.emplace_back(Circle({4 * nx / 5, ny - 1}, radius));
+        break;
+      }
+      default:
+        throw std::runtime_error("Invalid obstacleCase argument: " +
+                                 std::to_string(static_cast<int>(config)));
+    }
+    return obstacles;
+  }
+
+  /**
+   * @brief The start position used by the pre-configured cases, at the bottom
+   * corner.
+   */
+  static Cell start(const size_t /* nx */,
+                    const size_t /* ny */,
+                    const size_t robotRadius)
+  {
+    return {robotRadius + 1, robotRadius + 1};
+  }
+
+  /**
+   * @brief The goal position used by the pre-configured cases, at the corner
+   * opposite the start.
+   */
+  static Cell goal(const size_t nx, const size_t ny, const size_t robotRadius)
+  {
+    return {nx - robotRadius - 1, ny - robotRadius - 1};
+  }
+
+  private:
+  /**
+   * @brief The obstacle radius of a fraction of the narrow dimension, shrunk
+   * by the robot radius so the padded obstacles keep the same footprint.
+   * NOTE: clamped at zero for robots which are large relative to the space.
+   */
+  static size_t scaledRadius(const size_t nx,
+                             const size_t ny,
+                             const size_t divisor,
+                             const size_t robotRadius)
+  {
+    const size_t radius = std::min(nx, ny) / divisor;
+    return radius > robotRadius ? radius - robotRadius : 0U;
+  }
+};
@@ -0,0 +1,118 @@
+/**
+ * @file SearchStats.h
+ * @brief File containing the outcome and instrumentation data reported by the
+ * path-finding algorithms for each query.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+/**
+ * @brief Enumerator for indicating the outcome of a path search.
+ */
+enum class search_status : uint8_t {
+  FOUND,
+  NOT_FOUND,
+  START_OUTSIDE,
+  GOAL_OUTSIDE,
+  START_BLOCKED,
+  GOAL_BLOCKED,
+  START_AT_GOAL,
+  UNREACHABLE,
+  BUDGET_EXHAUSTED,
+  CANCELLED,
+  MAP_CHANGED
+};
+
+inline std::ostream& operator<<(std::ostream& os, const search_status status)
+{
+  switch (status) {
+    case search_status::FOUND:
+      return os << "Goal found";
+    case search_status::NOT_FOUND:
+      return os << "Goal not found";
+    case search_status::START_OUTSIDE:
+      return os << "Start point is not in the grid";
+    case search_status::GOAL_OUTSIDE:
+      return os << "Goal point is not in the grid";
+    case search_status::START_BLOCKED:
+      return os << "Start point is not accessible";
+    case search_status::GOAL_BLOCKED:
+      return os << "Goal point is not accessible";
+    case search_status::START_AT_GOAL:
+      return os << "Start position is already at goal";
+    case search_status::UNREACHABLE:
+      return os << "Goal is not connected to the start";
+    case search_status::BUDGET_EXHAUSTED:
+      return os << "Search budget exhausted before a path was found";
+    case search_status::CANCELLED:
+      return os << "Search was cancelled";
+    case search_status::MAP_CHANGED:
+      return os << "Configuration space changed since the search was updated";
+  }
+  return os << "Unknown search status";
+}
+
+/**
+ * @brief Structure containing the outcome of a single path search, with
+ * counters and timings for comparing planners and monitoring query latency.
+ */
+struct SearchStats {
+  using duration = std::chrono::nanoseconds;
+
+  search_status status = search_status::NOT_FOUND;
+
+  // nodes taken from the open list and expanded
+  size_t nodesExpanded = 0U;
+  // open list operations, where stale pops are entries skipped as already
+  // explored (only possible with open lists without decrease-key)
+  size_t heapPushes = 0U;
+  size_t heapDecreaseKeys = 0U;
+  size_t heapPops = 0U;
+  size_t stalePops = 0U;
+  size_t peakOpenListSize = 0U;
+
+  // memory held by the search workspace, in bytes
+  size_t workspaceBytes = 0U;
+
+  // whether the path was answered from a cache without searching (see
+  // CachedPlanner)
+  bool cacheHit = false;
+
+  // the factor by which the path cost may exceed the optimal cost, for
+  // searches which trade optimality for speed (see BasicAnytimeAStar)
+  double suboptimalityBound = 1.0;
+
+  // wall time spent validating the query and preparing the workspace, in the
+  // search loop, and generating the path
+  duration setupTime = duration::zero();
+  duration searchTime = duration::zero();
+  duration pathTime = duration::zero();
+
+  duration totalTime() const
+  {
+    return setupTime + searchTime + pathTime;
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const SearchStats& stats)
+  {
+    os << stats.status << (stats.cacheHit ? " (cached)" : "");
+    if (stats.suboptimalityBound > 1.0) {
+      os << " (at most " << stats.suboptimalityBound << " times optimal)";
+    }
+    return os << ": expanded " << stats.nodesExpanded
+              << " nodes, " << stats.heapPushes << " pushes, "
+              << stats.heapDecreaseKeys << " decrease-keys, "
+              << stats.heapPops << " pops (" << stats.stalePops
+              << " stale), peak open list " << stats.peakOpenListSize
+              << ", workspace " << stats.workspaceBytes << " bytes, setup "
+              << stats.setupTime.count() << " ns, search "
+              << stats.searchTime.count() << " ns, path "
+              << stats.pathTime.count() << " ns";
+  }
+};
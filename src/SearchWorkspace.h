@@ -0,0 +1,251 @@
+/**
+ * @file SearchWorkspace.h
+ * @brief File containing the per-node search state used by the path finding
+ * algorithms, and a reusable workspace for storing it between queries.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#pragma once
+
+#include "Cell.h"
+#include "Grid.h"
+#include "OpenList.h"
+#include "TiledGrid.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Structure describing the row-major layout of the per-node search
+ * state, stored densely for every cell of the grid.
+ */
+struct RowMajorLayout : public GridIndexer {
+  template <typename T>
+  using array_type = std::vector<T>;
+
+  RowMajorLayout() : GridIndexer(0U, 0U)
+  {
+    // do nothing
+  }
+
+  explicit RowMajorLayout(const GridIndexer& grid) : GridIndexer(grid)
+  {
+    // do nothing
+  }
+
+  size_t storageSize() const
+  {
+    return size();
+  }
+
+  Cell cellFrom(const size_t idx) const
+  {
+    return Cell(idx % numX(), idx / numX());
+  }
+};
+
+/**
+ * @brief Structure describing the tiled layout of the per-node search state
+ * (see TileIndexer), where storage is only allocated for the tiles touched by
+ * a search. The memory held then depends on the area explored rather than the
+ * map size, and the neighbors of a node are close in memory on tall maps.
+ */
+struct TiledLayout : public TileIndexer {
+  template <typename T>
+  using array_type = PagedArray<T, TILE_CELLS>;
+
+  TiledLayout() : TileIndexer()
+  {
+    // do nothing
+  }
+
+  explicit TiledLayout(const GridIndexer& grid) : TileIndexer(grid.shape())
+  {
+    // do nothing
+  }
+};
+
+/**
+ * @brief Class holding the state of every node in a search, which may be kept
+ * by the caller and reused between queries on maps of the same shape. Nodes
+ * are identified by their linear cell index (see idxFrom / cellFrom), and
+ * their state is held as a structure of arrays: a 2-byte stamp, a 4-byte
+ * parent index and the g-cost, so a node takes 10 bytes with integer costs.
+ * The f-cost of an open node is only held as its key in the open list.
+ * NOTE: rather than clearing the node data for each query, every cell is
+ * stamped with the generation (query) it was last touched in, so the cost of
+ * starting a new query is independent of the map size. The stamps are only
+ * cleared once the generations wrap around, every 32767 queries.
+ *
+ * @tparam OpenListT The open list type, keyed on the path cost type.
+ * @tparam Layout The layout of the node state (see RowMajorLayout and
+ * TiledLayout).
+ */
+template <typename OpenListT, typename Layout = RowMajorLayout>
+class BasicSearchWorkspace
+{
+  public:
+  using open_list_type = OpenListT;
+  using cost_type = typename OpenListT::key_type;
+  using index_type = uint32_t;
+  using layout_type = Layout;
+
+  BasicSearchWorkspace() : m_generation(0U)
+  {
+    // do nothing
+  }
+
+  /**
+   * @brief Prepare the workspace for a new query over the given grid. Memory
+   * is only (re)allocated if the grid shape differs from the previous query.
+   *
+   * @param grid The grid to be searched.
+   */
+  void reset(const GridIndexer& grid)
+  {
+    if (grid.shape() != m_layout.shape()) {
+      assert(Layout(grid).storageSize() <=
+             size_t{std::numeric_limits<index_type>::max()} + 1U);
+      m_layout = Layout(grid);
+      m_stamps.assign(m_layout.storageSize(), 0U);
+      m_parents.assign(m_layout.storageSize(), 0U);
+      m_gCosts.assign(m_layout.storageSize(), cost_type());
+      m_generation = 0U;
+    }
+
+    // start a new generation, clearing the stamps only once they wrap around
+    if (m_generation == MAX_GENERATION) {
+      m_stamps.assign(m_layout.storageSize(), 0U);
+      m_generation = 0U;
+    }
+    ++m_generation;
+    m_openList.reset(m_layout.storageSize());
+  }
+
+  /**
+   * @brief Record a path to a node, from the given parent and with the given
+   * g-cost, marking it as visited (but not explored) by the current query.
+   * NOTE: the start node is its own parent.
+   */
+  void visit(const index_type idx, const index_type parent, const cost_type g)
+  {
+    m_stamps[idx] = static_cast<uint16_t>(m_generation << 1);
+    m_parents[idx] = parent;
+    m_gCosts[idx] = g;
+  }
+
+  /**
+   * @brief Check whether the node has been visited by the current query.
+   */
+  bool isVisited(const index_type idx) const
+  {
+    return (std::as_const(m_stamps)[idx] >> 1) == m_generation;
+  }
+
+  /**
+   * @brief Check whether the node has been explored (closed) by the current
+   * query.
+   */
+  bool isExplored(const index_type idx) const
+  {
+    return std::as_const(m_stamps)[idx] == ((m_generation << 1) | 1U);
+  }
+
+  /**
+   * @brief Mark a visited node as explored (closed) in the current query.
+   */
+  void markExplored(const index_type idx)
+  {
+    assert(isVisited(idx));
+    m_stamps[idx] |= 1U;
+  }
+
+  /**
+   * @brief Mark an explored node as only visited again, keeping its parent and
+   * g-cost, for searches which reopen nodes (e.g., ARA*).
+   */
+  void markUnexplored(const index_type idx)
+  {
+    assert(isExplored(idx));
+    m_stamps[idx] &= static_cast<uint16_t>(~1U);
+  }
+
+  /**
+   * @brief Get the g-cost of a node visited by the current query.
+   */
+  cost_type gCost(const index_type idx) const
+  {
+    assert(isVisited(idx));
+    return std::as_const(m_gCosts)[idx];
+  }
+
+  /**
+   * @brief Get the parent of a node visited by the current query.
+   */
+  index_type parent(const index_type idx) const
+  {
+    assert(isVisited(idx));
+    return std::as_const(m_parents)[idx];
+  }
+
+  /**
+   * @brief The open list of the current query, kept to reuse its storage. Items
+   * in the open list are linear cell indices.
+   */
+  OpenListT& openList()
+  {
+    return m_openList;
+  }
+
+  /**
+   * @brief The number of bytes currently held by the workspace.
+   */
+  size_t bytes() const
+  {
+    return m_stamps.capacity() * sizeof(uint16_t) +
+           m_parents.capacity() * sizeof(index_type) +
+           m_gCosts.capacity() * sizeof(cost_type) + m_openList.bytes();
+  }
+
+  /**
+   * @brief Get the linear index of a cell, as used for open list items.
+   */
+  index_type idxFrom(const Cell& c) const
+  {
+    return static_cast<index_type>(m_layout.idxFrom(c));
+  }
+
+  /**
+   * @brief Get the cell at a linear index.
+   */
+  Cell cellFrom(const size_t idx) const
+  {
+    return m_layout.cellFrom(idx);
+  }
+
+  private:
+  // the lowest stamp bit is used for the explored flag
+  static constexpr uint16_t MAX_GENERATION =
+      std::numeric_limits<uint16_t>::max() >> 1;
+
+  Layout m_layout;
+  typename Layout::template array_type<uint16_t> m_stamps;
+  typename Layout::template array_type<index_type> m_parents;
+  typename Layout::template array_type<cost_type> m_gCosts;
+  uint16_t m_generation;
+  OpenListT m_openList;
+};
+
+using SearchWorkspace = BasicSearchWorkspace<IndexedHeap<double>>;
+
+/**
+ * @brief Indexed heap storing its item positions in the tiles of a
+ * TiledLayout, for use with tiled workspaces.
+ */
+template <typename Key>
+using TiledIndexedHeap = IndexedHeap<Key, 4, TiledLayout::array_type<uint32_t>>;
@@ -0,0 +1,123 @@
+/**
+ * @file ThreadPool.h
+ * @brief File containing a fixed-size thread pool used for running planning
+ * tasks concurrently.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Class providing a fixed number of worker threads, which are created
+ * once and run submitted tasks in FIFO order until the pool is destroyed.
+ * Each task is passed the index of the worker running it, in [0, size()), so
+ * callers may keep per-worker state (e.g., search workspaces) without locking.
+ * NOTE: a worker only runs one task at a time, so per-worker state is never
+ * accessed concurrently.
+ */
+class ThreadPool
+{
+  public:
+  /**
+   * @brief Construct a new Thread Pool object.
+   *
+   * @param numWorkers The number of worker threads. If zero, the number of
+   * hardware threads is used.
+   */
+  explicit ThreadPool(const size_t numWorkers = 0U) : m_stopping(false)
+  {
+    const size_t count =
+        numWorkers > 0U
+            ? numWorkers
+            : std::max<size_t>(1U, std::thread::hardware_concurrency());
+    m_workers.reserve(count);
+    for (size_t workerIdx = 0; workerIdx < count; ++workerIdx) {
+      m_workers.emplace_back([this, workerIdx]() { run(workerIdx); });
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * @brief Destroy the Thread Pool object, after finishing all queued tasks.
+   */
+  ~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stopping = true;
+    }
+    m_condition.notify_all();
+    for (auto& worker : m_workers) {
+      worker.join();
+    }
+  }
+
+  size_t size() const
+  {
+    return m_workers.size();
+  }
+
+  /**
+   * @brief Submit a task to be run by the next available worker.
+   * NOTE: waiting on the returned future from within a task may deadlock if
+   * all workers are busy.
+   *
+   * @param task The task, invoked as task(workerIdx).
+   * @return std::future The future result of the task.
+   */
+  template <typename F>
+  auto submit(F&& task) -> std::future<std::invoke_result_t<F, size_t>>
+  {
+    using result_type = std::invoke_result_t<F, size_t>;
+    auto packaged = std::make_shared<std::packaged_task<result_type(size_t)>>(
+        std::forward<F>(task));
+    std::future<result_type> result = packaged->get_future();
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_tasks.emplace_back(
+          [packaged](const size_t workerIdx) { (*packaged)(workerIdx); });
+    }
+    m_condition.notify_one();
+    return result;
+  }
+
+  private:
+  std::vector<std::thread> m_workers;
+  std::deque<std::function<void(size_t)>> m_tasks;
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  bool m_stopping;
+
+  void run(const size_t workerIdx)
+  {
+    while (true) {
+      std::function<void(size_t)> task;
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock,
+                         [this]() { return m_stopping || !m_tasks.empty(); });
+        if (m_tasks.empty()) {
+          return;
+        }
+        task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+      }
+      task(workerIdx);
+    }
+  }
+};
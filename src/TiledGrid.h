@@ -0,0 +1,727 @@
+/**
+ * @file TiledGrid.h
+ * @brief File containing class definitions for storing data on a 2D grid in
+ * lazily allocated square tiles, for very large, mostly uniform maps.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#pragma once
+
+#include "Cell.h"
+#include "Grid.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Class providing a 1D array of values stored in fixed-size pages,
+ * which are only allocated once written to. Unallocated pages read as a single
+ * fill value, so an array which is mostly the fill value takes little memory.
+ *
+ * @tparam T The data type.
+ * @tparam PageSize The number of values per page, a power of two.
+ */
+template <typename T, size_t PageSize>
+class PagedArray
+{
+  static_assert((PageSize & (PageSize - 1)) == 0,
+                "Page size must be a power of two");
+
+  public:
+  using value_type = T;
+
+  PagedArray() : m_size(0U), m_fill(), m_numAllocated(0U)
+  {
+    // do nothing
+  }
+
+  PagedArray(const size_t size, const T& fill) : PagedArray()
+  {
+    assign(size, fill);
+  }
+
+  PagedArray(const PagedArray& other)
+      : m_pages(other.m_pages.size()),
+        m_size(other.m_size),
+        m_fill(other.m_fill),
+        m_numAllocated(other.m_numAllocated)
+  {
+    for (size_t pageIdx = 0; pageIdx < m_pages.size(); ++pageIdx) {
+      if (other.m_pages[pageIdx]) {
+        m_pages[pageIdx] = std::make_unique<T[]>(PageSize);
+        std::copy(other.m_pages[pageIdx].get(),
+                  other.m_pages[pageIdx].get() + PageSize,
+                  m_pages[pageIdx].get());
+      }
+    }
+  }
+
+  PagedArray(PagedArray&& other) noexcept = default;
+
+  PagedArray& operator=(PagedArray other) noexcept
+  {
+    std::swap(m_pages, other.m_pages);
+    std::swap(m_size, other.m_size);
+    std::swap(m_fill, other.m_fill);
+    std::swap(m_numAllocated, other.m_numAllocated);
+    return *this;
+  }
+
+  /**
+   * @brief Resize the array, with every value reading as the fill value. All
+   * pages are released.
+   */
+  void assign(const size_t size, const T& fill)
+  {
+    m_pages.clear();
+    m_pages.resize((size + PageSize - 1) / PageSize);
+    m_size = size;
+    m_fill = fill;
+    m_numAllocated = 0U;
+  }
+
+  size_t size() const
+  {
+    return m_size;
+  }
+
+  /**
+   * @brief Read a value, without allocating its page.
+   */
+  const T& operator[](const size_t idx) const
+  {
+    assert(idx < m_size);
+    const std::unique_ptr<T[]>& page = m_pages[idx / PageSize];
+    return page ? page[idx % PageSize] : m_fill;
+  }
+
+  /**
+   * @brief Get a writable value, allocating its page if needed.
+   */
+  T& operator[](const size_t idx)
+  {
+    assert(idx < m_size);
+    return page(idx / PageSize)[idx % PageSize];
+  }
+
+  /**
+   * @brief Get the values of a page, allocating it if needed.
+   */
+  T* page(const size_t pageIdx)
+  {
+    std::unique_ptr<T[]>& page = m_pages[pageIdx];
+    if (!page) {
+      page = std::make_unique<T[]>(PageSize);
+      std::fill(page.get(), page.get() + PageSize, m_fill);
+      ++m_numAllocated;
+    }
+    return page.get();
+  }
+
+  bool isAllocated(const size_t pageIdx) const
+  {
+    return m_pages[pageIdx] != nullptr;
+  }
+
+  /**
+   * @brief Get the values of a page, or nullptr if it is not allocated.
+   */
+  const T* findPage(const size_t pageIdx) const
+  {
+    return m_pages[pageIdx].get();
+  }
+
+  /**
+   * @brief Release a page, so its values read as the fill value.
+   */
+  void release(const size_t pageIdx)
+  {
+    if (m_pages[pageIdx]) {
+      m_pages[pageIdx].reset();
+      --m_numAllocated;
+    }
+  }
+
+  /**
+   * @brief Release the pages holding only the fill value.
+   */
+  void compact()
+  {
+    for (size_t pageIdx = 0; pageIdx < m_pages.size(); ++pageIdx) {
+      const T* values = m_pages[pageIdx].get();
+      if (values && std::all_of(values, values + PageSize, [this](const T& v) {
+            return v == m_fill;
+          })) {
+        release(pageIdx);
+      }
+    }
+  }
+
+  size_t numPages() const
+  {
+    return m_pages.size();
+  }
+
+  size_t numAllocated() const
+  {
+    return m_numAllocated;
+  }
+
+  /**
+   * @brief The number of values with allocated storage.
+   */
+  size_t capacity() const
+  {
+    return m_numAllocated * PageSize;
+  }
+
+  size_t bytes() const
+  {
+    return capacity() * sizeof(T) +
+           m_pages.capacity() * sizeof(std::unique_ptr<T[]>);
+  }
+
+  private:
+  std::vector<std::unique_ptr<T[]>> m_pages;
+  size_t m_size;
+  T m_fill;
+  size_t m_numAllocated;
+};
+
+/**
+ * @brief Class used to provide the indexing of a 2D cartesian grid of cells
+ * stored in square tiles. Tiles are ordered row-major across the grid, as are
+ * the cells within each tile, so the 8-neighbors of a cell are at most a tile
+ * row apart in memory (rather than a grid row), unless on the tile's border.
+ * NOTE: the grid is padded to a whole number of tiles in each direction.
+ */
+class TileIndexer
+{
+  public:
+  static constexpr size_t TILE_BITS = 6;
+  static constexpr size_t TILE_DIM = size_t{1} << TILE_BITS;
+  static constexpr size_t TILE_CELLS = TILE_DIM * TILE_DIM;
+
+  TileIndexer() : TileIndexer(0U, 0U)
+  {
+    // do nothing
+  }
+
+  TileIndexer(const size_t nx, const size_t ny)
+      : m_nx(nx),
+        m_ny(ny),
+        m_tilesX((nx + TILE_DIM - 1) / TILE_DIM),
+        m_tilesY((ny + TILE_DIM - 1) / TILE_DIM)
+  {
+    // do nothing
+  }
+
+  TileIndexer(const std::pair<size_t, size_t>& shape)
+      : TileIndexer(shape.first, shape.second)
+  {
+    // do nothing
+  }
+
+  /**
+   * @brief Get the collapsed 1D (tile-major) index, given the 2D cartesian
+   * indices.
+   */
+  size_t idxFrom(const size_t xIdx, const size_t yIdx) const
+  {
+    assert(xIdx < m_nx);
+    assert(yIdx < m_ny);
+    const size_t tileIdx = (yIdx >> TILE_BITS) * m_tilesX + (xIdx >> TILE_BITS);
+    return (tileIdx << (2 * TILE_BITS)) |
+           ((yIdx & (TILE_DIM - 1)) << TILE_BITS) | (xIdx & (TILE_DIM - 1));
+  }
+
+  size_t idxFrom(const Cell& c) const
+  {
+    return idxFrom(c.x(), c.y());
+  }
+
+  /**
+   * @brief Get the cell at a collapsed 1D (tile-major) index.
+   */
+  Cell cellFrom(const size_t idx) const
+  {
+    const size_t tileIdx = idx >> (2 * TILE_BITS);
+    const size_t offset = idx & (TILE_CELLS - 1);
+    return Cell((tileIdx % m_tilesX) * TILE_DIM + (offset & (TILE_DIM - 1)),
+                (tileIdx / m_tilesX) * TILE_DIM + (offset >> TILE_BITS));
+  }
+
+  /**
+   * @brief The number of cells stored, including the padding of the edge
+   * tiles.
+   */
+  size_t storageSize() const
+  {
+    return numTiles() * TILE_CELLS;
+  }
+
+  size_t numTiles() const
+  {
+    return m_tilesX * m_tilesY;
+  }
+
+  size_t numTilesX() const
+  {
+    return m_tilesX;
+  }
+
+  size_t numTilesY() const
+  {
+    return m_tilesY;
+  }
+
+  size_t size() const
+  {
+    return m_nx * m_ny;
+  }
+
+  size_t numX() const
+  {
+    return m_nx;
+  }
+
+  size_t numY() const
+  {
+    return m_ny;
+  }
+
+  std::pair<size_t, size_t> shape() const
+  {
+    return std::make_pair(numX(), numY());
+  }
+
+  bool contains(const Cell& c) const
+  {
+    return c.x() < numX() && c.y() < numY();
+  }
+
+  private:
+  size_t m_nx;
+  size_t m_ny;
+  size_t m_tilesX;
+  size_t m_tilesY;
+};
+
+/**
+ * @brief Class used for storing data on a 2D grid in square tiles (see
+ * TileIndexer), which are only allocated once a cell within them is given a
+ * value other than the fill value. Tiles of only the fill value (e.g., FREE
+ * space) take no memory, so only the non-uniform parts of a very large map are
+ * stored. The accessors mirror those of DataMap.
+ *
+ * @tparam T The data type.
+ */
+template <typename T>
+class TiledDataMap : public TileIndexer
+{
+  public:
+  TiledDataMap(const std::pair<size_t, size_t>& shape, const T& fill)
+      : TileIndexer(shape),
+        m_data(storageSize(), fill),
+        m_fill(fill),
+        m_fillRow(TILE_DIM, fill)
+  {
+    // do nothing
+  }
+
+  /**
+   * @brief Construct a TiledDataMap from a dense map, only allocating the
+   * tiles containing values other than the fill value.
+   */
+  TiledDataMap(const DataMap<T>& dense, const T& fill)
+      : TiledDataMap(dense.shape(), fill)
+  {
+    for (size_t yIdx = 0; yIdx < numY(); ++yIdx) {
+      for (size_t xIdx = 0; xIdx < numX(); ++xIdx) {
+        set(xIdx, yIdx, dense.at(xIdx, yIdx));
+      }
+    }
+  }
+
+  const T& at(const size_t xIdx, const size_t yIdx) const
+  {
+    return m_data[idxFrom(xIdx, yIdx)];
+  }
+
+  const T& at(const Cell& c) const
+  {
+    return m_data[idxFrom(c)];
+  }
+
+  /**
+   * @brief Get a writable value, allocating its tile if needed. Prefer set()
+   * when the value written may be the fill value.
+   */
+  T& at(const size_t xIdx, const size_t yIdx)
+  {
+    return m_data[idxFrom(xIdx, yIdx)];
+  }
+
+  T& at(const Cell& c)
+  {
+    return m_data[idxFrom(c)];
+  }
+
+  /**
+   * @brief Assign a value, only allocating its tile if the value differs from
+   * the fill value.
+   */
+  void set(const size_t xIdx, const size_t yIdx, const T& val)
+  {
+    const size_t idx = idxFrom(xIdx, yIdx);
+    if (val != m_fill || m_data.isAllocated(idx / TILE_CELLS)) {
+      m_data[idx] = val;
+    }
+  }
+
+  /**
+   * @brief Assign a value to all cells in the (inclusive) span [x0, x1] of a
+   * row, as for DataMap.
+   */
+  void fillSpan(const size_t yIdx,
+                const size_t x0,
+                const size_t x1,
+                const T& val)
+  {
+    assert(x0 <= x1);
+    forEachTileSpan(yIdx, x0, x1, [&](size_t, size_t first, size_t count) {
+      if (val == m_fill && !m_data.isAllocated(first / TILE_CELLS)) {
+        return;
+      }
+      T* values = m_data.page(first / TILE_CELLS) + first % TILE_CELLS;
+      std::fill(values, values + count, val);
+    });
+  }
+
+  /**
+   * @brief Replace all cells equal to oldVal with newVal, in the (inclusive)
+   * span [x0, x1] of a row, as for DataMap.
+   */
+  void replaceSpan(const size_t yIdx,
+                   const size_t x0,
+                   const size_t x1,
+                   const T& oldVal,
+                   const T& newVal)
+  {
+    assert(x0 <= x1);
+    forEachTileSpan(yIdx, x0, x1, [&](size_t, size_t first, size_t count) {
+      if (!m_data.isAllocated(first / TILE_CELLS) &&
+          (oldVal != m_fill || newVal == m_fill)) {
+        return;
+      }
+      T* values = m_data.page(first / TILE_CELLS) + first % TILE_CELLS;
+      std::replace(values, values + count, oldVal, newVal);
+    });
+  }
+
+  /**
+   * @brief Call f(xIdx, values, count) for the part of the (inclusive) span
+   * [x0, x1] of a row within each tile, where values points to the count
+   * cells from xIdx, which are contiguous in memory. The cells of unallocated
+   * tiles are read from a row of the fill value, without allocating them.
+   */
+  template <typename F>
+  void forEachSpan(const size_t yIdx,
+                   const size_t x0,
+                   const size_t x1,
+                   F&& f) const
+  {
+    assert(x0 <= x1);
+    forEachTileSpan(
+        yIdx, x0, x1, [&](size_t xIdx, size_t first, size_t count) {
+          const T* page = m_data.findPage(first / TILE_CELLS);
+          f(xIdx, page ? page + first % TILE_CELLS : m_fillRow.data(), count);
+        });
+  }
+
+  /**
+   * @brief Call f(xIdx, values, count) for each tile's part of a span of a
+   * row, as above, with writable values, allocating the tiles if needed.
+   */
+  template <typename F>
+  void forEachMutableSpan(const size_t yIdx,
+                          const size_t x0,
+                          const size_t x1,
+                          F&& f)
+  {
+    assert(x0 <= x1);
+    forEachTileSpan(
+        yIdx, x0, x1, [&](size_t xIdx, size_t first, size_t count) {
+          f(xIdx, m_data.page(first / TILE_CELLS) + first % TILE_CELLS, count);
+        });
+  }
+
+  /**
+   * @brief Copy count values to a row from the cell at xIdx on, only
+   * allocating the tiles given values other than the fill value.
+   */
+  void assignSpan(const size_t yIdx,
+                  const size_t xIdx,
+                  const T* values,
+                  const size_t count)
+  {
+    if (count == 0U) {
+      return;
+    }
+    forEachTileSpan(
+        yIdx, xIdx, xIdx + count - 1, [&](size_t x, size_t first, size_t n) {
+          const T* src = values + (x - xIdx);
+          if (!m_data.isAllocated(first / TILE_CELLS) &&
+              std::all_of(
+                  src, src + n, [this](const T& v) { return v == m_fill; })) {
+            return;
+          }
+          T* dst = m_data.page(first / TILE_CELLS) + first % TILE_CELLS;
+          std::copy(src, src + n, dst);
+        });
+  }
+
+  /**
+   * @brief Release the tiles holding only the fill value.
+   */
+  void compact()
+  {
+    m_data.compact();
+  }
+
+  /**
+   * @brief Copy the data into a dense, row-major map.
+   */
+  DataMap<T> toDense() const
+  {
+    DataMap<T> dense(shape(), m_fill);
+    for (size_t yIdx = 0; yIdx < numY(); ++yIdx) {
+      for (size_t xIdx = 0; xIdx < numX(); ++xIdx) {
+        dense.at(xIdx, yIdx) = at(xIdx, yIdx);
+      }
+    }
+    return dense;
+  }
+
+  const T& fill() const
+  {
+    return m_fill;
+  }
+
+  size_t numAllocatedTiles() const
+  {
+    return m_data.numAllocated();
+  }
+
+  bool isTileAllocated(const size_t tileX, const size_t tileY) const
+  {
+    return m_data.isAllocated(tileX + tileY * numTilesX());
+  }
+
+  size_t bytes() const
+  {
+    return m_data.bytes();
+  }
+
+  private:
+  PagedArray<T, TILE_CELLS> m_data;
+  T m_fill;
+  // a tile row of the fill value, read in place of unallocated tiles
+  std::vector<T> m_fillRow;
+
+  /**
+   * @brief Call f(xIdx, first, count) for the part of the (inclusive) span
+   * [x0, x1] of a row within each tile, being the count cells from xIdx, which
+   * are contiguous in memory from the 1D index first.
+   */
+  template <typename F>
+  void forEachTileSpan(const size_t yIdx,
+                       const size_t x0,
+                       const size_t x1,
+                       F&& f) const
+  {
+    size_t xIdx = x0;
+    while (xIdx <= x1) {
+      const size_t tileEnd = std::min((xIdx | (TILE_DIM - 1)), x1);
+      f(xIdx, idxFrom(xIdx, yIdx), tileEnd - xIdx + 1);
+      xIdx = tileEnd + 1;
+    }
+  }
+};
+
+/**
+ * @brief Enumeration of the storage of the layers of a grid.
+ */
+enum class grid_storage : uint8_t {
+  // a single row-major array (see DataMap)
+  DENSE,
+  // lazily allocated square tiles (see TiledDataMap)
+  TILED
+};
+
+/**
+ * @brief Class storing a layer of data on a 2D grid either densely or in
+ * lazily allocated tiles, chosen when constructed, for classes which support
+ * both without being templates of their storage (e.g., ConfigurationSpace).
+ * Reads of a single cell branch on the storage, which never changes, so is
+ * well predicted. Rows are accessed a span at a time, being contiguous over
+ * the whole span when dense, or over the part within each tile when tiled.
+ *
+ * @tparam T The data type.
+ */
+template <typename T>
+class GridLayer
+{
+  public:
+  /**
+   * @brief Construct a new Grid Layer object, with every cell set to the fill
+   * value, which is also the value of the unallocated tiles if tiled.
+   */
+  GridLayer(const std::pair<size_t, size_t>& shape,
+            const T& fill,
+            const grid_storage storage)
+      : m_dense(storage == grid_storage::DENSE ? shape
+                                                : std::pair<size_t, size_t>(),
+                fill)
+  {
+    if (storage == grid_storage::TILED) {
+      m_tiled.emplace(shape, fill);
+    }
+  }
+
+  /**
+   * @brief Construct a new dense Grid Layer object, taking ownership of the
+   * (possibly viewed) map.
+   */
+  explicit GridLayer(DataMap<T> dense) : m_dense(std::move(dense))
+  {
+    // do nothing
+  }
+
+  grid_storage storage() const
+  {
+    return m_tiled ? grid_storage::TILED : grid_storage::DENSE;
+  }
+
+  /**
+   * @brief Get the dense map of the layer.
+   * NOTE: requires dense storage.
+   */
+  const DataMap<T>& dense() const
+  {
+    assert(!m_tiled);
+    return m_dense;
+  }
+
+  T at(const size_t xIdx, const size_t yIdx) const
+  {
+    return m_tiled ? m_tiled->at(xIdx, yIdx) : m_dense.at(xIdx, yIdx);
+  }
+
+  T at(const Cell& c) const
+  {
+    return m_tiled ? m_tiled->at(c) : m_dense.at(c);
+  }
+
+  void fillSpan(const size_t yIdx,
+                const size_t x0,
+                const size_t x1,
+                const T& val)
+  {
+    if (m_tiled) {
+      m_tiled->fillSpan(yIdx, x0, x1, val);
+    } else {
+      m_dense.fillSpan(yIdx, x0, x1, val);
+    }
+  }
+
+  void replaceSpan(const size_t yIdx,
+                   const size_t x0,
+                   const size_t x1,
+                   const T& oldVal,
+                   const T& newVal)
+  {
+    if (m_tiled) {
+      m_tiled->replaceSpan(yIdx, x0, x1, oldVal, newVal);
+    } else {
+      m_dense.replaceSpan(yIdx, x0, x1, oldVal, newVal);
+    }
+  }
+
+  /**
+   * @brief Call f(xIdx, values, count) for the contiguous parts of the
+   * (inclusive) span [x0, x1] of a row (see TiledDataMap::forEachSpan()).
+   */
+  template <typename F>
+  void forEachSpan(const size_t yIdx,
+                   const size_t x0,
+                   const size_t x1,
+                   F&& f) const
+  {
+    if (m_tiled) {
+      m_tiled->forEachSpan(yIdx, x0, x1, f);
+    } else {
+      f(x0, m_dense.data() + m_dense.idxFrom(x0, yIdx), x1 - x0 + 1);
+    }
+  }
+
+  /**
+   * @brief Call f(xIdx, values, count) for the contiguous parts of a span of
+   * a row, as above, with writable values.
+   */
+  template <typename F>
+  void forEachMutableSpan(const size_t yIdx,
+                          const size_t x0,
+                          const size_t x1,
+                          F&& f)
+  {
+    if (m_tiled) {
+      m_tiled->forEachMutableSpan(yIdx, x0, x1, f);
+    } else {
+      f(x0, m_dense.data() + m_dense.idxFrom(x0, yIdx), x1 - x0 + 1);
+    }
+  }
+
+  /**
+   * @brief Copy count values to a row from the cell at xIdx on, without
+   * allocating tiles for values which are all the fill value.
+   */
+  void assignSpan(const size_t yIdx,
+                  const size_t xIdx,
+                  const T* values,
+                  const size_t count)
+  {
+    if (m_tiled) {
+      m_tiled->assignSpan(yIdx, xIdx, values, count);
+    } else {
+      std::copy(
+          values, values + count, m_dense.data() + m_dense.idxFrom(xIdx, yIdx));
+    }
+  }
+
+  /**
+   * @brief Release the tiles holding only the fill value, if tiled.
+   */
+  void compact()
+  {
+    if (m_tiled) {
+      m_tiled->compact();
+    }
+  }
+
+  size_t bytes() const
+  {
+    return m_tiled ? m_tiled->bytes() : m_dense.size() * sizeof(T);
+  }
+
+  private:
+  // empty when tiled
+  DataMap<T> m_dense;
+  std::optional<TiledDataMap<T>> m_tiled;
+};
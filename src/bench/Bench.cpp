@@ -0,0 +1,387 @@
+/**
+ * @file Bench.cpp
+ * @brief Benchmark suite timing the main stages of the save-bb8 pipeline over
+ * the pre-configured obstacle cases, at a range of map sizes and robot radii.
+ * Results are written as JSON, to allow diffing across releases.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#include "BidirectionalSearch.h"
+#include "ConfigSpace.h"
+#include "FileIO.h"
+#include "MotionPlanning.h"
+#include "Scenarios.h"
+#include "SearchStats.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+using Nanoseconds = std::chrono::nanoseconds;
+
+// M x N, being rows (ny) by columns (nx), as for the save-bb8 arguments
+const std::vector<std::pair<size_t, size_t>> DEFAULT_SIZES = {
+    {100, 250}, {1000, 1000}, {8000, 8000}};
+const std::vector<size_t> DEFAULT_RADII = {2, 6, 12};
+constexpr size_t DEFAULT_REPEATS = 3;
+
+struct BenchOptions {
+  std::vector<std::pair<size_t, size_t>> sizes = DEFAULT_SIZES;
+  std::vector<size_t> radii = DEFAULT_RADII;
+  std::vector<obstacle_config> cases = {ALL_OBSTACLE_CONFIGS.begin(),
+                                        ALL_OBSTACLE_CONFIGS.end()};
+  size_t repeats = DEFAULT_REPEATS;
+  // worker threads for the parallel stages, where 0 uses all hardware threads
+  size_t threads = 0U;
+  std::filesystem::path output = "bench-results.json";
+  std::filesystem::path workDir =
+      std::filesystem::temp_directory_path() / "save-bb8-bench";
+};
+
+/**
+ * @brief The timings and outcome of a single benchmark run. Each timing is
+ * the fastest of the repeats, which is the least noisy to compare.
+ */
+struct BenchResult {
+  obstacle_config config;
+  size_t ny;
+  size_t nx;
+  size_t robotRadius;
+  size_t numObstacles = 0U;
+  size_t fileBytes = 0U;
+  size_t binaryFileBytes = 0U;
+  size_t runLengthFileBytes = 0U;
+  size_t obstacleMapFileBytes = 0U;
+  size_t pathLength = 0U;
+  SearchStats stats;
+  // bidirectional search of the same query, to compare with A*
+  SearchStats bidirectionalStats;
+  Nanoseconds addObstaclesTime = Nanoseconds::max();
+  Nanoseconds parallelAddObstaclesTime = Nanoseconds::max();
+  Nanoseconds clearanceTime = Nanoseconds::max();
+  Nanoseconds writeTime = Nanoseconds::max();
+  Nanoseconds readTime = Nanoseconds::max();
+  Nanoseconds writeBinaryTime = Nanoseconds::max();
+  Nanoseconds readBinaryTime = Nanoseconds::max();
+  Nanoseconds writeRunLengthTime = Nanoseconds::max();
+  Nanoseconds readRunLengthTime = Nanoseconds::max();
+  Nanoseconds writeObstacleMapTime = Nanoseconds::max();
+  Nanoseconds readObstacleMapTime = Nanoseconds::max();
+  Nanoseconds searchTime = Nanoseconds::max();
+  Nanoseconds bidirectionalSearchTime = Nanoseconds::max();
+  Nanoseconds parallelBidirectionalSearchTime = Nanoseconds::max();
+};
+
+void printUsage(std::ostream& os)
+{
+  os << "Usage: save-bb8.Bench [options]\n"
+     << "  --sizes <MxN,...>    map sizes, rows by columns "
+        "(default 100x250,1000x1000,8000x8000)\n"
+     << "  --radii <r,...>      robot radii, in cells (default 2,6,12)\n"
+     << "  --cases <c,...>      obstacle cases 1-5 (default all)\n"
+     << "  --repeats <n>        repeats of each run (default 3)\n"
+     << "  --threads <n>        threads for the parallel stages "
+        "(default all)\n"
+     << "  --output <file>      JSON results file "
+        "(default bench-results.json)\n"
+     << "  --work-dir <dir>     directory for the temporary map files\n";
+}
+
+std::vector<std::string> splitList(const std::string& list)
+{
+  std::vector<std::string> entries;
+  std::stringstream s(list);
+  std::string entry;
+  while (getline(s, entry, ',')) {
+    entries.emplace_back(entry);
+  }
+  return entries;
+}
+
+std::pair<size_t, size_t> parseSize(const std::string& entry)
+{
+  const size_t sep = entry.find('x');
+  if (sep == std::string::npos) {
+    throw std::runtime_error("Invalid size, expected MxN: " + entry);
+  }
+  return {static_cast<size_t>(std::stoul(entry.substr(0, sep))),
+          static_cast<size_t>(std::stoul(entry.substr(sep + 1)))};
+}
+
+BenchOptions parseArgs(const int argc, char** argv)
+{
+  BenchOptions options;
+  for (int idx = 1; idx < argc; ++idx) {
+    const std::string arg = argv[idx];
+    if (arg == "-h" || arg == "--help") {
+      printUsage(std::cout);
+      std::exit(0);
+    }
+    if (idx + 1 >= argc) {
+      throw std::runtime_error("Missing value for argument: " + arg);
+    }
+    const std::string value = argv[++idx];
+    if (arg == "--sizes") {
+      options.sizes.clear();
+      for (const std::string& entry : splitList(value)) {
+        options.sizes.emplace_back(parseSize(entry));
+      }
+    } else if (arg == "--radii") {
+      options.radii.clear();
+      for (const std::string& entry : splitList(value)) {
+        options.radii.emplace_back(static_cast<size_t>(std::stoul(entry)));
+      }
+    } else if (arg == "--cases") {
+      options.cases.clear();
+      for (const std::string& entry : splitList(value)) {
+        options.cases.emplace_back(Scenarios::fromInt(std::stoi(entry)));
+      }
+    } else if (arg == "--repeats") {
+      options.repeats = std::max<size_t>(1U, std::stoul(value));
+    } else if (arg == "--threads") {
+      options.threads = std::stoul(value);
+    } else if (arg == "--output") {
+      options.output = value;
+    } else if (arg == "--work-dir") {
+      options.workDir = value;
+    } else {
+      throw std::runtime_error("Unknown argument: " + arg);
+    }
+  }
+  return options;
+}
+
+template <typename F>
+Nanoseconds timed(F&& f)
+{
+  const auto start = Clock::now();
+  f();
+  return Clock::now() - start;
+}
+
+BenchResult run(const obstacle_config config,
+                const size_t ny,
+                const size_t nx,
+                const size_t robotRadius,
+                const BenchOptions& options,
+                ThreadPool& pool)
+{
+  BenchResult result;
+  result.config = config;
+  result.ny = ny;
+  result.nx = nx;
+  result.robotRadius = robotRadius;
+  const std::vector<Circle> obstacles =
+      Scenarios::obstacles(config, nx, ny, robotRadius);
+  result.numObstacles = obstacles.size();
+  const std::filesystem::path cSpaceFile =
+      options.workDir / "config-space.txt";
+  const std::filesystem::path cSpaceBinFile =
+      options.workDir / "config-space.bin";
+  const std::filesystem::path cSpaceRleFile =
+      options.workDir / "config-space.rle.bin";
+  const std::filesystem::path obstacleMapFile =
+      options.workDir / "obstacle-map.bin";
+  const Cell start = Scenarios::start(nx, ny, robotRadius);
+  const Cell goal = Scenarios::goal(nx, ny, robotRadius);
+
+  AStar::workspace_type workspace;
+  BidirectionalAStar::workspace_type bidirectionalWorkspace;
+  for (size_t rep = 0; rep < options.repeats; ++rep) {
+    ConfigurationSpace cSpace(nx, ny, robotRadius);
+    result.addObstaclesTime =
+        std::min(result.addObstaclesTime,
+                 timed([&]() { cSpace.addObstacles(obstacles); }));
+    ConfigurationSpace parallelCSpace(nx, ny, robotRadius);
+    result.parallelAddObstaclesTime = std::min(
+        result.parallelAddObstaclesTime,
+        timed([&]() { parallelCSpace.addObstacles(obstacles, pool); }));
+
+    result.clearanceTime =
+        std::min(result.clearanceTime,
+                 timed([&]() { cSpace.computeClearance(); }));
+
+    result.writeTime =
+        std::min(result.writeTime,
+                 timed([&]() { ConfigSpaceIO::write(cSpace, cSpaceFile); }));
+    result.fileBytes = std::filesystem::file_size(cSpaceFile);
+
+    std::optional<ConfigurationSpace> cSpace2;
+    result.readTime = std::min(
+        result.readTime,
+        timed([&]() { cSpace2.emplace(ConfigSpaceIO::read(cSpaceFile)); }));
+
+    result.writeBinaryTime = std::min(
+        result.writeBinaryTime,
+        timed([&]() { ConfigSpaceIO::writeBinary(cSpace, cSpaceBinFile); }));
+    result.binaryFileBytes = std::filesystem::file_size(cSpaceBinFile);
+    std::optional<ConfigurationSpace> cSpace3;
+    result.readBinaryTime =
+        std::min(result.readBinaryTime, timed([&]() {
+                   cSpace3.emplace(ConfigSpaceIO::readBinary(cSpaceBinFile));
+                 }));
+
+    result.writeRunLengthTime =
+        std::min(result.writeRunLengthTime, timed([&]() {
+                   ConfigSpaceIO::writeBinary(
+                       cSpace, cSpaceRleFile, payload_encoding::RUN_LENGTH);
+                 }));
+    result.runLengthFileBytes = std::filesystem::file_size(cSpaceRleFile);
+    result.readRunLengthTime =
+        std::min(result.readRunLengthTime, timed([&]() {
+                   cSpace3.emplace(ConfigSpaceIO::readBinary(cSpaceRleFile));
+                 }));
+
+    result.writeObstacleMapTime =
+        std::min(result.writeObstacleMapTime, timed([&]() {
+                   ObstacleMapIO::write(cSpace, obstacleMapFile);
+                 }));
+    result.obstacleMapFileBytes = std::filesystem::file_size(obstacleMapFile);
+    result.readObstacleMapTime =
+        std::min(result.readObstacleMapTime, timed([&]() {
+                   cSpace3.emplace(ObstacleMapIO::read(obstacleMapFile));
+                 }));
+
+    const AStar search(*cSpace2);
+    std::vector<Cell> path;
+    SearchStats stats;
+    result.searchTime = std::min(result.searchTime, timed([&]() {
+                                   path = search.searchPath(
+                                       start, goal, workspace, &stats);
+                                 }));
+    result.pathLength = path.size();
+    result.stats = stats;
+
+    const BidirectionalAStar bidirectionalSearch(*cSpace2);
+    SearchStats bidirectionalStats;
+    result.bidirectionalSearchTime =
+        std::min(result.bidirectionalSearchTime, timed([&]() {
+                   bidirectionalSearch.searchPath(start,
+                                                  goal,
+                                                  bidirectionalWorkspace,
+                                                  &bidirectionalStats);
+                 }));
+    result.bidirectionalStats = bidirectionalStats;
+    result.parallelBidirectionalSearchTime =
+        std::min(result.parallelBidirectionalSearchTime, timed([&]() {
+                   bidirectionalSearch.searchPathParallel(
+                       start, goal, bidirectionalWorkspace);
+                 }));
+  }
+  std::filesystem::remove(cSpaceFile);
+  std::filesystem::remove(cSpaceBinFile);
+  std::filesystem::remove(cSpaceRleFile);
+  std::filesystem::remove(obstacleMapFile);
+  return result;
+}
+
+void writeJson(const std::vector<BenchResult>& results,
+               const BenchOptions& options,
+               const size_t numThreads,
+               std::ostream& os)
+{
+  os << "{\n"
+     << "  \"schema\": 1,\n"
+     << "  \"repeats\": " << options.repeats << ",\n"
+     << "  \"threads\": " << numThreads << ",\n"
+     << "  \"results\": [";
+  for (size_t idx = 0; idx < results.size(); ++idx) {
+    const BenchResult& r = results[idx];
+    os << (idx == 0 ? "\n" : ",\n") << "    {"
+       << "\"case\": \"" << Scenarios::name(r.config) << "\", "
+       << "\"M\": " << r.ny << ", "
+       << "\"N\": " << r.nx << ", "
+       << "\"robot_radius\": " << r.robotRadius << ", "
+       << "\"obstacles\": " << r.numObstacles << ", "
+       << "\"add_obstacles_ns\": " << r.addObstaclesTime.count() << ", "
+       << "\"add_obstacles_parallel_ns\": "
+       << r.parallelAddObstaclesTime.count() << ", "
+       << "\"clearance_ns\": " << r.clearanceTime.count() << ", "
+       << "\"write_ns\": " << r.writeTime.count() << ", "
+       << "\"read_ns\": " << r.readTime.count() << ", "
+       << "\"write_binary_ns\": " << r.writeBinaryTime.count() << ", "
+       << "\"read_binary_ns\": " << r.readBinaryTime.count() << ", "
+       << "\"write_rle_ns\": " << r.writeRunLengthTime.count() << ", "
+       << "\"read_rle_ns\": " << r.readRunLengthTime.count() << ", "
+       << "\"write_obstacle_map_ns\": " << r.writeObstacleMapTime.count()
+       << ", "
+       << "\"read_obstacle_map_ns\": " << r.readObstacleMapTime.count()
+       << ", "
+       << "\"search_ns\": " << r.searchTime.count() << ", "
+       << "\"file_bytes\": " << r.fileBytes << ", "
+       << "\"binary_file_bytes\": " << r.binaryFileBytes << ", "
+       << "\"rle_file_bytes\": " << r.runLengthFileBytes << ", "
+       << "\"obstacle_map_file_bytes\": " << r.obstacleMapFileBytes << ", "
+       << "\"status\": \"" << r.stats.status << "\", "
+       << "\"path_length\": " << r.pathLength << ", "
+       << "\"nodes_expanded\": " << r.stats.nodesExpanded << ", "
+       << "\"heap_pushes\": " << r.stats.heapPushes << ", "
+       << "\"peak_open_list\": " << r.stats.peakOpenListSize << ", "
+       << "\"workspace_bytes\": " << r.stats.workspaceBytes << ", "
+       << "\"bidirectional_search_ns\": " << r.bidirectionalSearchTime.count()
+       << ", "
+       << "\"bidirectional_search_parallel_ns\": "
+       << r.parallelBidirectionalSearchTime.count() << ", "
+       << "\"bidirectional_nodes_expanded\": "
+       << r.bidirectionalStats.nodesExpanded << "}";
+  }
+  os << "\n  ]\n}\n";
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  // Usage:
+  // ./save-bb8.Bench --sizes 100x250,1000x1000 --radii 2,6 --output out.json
+  const BenchOptions options = parseArgs(argc, argv);
+  std::filesystem::create_directories(options.workDir);
+  ThreadPool pool(options.threads);
+
+  std::vector<BenchResult> results;
+  for (const auto& [ny, nx] : options.sizes) {
+    for (const size_t robotRadius : options.radii) {
+      for (const obstacle_config config : options.cases) {
+        results.emplace_back(run(config, ny, nx, robotRadius, options, pool));
+        const BenchResult& r = results.back();
+        std::cout << Scenarios::name(config) << ' ' << ny << 'x' << nx
+                  << " r=" << robotRadius
+                  << ": addObstacles " << r.addObstaclesTime.count()
+                  << " ns (parallel " << r.parallelAddObstaclesTime.count()
+                  << " ns), write " << r.writeTime.count() << " ns, read "
+                  << r.readTime.count() << " ns (binary "
+                  << r.writeBinaryTime.count() << " / "
+                  << r.readBinaryTime.count() << " ns, rle "
+                  << r.writeRunLengthTime.count() << " / "
+                  << r.readRunLengthTime.count() << " ns, obstacle map "
+                  << r.writeObstacleMapTime.count() << " / "
+                  << r.readObstacleMapTime.count() << " ns), search "
+                  << r.searchTime.count() << " ns (" << r.stats.status << ", "
+                  << r.stats.nodesExpanded << " nodes), bidirectional "
+                  << r.bidirectionalSearchTime.count() << " ns (parallel "
+                  << r.parallelBidirectionalSearchTime.count() << " ns, "
+                  << r.bidirectionalStats.nodesExpanded << " nodes)"
+                  << std::endl;
+      }
+    }
+  }
+
+  std::ofstream outStream(options.output, std::ios::out);
+  if (!outStream) {
+    throw std::runtime_error("Failed to open file for writing: " +
+                             options.output.string());
+  }
+  writeJson(results, options, pool.size(), outStream);
+  return 0;
+}
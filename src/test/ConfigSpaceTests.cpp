@@ -0,0 +1,822 @@
+/**
+ * @file ConfigSpaceTests.cpp
+ * @brief Unit tests for the ConfigurationSpace class.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#include "ConfigSpace.h"
+#include "ThreadPool.h"
+
+#include "catch2.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <map>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+/**
+ * @brief Reference implementation of neighbor lookup, checking all eight
+ * neighbors of a cell directly against its accessibility.
+ */
+std::vector<Cell> bruteForceNbrs(const ConfigurationSpace& space, const Cell& c)
+{
+  std::vector<Cell> nbrs;
+  for (const NbrOffset& offset : NBR_OFFSETS) {
+    const Cell nbr(c.x() + offset.dx, c.y() + offset.dy);
+    if (space.isAccessible(nbr)) {
+      nbrs.emplace_back(nbr);
+    }
+  }
+  return nbrs;
+}
+
+/**
+ * @brief Reference implementation of the connected components, labelling the
+ * accessible cells with a flood fill over their accessible neighbors.
+ */
+DataMap<size_t> floodFillComponents(const ConfigurationSpace& space)
+{
+  constexpr size_t UNLABELLED = std::numeric_limits<size_t>::max();
+  DataMap<size_t> labels(space.shape(), UNLABELLED);
+  size_t numLabels = 0;
+  for (size_t yIdx = 0; yIdx < space.numY(); ++yIdx) {
+    for (size_t xIdx = 0; xIdx < space.numX(); ++xIdx) {
+      if (!space.isAccessible({xIdx, yIdx}) ||
+          labels.at(xIdx, yIdx) != UNLABELLED) {
+        continue;
+      }
+      std::queue<Cell> frontier;
+      frontier.emplace(xIdx, yIdx);
+      labels.at(xIdx, yIdx) = numLabels;
+      while (!frontier.empty()) {
+        const Cell c = frontier.front();
+        frontier.pop();
+        for (const Cell nbr : space.accessibleNbrs(c)) {
+          if (labels.at(nbr) == UNLABELLED) {
+            labels.at(nbr) = numLabels;
+            frontier.push(nbr);
+          }
+        }
+      }
+      ++numLabels;
+    }
+  }
+  return labels;
+}
+/**
+ * @brief Check two spaces have the same cells and derived layers.
+ */
+void requireSameCells(const ConfigurationSpace& space,
+                      const ConfigurationSpace& expected)
+{
+  REQUIRE(expected.shape() == space.shape());
+  for (size_t yIdx = 0; yIdx < space.numY(); ++yIdx) {
+    for (size_t xIdx = 0; xIdx < space.numX(); ++xIdx) {
+      const Cell c(xIdx, yIdx);
+      REQUIRE(expected.cellState(c) == space.cellState(c));
+      REQUIRE(expected.isAccessible(c) == space.isAccessible(c));
+      REQUIRE(expected.nbrMask(c) == space.nbrMask(c));
+      REQUIRE(expected.isConnected(c, {xIdx / 2, yIdx / 2}) ==
+              space.isConnected(c, {xIdx / 2, yIdx / 2}));
+    }
+  }
+}
+
+/**
+ * @brief Get the cells accessible in one space but not in another, in
+ * row-major order.
+ */
+std::vector<Cell> accessibleDifference(const ConfigurationSpace& space,
+                                       const ConfigurationSpace& other)
+{
+  std::vector<Cell> cells;
+  for (size_t yIdx = 0; yIdx < space.numY(); ++yIdx) {
+    for (size_t xIdx = 0; xIdx < space.numX(); ++xIdx) {
+      if (space.isAccessible({xIdx, yIdx}) &&
+          !other.isAccessible({xIdx, yIdx})) {
+        cells.emplace_back(xIdx, yIdx);
+      }
+    }
+  }
+  return cells;
+}
+
+void sortRowMajor(std::vector<Cell>& cells)
+{
+  std::sort(cells.begin(), cells.end(), [](const Cell& a, const Cell& b) {
+    return a.y() != b.y() ? a.y() < b.y() : a.x() < b.x();
+  });
+}
+} // namespace
+
+TEST_CASE("Neighbor masks match accessibility of each neighbor", "[nbrs]")
+{
+  // arrange
+  ConfigurationSpace space(40, 30, 2);
+  space.addObstacles({Circle({10, 10}, 4), Circle({30, 20}, 6)});
+
+  // act & assert
+  for (size_t yIdx = 0; yIdx < space.numY(); ++yIdx) {
+    for (size_t xIdx = 0; xIdx < space.numX(); ++xIdx) {
+      const Cell c(xIdx, yIdx);
+      const std::vector<Cell> expected = bruteForceNbrs(space, c);
+      const std::vector<Cell> actual = space.getAccessibleNbrs(c);
+      REQUIRE(expected == actual);
+      REQUIRE(expected.size() == space.accessibleNbrs(c).size());
+    }
+  }
+}
+
+TEST_CASE("Neighbors exclude the center cell", "[nbrs]")
+{
+  // arrange
+  ConfigurationSpace space(10, 10, 0);
+
+  // act
+  const std::vector<Cell> nbrs = space.getAccessibleNbrs({5, 5});
+
+  // assert
+  REQUIRE(8 == nbrs.size());
+  REQUIRE(std::find(nbrs.begin(), nbrs.end(), Cell(5, 5)) == nbrs.end());
+}
+
+TEST_CASE("Neighbors are clipped at the domain boundary", "[nbrs]")
+{
+  // arrange
+  ConfigurationSpace space(10, 10, 0);
+
+  // act & assert
+  REQUIRE(3 == space.accessibleNbrs({0, 0}).size());
+  REQUIRE(3 == space.accessibleNbrs({9, 9}).size());
+  REQUIRE(5 == space.accessibleNbrs({0, 5}).size());
+}
+
+TEST_CASE("Packed free cells match the FREE cell states", "[free]")
+{
+  // arrange
+  ConfigurationSpace space(130, 40, 3);
+  space.addObstacles({Circle({64, 20}, 8), Circle({5, 5}, 10)});
+
+  // act & assert
+  for (size_t yIdx = 0; yIdx < space.numY(); ++yIdx) {
+    for (size_t xIdx = 0; xIdx < space.numX(); ++xIdx) {
+      const bool isFree =
+          space.cellStates().at(xIdx, yIdx) == cell_state::FREE;
+      REQUIRE(isFree == space.freeCells().test(xIdx, yIdx));
+      REQUIRE(isFree == space.isAccessible({xIdx, yIdx}));
+    }
+  }
+}
+
+TEST_CASE("Obstacle states do not depend on the order of the obstacles",
+          "[obstacles]")
+{
+  // arrange
+  const size_t robotRadius = 3;
+  std::vector<Circle> obstacles = {
+      Circle({20, 20}, 6), Circle({27, 20}, 4), Circle({2, 38}, 7)};
+  ConfigurationSpace space(60, 40, robotRadius);
+  ConfigurationSpace reversed(60, 40, robotRadius);
+
+  // act
+  space.addObstacles(obstacles);
+  std::reverse(obstacles.begin(), obstacles.end());
+  reversed.addObstacles(obstacles);
+
+  // assert
+  const auto within = [](const Circle& circle, const Cell& c, const size_t r) {
+    const size_t dx = circle.center().xDistance(c);
+    const size_t dy = circle.center().yDistance(c);
+    return dx * dx + dy * dy < r * r;
+  };
+  for (size_t yIdx = 0; yIdx < space.numY(); ++yIdx) {
+    for (size_t xIdx = 0; xIdx < space.numX(); ++xIdx) {
+      const Cell c(xIdx, yIdx);
+      const bool onBoundary = xIdx < robotRadius || yIdx < robotRadius ||
+                              xIdx + robotRadius >= space.numX() ||
+                              yIdx + robotRadius >= space.numY();
+      bool inObject = false;
+      bool inPadding = onBoundary;
+      for (const Circle& obstacle : obstacles) {
+        inObject = inObject || within(obstacle, c, obstacle.radius());
+        inPadding = inPadding ||
+                    within(obstacle, c, obstacle.radius() + robotRadius);
+      }
+      const cell_state expected =
+          inObject ? cell_state::OBJECT
+                   : (inPadding ? cell_state::PADDED : cell_state::FREE);
+      REQUIRE(expected == space.cellStates().at(c));
+      REQUIRE(expected == reversed.cellStates().at(c));
+    }
+  }
+}
+
+TEST_CASE("Clearance is the distance to the nearest obstacle or boundary",
+          "[clearance]")
+{
+  // arrange
+  ConfigurationSpace space(50, 35, 0);
+  space.computeClearance();
+
+  // act
+  space.addObstacles({Circle({20, 15}, 5), Circle({44, 30}, 3)});
+
+  // assert
+  for (size_t yIdx = 0; yIdx < space.numY(); ++yIdx) {
+    for (size_t xIdx = 0; xIdx < space.numX(); ++xIdx) {
+      const Cell c(xIdx, yIdx);
+      size_t expected = std::min(std::min(xIdx + 1, space.numX() - xIdx),
+                                 std::min(yIdx + 1, space.numY() - yIdx));
+      expected *= expected;
+      for (size_t oy = 0; oy < space.numY(); ++oy) {
+        for (size_t ox = 0; ox < space.numX(); ++ox) {
+          if (space.cellStates().at(ox, oy) == cell_state::OBJECT) {
+            const size_t dx = c.xDistance({ox, oy});
+            const size_t dy = c.yDistance({ox, oy});
+            expected = std::min(expected, dx * dx + dy * dy);
+          }
+        }
+      }
+      REQUIRE(expected == space.clearanceSq(c));
+    }
+  }
+}
+
+TEST_CASE("Clearance updated as obstacles are added matches recomputing it",
+          "[clearance]")
+{
+  // arrange
+  std::mt19937 rng(5);
+  std::uniform_int_distribution<size_t> xDist(0, 250);
+  std::uniform_int_distribution<size_t> yDist(0, 170);
+  std::uniform_int_distribution<size_t> rDist(0, 9);
+  ConfigurationSpace space(240, 160, 1);
+  space.computeClearance();
+  ThreadPool pool(2);
+
+  for (size_t round = 0; round < 12; ++round) {
+    const std::vector<Circle> obstacles{
+        Circle({xDist(rng), yDist(rng)}, rDist(rng)),
+        Circle({xDist(rng), yDist(rng)}, rDist(rng))};
+
+    // act
+    if (round % 2 == 0) {
+      space.addObstacles(obstacles);
+    } else {
+      space.addObstacles(obstacles, pool);
+    }
+
+    // assert
+    ConfigurationSpace recomputed = space;
+    recomputed.computeClearance();
+    for (size_t yIdx = 0; yIdx < space.numY(); ++yIdx) {
+      for (size_t xIdx = 0; xIdx < space.numX(); ++xIdx) {
+        REQUIRE(recomputed.clearanceSq({xIdx, yIdx}) ==
+                space.clearanceSq({xIdx, yIdx}));
+      }
+    }
+  }
+}
+
+TEST_CASE("Accessibility at a robot radius is a clearance threshold",
+          "[clearance]")
+{
+  // arrange
+  ConfigurationSpace space(60, 40, 0);
+  space.addObstacles({Circle({30, 20}, 8)});
+  space.computeClearance();
+
+  // act & assert
+  REQUIRE(space.isAccessible({3, 20}, 0));
+  REQUIRE(space.isAccessible({3, 20}, 3));
+  REQUIRE(!space.isAccessible({3, 20}, 4));
+  REQUIRE(!space.isAccessible({30, 20}, 0));
+  REQUIRE(!space.isAccessible({60, 20}, 0));
+  for (size_t r = 0; r < 6; ++r) {
+    for (size_t yIdx = 0; yIdx < space.numY(); ++yIdx) {
+      for (size_t xIdx = 0; xIdx < space.numX(); ++xIdx) {
+        const Cell c(xIdx, yIdx);
+        REQUIRE(space.isAccessible(c, r) == (space.clearance(c) > r));
+        const NeighborRange nbrs = space.accessibleNbrs(c, r);
+        for (auto it = nbrs.begin(); it != nbrs.end(); ++it) {
+          REQUIRE(space.isAccessible(*it, r));
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("Parallel obstacles match adding the obstacles serially",
+          "[obstacles]")
+{
+  // arrange
+  std::mt19937 rng(11);
+  std::uniform_int_distribution<size_t> xDist(0, 310);
+  std::uniform_int_distribution<size_t> yDist(0, 210);
+  std::uniform_int_distribution<size_t> rDist(0, 12);
+  std::vector<Circle> obstacles;
+  for (size_t idx = 0; idx < 300; ++idx) {
+    obstacles.emplace_back(Cell(xDist(rng), yDist(rng)), rDist(rng));
+  }
+  ConfigurationSpace serial(300, 200, 2);
+  ConfigurationSpace parallel(300, 200, 2);
+  serial.computeClearance();
+  parallel.computeClearance();
+  ThreadPool pool(3);
+
+  // act
+  serial.addObstacles(obstacles);
+  parallel.addObstacles(obstacles, pool);
+
+  // assert
+  for (size_t yIdx = 0; yIdx < serial.numY(); ++yIdx) {
+    for (size_t xIdx = 0; xIdx < serial.numX(); ++xIdx) {
+      const Cell c(xIdx, yIdx);
+      REQUIRE(serial.cellStates().at(c) == parallel.cellStates().at(c));
+      REQUIRE(serial.isAccessible(c) == parallel.isAccessible(c));
+      REQUIRE(serial.nbrMask(c) == parallel.nbrMask(c));
+      REQUIRE(serial.clearanceSq(c) == parallel.clearanceSq(c));
+      REQUIRE(serial.components().component(c) ==
+              parallel.components().component(c));
+    }
+  }
+  REQUIRE(obstacles.size() == serial.obstacles().size());
+  REQUIRE(obstacles.size() == parallel.obstacles().size());
+}
+
+TEST_CASE("Parallel obstacles handle spaces without rows and no obstacles",
+          "[obstacles]")
+{
+  // arrange
+  ConfigurationSpace empty(10, 0, 1);
+  ConfigurationSpace space(10, 8, 1);
+  ThreadPool pool(2);
+
+  // act
+  empty.addObstacles({Circle({2, 0}, 3)}, pool);
+  empty.addObstacles({Circle({2, 0}, 3)});
+  space.addObstacles({}, pool);
+  empty.computeClearance();
+  ConfigurationSpace noColumns(0, 5, 1);
+  noColumns.computeClearance();
+  ConfigurationSpace noCells(0, 0, 1);
+  noCells.computeClearance();
+
+  // assert
+  REQUIRE(empty.hasClearance());
+  REQUIRE(noColumns.hasClearance());
+  REQUIRE(noCells.hasClearance());
+  REQUIRE(2U == empty.version());
+  REQUIRE(2U == empty.obstacles().size());
+  REQUIRE(1U == space.version());
+  REQUIRE(space.obstacles().empty());
+  REQUIRE(space.isAccessible({5, 4}));
+}
+
+TEST_CASE("Components match a flood fill of the accessible cells",
+          "[components]")
+{
+  // arrange
+  std::mt19937 rng(5);
+  std::uniform_int_distribution<size_t> xDist(0, 140);
+  std::uniform_int_distribution<size_t> yDist(0, 90);
+  std::uniform_int_distribution<size_t> rDist(0, 8);
+  std::vector<Circle> obstacles;
+  for (size_t idx = 0; idx < 120; ++idx) {
+    obstacles.emplace_back(Cell(xDist(rng), yDist(rng)), rDist(rng));
+  }
+  ConfigurationSpace space(140, 90, 1);
+
+  // act
+  space.addObstacles(obstacles);
+  const DataMap<size_t> expected = floodFillComponents(space);
+
+  // assert
+  // the labels may be numbered differently, but must partition the cells
+  // identically
+  std::map<size_t, ConnectivityIndex::label_type> labelMap;
+  for (size_t yIdx = 0; yIdx < space.numY(); ++yIdx) {
+    for (size_t xIdx = 0; xIdx < space.numX(); ++xIdx) {
+      const Cell c(xIdx, yIdx);
+      const auto label = space.components().component(c);
+      if (!space.isAccessible(c)) {
+        REQUIRE(ConnectivityIndex::NO_COMPONENT == label);
+        continue;
+      }
+      const auto mapped = labelMap.emplace(expected.at(c), label).first;
+      REQUIRE(mapped->second == label);
+    }
+  }
+  REQUIRE(labelMap.size() == space.components().numComponents());
+  REQUIRE(labelMap.size() > 1U);
+}
+
+TEST_CASE("Components are split as obstacles are added", "[components]")
+{
+  // arrange
+  ConfigurationSpace space(100, 50, 2);
+  const Cell left(3, 3);
+  const Cell right(96, 46);
+  REQUIRE(space.isConnected(left, right));
+  REQUIRE(1U == space.components().numComponents());
+
+  // act
+  // a wall spanning the height of the space
+  space.addObstacles({Circle({50, 25}, 30)});
+
+  // assert
+  REQUIRE_FALSE(space.isConnected(left, right));
+  REQUIRE(2U == space.components().numComponents());
+  REQUIRE(space.isConnected(left, {3, 46}));
+  REQUIRE_FALSE(space.isConnected(left, {0, 0}));
+  REQUIRE_FALSE(space.isConnected(left, {100, 3}));
+}
+
+TEST_CASE("Components join cells touching diagonally", "[components]")
+{
+  // arrange
+  DataMap<cell_state> states(std::make_pair(4, 4), cell_state::OBJECT);
+  states.at(0, 0) = cell_state::FREE;
+  states.at(1, 1) = cell_state::FREE;
+  states.at(3, 2) = cell_state::FREE;
+
+  // act
+  const ConfigurationSpace space(states, 0);
+
+  // assert
+  REQUIRE(space.isConnected({0, 0}, {1, 1}));
+  REQUIRE_FALSE(space.isConnected({1, 1}, {3, 2}));
+  REQUIRE(2U == space.components().numComponents());
+}
+
+TEST_CASE("Adding obstacles reports the newly blocked cells", "[obstacles]")
+{
+  // arrange
+  ConfigurationSpace serial(120, 90, 2);
+  serial.addObstacles({Circle({30, 30}, 10)});
+  ConfigurationSpace parallel = serial;
+  const ConfigurationSpace before = serial;
+  // overlapping the existing obstacle and the boundary
+  const std::vector<Circle> obstacles{
+      Circle({38, 36}, 8), Circle({100, 5}, 12), Circle({70, 60}, 0)};
+  ThreadPool pool(3);
+  std::vector<Cell> serialCells;
+  std::vector<Cell> parallelCells;
+
+  // act
+  serial.addObstacles(obstacles, &serialCells);
+  parallel.addObstacles(obstacles, pool, &parallelCells);
+
+  // assert
+  std::vector<Cell> expected;
+  for (size_t yIdx = 0; yIdx < serial.numY(); ++yIdx) {
+    for (size_t xIdx = 0; xIdx < serial.numX(); ++xIdx) {
+      if (before.isAccessible({xIdx, yIdx}) &&
+          !serial.isAccessible({xIdx, yIdx})) {
+        expected.emplace_back(xIdx, yIdx);
+      }
+    }
+  }
+  REQUIRE(!expected.empty());
+  const auto toIdx = [&](const Cell& c) { return serial.idxFrom(c); };
+  for (auto* cells : {&expected, &serialCells, &parallelCells}) {
+    std::sort(cells->begin(), cells->end(), [&](const Cell& a, const Cell& b) {
+      return toIdx(a) < toIdx(b);
+    });
+  }
+  REQUIRE(expected == serialCells);
+  REQUIRE(expected == parallelCells);
+}
+
+TEST_CASE("Adding obstacles increments the version", "[obstacles]")
+{
+  // arrange
+  ConfigurationSpace space(60, 40, 1);
+  ThreadPool pool(2);
+  REQUIRE(0U == space.version());
+
+  // act & assert
+  space.addObstacles({Circle({20, 20}, 5)});
+  REQUIRE(1U == space.version());
+  space.addObstacles({Circle({40, 20}, 5)}, pool);
+  REQUIRE(2U == space.version());
+}
+
+TEST_CASE("Removing obstacles matches rebuilding the space", "[obstacles]")
+{
+  // arrange
+  const size_t nx = 200;
+  const size_t ny = 150;
+  const size_t robotRadius = 3;
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<size_t> xDist(0, nx - 1);
+  std::uniform_int_distribution<size_t> yDist(0, ny - 1);
+  std::uniform_int_distribution<size_t> rDist(0, 30);
+  std::vector<Circle> obstacles;
+  for (size_t idx = 0; idx < 40; ++idx) {
+    obstacles.emplace_back(Cell(xDist(rng), yDist(rng)), rDist(rng));
+  }
+  // the same obstacle added twice is only removed once
+  obstacles.push_back(obstacles.front());
+  ConfigurationSpace space(nx, ny, robotRadius);
+  space.addObstacles(obstacles);
+  space.computeClearance();
+
+  for (size_t round = 0; round < 3; ++round) {
+    const ConfigurationSpace before = space;
+    std::vector<Circle> removed;
+    for (size_t idx = 0; idx < 8; ++idx) {
+      removed.push_back(obstacles[(idx * 5 + round) % obstacles.size()]);
+      obstacles.erase(
+          obstacles.begin() +
+          static_cast<std::ptrdiff_t>((idx * 5 + round) % obstacles.size()));
+    }
+    std::vector<Cell> freedCells;
+
+    // act
+    space.removeObstacles(removed, &freedCells);
+
+    // assert
+    ConfigurationSpace rebuilt(nx, ny, robotRadius);
+    rebuilt.addObstacles(obstacles);
+    rebuilt.computeClearance();
+    requireSameCells(space, rebuilt);
+    REQUIRE(obstacles.size() == space.obstacles().size());
+    for (size_t yIdx = 0; yIdx < ny; ++yIdx) {
+      for (size_t xIdx = 0; xIdx < nx; ++xIdx) {
+        REQUIRE(rebuilt.clearanceSq({xIdx, yIdx}) ==
+                space.clearanceSq({xIdx, yIdx}));
+      }
+    }
+    REQUIRE(before.version() + 1 == space.version());
+    sortRowMajor(freedCells);
+    REQUIRE(accessibleDifference(space, before) == freedCells);
+
+    // obstacles added once the index is built are also found when removing
+    const Circle added(Cell(xDist(rng), yDist(rng)), rDist(rng));
+    space.addObstacles({added});
+    obstacles.push_back(added);
+  }
+}
+
+TEST_CASE("Removing obstacles joins components and raises the clearance",
+          "[obstacles]")
+{
+  // arrange
+  ConfigurationSpace space(100, 50, 2);
+  const Cell left(3, 3);
+  const Cell right(96, 46);
+  // a wall spanning the height of the space, and a small obstacle within
+  // each half
+  space.addObstacles(
+      {Circle({50, 25}, 30), Circle({20, 25}, 2), Circle({80, 25}, 2)});
+  space.computeClearance();
+  REQUIRE_FALSE(space.isConnected(left, right));
+  REQUIRE(2U == space.components().numComponents());
+
+  // act
+  space.removeObstacles({Circle({50, 25}, 30)});
+
+  // assert
+  ConfigurationSpace rebuilt(100, 50, 2);
+  rebuilt.addObstacles({Circle({20, 25}, 2), Circle({80, 25}, 2)});
+  rebuilt.computeClearance();
+  requireSameCells(space, rebuilt);
+  REQUIRE(space.isConnected(left, right));
+  REQUIRE(1U == space.components().numComponents());
+  // the clearance rises beyond its largest value before the removal
+  for (size_t yIdx = 0; yIdx < space.numY(); ++yIdx) {
+    for (size_t xIdx = 0; xIdx < space.numX(); ++xIdx) {
+      REQUIRE(rebuilt.clearanceSq({xIdx, yIdx}) ==
+              space.clearanceSq({xIdx, yIdx}));
+    }
+  }
+}
+
+TEST_CASE("Moving an obstacle matches removing and adding it", "[obstacles]")
+{
+  // arrange
+  ConfigurationSpace space(120, 90, 2);
+  const std::vector<Circle> obstacles{
+      Circle({30, 30}, 10), Circle({38, 36}, 8), Circle({100, 5}, 12)};
+  space.addObstacles(obstacles);
+  space.computeClearance();
+  const ConfigurationSpace before = space;
+  std::vector<Cell> freedCells;
+  std::vector<Cell> blockedCells;
+
+  // act
+  // overlapping its old position, and another obstacle
+  space.moveObstacle(
+      Circle({38, 36}, 8), Circle({44, 40}, 9), &freedCells, &blockedCells);
+
+  // assert
+  ConfigurationSpace rebuilt(120, 90, 2);
+  rebuilt.addObstacles(
+      {Circle({30, 30}, 10), Circle({100, 5}, 12), Circle({44, 40}, 9)});
+  rebuilt.computeClearance();
+  requireSameCells(space, rebuilt);
+  for (size_t yIdx = 0; yIdx < space.numY(); ++yIdx) {
+    for (size_t xIdx = 0; xIdx < space.numX(); ++xIdx) {
+      REQUIRE(rebuilt.clearanceSq({xIdx, yIdx}) ==
+              space.clearanceSq({xIdx, yIdx}));
+    }
+  }
+  REQUIRE(before.version() + 1 == space.version());
+  sortRowMajor(freedCells);
+  sortRowMajor(blockedCells);
+  REQUIRE(!freedCells.empty());
+  REQUIRE(!blockedCells.empty());
+  REQUIRE(accessibleDifference(space, before) == freedCells);
+  REQUIRE(accessibleDifference(before, space) == blockedCells);
+}
+
+TEST_CASE("Shrinking an obstacle joins the components it split",
+          "[obstacles]")
+{
+  // arrange
+  ConfigurationSpace space(100, 50, 2);
+  space.addObstacles({Circle({50, 25}, 30)});
+  REQUIRE(2U == space.components().numComponents());
+  std::vector<Cell> blockedCells;
+
+  // act
+  space.moveObstacle(
+      Circle({50, 25}, 30), Circle({50, 25}, 10), nullptr, &blockedCells);
+
+  // assert
+  ConfigurationSpace rebuilt(100, 50, 2);
+  rebuilt.addObstacles({Circle({50, 25}, 10)});
+  requireSameCells(space, rebuilt);
+  REQUIRE(blockedCells.empty());
+  REQUIRE(1U == space.components().numComponents());
+}
+
+TEST_CASE("Removing obstacles requires their geometry", "[obstacles]")
+{
+  // arrange
+  ConfigurationSpace space(60, 40, 1);
+  space.addObstacles({Circle({20, 20}, 5)});
+  const ConfigurationSpace before = space;
+  ConfigurationSpace raster(space.cellStates(), 1);
+
+  // act & assert
+  REQUIRE_THROWS_AS(space.removeObstacles({Circle({20, 20}, 5),
+                                           Circle({40, 20}, 5)}),
+                    std::runtime_error);
+  REQUIRE_THROWS_AS(space.moveObstacle(Circle({20, 21}, 5),
+                                       Circle({40, 20}, 5)),
+                    std::runtime_error);
+  requireSameCells(space, before);
+  REQUIRE(before.version() == space.version());
+  REQUIRE(1U == space.obstacles().size());
+  REQUIRE_THROWS_AS(raster.removeObstacles({Circle({20, 20}, 5)}),
+                    std::runtime_error);
+}
+
+TEST_CASE("Removing obstacles keeps the order of the rest", "[obstacles]")
+{
+  // arrange
+  ConfigurationSpace space(200, 100, 1);
+  const Circle a({20, 20}, 5);
+  const Circle b({150, 70}, 8);
+  const Circle offMap({500, 500}, 3);
+  space.addObstacles({a, b, a, offMap, b, a});
+  const ConfigurationSpace before = space;
+
+  // act & assert
+  // more copies than were added, including of an obstacle outside the space
+  REQUIRE_THROWS_AS(space.removeObstacles({a, a, a, a}), std::runtime_error);
+  REQUIRE_THROWS_AS(space.removeObstacles({offMap, offMap}),
+                    std::runtime_error);
+  requireSameCells(space, before);
+  REQUIRE(before.obstacles() == space.obstacles());
+
+  // the most recently added copies are removed
+  space.removeObstacles({a, offMap, a, b});
+  REQUIRE(std::vector<Circle>{a, b} == space.obstacles());
+  ConfigurationSpace rebuilt(200, 100, 1);
+  rebuilt.addObstacles({a, b});
+  requireSameCells(space, rebuilt);
+
+  // obstacles indexed by the first removal are found by later ones
+  space.removeObstacles({b, a});
+  REQUIRE(space.obstacles().empty());
+  requireSameCells(space, ConfigurationSpace(200, 100, 1));
+}
+
+TEST_CASE("Obstacles with huge radii block the whole space", "[obstacles]")
+{
+  // arrange
+  ConfigurationSpace space(50, 40, 2);
+  std::vector<Cell> changedCells;
+
+  // act
+  space.addObstacles(
+      {Circle({5, 5}, 3037000500U),
+       Circle({10, 10}, std::numeric_limits<size_t>::max())},
+      &changedCells);
+
+  // assert
+  for (size_t yIdx = 0; yIdx < space.numY(); ++yIdx) {
+    for (size_t xIdx = 0; xIdx < space.numX(); ++xIdx) {
+      REQUIRE(cell_state::OBJECT == space.cellStates().at(xIdx, yIdx));
+    }
+  }
+  // all but the padded boundary were free
+  REQUIRE((50U - 4U) * (40U - 4U) == changedCells.size());
+}
+
+TEST_CASE("Tiled spaces match dense ones", "[obstacles]")
+{
+  // arrange
+  const size_t nx = 700;
+  const size_t ny = 450;
+  ConfigurationSpace dense(nx, ny, 3);
+  ConfigurationSpace tiled(nx, ny, 3, grid_storage::TILED);
+  dense.computeClearance();
+  tiled.computeClearance();
+  const std::vector<Circle> obstacles{Circle({100, 100}, 20),
+                                      Circle({64, 300}, 0),
+                                      Circle({127, 128}, 40),
+                                      Circle({600, 400}, 10)};
+  const std::vector<Circle> moreObstacles{Circle({300, 50}, 30),
+                                          Circle({699, 200}, 12)};
+  ThreadPool pool(2);
+  std::vector<Cell> denseCells;
+  std::vector<Cell> tiledCells;
+
+  // act & assert
+  REQUIRE(grid_storage::TILED == tiled.storage());
+  const auto requireSame = [&]() {
+    requireSameCells(tiled, dense);
+    for (size_t yIdx = 0; yIdx < ny; ++yIdx) {
+      for (size_t xIdx = 0; xIdx < nx; ++xIdx) {
+        REQUIRE(dense.clearanceSq({xIdx, yIdx}) ==
+                tiled.clearanceSq({xIdx, yIdx}));
+      }
+    }
+    REQUIRE(denseCells == tiledCells);
+    REQUIRE(dense.version() == tiled.version());
+  };
+  requireSame();
+
+  dense.addObstacles(obstacles, &denseCells);
+  tiled.addObstacles(obstacles, &tiledCells);
+  requireSame();
+
+  dense.addObstacles(moreObstacles, pool, &denseCells);
+  tiled.addObstacles(moreObstacles, pool, &tiledCells);
+  sortRowMajor(denseCells);
+  sortRowMajor(tiledCells);
+  requireSame();
+
+  dense.removeObstacles({obstacles[2]}, &denseCells);
+  tiled.removeObstacles({obstacles[2]}, &tiledCells);
+  requireSame();
+
+  std::vector<Cell> denseBlocked;
+  std::vector<Cell> tiledBlocked;
+  const Circle moved({400, 300}, 25);
+  dense.moveObstacle(obstacles[0], moved, nullptr, &denseBlocked);
+  tiled.moveObstacle(obstacles[0], moved, nullptr, &tiledBlocked);
+  REQUIRE(denseBlocked == tiledBlocked);
+  requireSame();
+
+  std::ostringstream denseText;
+  std::ostringstream tiledText;
+  denseText << dense;
+  tiledText << tiled;
+  REQUIRE(denseText.str() == tiledText.str());
+}
+
+TEST_CASE("Tiled spaces only allocate the tiles which are not free",
+          "[obstacles]")
+{
+  // arrange
+  const size_t nx = 4000;
+  const size_t ny = 3000;
+  ConfigurationSpace space(nx, ny, 3, grid_storage::TILED);
+  const size_t emptyBytes = space.layerBytes();
+
+  // act
+  space.addObstacles({Circle({2000, 1500}, 100)});
+
+  // assert
+  // a byte of state and mask per cell if dense, but only the tiles of the
+  // padded boundary and the obstacle, and their neighbors' masks, if tiled
+  REQUIRE(emptyBytes * 10 < 2 * nx * ny);
+  REQUIRE(space.layerBytes() - emptyBytes < 2 * 25 * 64 * 64);
+  REQUIRE(cell_state::OBJECT == space.cellState({2000, 1500}));
+  REQUIRE(cell_state::FREE == space.cellState({2000, 1300}));
+  REQUIRE(0xFFU == space.nbrMask({1000, 1000}));
+  REQUIRE(space.isConnected({10, 10}, {nx - 10, ny - 10}));
+}
@@ -0,0 +1,92 @@
+/**
+ * @file DistanceTransformTests.cpp
+ * @brief Unit tests for the DistanceTransform class.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#include "DistanceTransform.h"
+
+#include "catch2.h"
+
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+TEST_CASE("Distance transform matches brute force distances", "[edt]")
+{
+  // arrange
+  const GridIndexer grid(57, 31);
+  std::mt19937 rng(7);
+  std::bernoulli_distribution siteDist(0.02);
+  std::vector<bool> sites(grid.size());
+  for (size_t idx = 0; idx < sites.size(); ++idx) {
+    sites[idx] = siteDist(rng);
+  }
+  // an empty column and row, so some distances span the whole grid
+  for (size_t yIdx = 0; yIdx < grid.numY(); ++yIdx) {
+    sites[grid.idxFrom(0, yIdx)] = false;
+  }
+  for (size_t xIdx = 0; xIdx < grid.numX(); ++xIdx) {
+    sites[grid.idxFrom(xIdx, 0)] = false;
+  }
+
+  // act
+  const DataMap<uint32_t> dSq = DistanceTransform::squared(
+      grid, [&](const size_t xIdx, const size_t yIdx) {
+        return sites[grid.idxFrom(xIdx, yIdx)];
+      });
+
+  // assert
+  for (size_t yIdx = 0; yIdx < grid.numY(); ++yIdx) {
+    for (size_t xIdx = 0; xIdx < grid.numX(); ++xIdx) {
+      uint32_t expected = DistanceTransform::INF_SQ;
+      for (size_t idx = 0; idx < sites.size(); ++idx) {
+        if (sites[idx]) {
+          const Cell site(idx % grid.numX(), idx / grid.numX());
+          const size_t dx = site.xDistance({xIdx, yIdx});
+          const size_t dy = site.yDistance({xIdx, yIdx});
+          expected = std::min(expected, static_cast<uint32_t>(dx * dx + dy * dy));
+        }
+      }
+      REQUIRE(expected == dSq.at(xIdx, yIdx));
+    }
+  }
+}
+
+TEST_CASE("Distance transform without sites is unbounded", "[edt]")
+{
+  // arrange
+  const GridIndexer grid(12, 5);
+
+  // act
+  const DataMap<uint32_t> dSq = DistanceTransform::squared(
+      grid, [](const size_t, const size_t) { return false; });
+
+  // assert
+  for (size_t yIdx = 0; yIdx < grid.numY(); ++yIdx) {
+    for (size_t xIdx = 0; xIdx < grid.numX(); ++xIdx) {
+      REQUIRE(DistanceTransform::INF_SQ == dSq.at(xIdx, yIdx));
+    }
+  }
+}
+
+TEST_CASE("Distance transform of an empty grid is empty", "[edt]")
+{
+  for (const auto& [nx, ny] : {std::make_pair(5U, 0U),
+                               std::make_pair(0U, 5U),
+                               std::make_pair(0U, 0U)}) {
+    // arrange
+    const GridIndexer grid(nx, ny);
+
+    // act
+    const DataMap<uint32_t> dSq = DistanceTransform::squared(
+        grid, [](const size_t, const size_t) { return true; });
+
+    // assert
+    REQUIRE(nx == dSq.numX());
+    REQUIRE(ny == dSq.numY());
+    REQUIRE(0U == dSq.size());
+  }
+}
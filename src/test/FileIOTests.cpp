@@ -0,0 +1,570 @@
+/**
+ * @file FileIOTests.cpp
+ * @brief Unit tests for the file I/O operations.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#include "ConfigSpace.h"
+#include "FileIO.h"
+#include "PlanningService.h"
+#include "RunLength.h"
+
+#include "catch2.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+const std::filesystem::path TEST_DIR =
+    std::filesystem::temp_directory_path() / "save-bb8-tests";
+
+ConfigurationSpace makeSpace()
+{
+  ConfigurationSpace space(70, 45, 2);
+  space.addObstacles({Circle({20, 20}, 8), Circle({69, 0}, 10)});
+  return space;
+}
+
+void requireSameStates(const ConfigurationSpace& expected,
+                       const ConfigurationSpace& actual)
+{
+  REQUIRE(expected.robotRadius() == actual.robotRadius());
+  REQUIRE(expected.shape() == actual.shape());
+  for (size_t yIdx = 0; yIdx < expected.numY(); ++yIdx) {
+    for (size_t xIdx = 0; xIdx < expected.numX(); ++xIdx) {
+      const Cell c(xIdx, yIdx);
+      REQUIRE(expected.cellStates().at(c) == actual.cellStates().at(c));
+      REQUIRE(expected.nbrMask(c) == actual.nbrMask(c));
+    }
+  }
+}
+} // namespace
+
+TEST_CASE("Text configuration space files round trip", "[io]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace();
+  const std::filesystem::path file = TEST_DIR / "config-space.txt";
+
+  // act
+  ConfigSpaceIO::write(space, file);
+  const ConfigurationSpace loaded = ConfigSpaceIO::read(file);
+
+  // assert
+  REQUIRE(!ConfigSpaceIO::isBinary(file));
+  requireSameStates(space, loaded);
+  std::filesystem::remove(file);
+}
+
+TEST_CASE("Binary configuration space files are mapped without copying",
+          "[io]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace();
+  const std::filesystem::path file = TEST_DIR / "config-space.bin";
+
+  // act
+  ConfigSpaceIO::writeBinary(space, file);
+  const ConfigurationSpace loaded = ConfigSpaceIO::readBinary(file);
+  const ConfigurationSpace detected = ConfigSpaceIO::read(file);
+
+  // assert
+  REQUIRE(ConfigSpaceIO::isBinary(file));
+  REQUIRE(loaded.cellStates().isView());
+  requireSameStates(space, loaded);
+  requireSameStates(space, detected);
+  std::filesystem::remove(file);
+}
+
+TEST_CASE("Changes to a mapped configuration space do not reach the file",
+          "[io]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace();
+  const std::filesystem::path file = TEST_DIR / "config-space-cow.bin";
+  ConfigSpaceIO::writeBinary(space, file);
+
+  // act
+  ConfigurationSpace loaded = ConfigSpaceIO::readBinary(file);
+  loaded.addObstacles({Circle({50, 30}, 6)});
+  const ConfigurationSpace reloaded = ConfigSpaceIO::readBinary(file);
+  const ConfigurationSpace copied = loaded;
+
+  // assert
+  REQUIRE(cell_state::OBJECT == loaded.cellStates().at(50, 30));
+  REQUIRE(!copied.cellStates().isView());
+  requireSameStates(loaded, copied);
+  requireSameStates(space, reloaded);
+  std::filesystem::remove(file);
+}
+
+TEST_CASE("Corrupt binary configuration space files are rejected", "[io]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace();
+  const std::filesystem::path file = TEST_DIR / "config-space-bad.bin";
+  ConfigSpaceIO::writeBinary(space, file);
+  const auto fileSize = std::filesystem::file_size(file);
+
+  SECTION("Checksum mismatch")
+  {
+    // act
+    {
+      std::fstream stream(file,
+                          std::ios::in | std::ios::out | std::ios::binary);
+      // flip a cell between the FREE and OBJECT states
+      const auto pos = static_cast<std::streamoff>(fileSize / 2);
+      stream.seekg(pos);
+      const char state = static_cast<char>(stream.get());
+      stream.seekp(pos);
+      stream.put(static_cast<char>(state ^ 1));
+    }
+
+    // assert
+    REQUIRE_THROWS_AS(ConfigSpaceIO::readBinary(file), std::runtime_error);
+    REQUIRE_NOTHROW(ConfigSpaceIO::readBinary(file, false));
+  }
+
+  SECTION("Truncated payload")
+  {
+    // act
+    std::filesystem::resize_file(file, fileSize - 1);
+
+    // assert
+    REQUIRE_THROWS_AS(ConfigSpaceIO::readBinary(file, false),
+                      std::runtime_error);
+  }
+
+  SECTION("Invalid cell state")
+  {
+    // act
+    {
+      std::fstream stream(file,
+                          std::ios::in | std::ios::out | std::ios::binary);
+      // store a state past PADDED, with a matching checksum
+      std::vector<char> payload(fileSize - sizeof(ConfigSpaceFileHeader));
+      stream.seekg(sizeof(ConfigSpaceFileHeader));
+      stream.read(payload.data(), static_cast<std::streamsize>(payload.size()));
+      payload[payload.size() / 2] = 3;
+      Fnv1a hash;
+      hash.update(reinterpret_cast<const std::byte*>(payload.data()),
+                  payload.size());
+      const uint64_t checksum = hash.value();
+      stream.seekp(offsetof(ConfigSpaceFileHeader, checksum));
+      stream.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+      stream.seekp(sizeof(ConfigSpaceFileHeader));
+      stream.write(payload.data(),
+                   static_cast<std::streamsize>(payload.size()));
+    }
+
+    // assert
+    REQUIRE_THROWS_AS(ConfigSpaceIO::readBinary(file), std::runtime_error);
+  }
+
+  SECTION("Dimensions overflow")
+  {
+    // act
+    {
+      std::fstream stream(file,
+                          std::ios::in | std::ios::out | std::ios::binary);
+      // the product wraps to the original number of cells
+      const uint64_t nx = uint64_t{1} << 32U;
+      const uint64_t ny = (uint64_t{1} << 32U) + 70U * 45U;
+      stream.seekp(offsetof(ConfigSpaceFileHeader, nx));
+      stream.write(reinterpret_cast<const char*>(&nx), sizeof(nx));
+      stream.write(reinterpret_cast<const char*>(&ny), sizeof(ny));
+    }
+
+    // assert
+    REQUIRE_THROWS_AS(ConfigSpaceIO::readBinary(file, false),
+                      std::runtime_error);
+  }
+  std::filesystem::remove(file);
+}
+
+TEST_CASE("Text configuration space files with invalid states are rejected",
+          "[io]")
+{
+  // arrange
+  const std::filesystem::path file = TEST_DIR / "config-space-bad.txt";
+  std::filesystem::create_directories(TEST_DIR);
+  {
+    std::ofstream stream(file);
+    stream << "0\n3\n2\n0 0 0\n0 3 0\n";
+  }
+
+  // act & assert
+  REQUIRE_THROWS_AS(ConfigSpaceIO::read(file), std::runtime_error);
+  std::filesystem::remove(file);
+}
+
+TEST_CASE("Run-length encoding round trips when split into pieces", "[io]")
+{
+  // arrange
+  // runs both shorter and longer than a single LEB128 byte may hold
+  std::vector<std::byte> input;
+  for (const size_t runLength : {1U, 3U, 127U, 128U, 129U, 70000U, 1U}) {
+    input.insert(input.end(),
+                 runLength,
+                 static_cast<std::byte>(input.size() % 3U));
+  }
+  std::stringstream stream;
+
+  // act
+  RunLengthWriter writer(stream);
+  writer.write(input.data(), 100U);
+  writer.write(input.data() + 100U, input.size() - 100U);
+  writer.finish();
+  std::vector<std::byte> output(input.size());
+  RunLengthReader reader(stream);
+  reader.read(output.data(), 1U);
+  reader.read(output.data() + 1U, output.size() - 1U);
+  reader.finish();
+
+  // assert
+  REQUIRE(input == output);
+  REQUIRE(writer.bytesWritten() < 20U);
+  REQUIRE(writer.checksum() == reader.checksum());
+}
+
+TEST_CASE("Run-length encoded configuration space files round trip", "[io]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace();
+  const std::filesystem::path rawFile = TEST_DIR / "config-space-raw.bin";
+  const std::filesystem::path file = TEST_DIR / "config-space.rle.bin";
+
+  // act
+  ConfigSpaceIO::writeBinary(space, rawFile);
+  ConfigSpaceIO::writeBinary(space, file, payload_encoding::RUN_LENGTH);
+  const ConfigurationSpace loaded = ConfigSpaceIO::read(file);
+
+  // assert
+  REQUIRE(ConfigSpaceIO::isBinary(file));
+  REQUIRE(!loaded.cellStates().isView());
+  REQUIRE(std::filesystem::file_size(file) <
+          std::filesystem::file_size(rawFile) / 4U);
+  requireSameStates(space, loaded);
+  std::filesystem::remove(rawFile);
+  std::filesystem::remove(file);
+}
+
+TEST_CASE("Tiled configuration spaces are written as dense ones", "[io]")
+{
+  // arrange
+  const ConfigurationSpace dense = makeSpace();
+  ConfigurationSpace tiled(
+      dense.numX(), dense.numY(), dense.robotRadius(), grid_storage::TILED);
+  tiled.addObstacles(dense.obstacles());
+  const auto readBytes = [](const std::filesystem::path& file) {
+    std::ifstream inStream(file, std::ios::in | std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(inStream), {});
+  };
+  const auto requireSameFiles = [&](const std::string& name, auto write) {
+    const std::filesystem::path denseFile = TEST_DIR / "dense" / name;
+    const std::filesystem::path tiledFile = TEST_DIR / "tiled" / name;
+    write(dense, denseFile);
+    write(tiled, tiledFile);
+    REQUIRE(readBytes(denseFile) == readBytes(tiledFile));
+    std::filesystem::remove(denseFile);
+    std::filesystem::remove(tiledFile);
+  };
+
+  // act & assert
+  requireSameFiles("config-space.txt", [](const auto& space, const auto& f) {
+    ConfigSpaceIO::write(space, f);
+  });
+  requireSameFiles("config-space.bin", [](const auto& space, const auto& f) {
+    ConfigSpaceIO::writeBinary(space, f);
+  });
+  requireSameFiles("config-space.rle.bin",
+                   [](const auto& space, const auto& f) {
+                     ConfigSpaceIO::writeBinary(
+                         space, f, payload_encoding::RUN_LENGTH);
+                   });
+  requireSameFiles("config-space.pgm", [](const auto& space, const auto& f) {
+    ConfigSpaceImageIO::writePgm(space, f, 3);
+  });
+}
+
+TEST_CASE("Corrupt run-length encoded configuration space files are rejected",
+          "[io]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace();
+  const std::filesystem::path file = TEST_DIR / "config-space-bad.rle.bin";
+  ConfigSpaceIO::writeBinary(space, file, payload_encoding::RUN_LENGTH);
+  const auto fileSize = std::filesystem::file_size(file);
+
+  SECTION("Checksum mismatch")
+  {
+    // act
+    {
+      std::fstream stream(file,
+                          std::ios::in | std::ios::out | std::ios::binary);
+      // a payload edited in place may change its cell count, so the stored
+      // checksum is edited instead
+      const auto pos = static_cast<std::streamoff>(
+          offsetof(ConfigSpaceFileHeader, checksum));
+      stream.seekg(pos);
+      const char hashByte = static_cast<char>(stream.get());
+      stream.seekp(pos);
+      stream.put(static_cast<char>(hashByte ^ 1));
+    }
+
+    // assert
+    REQUIRE_NOTHROW(ConfigSpaceIO::readBinary(file, false));
+    REQUIRE_THROWS_AS(ConfigSpaceIO::readBinary(file), std::runtime_error);
+  }
+
+  SECTION("Truncated payload")
+  {
+    // act
+    std::filesystem::resize_file(file, fileSize - 2U);
+
+    // assert
+    REQUIRE_THROWS_AS(ConfigSpaceIO::readBinary(file, false),
+                      std::runtime_error);
+  }
+
+  SECTION("Trailing data")
+  {
+    // act
+    {
+      std::ofstream stream(file, std::ios::app | std::ios::binary);
+      stream.put('\0');
+    }
+
+    // assert
+    REQUIRE_THROWS_AS(ConfigSpaceIO::readBinary(file, false),
+                      std::runtime_error);
+  }
+  std::filesystem::remove(file);
+}
+
+TEST_CASE("Obstacle map files round trip", "[io]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace();
+  const std::filesystem::path file = TEST_DIR / "obstacle-map.bin";
+  const std::filesystem::path cachedFile = TEST_DIR / "obstacle-map-cached.bin";
+
+  // act
+  ObstacleMapIO::write(space, file);
+  ObstacleMapIO::write(space, cachedFile, true);
+  const ConfigurationSpace rasterized = ObstacleMapIO::read(file);
+  const ConfigurationSpace cached = ObstacleMapIO::read(cachedFile);
+  const ConfigurationSpace uncached = ObstacleMapIO::read(cachedFile, false);
+
+  // assert
+  REQUIRE(ObstacleMapIO::isObstacleMap(file));
+  REQUIRE(!ConfigSpaceIO::isBinary(file));
+  REQUIRE(std::filesystem::file_size(file) <
+          std::filesystem::file_size(cachedFile));
+  for (const ConfigurationSpace* loaded : {&rasterized, &cached, &uncached}) {
+    REQUIRE(loaded->hasObstacleGeometry());
+    REQUIRE(space.obstacles().size() == loaded->obstacles().size());
+    for (size_t idx = 0; idx < space.obstacles().size(); ++idx) {
+      REQUIRE(space.obstacles()[idx].center() ==
+              loaded->obstacles()[idx].center());
+      REQUIRE(space.obstacles()[idx].radius() ==
+              loaded->obstacles()[idx].radius());
+    }
+    requireSameStates(space, *loaded);
+  }
+  std::filesystem::remove(file);
+  std::filesystem::remove(cachedFile);
+}
+
+TEST_CASE("Obstacle maps require the obstacle geometry", "[io]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace();
+  const ConfigurationSpace fromStates(space.cellStates(), space.robotRadius());
+  const std::filesystem::path file = TEST_DIR / "obstacle-map-states.bin";
+
+  // act / assert
+  REQUIRE(!fromStates.hasObstacleGeometry());
+  REQUIRE_THROWS_AS(ObstacleMapIO::write(fromStates, file),
+                    std::runtime_error);
+}
+
+TEST_CASE("Configuration space images are downsampled to the darkest shade",
+          "[io]")
+{
+  // arrange
+  const std::filesystem::path file = TEST_DIR / "config-space.pgm";
+  DataMap<cell_state> states(std::make_pair(5, 3), cell_state::FREE);
+  states.at(1, 0) = cell_state::PADDED;
+  states.at(0, 1) = cell_state::OBJECT;
+  states.at(4, 2) = cell_state::PADDED;
+  const ConfigurationSpace space(states, 0);
+
+  // act
+  ConfigSpaceImageIO::writePgm(space, file, 2, {Cell(2, 2)});
+
+  // assert
+  std::ifstream inStream(file, std::ios::in | std::ios::binary);
+  std::string magic;
+  size_t width = 0;
+  size_t height = 0;
+  size_t maxShade = 0;
+  inStream >> magic >> width >> height >> maxShade;
+  inStream.get();
+  std::vector<char> pixels(width * height);
+  inStream.read(pixels.data(), static_cast<std::streamsize>(pixels.size()));
+  REQUIRE(inStream);
+  REQUIRE("P5" == magic);
+  REQUIRE(3U == width);
+  REQUIRE(2U == height);
+  REQUIRE(255U == maxShade);
+  const std::vector<uint8_t> expected{ConfigSpaceImageIO::OBJECT_SHADE,
+                                      ConfigSpaceImageIO::FREE_SHADE,
+                                      ConfigSpaceImageIO::FREE_SHADE,
+                                      ConfigSpaceImageIO::FREE_SHADE,
+                                      ConfigSpaceImageIO::PATH_SHADE,
+                                      ConfigSpaceImageIO::PADDED_SHADE};
+  REQUIRE(expected == std::vector<uint8_t>(pixels.begin(), pixels.end()));
+  REQUIRE_THROWS_AS(ConfigSpaceImageIO::writePgm(space, file, 0),
+                    std::runtime_error);
+  REQUIRE(3U == ConfigSpaceImageIO::numPixels(5, 2));
+  REQUIRE(1U == ConfigSpaceImageIO::numPixels(
+                    5, std::numeric_limits<size_t>::max()));
+  REQUIRE(0U == ConfigSpaceImageIO::numPixels(0, 2));
+}
+
+TEST_CASE("The planning service answers updates and queries by line",
+          "[io][service]")
+{
+  // arrange
+  ConfigurationSpace space(40, 30, 1);
+  PlanningService service(std::move(space));
+  const std::filesystem::path file = TEST_DIR / "service.pgm";
+  std::istringstream inStream("info\n"
+                              "# comment, and a blank line\n"
+                              "\n"
+                              "path 2 2 2 6\n"
+                              "add 2 4 1\n"
+                              "path 2 2 2 6\n"
+                              "move 2 4 1 30 20 2\n"
+                              "remove 30 20 2\n"
+                              "remove 30 20 2\n"
+                              "path 2 2 50 6\n"
+                              "add 2 -4 1\n"
+                              "path 2 2\n"
+                              "jump\n"
+                              "image " +
+                              file.string() +
+                              " 4\n"
+                              "quit\n"
+                              "info\n");
+  std::ostringstream outStream;
+
+  // act
+  service.serve(inStream, outStream);
+
+  // assert
+  std::istringstream replies(outStream.str());
+  std::vector<std::string> lines;
+  for (std::string line; std::getline(replies, line);) {
+    lines.push_back(line);
+  }
+  REQUIRE(13U == lines.size());
+  REQUIRE("ok 40 30 1 0 0" == lines[0]);
+  REQUIRE("ok 5 2 2 2 3 2 4 2 5 2 6" == lines[1]);
+  REQUIRE("ok 1 " == lines[2].substr(0, 5));
+  REQUIRE("ok 7 " == lines[3].substr(0, 5));
+  REQUIRE(lines[3].size() > lines[1].size());
+  REQUIRE("ok 2 " == lines[4].substr(0, 5));
+  REQUIRE("ok 3 " == lines[5].substr(0, 5));
+  REQUIRE("error " == lines[6].substr(0, 6));
+  REQUIRE("fail " == lines[7].substr(0, 5));
+  REQUIRE("error " == lines[8].substr(0, 6));
+  REQUIRE("error Missing argument" == lines[9]);
+  REQUIRE("error Unknown command: jump" == lines[10]);
+  REQUIRE("ok 10 8" == lines[11]);
+  REQUIRE("ok" == lines[12]);
+  REQUIRE(std::filesystem::is_regular_file(file));
+  REQUIRE(3U == service.configSpace().version());
+  REQUIRE(service.configSpace().obstacles().empty());
+}
+
+TEST_CASE("The planning service rejects obstacles beyond the space",
+          "[io][service]")
+{
+  // arrange
+  ConfigurationSpace space(40, 30, 1);
+  PlanningService service(std::move(space));
+  std::istringstream inStream("add 5 5 3037000500\n"
+                              "add 5 5 18446744073709551615\n"
+                              "add 40 5 1\n"
+                              "move 5 5 1 5 30 1\n"
+                              "add 39 29 70\n");
+  std::ostringstream outStream;
+
+  // act
+  service.serve(inStream, outStream);
+
+  // assert
+  std::istringstream replies(outStream.str());
+  std::vector<std::string> lines;
+  for (std::string line; std::getline(replies, line);) {
+    lines.push_back(line);
+  }
+  REQUIRE(5U == lines.size());
+  REQUIRE("error Obstacle radius larger than the space: 3037000500" ==
+          lines[0]);
+  REQUIRE(
+      "error Obstacle radius larger than the space: 18446744073709551615" ==
+      lines[1]);
+  REQUIRE("error Obstacle center outside of the space: 40 5" == lines[2]);
+  REQUIRE("error Obstacle center outside of the space: 5 30" == lines[3]);
+  // the largest radius accepted covers the whole space
+  REQUIRE("ok 1 " == lines[4].substr(0, 5));
+  REQUIRE(1U == service.configSpace().version());
+  REQUIRE(!service.configSpace().isAccessible({0, 0}));
+  REQUIRE(!service.configSpace().isAccessible({20, 15}));
+}
+
+TEST_CASE("The planning service rejects image scales beyond the space",
+          "[io][service]")
+{
+  // arrange
+  ConfigurationSpace space(40, 30, 1);
+  PlanningService service(std::move(space));
+  const std::filesystem::path file = TEST_DIR / "service-scale.pgm";
+  std::istringstream inStream("image " + file.string() +
+                              " 18446744073709551615\n"
+                              "image " + file.string() + " 41\n"
+                              "image " + file.string() + " 40\n"
+                              "image " + file.string() + " 0\n");
+  std::ostringstream outStream;
+
+  // act
+  service.serve(inStream, outStream);
+
+  // assert
+  std::istringstream replies(outStream.str());
+  std::vector<std::string> lines;
+  for (std::string line; std::getline(replies, line);) {
+    lines.push_back(line);
+  }
+  REQUIRE(4U == lines.size());
+  REQUIRE("error Image scale larger than the space: 18446744073709551615" ==
+          lines[0]);
+  REQUIRE("error Image scale larger than the space: 41" == lines[1]);
+  // the largest scale accepted gives a single pixel
+  REQUIRE("ok 1 1" == lines[2]);
+  REQUIRE("error " == lines[3].substr(0, 6));
+  REQUIRE(std::filesystem::is_regular_file(file));
+}
@@ -0,0 +1,168 @@
+/**
+ * @file GridTests.cpp
+ * @brief Unit tests for the grid data structures.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#include "Grid.h"
+
+#include "catch2.h"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace
+{
+// circles centered inside, on the edge of, and outside of a 40 x 30 grid
+const std::vector<Circle> CIRCLES = {Circle({20, 15}, 9),
+                                     Circle({0, 0}, 12),
+                                     Circle({39, 29}, 1),
+                                     Circle({45, 10}, 8),
+                                     Circle({10, 35}, 3),
+                                     Circle({5, 5}, 0)};
+
+bool withinRadius(const Circle& circle, const size_t xIdx, const size_t yIdx)
+{
+  const Cell& c = circle.center();
+  const size_t dx = c.xDistance({xIdx, yIdx});
+  const size_t dy = c.yDistance({xIdx, yIdx});
+  return dx * dx + dy * dy < circle.radius() * circle.radius();
+}
+} // namespace
+
+TEST_CASE("BitMap spans are valid across word boundaries", "[bitmap]")
+{
+  // arrange
+  const size_t nx = 200;
+  BitMap bits(std::make_pair(nx, 3));
+  std::vector<bool> expected(nx, false);
+
+  // act
+  bits.fillSpan(1, 3, 150, true);
+  bits.fillSpan(1, 60, 70, false);
+  bits.set(199, 1, true);
+  for (size_t xIdx = 3; xIdx <= 150; ++xIdx) {
+    expected[xIdx] = xIdx < 60 || xIdx > 70;
+  }
+  expected[199] = true;
+
+  // assert
+  for (size_t xIdx = 0; xIdx < nx; ++xIdx) {
+    REQUIRE(!bits.test(xIdx, 0));
+    REQUIRE(expected[xIdx] == bits.test(xIdx, 1));
+    REQUIRE(!bits.test(xIdx, 2));
+  }
+  REQUIRE(bits.allSet(1, 3, 59));
+  REQUIRE(bits.allSet(1, 71, 150));
+  REQUIRE(!bits.allSet(1, 3, 150));
+  REQUIRE(138 == bits.count(1, 0, nx - 1));
+  REQUIRE(0 == bits.count(0, 0, nx - 1));
+}
+
+TEST_CASE("BitMap can be initialized as set", "[bitmap]")
+{
+  // arrange & act
+  const BitMap bits(std::make_pair(65, 2), true);
+
+  // assert
+  REQUIRE(bits.allSet(0, 0, 64));
+  REQUIRE(bits.allSet(1, 0, 64));
+  REQUIRE(65 == bits.count(1, 0, 64));
+}
+
+TEST_CASE("Circles visit each cell within the radius exactly once", "[circle]")
+{
+  // arrange
+  const GridIndexer grid(40, 30);
+
+  for (const Circle& circle : CIRCLES) {
+    // act
+    std::vector<int> visits(grid.size(), 0);
+    GridCircle::visit(circle, grid, [&](const size_t xIdx, const size_t yIdx) {
+      ++visits[grid.idxFrom(xIdx, yIdx)];
+    });
+
+    // assert
+    for (size_t yIdx = 0; yIdx < grid.numY(); ++yIdx) {
+      for (size_t xIdx = 0; xIdx < grid.numX(); ++xIdx) {
+        const int expected = withinRadius(circle, xIdx, yIdx) ? 1 : 0;
+        REQUIRE(expected == visits[grid.idxFrom(xIdx, yIdx)]);
+      }
+    }
+  }
+}
+
+TEST_CASE("Circle ring and core spans partition the circle", "[circle]")
+{
+  // arrange
+  const GridIndexer grid(40, 30);
+
+  for (const Circle& circle : CIRCLES) {
+    const Circle core(circle.center(), circle.radius() / 2);
+    std::vector<int> ringVisits(grid.size(), 0);
+    std::vector<int> coreVisits(grid.size(), 0);
+    const auto countSpan = [&](std::vector<int>& visits) {
+      return [&](const size_t yIdx, const size_t x0, const size_t x1) {
+        REQUIRE(x0 <= x1);
+        REQUIRE(x1 < grid.numX());
+        for (size_t xIdx = x0; xIdx <= x1; ++xIdx) {
+          ++visits[grid.idxFrom(xIdx, yIdx)];
+        }
+      };
+    };
+
+    // act
+    GridCircle::visitRingSpans(circle,
+                               core.radius(),
+                               grid,
+                               countSpan(ringVisits),
+                               countSpan(coreVisits));
+
+    // assert
+    for (size_t yIdx = 0; yIdx < grid.numY(); ++yIdx) {
+      for (size_t xIdx = 0; xIdx < grid.numX(); ++xIdx) {
+        const size_t idx = grid.idxFrom(xIdx, yIdx);
+        const bool inCore = withinRadius(core, xIdx, yIdx);
+        const bool inRing = !inCore && withinRadius(circle, xIdx, yIdx);
+        REQUIRE((inCore ? 1 : 0) == coreVisits[idx]);
+        REQUIRE((inRing ? 1 : 0) == ringVisits[idx]);
+      }
+    }
+  }
+}
+
+TEST_CASE("Circles with huge radii cover the grid without overflowing",
+          "[circle]")
+{
+  // arrange
+  const GridIndexer grid(40, 30);
+  const size_t maxRadius = std::numeric_limits<size_t>::max();
+
+  for (const Circle& circle : {Circle({5, 5}, 3037000500U),
+                               Circle({45, 10}, maxRadius),
+                               Circle({1U << 20, 1U << 20}, maxRadius)}) {
+    std::vector<int> ringVisits(grid.size(), 0);
+    std::vector<int> coreVisits(grid.size(), 0);
+    const auto countSpan = [&](std::vector<int>& visits) {
+      return [&](const size_t yIdx, const size_t x0, const size_t x1) {
+        for (size_t xIdx = x0; xIdx <= x1; ++xIdx) {
+          ++visits[grid.idxFrom(xIdx, yIdx)];
+        }
+      };
+    };
+
+    // act
+    GridCircle::visitRingSpans(circle,
+                               circle.radius() - 1U,
+                               grid,
+                               countSpan(ringVisits),
+                               countSpan(coreVisits));
+
+    // assert
+    // every cell is well within both radii, so is in the core
+    REQUIRE(std::vector<int>(grid.size(), 0) == ringVisits);
+    REQUIRE(std::vector<int>(grid.size(), 1) == coreVisits);
+  }
+}
@@ -0,0 +1,1650 @@
+/**
+ * @file MotionPlanningTests.cpp
+ * @brief Unit tests for the motion planning algorithms.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#include "AnyAngle.h"
+#include "AnytimeSearch.h"
+#include "AsyncPlanning.h"
+#include "BatchPlanning.h"
+#include "BidirectionalSearch.h"
+#include "ConfigSpace.h"
+#include "DStarLite.h"
+#include "FlowField.h"
+#include "HierarchicalPlanning.h"
+#include "JumpPointSearch.h"
+#include "MotionPlanning.h"
+#include "PathCache.h"
+#include "Scenarios.h"
+#include "SearchStats.h"
+#include "SearchWorkspace.h"
+#include "ThreadPool.h"
+
+#include "catch2.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <stop_token>
+#include <utility>
+#include <vector>
+
+namespace
+{
+ConfigurationSpace makeSpace(const size_t nx,
+                             const size_t ny,
+                             const size_t robotRadius)
+{
+  ConfigurationSpace space(nx, ny, robotRadius);
+  space.addObstacles({Circle({nx / 3, ny / 2}, ny / 4),
+                      Circle({2 * nx / 3, ny / 3}, ny / 5)});
+  return space;
+}
+
+/**
+ * @brief Calculate the cost of a path with the given cost policy.
+ */
+template <typename CostPolicy>
+typename CostPolicy::cost_type pathCost(const std::vector<Cell>& path)
+{
+  typename CostPolicy::cost_type cost = 0;
+  for (size_t idx = 1; idx < path.size(); ++idx) {
+    for (size_t dir = 0; dir < NBR_OFFSETS.size(); ++dir) {
+      const Cell next(path[idx - 1].x() + NBR_OFFSETS[dir].dx,
+                      path[idx - 1].y() + NBR_OFFSETS[dir].dy);
+      if (next == path[idx]) {
+        REQUIRE(((CostPolicy::MOVES >> dir) & 1U));
+        cost += CostPolicy::stepCost(dir);
+      }
+    }
+  }
+  return cost;
+}
+
+/**
+ * @brief Reference implementation of the optimal path cost with the given cost
+ * policy, using Dijkstra's algorithm.
+ */
+template <typename CostPolicy>
+typename CostPolicy::cost_type dijkstraCost(
+    const ConfigurationSpace& space,
+    const Cell& start,
+    const Cell& goal,
+    const std::optional<size_t>& robotRadius = std::nullopt)
+{
+  using cost_type = typename CostPolicy::cost_type;
+  using Entry = std::pair<cost_type, size_t>;
+  constexpr cost_type UNSET = std::numeric_limits<cost_type>::max();
+  std::vector<cost_type> dist(space.size(), UNSET);
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+  dist[space.idxFrom(start)] = 0;
+  open.emplace(0, space.idxFrom(start));
+  while (!open.empty()) {
+    const auto [d, idx] = open.top();
+    open.pop();
+    if (d > dist[idx]) {
+      continue;
+    }
+    const Cell c(idx % space.numX(), idx / space.numX());
+    if (c == goal) {
+      return d;
+    }
+    const NeighborRange nbrs(
+        c, SearchUtils::nbrMask(space, c, robotRadius) & CostPolicy::MOVES);
+    for (auto it = nbrs.begin(); it != nbrs.end(); ++it) {
+      const cost_type nd = d + CostPolicy::stepCost(it.direction());
+      if (nd < dist[space.idxFrom(*it)]) {
+        dist[space.idxFrom(*it)] = nd;
+        open.emplace(nd, space.idxFrom(*it));
+      }
+    }
+  }
+  return UNSET;
+}
+
+/**
+ * @brief Check a path is connected and only passes through accessible cells.
+ */
+void requireValidPath(const ConfigurationSpace& space,
+                      const std::vector<Cell>& path,
+                      const Cell& start,
+                      const Cell& goal,
+                      const std::optional<size_t>& robotRadius = std::nullopt)
+{
+  REQUIRE(!path.empty());
+  REQUIRE(start == path.front());
+  REQUIRE(goal == path.back());
+  for (size_t idx = 0; idx < path.size(); ++idx) {
+    REQUIRE(SearchUtils::isAccessible(space, path[idx], robotRadius));
+    if (idx > 0) {
+      REQUIRE(path[idx - 1].distance(path[idx]) < 1.5);
+      REQUIRE(path[idx - 1] != path[idx]);
+    }
+  }
+}
+
+/**
+ * @brief Check a planner finds optimal paths for the given queries.
+ */
+template <typename Planner>
+void requireOptimalPaths(const ConfigurationSpace& space,
+                         const std::vector<std::pair<Cell, Cell>>& queries)
+{
+  using cost_policy = typename Planner::cost_policy;
+  const Planner search(space);
+  typename Planner::workspace_type workspace;
+  for (const auto& [start, goal] : queries) {
+    const std::vector<Cell> path = search.searchPath(start, goal, workspace);
+    requireValidPath(space, path, start, goal);
+    REQUIRE(pathCost<cost_policy>(path) ==
+            Approx(dijkstraCost<cost_policy>(space, start, goal)));
+  }
+}
+
+/**
+ * @brief Reference implementation of the line-of-sight test, clipping the
+ * segment between two cell centres against the open square of every blocked
+ * cell near it.
+ */
+bool referenceIsClear(const ConfigurationSpace& space,
+                      const Cell& a,
+                      const Cell& b,
+                      const std::optional<size_t>& robotRadius = std::nullopt)
+{
+  const double ax = static_cast<double>(a.x());
+  const double ay = static_cast<double>(a.y());
+  const double dx = static_cast<double>(b.x()) - ax;
+  const double dy = static_cast<double>(b.y()) - ay;
+  for (size_t y = std::min(a.y(), b.y()); y <= std::max(a.y(), b.y()); ++y) {
+    for (size_t x = std::min(a.x(), b.x()); x <= std::max(a.x(), b.x());
+         ++x) {
+      if (SearchUtils::isAccessible(space, Cell(x, y), robotRadius)) {
+        continue;
+      }
+      const double cx = static_cast<double>(x);
+      const double cy = static_cast<double>(y);
+      double t0 = 0.0;
+      double t1 = 1.0;
+      bool crosses = true;
+      for (const auto& [p, q] : {std::make_pair(-dx, ax - cx + 0.5),
+                                std::make_pair(dx, cx + 0.5 - ax),
+                                std::make_pair(-dy, ay - cy + 0.5),
+                                std::make_pair(dy, cy + 0.5 - ay)}) {
+        if (p == 0.0) {
+          crosses = crosses && q > 0.0;
+        } else if (p < 0.0) {
+          t0 = std::max(t0, q / p);
+        } else {
+          t1 = std::min(t1, q / p);
+        }
+      }
+      if (crosses && t1 - t0 > 1e-9) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Check a path of waypoints joins the start and goal with clear
+ * segments.
+ */
+void requireClearWaypoints(
+    const ConfigurationSpace& space,
+    const std::vector<Cell>& waypoints,
+    const Cell& start,
+    const Cell& goal,
+    const std::optional<size_t>& robotRadius = std::nullopt)
+{
+  REQUIRE(waypoints.size() >= 2U);
+  REQUIRE(start == waypoints.front());
+  REQUIRE(goal == waypoints.back());
+  for (size_t idx = 1; idx < waypoints.size(); ++idx) {
+    REQUIRE(waypoints[idx - 1] != waypoints[idx]);
+    REQUIRE(LineOfSight::isClear(
+        space, waypoints[idx - 1], waypoints[idx], robotRadius));
+  }
+}
+
+/**
+ * @brief A* planner which throws for queries starting at a given cell, and
+ * counts the other queries it answers.
+ */
+class ThrowingAStar : public AStar
+{
+  public:
+  ThrowingAStar(const SharedConfigSpace& cSpace,
+                const Cell& throwAt,
+                std::shared_ptr<std::atomic<size_t>> numAnswered)
+      : AStar(cSpace), m_throwAt(throwAt), m_numAnswered(std::move(numAnswered))
+  {
+    // do nothing
+  }
+
+  std::vector<Cell> searchPath(const Cell& start,
+                               const Cell& goal,
+                               workspace_type& workspace,
+                               SearchStats* stats = nullptr) const
+  {
+    if (start == m_throwAt) {
+      throw std::runtime_error("Query failed");
+    }
+    std::vector<Cell> path = AStar::searchPath(start, goal, workspace, stats);
+    ++*m_numAnswered;
+    return path;
+  }
+
+  private:
+  Cell m_throwAt;
+  std::shared_ptr<std::atomic<size_t>> m_numAnswered;
+};
+
+const std::vector<std::pair<Cell, Cell>> QUERIES{{{3, 3}, {146, 76}},
+                                                 {{10, 70}, {140, 5}},
+                                                 {{75, 3}, {5, 76}},
+                                                 {{3, 40}, {146, 40}},
+                                                 {{50, 3}, {50, 76}}};
+} // namespace
+
+TEST_CASE("Reused workspace produces the same paths as a fresh search",
+          "[workspace]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace(120, 60, 2);
+  const AStar search(space);
+  AStar::workspace_type workspace;
+
+  const std::vector<std::pair<Cell, Cell>> queries{
+      {{3, 3}, {116, 56}}, {{10, 50}, {110, 5}}, {{60, 3}, {5, 56}}};
+
+  // act & assert
+  for (size_t pass = 0; pass < 2; ++pass) {
+    for (const auto& [start, goal] : queries) {
+      const std::vector<Cell> expected = search.searchPath(start, goal);
+      const std::vector<Cell> actual =
+          search.searchPath(start, goal, workspace);
+      REQUIRE(!expected.empty());
+      REQUIRE(expected == actual);
+    }
+  }
+}
+
+TEST_CASE("Workspace is resized when reused on a different map", "[workspace]")
+{
+  // arrange
+  const ConfigurationSpace small = makeSpace(40, 30, 1);
+  const ConfigurationSpace large = makeSpace(90, 70, 1);
+  AStar::workspace_type workspace;
+
+  // act
+  const std::vector<Cell> smallPath =
+      AStar(small).searchPath({2, 2}, {37, 27}, workspace);
+  const std::vector<Cell> largePath =
+      AStar(large).searchPath({2, 2}, {87, 67}, workspace);
+
+  // assert
+  REQUIRE(smallPath == AStar(small).searchPath({2, 2}, {37, 27}));
+  REQUIRE(largePath == AStar(large).searchPath({2, 2}, {87, 67}));
+}
+
+TEST_CASE("Workspace node state is compact", "[workspace]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace(300, 200, 2);
+  AStar::workspace_type workspace;
+
+  // act
+  AStar(space).searchPath({3, 3}, {296, 196}, workspace);
+
+  // assert
+  // a 2-byte stamp, 4-byte parent and 4-byte g-cost per node, and a 4-byte
+  // open list position, plus the open list entries
+  REQUIRE(workspace.bytes() < 15U * space.size());
+  REQUIRE(8U == sizeof(AStar::workspace_type::open_list_type::Entry));
+}
+
+TEST_CASE("Reused workspace is valid once its generations wrap around",
+          "[workspace]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace(24, 16, 1);
+  const AStar search(space);
+  const std::vector<Cell> expected = search.searchPath({2, 2}, {21, 13});
+  AStar::workspace_type workspace;
+
+  REQUIRE(!expected.empty());
+
+  // act & assert
+  for (size_t query = 0; query < 70000; ++query) {
+    const std::vector<Cell> actual =
+        search.searchPath({2, 2}, {21, 13}, workspace);
+    if (query % 5000 == 0) {
+      REQUIRE(expected == actual);
+    }
+  }
+  REQUIRE(expected == search.searchPath({2, 2}, {21, 13}, workspace));
+}
+
+TEST_CASE("Tiled workspaces produce the same paths as dense workspaces",
+          "[workspace]")
+{
+  // arrange
+  // the map is not a whole number of tiles in either direction
+  const ConfigurationSpace space = makeSpace(150, 80, 2);
+
+  // act & assert
+  requireOptimalPaths<TiledAStar>(space, QUERIES);
+  requireOptimalPaths<TiledJumpPointSearch>(space, QUERIES);
+  for (const auto& [start, goal] : QUERIES) {
+    REQUIRE(AStar(space).searchPath(start, goal) ==
+            TiledAStar(space).searchPath(start, goal));
+  }
+}
+
+TEST_CASE("Tiled workspaces only allocate the tiles explored", "[workspace]")
+{
+  // arrange
+  const ConfigurationSpace space(1000, 1000, 2);
+  AStar::workspace_type dense;
+  TiledAStar::workspace_type tiled;
+
+  // act
+  const std::vector<Cell> densePath =
+      AStar(space).searchPath({500, 500}, {540, 520}, dense);
+  const std::vector<Cell> tiledPath =
+      TiledAStar(space).searchPath({500, 500}, {540, 520}, tiled);
+
+  // assert
+  REQUIRE(densePath == tiledPath);
+  REQUIRE(tiled.bytes() * 20U < dense.bytes());
+}
+
+TEST_CASE("Planners share a configuration space without copying it",
+          "[shared]")
+{
+  // arrange
+  const SharedConfigSpace space =
+      std::make_shared<const ConfigurationSpace>(makeSpace(120, 60, 2));
+
+  // act
+  const AStar search1(space);
+  const AStar search2(space);
+  const AStar borrowed(*space);
+
+  // assert
+  REQUIRE(&search1.configSpace() == space.get());
+  REQUIRE(&search2.configSpace() == space.get());
+  REQUIRE(&borrowed.configSpace() == space.get());
+  REQUIRE(3 == space.use_count());
+  REQUIRE(search1.searchPath({3, 3}, {116, 56}) ==
+          borrowed.searchPath({3, 3}, {116, 56}));
+}
+
+TEST_CASE("Jump point search finds optimal paths", "[jps]")
+{
+  const ConfigurationSpace space = makeSpace(150, 80, 2);
+  requireOptimalPaths<JumpPointSearch>(space, QUERIES);
+  requireOptimalPaths<BasicJumpPointSearch<EuclideanCost>>(space, QUERIES);
+}
+
+TEST_CASE("Jump point search rejects unreachable goals", "[jps]")
+{
+  // arrange
+  ConfigurationSpace space(100, 50, 2);
+  space.addObstacles({Circle({50, 25}, 30)});
+  const JumpPointSearch search(space);
+
+  // act & assert
+  REQUIRE(search.searchPath({3, 3}, {96, 46}).empty());
+}
+
+TEST_CASE("Bidirectional A* finds optimal paths with each cost policy",
+          "[bidirectional]")
+{
+  const ConfigurationSpace space = makeSpace(150, 80, 2);
+  requireOptimalPaths<BasicBidirectionalAStar<OctileCost>>(space, QUERIES);
+  requireOptimalPaths<BasicBidirectionalAStar<ChebyshevCost>>(space, QUERIES);
+  requireOptimalPaths<BasicBidirectionalAStar<ManhattanCost>>(space, QUERIES);
+  requireOptimalPaths<BasicBidirectionalAStar<EuclideanCost>>(space, QUERIES);
+  requireOptimalPaths<
+      BasicBidirectionalAStar<OctileCost, BucketQueue<uint32_t>>>(space,
+                                                                  QUERIES);
+}
+
+TEST_CASE("Bidirectional A* on two threads finds optimal paths",
+          "[bidirectional]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace(150, 80, 2);
+  const BidirectionalAStar search(space);
+  BidirectionalAStar::workspace_type workspace;
+
+  for (const auto& [start, goal] : QUERIES) {
+    SearchStats stats;
+
+    // act
+    const std::vector<Cell> path =
+        search.searchPathParallel(start, goal, workspace, &stats);
+
+    // assert
+    REQUIRE(search_status::FOUND == stats.status);
+    requireValidPath(space, path, start, goal);
+    REQUIRE(dijkstraCost<OctileCost>(space, start, goal) ==
+            pathCost<OctileCost>(path));
+  }
+
+  // an adjacent goal is met within the first batch
+  REQUIRE(2U == search.searchPathParallel({3, 3}, {4, 4}, workspace).size());
+}
+
+TEST_CASE("Bidirectional A* expands fewer nodes in corridors",
+          "[bidirectional]")
+{
+  // arrange
+  const size_t nx = 100;
+  const size_t ny = 250;
+  ConfigurationSpace space(nx, ny, 2);
+  space.addObstacles(Scenarios::obstacles(obstacle_config::COMPLEX, nx, ny, 2));
+  const Cell start = Scenarios::start(nx, ny, 2);
+  const Cell goal = Scenarios::goal(nx, ny, 2);
+  AStar::workspace_type workspace;
+  BidirectionalAStar::workspace_type bidirectionalWorkspace;
+  SearchStats stats;
+  SearchStats bidirectionalStats;
+
+  // act
+  const std::vector<Cell> path =
+      AStar(space).searchPath(start, goal, workspace, &stats);
+  const std::vector<Cell> bidirectionalPath =
+      BidirectionalAStar(space).searchPath(
+          start, goal, bidirectionalWorkspace, &bidirectionalStats);
+
+  // assert
+  REQUIRE(pathCost<OctileCost>(path) ==
+          pathCost<OctileCost>(bidirectionalPath));
+  REQUIRE(bidirectionalStats.nodesExpanded < stats.nodesExpanded);
+}
+
+TEST_CASE("Bidirectional A* reports goals not found by a search",
+          "[bidirectional]")
+{
+  // arrange
+  // the goal is connected to the start, but not by moves along the axes
+  DataMap<cell_state> states(std::make_pair(6, 6), cell_state::FREE);
+  for (size_t idx = 0; idx < 6; ++idx) {
+    states.at(idx, 5 - idx) = cell_state::OBJECT;
+  }
+  const ConfigurationSpace space(states, 0);
+  const BasicBidirectionalAStar<ManhattanCost> search(space);
+  BasicBidirectionalAStar<ManhattanCost>::workspace_type workspace;
+  SearchStats stats;
+  SearchStats parallelStats;
+
+  // act
+  const std::vector<Cell> path =
+      search.searchPath({0, 0}, {5, 5}, workspace, &stats);
+  const std::vector<Cell> parallelPath =
+      search.searchPathParallel({0, 0}, {5, 5}, workspace, &parallelStats);
+
+  // assert
+  REQUIRE(path.empty());
+  REQUIRE(parallelPath.empty());
+  REQUIRE(search_status::NOT_FOUND == stats.status);
+  REQUIRE(search_status::NOT_FOUND == parallelStats.status);
+}
+
+TEST_CASE("A* paths include the start and goal", "[astar]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace(120, 60, 2);
+  const AStar search(space);
+
+  // act
+  const std::vector<Cell> path = search.searchPath({3, 3}, {116, 56});
+
+  // assert
+  requireValidPath(space, path, {3, 3}, {116, 56});
+}
+
+TEST_CASE("Batch planning matches sequential planning", "[batch]")
+{
+  // arrange
+  const SharedConfigSpace space =
+      std::make_shared<const ConfigurationSpace>(makeSpace(150, 80, 2));
+  BatchPlanner<AStar> batch(space, 3);
+  BatchPlanner<JumpPointSearch> jpsBatch(space, 2);
+
+  std::vector<PathQuery> queries;
+  for (size_t idx = 0; idx < 20; ++idx) {
+    queries.emplace_back(Cell(3 + idx, 3), Cell(146 - idx, 76));
+    queries.emplace_back(Cell(3, 76 - idx), Cell(146, 3 + idx));
+  }
+
+  // act
+  const std::vector<std::vector<Cell>> paths = batch.searchPaths(queries);
+  const std::vector<std::vector<Cell>> jpsPaths =
+      jpsBatch.searchPaths(queries);
+
+  // assert
+  REQUIRE(queries.size() == paths.size());
+  REQUIRE(queries.size() == jpsPaths.size());
+  const AStar search(space);
+  const JumpPointSearch jps(space);
+  for (size_t idx = 0; idx < queries.size(); ++idx) {
+    const auto& [start, goal] = queries[idx];
+    REQUIRE(search.searchPath(start, goal) == paths[idx]);
+    REQUIRE(jps.searchPath(start, goal) == jpsPaths[idx]);
+  }
+}
+
+TEST_CASE("Batch planning answers all queries before rethrowing an error",
+          "[batch]")
+{
+  // arrange
+  const SharedConfigSpace space =
+      std::make_shared<const ConfigurationSpace>(makeSpace(150, 80, 2));
+  const auto numAnswered = std::make_shared<std::atomic<size_t>>(0U);
+  BatchPlanner<ThrowingAStar> batch(
+      ThrowingAStar(space, Cell(3, 3), numAnswered),
+      std::make_shared<ThreadPool>(3));
+  // the failing query is taken first, while the others are still searched
+  std::vector<PathQuery> queries{{Cell(3, 3), Cell(146, 76)}};
+  for (size_t idx = 0; idx < 40; ++idx) {
+    queries.emplace_back(Cell(4 + idx, 3), Cell(146 - idx, 76));
+  }
+
+  // act & assert
+  REQUIRE_THROWS_AS(batch.searchPaths(queries), std::runtime_error);
+  REQUIRE(queries.size() - 1 == numAnswered->load());
+}
+
+TEST_CASE("A* finds optimal paths with each cost policy", "[astar]")
+{
+  const ConfigurationSpace space = makeSpace(150, 80, 2);
+  requireOptimalPaths<BasicAStar<OctileCost>>(space, QUERIES);
+  requireOptimalPaths<BasicAStar<ChebyshevCost>>(space, QUERIES);
+  requireOptimalPaths<BasicAStar<ManhattanCost>>(space, QUERIES);
+  requireOptimalPaths<BasicAStar<EuclideanCost>>(space, QUERIES);
+  requireOptimalPaths<BasicAStar<OctileCost, BucketQueue<uint32_t>>>(space,
+                                                                     QUERIES);
+}
+
+TEST_CASE("Weighted A* paths are within the weight of optimal", "[astar]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace(150, 80, 2);
+  const BasicAStar<WeightedCost<OctileCost, 3, 2>> search(space);
+
+  // act & assert
+  for (const auto& [start, goal] : QUERIES) {
+    const std::vector<Cell> path = search.searchPath(start, goal);
+    requireValidPath(space, path, start, goal);
+    const uint32_t optimal = dijkstraCost<OctileCost>(space, start, goal);
+    REQUIRE(pathCost<OctileCost>(path) >= optimal);
+    REQUIRE(2 * pathCost<OctileCost>(path) <= 3 * optimal);
+  }
+}
+
+TEST_CASE("Search stats report the outcome and work of each query", "[stats]")
+{
+  // arrange
+  ConfigurationSpace space = makeSpace(150, 80, 2);
+  const AStar search(space);
+  const JumpPointSearch jps(space);
+  AStar::workspace_type workspace;
+  JumpPointSearch::workspace_type jpsWorkspace;
+  SearchStats stats;
+  SearchStats jpsStats;
+
+  // act
+  const std::vector<Cell> path =
+      search.searchPath({3, 3}, {146, 76}, workspace, &stats);
+  const std::vector<Cell> jpsPath =
+      jps.searchPath({3, 3}, {146, 76}, jpsWorkspace, &jpsStats);
+
+  // assert
+  REQUIRE(!path.empty());
+  REQUIRE(search_status::FOUND == stats.status);
+  REQUIRE(stats.nodesExpanded > 0U);
+  REQUIRE(stats.heapPops == stats.nodesExpanded + stats.stalePops);
+  REQUIRE(stats.heapPushes >= stats.nodesExpanded);
+  REQUIRE(stats.peakOpenListSize > 0U);
+  REQUIRE(stats.workspaceBytes == workspace.bytes());
+  REQUIRE(search_status::FOUND == jpsStats.status);
+  REQUIRE(jpsStats.nodesExpanded < stats.nodesExpanded);
+
+  // each invalid query reports why it was rejected
+  search.searchPath({3, 3}, {150, 3}, workspace, &stats);
+  REQUIRE(search_status::GOAL_OUTSIDE == stats.status);
+  REQUIRE(0U == stats.nodesExpanded);
+  search.searchPath({0, 0}, {146, 76}, workspace, &stats);
+  REQUIRE(search_status::START_BLOCKED == stats.status);
+  search.searchPath({3, 3}, {3, 3}, workspace, &stats);
+  REQUIRE(search_status::START_AT_GOAL == stats.status);
+}
+
+TEST_CASE("Search stats report unreachable goals", "[stats]")
+{
+  // arrange
+  ConfigurationSpace space(100, 50, 2);
+  space.addObstacles({Circle({50, 25}, 30)});
+  const AStar search(space);
+  AStar::workspace_type workspace;
+  SearchStats stats;
+
+  // act
+  const std::vector<Cell> path =
+      search.searchPath({3, 3}, {96, 46}, workspace, &stats);
+
+  // assert
+  // the goal is in another component, so is rejected without searching
+  REQUIRE(path.empty());
+  REQUIRE(search_status::UNREACHABLE == stats.status);
+  REQUIRE(0U == stats.nodesExpanded);
+}
+
+TEST_CASE("Search stats report goals not found by a search", "[stats]")
+{
+  // arrange
+  // the goal is connected to the start, but not by moves along the axes
+  DataMap<cell_state> states(std::make_pair(6, 6), cell_state::FREE);
+  for (size_t idx = 0; idx < 6; ++idx) {
+    states.at(idx, 5 - idx) = cell_state::OBJECT;
+  }
+  const ConfigurationSpace space(states, 0);
+  const BasicAStar<ManhattanCost> search(space);
+  BasicAStar<ManhattanCost>::workspace_type workspace;
+  SearchStats stats;
+
+  // act
+  const std::vector<Cell> path =
+      search.searchPath({0, 0}, {5, 5}, workspace, &stats);
+
+  // assert
+  REQUIRE(path.empty());
+  REQUIRE(search_status::NOT_FOUND == stats.status);
+  REQUIRE(stats.nodesExpanded > 0U);
+}
+
+TEST_CASE("Planners search one configuration space at any robot radius",
+          "[clearance]")
+{
+  // arrange
+  ConfigurationSpace space = makeSpace(150, 80, 0);
+  space.computeClearance();
+
+  for (const size_t robotRadius : {0U, 1U, 3U}) {
+    const AStar search(space, robotRadius);
+    const JumpPointSearch jps(space, robotRadius);
+    REQUIRE(robotRadius == search.robotRadius());
+
+    // act & assert
+    for (const auto& [start, goal] : QUERIES) {
+      const std::vector<Cell> path = search.searchPath(start, goal);
+      const std::vector<Cell> jpsPath = jps.searchPath(start, goal);
+      requireValidPath(space, path, start, goal, robotRadius);
+      requireValidPath(space, jpsPath, start, goal, robotRadius);
+      const uint32_t optimal =
+          dijkstraCost<OctileCost>(space, start, goal, robotRadius);
+      REQUIRE(optimal == pathCost<OctileCost>(path));
+      REQUIRE(optimal == pathCost<OctileCost>(jpsPath));
+    }
+  }
+
+  // too large a robot cannot reach the goal
+  const AStar search(space, 20);
+  SearchStats stats;
+  AStar::workspace_type workspace;
+  REQUIRE(search.searchPath({3, 3}, {146, 76}, workspace, &stats).empty());
+  REQUIRE(search_status::START_BLOCKED == stats.status);
+}
+
+TEST_CASE("Searching at a robot radius requires the clearance", "[clearance]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace(60, 40, 2);
+
+  // act & assert
+  REQUIRE_THROWS_AS(AStar(space, 3), std::runtime_error);
+  REQUIRE_THROWS_AS(JumpPointSearch(space, 3), std::runtime_error);
+}
+
+TEST_CASE("D* Lite finds optimal paths", "[dstar]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace(150, 80, 2);
+  const std::vector<std::pair<Cell, Cell>> queries{
+      {{3, 3}, {146, 76}}, {{146, 3}, {3, 76}}, {{75, 3}, {75, 76}}};
+
+  for (const auto& [start, goal] : queries) {
+    DStarLite search(space, start, goal);
+    SearchStats stats;
+
+    // act
+    const std::vector<Cell> path = search.searchPath(&stats);
+
+    // assert
+    REQUIRE(search_status::FOUND == stats.status);
+    requireValidPath(space, path, start, goal);
+    REQUIRE(dijkstraCost<OctileCost>(space, start, goal) ==
+            pathCost<OctileCost>(path));
+  }
+}
+
+TEST_CASE("D* Lite repairs its path as obstacles are discovered", "[dstar]")
+{
+  // arrange
+  ConfigurationSpace space = makeSpace(160, 100, 1);
+  const Cell goal(156, 96);
+  DStarLite search(space, {3, 3}, goal);
+  SearchStats stats;
+  std::vector<Cell> path = search.searchPath(&stats);
+  const size_t initialExpanded = stats.nodesExpanded;
+  size_t numReplans = 0;
+
+  // act & assert
+  // follow the path, discovering an obstacle on it ahead of the robot after
+  // each few steps
+  while (path.size() > 30U) {
+    search.moveStart(path[8]);
+    std::vector<Cell> changedCells;
+    space.addObstacles({Circle(path[24], 3)}, &changedCells);
+    REQUIRE(!changedCells.empty());
+    search.updateCells(changedCells);
+
+    path = search.searchPath(&stats);
+    REQUIRE(search_status::FOUND == stats.status);
+    requireValidPath(space, path, search.start(), goal);
+    REQUIRE(dijkstraCost<OctileCost>(space, search.start(), goal) ==
+            pathCost<OctileCost>(path));
+    // only the part of the search affected by the obstacle is repaired
+    REQUIRE(stats.nodesExpanded < initialExpanded / 4);
+    ++numReplans;
+  }
+  REQUIRE(numReplans > 5U);
+}
+
+TEST_CASE("D* Lite reports goals cut off by discovered obstacles", "[dstar]")
+{
+  // arrange
+  ConfigurationSpace space(100, 50, 2);
+  DStarLite search(space, {3, 3}, {96, 46});
+  REQUIRE(!search.searchPath().empty());
+  std::vector<Cell> changedCells;
+
+  // act
+  space.addObstacles({Circle({50, 25}, 30)}, &changedCells);
+  search.updateCells(changedCells);
+  SearchStats stats;
+  const std::vector<Cell> path = search.searchPath(&stats);
+
+  // assert
+  REQUIRE(path.empty());
+  REQUIRE(search_status::UNREACHABLE == stats.status);
+}
+
+TEST_CASE("D* Lite rejects searches on a map changed without an update",
+          "[dstar]")
+{
+  // arrange
+  ConfigurationSpace space(256, 256, 2);
+  const Cell goal(250, 250);
+  DStarLite search(space, {5, 5}, goal);
+  DStarLite unrepaired(space, {5, 5}, goal);
+  REQUIRE(!search.searchPath().empty());
+  REQUIRE(!unrepaired.searchPath().empty());
+  std::vector<Cell> changedCells;
+  space.addObstacles({Circle({128, 128}, 20)}, &changedCells);
+
+  // act
+  SearchStats staleStats;
+  const std::vector<Cell> stalePath = search.searchPath(&staleStats);
+  search.updateCells(changedCells);
+  SearchStats stats;
+  const std::vector<Cell> path = search.searchPath(&stats);
+  // missing the changed cells, so the search state is inconsistent
+  unrepaired.updateCells({});
+  SearchStats unrepairedStats;
+  const std::vector<Cell> unrepairedPath =
+      unrepaired.searchPath(&unrepairedStats);
+
+  // assert
+  REQUIRE(stalePath.empty());
+  REQUIRE(search_status::MAP_CHANGED == staleStats.status);
+  REQUIRE(unrepairedPath.empty());
+  REQUIRE(search_status::NOT_FOUND == unrepairedStats.status);
+  REQUIRE(search_status::FOUND == stats.status);
+  requireValidPath(space, path, {5, 5}, goal);
+}
+
+TEST_CASE("Hierarchical planner finds near-optimal paths", "[hpa]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace(150, 80, 1);
+  const HierarchicalPlanner search(space, 16);
+  HierarchicalPlanner::workspace_type workspace;
+  std::vector<std::pair<Cell, Cell>> queries = QUERIES;
+  // within a single cluster
+  queries.push_back({{3, 3}, {12, 14}});
+
+  for (const auto& [start, goal] : queries) {
+    SearchStats stats;
+
+    // act
+    const std::vector<Cell> path =
+        search.searchPath(start, goal, workspace, &stats);
+
+    // assert
+    REQUIRE(search_status::FOUND == stats.status);
+    requireValidPath(space, path, start, goal);
+    const uint32_t optimal = dijkstraCost<OctileCost>(space, start, goal);
+    REQUIRE(pathCost<OctileCost>(path) >= optimal);
+    REQUIRE(pathCost<OctileCost>(path) <= optimal * 11U / 10U);
+  }
+}
+
+TEST_CASE("Hierarchical planner finds paths with straight moves only",
+          "[hpa]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace(150, 80, 1);
+  const BasicHierarchicalPlanner<ManhattanCost> search(space, 16);
+
+  for (const auto& [start, goal] : QUERIES) {
+    // act
+    const std::vector<Cell> path = search.searchPath(start, goal);
+
+    // assert
+    requireValidPath(space, path, start, goal);
+    const uint32_t optimal = dijkstraCost<ManhattanCost>(space, start, goal);
+    REQUIRE(pathCost<ManhattanCost>(path) >= optimal);
+    REQUIRE(pathCost<ManhattanCost>(path) <= optimal * 11U / 10U);
+  }
+}
+
+TEST_CASE("Hierarchical planner updates match a rebuilt planner", "[hpa]")
+{
+  // arrange
+  ConfigurationSpace space = makeSpace(150, 80, 1);
+  ThreadPool pool(2);
+  HierarchicalPlanner search(space, 16);
+  HierarchicalPlanner pooledSearch(space, pool, 16);
+  std::vector<Cell> changedCells;
+
+  // act
+  // including obstacles over the borders and corners of clusters
+  space.addObstacles({Circle({32, 40}, 5), Circle({100, 15}, 9)},
+                     &changedCells);
+  search.updateCells(changedCells);
+  pooledSearch.updateCells(changedCells, pool);
+  const HierarchicalPlanner rebuilt(space, 16);
+
+  // assert
+  REQUIRE(rebuilt.numNodes() == search.numNodes());
+  REQUIRE(rebuilt.numEdges() == search.numEdges());
+  REQUIRE(rebuilt.numNodes() == pooledSearch.numNodes());
+  REQUIRE(rebuilt.numEdges() == pooledSearch.numEdges());
+  for (const auto& [start, goal] : QUERIES) {
+    const std::vector<Cell> expected = rebuilt.searchPath(start, goal);
+    requireValidPath(space, expected, start, goal);
+    REQUIRE(expected == search.searchPath(start, goal));
+    REQUIRE(expected == pooledSearch.searchPath(start, goal));
+  }
+}
+
+TEST_CASE("Hierarchical planner rejects queries on a map changed without "
+          "an update",
+          "[hpa]")
+{
+  // arrange
+  // a wall within a column of clusters, with a gap in the upper cluster, and
+  // a longer way around it at the bottom of the lower cluster
+  DataMap<cell_state> states(std::make_pair(64, 32), cell_state::FREE);
+  for (size_t yIdx = 4; yIdx < 32; ++yIdx) {
+    for (size_t xIdx = 24; xIdx < 27 && (yIdx < 20 || yIdx > 22); ++xIdx) {
+      states.at(xIdx, yIdx) = cell_state::OBJECT;
+    }
+  }
+  ConfigurationSpace space(states, 0);
+  HierarchicalPlanner search(space, 16);
+  HierarchicalPlanner unrepaired(space, 16);
+  HierarchicalPlanner::workspace_type workspace;
+  const Cell start(2, 24);
+  const Cell goal(45, 24);
+  REQUIRE(!search.searchPath(start, goal).empty());
+  std::vector<Cell> changedCells;
+  space.addObstacles({Circle({25, 21}, 2)}, &changedCells);
+
+  // act
+  SearchStats staleStats;
+  const std::vector<Cell> stalePath =
+      search.searchPath(start, goal, workspace, &staleStats);
+  search.updateCells(changedCells);
+  SearchStats stats;
+  const std::vector<Cell> path =
+      search.searchPath(start, goal, workspace, &stats);
+  // missing the changed cells, so the graph still crosses the gap
+  unrepaired.updateCells({});
+  SearchStats unrepairedStats;
+  const std::vector<Cell> unrepairedPath =
+      unrepaired.searchPath(start, goal, workspace, &unrepairedStats);
+
+  // assert
+  REQUIRE(stalePath.empty());
+  REQUIRE(search_status::MAP_CHANGED == staleStats.status);
+  REQUIRE(search.isCurrent());
+  REQUIRE(search_status::FOUND == stats.status);
+  requireValidPath(space, path, start, goal);
+  REQUIRE(unrepairedPath.empty());
+  REQUIRE(search_status::NOT_FOUND == unrepairedStats.status);
+}
+
+TEST_CASE("Hierarchical planner finds goals reached diagonally between "
+          "clusters",
+          "[hpa]")
+{
+  // arrange
+  // the only way between the lower left and upper right clusters is the
+  // diagonal move across their corners
+  DataMap<cell_state> states(std::make_pair(8, 8), cell_state::FREE);
+  for (size_t yIdx = 0; yIdx < 4; ++yIdx) {
+    for (size_t xIdx = 0; xIdx < 4; ++xIdx) {
+      states.at(xIdx + 4, yIdx) = cell_state::OBJECT;
+      states.at(xIdx, yIdx + 4) = cell_state::OBJECT;
+    }
+  }
+  const ConfigurationSpace space(states, 0);
+  const HierarchicalPlanner search(space, 4);
+  HierarchicalPlanner::workspace_type workspace;
+  SearchStats stats;
+
+  // act
+  const std::vector<Cell> path =
+      search.searchPath({0, 0}, {7, 7}, workspace, &stats);
+
+  // assert
+  REQUIRE(2U == search.numNodes());
+  REQUIRE(search_status::FOUND == stats.status);
+  requireValidPath(space, path, {0, 0}, {7, 7});
+  REQUIRE(dijkstraCost<OctileCost>(space, {0, 0}, {7, 7}) ==
+          pathCost<OctileCost>(path));
+}
+
+TEST_CASE("Hierarchical planner finds goals joined only by diagonal moves",
+          "[hpa]")
+{
+  // arrange
+  // a checkerboard, whose free cells are only joined diagonally, around a
+  // free block
+  DataMap<cell_state> states(std::make_pair(45, 38), cell_state::FREE);
+  for (size_t yIdx = 0; yIdx < states.numY(); ++yIdx) {
+    for (size_t xIdx = 0; xIdx < states.numX(); ++xIdx) {
+      const bool inBlock = xIdx >= 15 && xIdx < 25 && yIdx >= 12 && yIdx < 20;
+      if (!inBlock && (xIdx + yIdx) % 2 == 0) {
+        states.at(xIdx, yIdx) = cell_state::OBJECT;
+      }
+    }
+  }
+  const ConfigurationSpace space(states, 0);
+  const std::vector<std::pair<Cell, Cell>> queries{
+      {{1, 0}, {44, 37}}, {{0, 37}, {44, 1}}, {{20, 15}, {3, 36}}};
+
+  for (const size_t clusterSize : {size_t{7}, size_t{8}}) {
+    const HierarchicalPlanner search(space, clusterSize);
+    for (const auto& [start, goal] : queries) {
+      REQUIRE(space.isConnected(start, goal));
+      SearchStats stats;
+
+      // act
+      HierarchicalPlanner::workspace_type workspace;
+      const std::vector<Cell> path =
+          search.searchPath(start, goal, workspace, &stats);
+
+      // assert
+      REQUIRE(search_status::FOUND == stats.status);
+      requireValidPath(space, path, start, goal);
+      REQUIRE(pathCost<OctileCost>(path) >=
+              dijkstraCost<OctileCost>(space, start, goal));
+    }
+  }
+}
+
+TEST_CASE("Flow field paths are optimal from every start", "[flowfield]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace(150, 80, 2);
+  const Cell goal(146, 76);
+  const FlowField field(space, goal);
+  const BasicFlowField<ManhattanCost> manhattanField(space, goal);
+  const BasicFlowField<EuclideanCost> euclideanField(space, goal);
+
+  for (const auto& query : QUERIES) {
+    const Cell start = query.first;
+    SearchStats stats;
+
+    // act
+    const std::vector<Cell> path = field.searchPath(start, &stats);
+    const std::vector<Cell> manhattanPath = manhattanField.searchPath(start);
+    const std::vector<Cell> euclideanPath = euclideanField.searchPath(start);
+
+    // assert
+    REQUIRE(search_status::FOUND == stats.status);
+    REQUIRE(0U == stats.nodesExpanded);
+    requireValidPath(space, path, start, goal);
+    requireValidPath(space, manhattanPath, start, goal);
+    requireValidPath(space, euclideanPath, start, goal);
+    const uint32_t optimal = dijkstraCost<OctileCost>(space, start, goal);
+    REQUIRE(optimal == pathCost<OctileCost>(path));
+    REQUIRE(optimal == field.costToGoal(start));
+    REQUIRE(dijkstraCost<ManhattanCost>(space, start, goal) ==
+            pathCost<ManhattanCost>(manhattanPath));
+    REQUIRE(dijkstraCost<EuclideanCost>(space, start, goal) ==
+            Approx(pathCost<EuclideanCost>(euclideanPath)));
+  }
+  REQUIRE(0U == field.costToGoal(goal));
+}
+
+TEST_CASE("Flow field reports starts which can't reach the goal",
+          "[flowfield]")
+{
+  // arrange
+  ConfigurationSpace space(100, 50, 2);
+  space.addObstacles({Circle({50, 25}, 30)});
+  const FlowField field(space, {96, 46});
+  const FlowField blockedField(space, {50, 25});
+  SearchStats stats;
+
+  // act & assert
+  REQUIRE(field.searchPath({3, 3}, &stats).empty());
+  REQUIRE(search_status::UNREACHABLE == stats.status);
+  REQUIRE(!field.isReachable({3, 3}));
+  REQUIRE(field.isReachable({90, 40}));
+  REQUIRE(FlowField::NO_STEP == field.step({3, 3}));
+  REQUIRE(FlowField::GOAL_STEP == field.step({96, 46}));
+
+  REQUIRE(0U == blockedField.numReachable());
+  REQUIRE(blockedField.searchPath({3, 3}, &stats).empty());
+  REQUIRE(search_status::GOAL_BLOCKED == stats.status);
+}
+
+TEST_CASE("Flow field is shared between threads", "[flowfield]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace(150, 80, 2);
+  const FlowField field(space, {146, 76});
+  ThreadPool pool(4);
+  std::vector<Cell> starts;
+  for (size_t xIdx = 3; xIdx < 147; xIdx += 9) {
+    starts.emplace_back(xIdx, 3);
+  }
+
+  // act
+  std::vector<std::future<std::vector<Cell>>> results;
+  for (const Cell& start : starts) {
+    results.push_back(pool.submit([&field, start](const size_t /* worker */) {
+      return field.searchPath(start);
+    }));
+  }
+
+  // assert
+  for (size_t idx = 0; idx < starts.size(); ++idx) {
+    REQUIRE(field.searchPath(starts[idx]) == results[idx].get());
+  }
+}
+
+TEST_CASE("Flow field tracks the version of the map", "[flowfield]")
+{
+  // arrange
+  ConfigurationSpace space = makeSpace(150, 80, 2);
+  const FlowField field(space, {146, 76});
+  REQUIRE(field.isCurrent());
+
+  // act
+  space.addObstacles({Circle({100, 70}, 4)});
+
+  // assert
+  REQUIRE(!field.isCurrent());
+  REQUIRE(FlowField(space, {146, 76}).isCurrent());
+}
+
+TEST_CASE("Path cache answers repeated queries", "[cache]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace(150, 80, 2);
+  const CachedPlanner<AStar> search(AStar(space),
+                                    std::make_shared<PathCache>(space, 8));
+  AStar::workspace_type workspace;
+  SearchStats missStats;
+  SearchStats hitStats;
+
+  // act
+  const std::vector<Cell> path =
+      search.searchPath({3, 3}, {146, 76}, workspace, &missStats);
+  const std::vector<Cell> cachedPath =
+      search.searchPath({3, 3}, {146, 76}, workspace, &hitStats);
+
+  // assert
+  REQUIRE(!missStats.cacheHit);
+  REQUIRE(missStats.nodesExpanded > 0U);
+  REQUIRE(hitStats.cacheHit);
+  REQUIRE(search_status::FOUND == hitStats.status);
+  REQUIRE(0U == hitStats.nodesExpanded);
+  REQUIRE(path == cachedPath);
+  REQUIRE(1U == search.cache()->hits());
+  REQUIRE(1U == search.cache()->misses());
+
+  // unreachable queries aren't cached
+  REQUIRE(search.searchPath({3, 3}, {0, 0}).empty());
+  REQUIRE(1U == search.cache()->size());
+}
+
+TEST_CASE("Path cache evicts the least recently used paths", "[cache]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace(150, 80, 2);
+  PathCache cache(space, 2);
+  const std::vector<Cell> pathA{{3, 3}, {4, 4}};
+  const std::vector<Cell> pathB{{5, 5}, {6, 6}};
+  const std::vector<Cell> pathC{{7, 7}, {8, 8}};
+
+  // act
+  cache.insert({3, 3}, {4, 4}, 2, pathA);
+  cache.insert({5, 5}, {6, 6}, 2, pathB);
+  REQUIRE(pathA == cache.find({3, 3}, {4, 4}, 2));
+  cache.insert({7, 7}, {8, 8}, 2, pathC);
+
+  // assert
+  REQUIRE(2U == cache.size());
+  REQUIRE(!cache.find({5, 5}, {6, 6}, 2));
+  REQUIRE(pathA == cache.find({3, 3}, {4, 4}, 2));
+  REQUIRE(pathC == cache.find({7, 7}, {8, 8}, 2));
+  // the robot radius is part of the key
+  REQUIRE(!cache.find({7, 7}, {8, 8}, 3));
+  REQUIRE(3U == cache.hits());
+  REQUIRE(2U == cache.misses());
+}
+
+TEST_CASE("Path cache only drops the paths through changed cells", "[cache]")
+{
+  // arrange
+  ConfigurationSpace space = makeSpace(150, 80, 2);
+  space.computeClearance();
+  const CachedPlanner<AStar> search(AStar(space),
+                                    std::make_shared<PathCache>(space, 8));
+  const CachedPlanner<AStar> largeSearch(
+      AStar(space, 4), std::make_shared<PathCache>(space, 8));
+  const std::vector<Cell> blocked = search.searchPath({3, 3}, {146, 76});
+  const std::vector<Cell> kept = search.searchPath({3, 76}, {20, 76});
+  const std::vector<Cell> largeBlocked =
+      largeSearch.searchPath({5, 5}, {144, 74});
+  std::vector<Cell> changedCells;
+
+  // act
+  space.addObstacles({Circle(blocked[blocked.size() / 2], 3)}, &changedCells);
+  search.cache()->invalidate(changedCells);
+  largeSearch.cache()->invalidate(changedCells);
+
+  // assert
+  AStar::workspace_type workspace;
+  SearchStats stats;
+  REQUIRE(kept == search.searchPath({3, 76}, {20, 76}, workspace, &stats));
+  REQUIRE(stats.cacheHit);
+  const std::vector<Cell> repaired =
+      search.searchPath({3, 3}, {146, 76}, workspace, &stats);
+  REQUIRE(!stats.cacheHit);
+  REQUIRE(repaired != blocked);
+  requireValidPath(space, repaired, {3, 3}, {146, 76});
+  REQUIRE(0U == largeSearch.cache()->size());
+
+  // paths found before a change which wasn't passed to the cache are dropped
+  space.addObstacles({Circle({140, 10}, 2)});
+  REQUIRE(kept == search.searchPath({3, 76}, {20, 76}, workspace, &stats));
+  REQUIRE(!stats.cacheHit);
+}
+
+TEST_CASE("Path cache keeps the paths of the padded cells and the clearance "
+          "apart",
+          "[cache]")
+{
+  // arrange
+  ConfigurationSpace space = makeSpace(150, 80, 2);
+  space.computeClearance();
+  const auto cache = std::make_shared<PathCache>(space, 8);
+  const CachedPlanner<AStar> padded(AStar(space), cache);
+  const CachedPlanner<AStar> clearance(AStar(space, space.robotRadius()),
+                                       cache);
+  AStar::workspace_type workspace;
+  SearchStats stats;
+  const std::vector<Cell> paddedPath = padded.searchPath({3, 3}, {146, 76});
+
+  // act
+  const std::vector<Cell> clearancePath =
+      clearance.searchPath({3, 3}, {146, 76}, workspace, &stats);
+
+  // assert
+  REQUIRE(!stats.cacheHit);
+  REQUIRE(2U == cache->size());
+  // the accessible cells differ at the edge of the padding
+  REQUIRE(paddedPath != clearancePath);
+  requireValidPath(
+      space, clearancePath, {3, 3}, {146, 76}, space.robotRadius());
+  REQUIRE(clearance.searchPath({3, 3}, {146, 76}, workspace, &stats) ==
+          clearancePath);
+  REQUIRE(stats.cacheHit);
+
+  // the path searched using the clearance is checked against it
+  std::vector<Cell> changedCells;
+  space.addObstacles({Circle(clearancePath[clearancePath.size() / 2], 3)},
+                     &changedCells);
+  cache->invalidate(changedCells);
+  REQUIRE(!clearance.searchPath({3, 3}, {146, 76}, workspace, &stats)
+               .empty());
+  REQUIRE(!stats.cacheHit);
+}
+
+TEST_CASE("Path cache drops the paths found before earlier changes",
+          "[cache]")
+{
+  // arrange
+  ConfigurationSpace space = makeSpace(150, 80, 2);
+  const CachedPlanner<AStar> search(AStar(space),
+                                    std::make_shared<PathCache>(space, 8));
+  const std::vector<Cell> blocked = search.searchPath({3, 3}, {146, 76});
+  const std::vector<Cell> kept = search.searchPath({3, 76}, {20, 76});
+  std::vector<Cell> firstCells;
+  std::vector<Cell> secondCells;
+
+  // act
+  // the first change blocks a cached path, but only the second is passed on
+  space.addObstacles({Circle(blocked[blocked.size() / 2], 3)}, &firstCells);
+  space.addObstacles({Circle({140, 10}, 2)}, &secondCells);
+  search.cache()->invalidate(secondCells);
+
+  // assert
+  REQUIRE(!firstCells.empty());
+  REQUIRE(!secondCells.empty());
+  REQUIRE(0U == search.cache()->size());
+  AStar::workspace_type workspace;
+  SearchStats stats;
+  const std::vector<Cell> repaired =
+      search.searchPath({3, 3}, {146, 76}, workspace, &stats);
+  REQUIRE(!stats.cacheHit);
+  requireValidPath(space, repaired, {3, 3}, {146, 76});
+  REQUIRE(kept == search.searchPath({3, 76}, {20, 76}, workspace, &stats));
+  REQUIRE(!stats.cacheHit);
+
+  // paths found in the current version are kept by a repeated invalidate
+  search.cache()->invalidate(secondCells);
+  REQUIRE(2U == search.cache()->size());
+  REQUIRE(kept == search.searchPath({3, 76}, {20, 76}, workspace, &stats));
+  REQUIRE(stats.cacheHit);
+}
+
+TEST_CASE("Path cache is shared by the threads of a batch planner", "[cache]")
+{
+  // arrange
+  const SharedConfigSpace space =
+      std::make_shared<const ConfigurationSpace>(makeSpace(150, 80, 2));
+  const auto cache = std::make_shared<PathCache>(space, 64);
+  BatchPlanner<CachedPlanner<AStar>> batch(
+      CachedPlanner<AStar>(AStar(space), cache),
+      std::make_shared<ThreadPool>(3));
+  std::vector<PathQuery> queries;
+  for (size_t idx = 0; idx < 20; ++idx) {
+    queries.emplace_back(Cell(3 + idx, 3), Cell(146 - idx, 76));
+  }
+
+  // act
+  const std::vector<std::vector<Cell>> paths = batch.searchPaths(queries);
+  std::vector<SearchStats> stats;
+  const std::vector<std::vector<Cell>> cachedPaths =
+      batch.searchPaths(queries, &stats);
+
+  // assert
+  REQUIRE(paths == cachedPaths);
+  for (const SearchStats& st : stats) {
+    REQUIRE(st.cacheHit);
+  }
+  REQUIRE(queries.size() == cache->hits());
+  REQUIRE(queries.size() == cache->misses());
+}
+
+TEST_CASE("Line of sight matches the cells crossed by the segment",
+          "[anyangle]")
+{
+  // arrange
+  ConfigurationSpace space(24, 24, 0);
+  space.addObstacles({Circle({8, 8}, 3), Circle({17, 15}, 2)});
+  space.addObstacles({Circle({4, 19}, 1)});
+  space.computeClearance();
+
+  for (size_t ay = 0; ay < 24; ay += 3) {
+    for (size_t ax = 1; ax < 24; ax += 2) {
+      for (size_t by = 2; by < 24; by += 3) {
+        for (size_t bx = 0; bx < 24; bx += 3) {
+          const Cell a(ax, ay);
+          const Cell b(bx, by);
+
+          // act & assert
+          REQUIRE(referenceIsClear(space, a, b) ==
+                  LineOfSight::isClear(space, a, b));
+          REQUIRE(LineOfSight::isClear(space, a, b) ==
+                  LineOfSight::isClear(space, b, a));
+          REQUIRE(referenceIsClear(space, a, b, 1U) ==
+                  LineOfSight::isClear(space, a, b, 1U));
+        }
+      }
+    }
+  }
+
+  // diagonals may pass between the corners of blocked cells
+  DataMap<cell_state> states(std::make_pair(4, 4), cell_state::FREE);
+  states.at(1, 0) = cell_state::OBJECT;
+  states.at(0, 1) = cell_state::OBJECT;
+  const ConfigurationSpace corners(states, 0);
+  REQUIRE(LineOfSight::isClear(corners, {0, 0}, {3, 3}));
+  REQUIRE(!LineOfSight::isClear(corners, {0, 0}, {3, 2}));
+  REQUIRE(!LineOfSight::isClear(corners, {0, 0}, {2, 1}));
+}
+
+TEST_CASE("Smoothed paths keep only the corners of the grid path",
+          "[anyangle]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace(150, 80, 2);
+  const AStar search(space);
+  const std::vector<Cell> path = search.searchPath({3, 40}, {146, 40});
+
+  for (const auto& [start, goal] : QUERIES) {
+    const std::vector<Cell> gridPath = search.searchPath(start, goal);
+
+    // act
+    const std::vector<Cell> waypoints =
+        LineOfSight::smoothPath(space, gridPath);
+
+    // assert
+    requireClearWaypoints(space, waypoints, start, goal);
+    REQUIRE(waypoints.size() < gridPath.size() / 4U);
+    auto it = gridPath.begin();
+    for (const Cell& c : waypoints) {
+      it = std::find(it, gridPath.end(), c);
+      REQUIRE(it != gridPath.end());
+    }
+    REQUIRE(LineOfSight::pathLength(waypoints) <=
+            pathCost<EuclideanCost>(gridPath) + 1e-9);
+    REQUIRE(LineOfSight::pathLength(waypoints) >= start.distance(goal));
+  }
+
+  // the path around an obstacle needs at least one corner
+  REQUIRE(LineOfSight::smoothPath(space, path).size() >= 3U);
+
+  // paths without obstacles are a single segment
+  const ConfigurationSpace open(40, 30, 0);
+  const std::vector<Cell> openPath = AStar(open).searchPath({1, 2}, {37, 25});
+  REQUIRE(std::vector<Cell>{{1, 2}, {37, 25}} ==
+          LineOfSight::smoothPath(open, openPath));
+}
+
+TEST_CASE("Theta* finds any-angle paths no longer than the grid paths",
+          "[anyangle]")
+{
+  // arrange
+  ConfigurationSpace space = makeSpace(150, 80, 0);
+  space.computeClearance();
+
+  for (const size_t robotRadius : {0U, 2U}) {
+    const ThetaStar search(space, robotRadius);
+    ThetaStar::workspace_type workspace;
+    for (const auto& [start, goal] : QUERIES) {
+      SearchStats stats;
+
+      // act
+      const std::vector<Cell> waypoints =
+          search.searchPath(start, goal, workspace, &stats);
+
+      // assert
+      REQUIRE(search_status::FOUND == stats.status);
+      requireClearWaypoints(space, waypoints, start, goal, robotRadius);
+      const double length = LineOfSight::pathLength(waypoints);
+      REQUIRE(length <= dijkstraCost<EuclideanCost>(
+                            space, start, goal, robotRadius) +
+                            1e-9);
+      REQUIRE(length >= start.distance(goal));
+    }
+  }
+
+  // paths without obstacles are a single segment
+  const ConfigurationSpace open(40, 30, 0);
+  REQUIRE(std::vector<Cell>{{1, 2}, {37, 25}} ==
+          ThetaStar(open).searchPath({1, 2}, {37, 25}));
+
+  // invalid queries are rejected as by the grid planners
+  SearchStats stats;
+  ThetaStar::workspace_type workspace;
+  REQUIRE(ThetaStar(space, 20)
+              .searchPath({3, 3}, {146, 76}, workspace, &stats)
+              .empty());
+  REQUIRE(search_status::START_BLOCKED == stats.status);
+}
+
+TEST_CASE("Anytime A* finds optimal paths without a budget", "[anytime]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace(150, 80, 2);
+  const AnytimeAStar search(space, 3.0);
+  const BasicAnytimeAStar<EuclideanCost> euclideanSearch(space, 2.5);
+  AnytimeAStar::workspace_type workspace;
+
+  for (const auto& [start, goal] : QUERIES) {
+    SearchStats stats;
+
+    // act
+    const std::vector<Cell> path =
+        search.searchPath(start, goal, workspace, &stats);
+    const std::vector<Cell> euclideanPath =
+        euclideanSearch.searchPath(start, goal);
+
+    // assert
+    REQUIRE(search_status::FOUND == stats.status);
+    REQUIRE(1.0 == stats.suboptimalityBound);
+    requireValidPath(space, path, start, goal);
+    REQUIRE(dijkstraCost<OctileCost>(space, start, goal) ==
+            pathCost<OctileCost>(path));
+    REQUIRE(dijkstraCost<EuclideanCost>(space, start, goal) ==
+            Approx(pathCost<EuclideanCost>(euclideanPath)));
+  }
+}
+
+TEST_CASE("Anytime A* paths are within their bound and improve with budget",
+          "[anytime]")
+{
+  // arrange
+  const size_t nx = 250;
+  const size_t ny = 100;
+  ConfigurationSpace space(nx, ny, 2);
+  space.addObstacles(Scenarios::obstacles(obstacle_config::COMPLEX, nx, ny, 2));
+  const Cell start = Scenarios::start(nx, ny, 2);
+  const Cell goal = Scenarios::goal(nx, ny, 2);
+  const uint32_t optimal = dijkstraCost<OctileCost>(space, start, goal);
+  const AnytimeAStar search(space, 4.0);
+  AnytimeAStar::workspace_type workspace;
+  uint32_t lastCost = std::numeric_limits<uint32_t>::max();
+  double lastBound = 4.0;
+  bool wasSuboptimal = false;
+
+  for (size_t maxExpansions = 250; maxExpansions < 100000;
+       maxExpansions *= 2) {
+    SearchStats stats;
+
+    // act
+    const std::vector<Cell> path =
+        search.searchPath(start,
+                          goal,
+                          SearchBudget{std::nullopt, maxExpansions},
+                          workspace,
+                          &stats);
+
+    // assert
+    REQUIRE(stats.nodesExpanded <= maxExpansions);
+    if (stats.status == search_status::BUDGET_EXHAUSTED) {
+      REQUIRE(path.empty());
+      REQUIRE(lastCost == std::numeric_limits<uint32_t>::max());
+      continue;
+    }
+    REQUIRE(search_status::FOUND == stats.status);
+    requireValidPath(space, path, start, goal);
+    const uint32_t cost = pathCost<OctileCost>(path);
+    REQUIRE(cost <= stats.suboptimalityBound * optimal);
+    REQUIRE(cost <= lastCost);
+    REQUIRE(stats.suboptimalityBound <= lastBound);
+    wasSuboptimal = wasSuboptimal || cost > optimal;
+    lastCost = cost;
+    lastBound = stats.suboptimalityBound;
+  }
+  REQUIRE(wasSuboptimal);
+  REQUIRE(optimal == lastCost);
+  REQUIRE(1.0 == lastBound);
+}
+
+TEST_CASE("Anytime A* reports budgets exhausted before a path is found",
+          "[anytime]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace(150, 80, 2);
+  const AnytimeAStar search(
+      space, 1.0, SearchBudget{SearchStats::duration::zero(), std::nullopt});
+  AnytimeAStar::workspace_type workspace;
+  SearchStats stats;
+
+  // act & assert
+  REQUIRE(search.searchPath({3, 3}, {146, 76}, workspace, &stats).empty());
+  REQUIRE(search_status::BUDGET_EXHAUSTED == stats.status);
+  const std::vector<Cell> path =
+      search.searchPath({3, 3}, {146, 76}, SearchBudget(), workspace, &stats);
+  REQUIRE(search_status::FOUND == stats.status);
+  REQUIRE(dijkstraCost<OctileCost>(space, {3, 3}, {146, 76}) ==
+          pathCost<OctileCost>(path));
+  REQUIRE_THROWS_AS(AnytimeAStar(space, 0.5), std::runtime_error);
+
+  // the goal is connected to the start, but not by moves along the axes
+  DataMap<cell_state> states(std::make_pair(6, 6), cell_state::FREE);
+  for (size_t idx = 0; idx < 6; ++idx) {
+    states.at(idx, 5 - idx) = cell_state::OBJECT;
+  }
+  const ConfigurationSpace walled(states, 0);
+  BasicAnytimeAStar<ManhattanCost>::workspace_type manhattanWorkspace;
+  REQUIRE(BasicAnytimeAStar<ManhattanCost>(walled)
+              .searchPath({0, 0}, {5, 5}, manhattanWorkspace, &stats)
+              .empty());
+  REQUIRE(search_status::NOT_FOUND == stats.status);
+}
+
+TEST_CASE("Async planning matches sequential planning", "[async]")
+{
+  // arrange
+  const SharedConfigSpace space =
+      std::make_shared<const ConfigurationSpace>(makeSpace(150, 80, 2));
+  const auto pool = std::make_shared<ThreadPool>(3);
+  const AsyncPlanner<AStar> async(AStar(space), pool);
+  const AsyncPlanner<JumpPointSearch> jpsAsync(JumpPointSearch(space), pool);
+  std::mutex mutex;
+  std::vector<std::pair<size_t, PathResult>> callbackResults;
+
+  // act
+  std::vector<std::future<PathResult>> results;
+  std::vector<std::future<PathResult>> jpsResults;
+  std::vector<std::future<void>> callbacks;
+  for (size_t idx = 0; idx < QUERIES.size(); ++idx) {
+    const auto& [start, goal] = QUERIES[idx];
+    results.push_back(async.submit(start, goal));
+    jpsResults.push_back(jpsAsync.submit(start, goal));
+    callbacks.push_back(
+        async.submit(start, goal, [&, idx](PathResult&& result) {
+          std::lock_guard<std::mutex> lock(mutex);
+          callbackResults.emplace_back(idx, std::move(result));
+        }));
+  }
+  for (auto& callback : callbacks) {
+    callback.get();
+  }
+
+  // assert
+  const AStar search(space);
+  const JumpPointSearch jps(space);
+  for (size_t idx = 0; idx < QUERIES.size(); ++idx) {
+    const auto& [start, goal] = QUERIES[idx];
+    const PathResult result = results[idx].get();
+    REQUIRE(search_status::FOUND == result.stats.status);
+    REQUIRE(search.searchPath(start, goal) == result.path);
+    REQUIRE(jps.searchPath(start, goal) == jpsResults[idx].get().path);
+  }
+  REQUIRE(QUERIES.size() == callbackResults.size());
+  for (const auto& [idx, result] : callbackResults) {
+    REQUIRE(search.searchPath(QUERIES[idx].first, QUERIES[idx].second) ==
+            result.path);
+  }
+}
+
+TEST_CASE("Cancelled queries are abandoned", "[async]")
+{
+  // arrange
+  const ConfigurationSpace space = makeSpace(150, 80, 2);
+  const auto pool = std::make_shared<ThreadPool>(1);
+  const AsyncPlanner<AStar> async(AStar(space), pool);
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::stop_source source;
+
+  // act
+  // hold up the only worker, so the query is cancelled before it starts
+  std::future<void> blocker =
+      pool->submit([released](size_t /* workerIdx */) { released.wait(); });
+  std::future<PathResult> cancelled =
+      async.submit({3, 3}, {146, 76}, source.get_token());
+  std::future<PathResult> kept = async.submit({3, 3}, {146, 76});
+  source.request_stop();
+  release.set_value();
+
+  // assert
+  const PathResult cancelledResult = cancelled.get();
+  REQUIRE(cancelledResult.path.empty());
+  REQUIRE(search_status::CANCELLED == cancelledResult.stats.status);
+  REQUIRE(0U == cancelledResult.stats.nodesExpanded);
+  REQUIRE(search_status::FOUND == kept.get().stats.status);
+
+  // searches check for cancellation within the search loop
+  AStar::workspace_type workspace;
+  SearchStats stats;
+  REQUIRE(AStar(space)
+              .searchPath(
+                  {3, 3}, {146, 76}, workspace, &stats, source.get_token())
+              .empty());
+  REQUIRE(search_status::CANCELLED == stats.status);
+  REQUIRE(0U == stats.nodesExpanded);
+  AnytimeAStar::workspace_type anytimeWorkspace;
+  REQUIRE(AnytimeAStar(space)
+              .searchPath({3, 3},
+                          {146, 76},
+                          anytimeWorkspace,
+                          &stats,
+                          source.get_token())
+              .empty());
+  REQUIRE(search_status::CANCELLED == stats.status);
+
+  // queries submitted with a token never asked to stop run to completion
+  std::stop_source unused;
+  const PathResult result =
+      async.submit({3, 3}, {146, 76}, unused.get_token()).get();
+  REQUIRE(search_status::FOUND == result.stats.status);
+}
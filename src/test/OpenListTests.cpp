@@ -0,0 +1,191 @@
+/**
+ * @file OpenListTests.cpp
+ * @brief Unit tests for the open list priority queues.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#include "Heuristics.h"
+#include "OpenList.h"
+
+#include "catch2.h"
+
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+/**
+ * @brief Push random items, randomly decreasing keys of queued items, and check
+ * the items are popped in non-decreasing key order with their lowest key.
+ */
+template <typename Queue>
+void testRandomOps(Queue& queue, const bool skipStale)
+{
+  constexpr uint32_t NUM_ITEMS = 500;
+  std::mt19937 rng(42);
+  std::vector<uint32_t> keys(NUM_ITEMS, 0U);
+  std::vector<bool> queued(NUM_ITEMS, false);
+  std::vector<bool> popped(NUM_ITEMS, false);
+
+  queue.reset(NUM_ITEMS);
+  for (uint32_t item = 0; item < NUM_ITEMS; ++item) {
+    keys[item] = 100U + rng() % 1000U;
+    queue.push(item, keys[item]);
+    queued[item] = true;
+  }
+  for (size_t idx = 0; idx < 2000; ++idx) {
+    const uint32_t item = rng() % NUM_ITEMS;
+    if (keys[item] > 100U) {
+      keys[item] -= 1U + rng() % (keys[item] - 100U);
+      queue.decreaseKey(item, keys[item]);
+    }
+  }
+
+  uint32_t lastKey = 0U;
+  size_t numPopped = 0;
+  while (!queue.empty()) {
+    const auto entry = queue.pop();
+    if (skipStale && popped[entry.item]) {
+      continue;
+    }
+    REQUIRE(!popped[entry.item]);
+    REQUIRE(keys[entry.item] == entry.key);
+    REQUIRE(lastKey <= entry.key);
+    popped[entry.item] = true;
+    lastKey = entry.key;
+    ++numPopped;
+  }
+  REQUIRE(NUM_ITEMS == numPopped);
+}
+} // namespace
+
+TEST_CASE("Indexed heap pops items in key order with decrease-key",
+          "[openlist]")
+{
+  IndexedHeap<uint32_t> binaryHeap;
+  testRandomOps(binaryHeap, false);
+
+  IndexedHeap<uint32_t, 2> quaternaryHeap;
+  testRandomOps(quaternaryHeap, false);
+}
+
+TEST_CASE("Indexed heap tracks which items it contains", "[openlist]")
+{
+  // arrange
+  IndexedHeap<double> heap;
+  heap.reset(10);
+
+  // act
+  heap.push(3, 2.0);
+  heap.push(7, 1.0);
+  heap.push(5, 3.0);
+
+  // assert
+  REQUIRE(heap.contains(3));
+  REQUIRE(heap.contains(7));
+  REQUIRE(!heap.contains(0));
+  REQUIRE(7 == heap.pop().item);
+  REQUIRE(!heap.contains(7));
+
+  // stale positions are not reported after a reset
+  heap.reset(10);
+  REQUIRE(!heap.contains(3));
+  REQUIRE(!heap.contains(5));
+}
+
+TEST_CASE("Bucket queue pops items in key order, skipping stale entries",
+          "[openlist]")
+{
+  BucketQueue<uint32_t> queue;
+  testRandomOps(queue, true);
+
+  // reuse after a reset with a different key range
+  testRandomOps(queue, true);
+}
+
+TEST_CASE("Bucket queue rejects keys below the last popped key", "[openlist]")
+{
+  // inconsistent cost policies are rejected at compile time
+  static_assert(IS_COMPATIBLE_OPEN_LIST<OctileCost, BucketQueue<uint32_t>>);
+  static_assert(
+      IS_COMPATIBLE_OPEN_LIST<WeightedCost<OctileCost, 1>, BucketQueue<uint32_t>>);
+  static_assert(!IS_COMPATIBLE_OPEN_LIST<WeightedCost<OctileCost, 3, 2>,
+                                         BucketQueue<uint32_t>>);
+  static_assert(IS_COMPATIBLE_OPEN_LIST<WeightedCost<OctileCost, 3, 2>,
+                                        IndexedHeap<uint32_t>>);
+
+  // arrange
+  BucketQueue<uint32_t> queue;
+  queue.reset(10);
+  queue.push(1, 20);
+  // lower keys are accepted before the first pop
+  queue.push(2, 15);
+  queue.push(3, 30);
+
+  // act & assert
+  REQUIRE(2U == queue.pop().item);
+  REQUIRE_THROWS_AS(queue.push(4, 10), std::runtime_error);
+  REQUIRE_THROWS_AS(queue.push(4, 14), std::runtime_error);
+  queue.push(4, 15);
+  REQUIRE(3U == queue.size());
+  REQUIRE(4U == queue.pop().item);
+  REQUIRE(1U == queue.pop().item);
+  REQUIRE_THROWS_AS(queue.push(4, 19), std::runtime_error);
+  REQUIRE(3U == queue.pop().item);
+  REQUIRE(queue.empty());
+
+  // any keys may be pushed after a reset
+  queue.reset(10);
+  queue.push(5, 1);
+  REQUIRE(5U == queue.pop().item);
+}
+
+TEST_CASE("Indexed heap raises keys and erases items", "[openlist]")
+{
+  // arrange
+  constexpr size_t NUM_ITEMS = 300;
+  std::mt19937 rng(9);
+  std::uniform_int_distribution<uint32_t> keyDist(0, 1000);
+  std::uniform_int_distribution<int> opDist(0, 2);
+  IndexedHeap<uint32_t> heap;
+  heap.reset(NUM_ITEMS);
+  std::vector<std::optional<uint32_t>> keys(NUM_ITEMS);
+  for (uint32_t item = 0; item < NUM_ITEMS; ++item) {
+    keys[item] = keyDist(rng);
+    heap.push(item, *keys[item]);
+  }
+
+  // act
+  // change the keys of half of the items in either direction, and erase a
+  // quarter of them
+  for (uint32_t item = 0; item < NUM_ITEMS; ++item) {
+    const int op = opDist(rng);
+    if (op == 0) {
+      keys[item] = keyDist(rng);
+      heap.updateKey(item, *keys[item]);
+    } else if (op == 1 && item % 2 == 0) {
+      keys[item].reset();
+      heap.erase(item);
+    }
+  }
+
+  // assert
+  uint32_t lastKey = 0;
+  size_t numPopped = 0;
+  while (!heap.empty()) {
+    const auto entry = heap.pop();
+    REQUIRE(keys[entry.item]);
+    REQUIRE(*keys[entry.item] == entry.key);
+    REQUIRE(entry.key >= lastKey);
+    lastKey = entry.key;
+    keys[entry.item].reset();
+    ++numPopped;
+  }
+  for (const auto& key : keys) {
+    REQUIRE(!key);
+  }
+  REQUIRE(numPopped > NUM_ITEMS / 2);
+}
@@ -0,0 +1,180 @@
+/**
+ * @file RowKernelsTests.cpp
+ * @brief Unit tests for the vectorized row kernels.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#include "ConfigSpace.h"
+#include "RowKernels.h"
+
+#include "catch2.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+// covers the empty row, partial vectors and words, and several whole vectors
+constexpr size_t MAX_ROW_LENGTH = 200;
+
+/**
+ * @brief Generate a row of bytes drawn from a few values, with long runs so
+ * that whole vectors both match and do not match.
+ */
+std::vector<uint8_t> randomStates(std::mt19937& rng, const size_t n)
+{
+  std::uniform_int_distribution<int> valueDist(0, 2);
+  std::uniform_int_distribution<size_t> runDist(1, 40);
+  std::vector<uint8_t> states;
+  while (states.size() < n) {
+    states.insert(states.end(),
+                  runDist(rng),
+                  static_cast<uint8_t>(valueDist(rng)));
+  }
+  states.resize(n);
+  return states;
+}
+
+/**
+ * @brief Generate a row of free bytes, padded by a cell either side.
+ */
+std::vector<uint8_t> randomFreeBytes(std::mt19937& rng, const size_t n)
+{
+  std::bernoulli_distribution freeDist(0.7);
+  std::vector<uint8_t> bytes(n + 2);
+  for (uint8_t& b : bytes) {
+    b = freeDist(rng) ? 0xFFU : 0x00U;
+  }
+  return bytes;
+}
+} // namespace
+
+TEST_CASE("The best row kernels are the last supported", "[kernels]")
+{
+  // arrange
+  const std::vector<RowKernels> kernels = RowKernels::supported();
+
+  // act & assert
+  REQUIRE(std::string("scalar") == kernels.front().name);
+  REQUIRE(std::string(kernels.back().name) == RowKernels::best().name);
+}
+
+TEST_CASE("Row kernels match the scalar kernels", "[kernels]")
+{
+  // arrange
+  std::mt19937 rng(3);
+  const RowKernels scalar = RowKernels::scalar();
+
+  for (const RowKernels& kernels : RowKernels::supported()) {
+    INFO(kernels.name);
+    for (size_t n = 0; n <= MAX_ROW_LENGTH; ++n) {
+      INFO(n);
+      const std::vector<uint8_t> states = randomStates(rng, n);
+      const uint8_t value = static_cast<uint8_t>(n % 3);
+
+      // act & assert
+      std::vector<uint8_t> expectedBytes(n);
+      std::vector<uint8_t> actualBytes(n);
+      scalar.matchBytes(states.data(), n, value, expectedBytes.data());
+      kernels.matchBytes(states.data(), n, value, actualBytes.data());
+      REQUIRE(expectedBytes == actualBytes);
+
+      // the words are written in full, so start from a different value
+      const size_t numWords = (n + 63) / 64;
+      std::vector<uint64_t> expectedWords(numWords, 0U);
+      std::vector<uint64_t> actualWords(numWords, ~uint64_t{0});
+      scalar.packMatches(states.data(), n, value, expectedWords.data());
+      kernels.packMatches(states.data(), n, value, actualWords.data());
+      REQUIRE(expectedWords == actualWords);
+
+      std::vector<uint8_t> expectedStates = states;
+      std::vector<uint8_t> actualStates = states;
+      scalar.replaceBytes(expectedStates.data(), n, value, 7U);
+      kernels.replaceBytes(actualStates.data(), n, value, 7U);
+      REQUIRE(expectedStates == actualStates);
+
+      const std::vector<uint8_t> below = randomFreeBytes(rng, n);
+      const std::vector<uint8_t> center = randomFreeBytes(rng, n);
+      const std::vector<uint8_t> above = randomFreeBytes(rng, n);
+      std::vector<uint8_t> expectedMasks(n);
+      std::vector<uint8_t> actualMasks(n);
+      scalar.nbrMasks(below.data() + 1,
+                      center.data() + 1,
+                      above.data() + 1,
+                      n,
+                      expectedMasks.data());
+      kernels.nbrMasks(below.data() + 1,
+                       center.data() + 1,
+                       above.data() + 1,
+                       n,
+                       actualMasks.data());
+      REQUIRE(expectedMasks == actualMasks);
+
+      // a large byte at any position, including the tail
+      std::vector<uint8_t> bytes = states;
+      if (n > 0) {
+        bytes[(n / 2 + 7U) % n] = static_cast<uint8_t>(200U + n % 50U);
+      }
+      REQUIRE(scalar.maxByte(states.data(), n) ==
+              kernels.maxByte(states.data(), n));
+      REQUIRE(scalar.maxByte(bytes.data(), n) ==
+              kernels.maxByte(bytes.data(), n));
+    }
+  }
+}
+
+TEST_CASE("Scalar row kernels pack matches into bits", "[kernels]")
+{
+  // arrange
+  std::vector<uint8_t> states(70, 0U);
+  states[0] = 1U;
+  states[63] = 1U;
+  states[64] = 1U;
+  states[69] = 1U;
+  std::vector<uint64_t> words(2, ~uint64_t{0});
+
+  // act
+  RowKernels::scalar().packMatches(
+      states.data(), states.size(), 1U, words.data());
+
+  // assert
+  REQUIRE((uint64_t{1} | uint64_t{1} << 63U) == words[0]);
+  REQUIRE((uint64_t{1} | uint64_t{1} << 5U) == words[1]);
+}
+
+TEST_CASE("Scalar row kernels find the largest byte", "[kernels]")
+{
+  // arrange
+  std::vector<uint8_t> bytes(70, 1U);
+  bytes[41] = 0xFEU;
+
+  // act & assert
+  REQUIRE(0xFEU == RowKernels::scalar().maxByte(bytes.data(), bytes.size()));
+  REQUIRE(1U == RowKernels::scalar().maxByte(bytes.data(), 41));
+  REQUIRE(0U == RowKernels::scalar().maxByte(bytes.data(), 0));
+}
+
+TEST_CASE("Scalar neighbor masks follow the neighbor offsets", "[kernels]")
+{
+  // arrange
+  // a single free cell at each neighbor of the center cell in turn, which is
+  // at index 1 of a row of three
+  for (size_t dir = 0; dir < NBR_OFFSETS.size(); ++dir) {
+    std::vector<std::vector<uint8_t>> rows(3, std::vector<uint8_t>(5, 0U));
+    rows[1 + NBR_OFFSETS[dir].dy][2 + NBR_OFFSETS[dir].dx] = 0xFFU;
+    std::vector<uint8_t> masks(3);
+
+    // act
+    RowKernels::scalar().nbrMasks(rows[0].data() + 1,
+                                  rows[1].data() + 1,
+                                  rows[2].data() + 1,
+                                  masks.size(),
+                                  masks.data());
+
+    // assert
+    REQUIRE((1U << dir) == masks[1]);
+  }
+}
@@ -0,0 +1,105 @@
+/**
+ * @file TiledGridTests.cpp
+ * @brief Unit tests for the tiled grid data structures.
+ * @author Kevin Briggs <kevinabriggs@hotmail.com>
+ * @version 1
+ * @date 2022-11-16
+ */
+#include "ConfigSpace.h"
+#include "Grid.h"
+#include "TiledGrid.h"
+
+#include "catch2.h"
+
+#include <cstdint>
+#include <vector>
+
+TEST_CASE("Tile indices are unique and invertible", "[tiled]")
+{
+  // arrange
+  const TileIndexer grid(150, 70);
+  std::vector<bool> used(grid.storageSize(), false);
+
+  // act & assert
+  REQUIRE(3U == grid.numTilesX());
+  REQUIRE(2U == grid.numTilesY());
+  for (size_t yIdx = 0; yIdx < grid.numY(); ++yIdx) {
+    for (size_t xIdx = 0; xIdx < grid.numX(); ++xIdx) {
+      const size_t idx = grid.idxFrom(xIdx, yIdx);
+      REQUIRE(idx < grid.storageSize());
+      REQUIRE(!used[idx]);
+      used[idx] = true;
+      REQUIRE(Cell(xIdx, yIdx) == grid.cellFrom(idx));
+    }
+  }
+}
+
+TEST_CASE("Tiles are only allocated for values other than the fill value",
+          "[tiled]")
+{
+  // arrange
+  TiledDataMap<uint8_t> map(std::make_pair(300, 200), 0U);
+
+  // act
+  map.set(10, 10, 0U);
+  map.fillSpan(100, 0, 299, 0U);
+  map.replaceSpan(150, 0, 299, 1U, 2U);
+  const size_t allocatedByFill = map.numAllocatedTiles();
+  map.set(70, 10, 5U);
+  map.fillSpan(130, 60, 140, 7U);
+
+  // assert
+  REQUIRE(0U == allocatedByFill);
+  REQUIRE(4U == map.numAllocatedTiles());
+  REQUIRE(map.isTileAllocated(1, 0));
+  REQUIRE(map.isTileAllocated(0, 2));
+  REQUIRE(map.isTileAllocated(1, 2));
+  REQUIRE(map.isTileAllocated(2, 2));
+  REQUIRE(5U == map.at(70, 10));
+  REQUIRE(0U == map.at(71, 10));
+  REQUIRE(7U == map.at(60, 130));
+  REQUIRE(7U == map.at(140, 130));
+  REQUIRE(0U == map.at(141, 130));
+}
+
+TEST_CASE("Tiled data round trips through a dense map", "[tiled]")
+{
+  // arrange
+  ConfigurationSpace space(500, 300, 3);
+  space.addObstacles({Circle({100, 100}, 20), Circle({480, 20}, 5)});
+
+  // act
+  TiledDataMap<cell_state> tiled(space.cellStates(), cell_state::FREE);
+  const DataMap<cell_state> dense = tiled.toDense();
+
+  // assert
+  // only the padded boundary and the tiles overlapping the obstacles
+  REQUIRE(tiled.numAllocatedTiles() < tiled.numTiles());
+  REQUIRE(!tiled.isTileAllocated(4, 2));
+  for (size_t yIdx = 0; yIdx < space.numY(); ++yIdx) {
+    for (size_t xIdx = 0; xIdx < space.numX(); ++xIdx) {
+      REQUIRE(space.cellStates().at(xIdx, yIdx) == tiled.at(xIdx, yIdx));
+      REQUIRE(space.cellStates().at(xIdx, yIdx) == dense.at(xIdx, yIdx));
+    }
+  }
+}
+
+TEST_CASE("Compacting releases the tiles of only the fill value", "[tiled]")
+{
+  // arrange
+  TiledDataMap<uint8_t> map(std::make_pair(200, 200), 0U);
+  map.fillSpan(10, 0, 199, 1U);
+  map.fillSpan(70, 0, 199, 1U);
+
+  // act
+  map.fillSpan(10, 0, 199, 0U);
+  const TiledDataMap<uint8_t> copy = map;
+  map.compact();
+
+  // assert
+  REQUIRE(8U == copy.numAllocatedTiles());
+  REQUIRE(4U == map.numAllocatedTiles());
+  REQUIRE(1U == map.at(199, 70));
+  REQUIRE(1U == copy.at(199, 70));
+  REQUIRE(0U == map.at(199, 10));
+}